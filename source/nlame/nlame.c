@@ -52,20 +52,48 @@ typedef enum
 } nlame_quality_value;
 
 
+/*! checks if libmp3lame.dll exports the given functions; the dll is delay-loaded and may not
+    be loaded yet, so it is loaded here. returns -1 when the dll couldn't be loaded, so that
+    the result isn't cached by the caller */
+static int is_avail_lame_functions(const char* function_name1, const char* function_name2)
+{
+   int is_avail;
+   HMODULE module = LoadLibrary("libmp3lame.dll");
+
+   if (module == NULL)
+      return -1;
+
+   is_avail =
+      (GetProcAddress(module, function_name1) != NULL &&
+         (function_name2 == NULL || GetProcAddress(module, function_name2) != NULL)) ? 1 : 0;
+
+   FreeLibrary(module);
+
+   return is_avail;
+}
+
 int is_avail_lame_encode_buffer_interleaved_int()
 {
    static int is_avail = -1;
 
    if (is_avail == -1)
-   {
-      HMODULE module = GetModuleHandle("libmp3lame.dll");
+      is_avail = is_avail_lame_functions("lame_encode_buffer_interleaved_int", NULL);
+
+   return is_avail == 1 ? 1 : 0;
+}
+
+int is_avail_lame_encode_buffer_ieee_float()
+{
+   static int is_avail = -1;
 
-      is_avail =
-         (module != NULL &&
-            GetProcAddress(module, "lame_encode_buffer_interleaved_int") != NULL) ? 1 : 0;
+   if (is_avail == -1)
+   {
+      is_avail = is_avail_lame_functions(
+         "lame_encode_buffer_ieee_float",
+         "lame_encode_buffer_interleaved_ieee_float");
    }
 
-   return is_avail;
+   return is_avail == 1 ? 1 : 0;
 }
 
 
@@ -409,6 +437,10 @@ int nlame_var_get_int(nlame_instance_t* inst, nlame_var_int_type type)
       val = is_avail_lame_encode_buffer_interleaved_int();
       break;
 
+   case nle_var_is_avail_encode_buffer_ieee_float:
+      val = is_avail_lame_encode_buffer_ieee_float();
+      break;
+
    default:
       assert(0); /* invalid value */
       break;
@@ -527,6 +559,14 @@ int nlame_encode_buffer(nlame_instance_t* inst,
          mp3buf, mp3buf_size);
       break;
 
+   case nle_buffer_ieee_float:
+      assert(is_avail_lame_encode_buffer_ieee_float());
+
+      ret = lame_encode_buffer_ieee_float(inst->lgf,
+         (const float*)buffer_l, (const float*)buffer_r, nsamples,
+         mp3buf, mp3buf_size);
+      break;
+
    default:
       assert(0); /* invalid value */
       break;
@@ -567,6 +607,14 @@ int nlame_encode_buffer_interleaved(nlame_instance_t* inst,
 
       break;
 
+   case nle_buffer_ieee_float:
+      assert(is_avail_lame_encode_buffer_ieee_float());
+
+      ret = lame_encode_buffer_interleaved_ieee_float(inst->lgf,
+         (const float*)buffer, nsamples, mp3buf, mp3buf_size);
+
+      break;
+
    default:
       assert(0); /* invalid value */
       break;
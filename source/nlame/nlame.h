@@ -71,6 +71,12 @@
       The following new variable values were added:
       nle_var_is_avail_encode_buffer_interleaved_int
 
+    Version 7: introduced on 2026-10-18
+      The following new buffer type was added:
+      nle_buffer_ieee_float
+      The following new variable values were added:
+      nle_var_is_avail_encode_buffer_ieee_float
+
 */
 /*! \defgroup nlame nlame Documentation
 
@@ -386,6 +392,11 @@ typedef enum
        nlame_encode_buffer_type of nle_buffer_int. */
    nle_var_is_avail_encode_buffer_interleaved_int = 52,
 
+   /*! when 1, the nlame_encode_buffer_*() functions can be used with the
+       nlame_encode_buffer_type of nle_buffer_ieee_float; can also be queried
+       with a NULL instance, e.g. before creating an instance. */
+   nle_var_is_avail_encode_buffer_ieee_float = 53,
+
 } nlame_var_int_type;
 
 
@@ -484,6 +495,8 @@ typedef enum
    nle_buffer_float,
    /*! buffer contains 32 bit long's */
    nle_buffer_long,
+   /*! buffer contains IEEE float's (allowed range: -1.0 to 1.0); since API version 7 */
+   nle_buffer_ieee_float,
 } nlame_encode_buffer_type;
 
 
@@ -526,7 +539,8 @@ int nlame_encode_buffer_mono( nlame_instance_t* inst,
 /*! encodes samples that are interleaved in a single buffer */
 /*! \param inst encoder instance
     \param buftype type of buffer that is passed in buffer_i
-           currently only nle_buffer_short and nle_buffer_int are supported.
+           currently only nle_buffer_short, nle_buffer_int and
+           nle_buffer_ieee_float are supported.
     \param buffer_i pointer to buffer with interleaved samples;
         sample order: <sample-left> <sample-right> <sample-left> ...
     \param nsamples number of samples per channel (not interleaved samples
@@ -680,7 +694,7 @@ int nlame_get_api_version();
     actually using is new enough to support the features you need. See
     the version history at the beginning of this file.
 */
-#define NLAME_CURRENT_API_VERSION 6
+#define NLAME_CURRENT_API_VERSION 7
 
 
 
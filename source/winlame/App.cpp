@@ -30,6 +30,7 @@
 #include "encoder/ModuleManagerImpl.hpp"
 #include "encoder/LameNogapInstanceManager.hpp"
 #include "TaskManager.hpp"
+#include "TaskCreationHelper.hpp"
 #include <ulib/CrashReporter.hpp>
 #include "CrashSaveResultsDlg.hpp"
 #include <functional>
@@ -88,6 +89,8 @@ m_startInputCD(false)
    // read settings from registry
    m_settings.ReadSettings();
 
+   m_settings.m_taskManagerConfig.m_journalFilename = TaskJournalFilename();
+
    m_spTaskManager.reset(new TaskManager(m_settings.m_taskManagerConfig));
 
    // register objects in IoC container
@@ -103,11 +106,22 @@ m_startInputCD(false)
    m_spPresetManager.reset(new PresetManagerImpl);
    ioc.Register<PresetManagerInterface>(std::ref(*m_spPresetManager.get()));
 
-   m_spModuleManager.reset(new Encoder::ModuleManagerImpl);
+   auto spModuleManager = std::make_shared<Encoder::ModuleManagerImpl>();
+
+   std::shared_ptr<Encoder::AudioFileInfoCache> spAudioFileInfoCache =
+      std::make_shared<Encoder::AudioFileInfoCache>(AudioFileInfoCacheFilename());
+   spAudioFileInfoCache->Load();
+   spModuleManager->SetAudioFileInfoCache(spAudioFileInfoCache);
+
+   m_spModuleManager = spModuleManager;
    ioc.Register<Encoder::ModuleManager>(std::ref(*m_spModuleManager.get()));
 
    LoadPresetFile();
 
+   // add tasks again that weren't finished when winLAME was closed or crashed
+   TaskCreationHelper helper;
+   helper.AddJournaledTasks();
+
    // set language to use
    if (m_langResourceManager.IsLangResourceAvail(m_settings.language_id))
       m_langResourceManager.LoadLangResource(m_settings.language_id);
@@ -130,6 +144,14 @@ App::~App()
       // ignore errors when storing settings
    }
 
+   std::shared_ptr<Encoder::AudioFileInfoCache> spAudioFileInfoCache =
+      m_spModuleManager->GetAudioFileInfoCache();
+
+   // store new entries of the audio file info cache; entries of deleted files were already
+   // evicted when they were looked up
+   if (spAudioFileInfoCache != nullptr)
+      spAudioFileInfoCache->Save();
+
    s_pApp = NULL;
 
    _Module.Term();
@@ -321,6 +343,26 @@ HICON App::AppIcon(bool smallIcon)
       ::GetSystemMetrics(smallIcon ? SM_CYSMICON : SM_CYICON));
 }
 
+CString App::UserAppDataFilename(LPCTSTR filename)
+{
+   CString folder = AppDataFolder(false);
+
+   if (!Path::FolderExists(folder))
+      CreateDirectory(folder, nullptr);
+
+   return Path::Combine(folder, filename);
+}
+
+CString App::TaskJournalFilename()
+{
+   return UserAppDataFilename(_T("TaskJournal.txt"));
+}
+
+CString App::AudioFileInfoCacheFilename()
+{
+   return UserAppDataFilename(_T("AudioFileInfoCache.bin"));
+}
+
 void App::LoadPresetFile()
 {
    CString userSpecificAppFolder = AppDataFolder(false);
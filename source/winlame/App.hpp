@@ -105,6 +105,15 @@ private:
    /// runs new main frame based winLAME window
    int RunMainFrame(int nCmdShow);
 
+   /// returns filename of a file in the user's app data folder; creates the folder when necessary
+   static CString UserAppDataFilename(LPCTSTR filename);
+
+   /// returns filename of task journal file
+   static CString TaskJournalFilename();
+
+   /// returns filename of audio file info cache file
+   static CString AudioFileInfoCacheFilename();
+
    /// loads presets file
    void LoadPresetFile();
 
@@ -22,12 +22,28 @@
 #include "stdafx.h"
 #include "AudioFileInfoManager.hpp"
 #include "ModuleManager.hpp"
+#include <ulib/IoCContainer.hpp>
 #include <functional>
+#include <algorithm>
+#include <set>
+
+/// max. number of worker threads; getting audio file infos is mostly bound by disk access
+const unsigned int c_maxNumWorkerThreads = 4;
+
+/// max. number of results that are passed to the callback at once
+const size_t c_maxNumResultsPerBatch = 64;
 
 AudioFileInfoManager::AudioFileInfoManager()
-   :m_ioService(1), // one thread max.
+   :AudioFileInfoManager(&AudioFileInfoManager::GetAudioFileInfo)
+{
+}
+
+AudioFileInfoManager::AudioFileInfoManager(T_fnGetAudioFileInfo fnGetAudioFileInfo)
+   :m_ioService(c_maxNumWorkerThreads),
    m_upDefaultWork(new boost::asio::io_service::work(m_ioService)),
-   m_stopping(false)
+   m_stopping(false),
+   m_fnGetAudioFileInfo(fnGetAudioFileInfo),
+   m_numPrioritizedRequests(0)
 {
 }
 
@@ -42,8 +58,8 @@ AudioFileInfoManager::~AudioFileInfoManager()
       // ignore errors when stopping
    }
 
-   if (m_upThread != nullptr)
-      m_upThread->join();
+   for (auto& upThread : m_threadList)
+      upThread->join();
 }
 
 bool AudioFileInfoManager::GetAudioFileInfo(LPCTSTR filename,
@@ -54,20 +70,86 @@ bool AudioFileInfoManager::GetAudioFileInfo(LPCTSTR filename,
    return moduleManager.GetAudioFileInfo(filename, lengthInSeconds, bitrateInBps, sampleFrequencyInHz, errorMessage);
 }
 
-void AudioFileInfoManager::AsyncGetAudioFileInfo(LPCTSTR filename, AudioFileInfoManager::T_fnCallback fnCallback)
+void AudioFileInfoManager::AsyncGetAudioFileInfo(LPCTSTR filename)
 {
-   ATLASSERT(fnCallback != nullptr);
+   ATLASSERT(m_fnCallback != nullptr);
 
    if (m_stopping)
       return;
 
-   if (m_upThread == nullptr)
+   if (m_threadList.empty())
    {
-      m_upThread.reset(new std::thread(std::bind(&AudioFileInfoManager::RunThread, std::ref(m_ioService))));
+      unsigned int numThreads = std::max(1U, std::min(std::thread::hardware_concurrency(), c_maxNumWorkerThreads));
+
+      for (unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+      {
+         m_threadList.push_back(std::unique_ptr<std::thread>(
+            new std::thread(std::bind(&AudioFileInfoManager::RunThread, std::ref(m_ioService)))));
+      }
    }
 
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      Request request;
+      request.m_filename = filename;
+      request.m_isPrioritized = false;
+
+      m_pendingRequestsList.push_back(request);
+   }
+
+   // each posted handler processes the request that is next in line at that time
    m_ioService.post(
-      std::bind(&AudioFileInfoManager::WorkerGetAudioFileInfo, std::ref(m_stopping), CString(filename), fnCallback));
+      std::bind(&AudioFileInfoManager::WorkerGetAudioFileInfo, this));
+}
+
+void AudioFileInfoManager::PrioritizeFiles(const std::vector<CString>& filenamesList)
+{
+   std::set<CString> filenamesSet(filenamesList.begin(), filenamesList.end());
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   m_numPrioritizedRequests = 0;
+   for (Request& request : m_pendingRequestsList)
+   {
+      request.m_isPrioritized = filenamesSet.find(request.m_filename) != filenamesSet.end();
+
+      if (request.m_isPrioritized)
+         m_numPrioritizedRequests++;
+   }
+
+   std::stable_partition(m_pendingRequestsList.begin(), m_pendingRequestsList.end(),
+      [](const Request& request) { return request.m_isPrioritized; });
+}
+
+void AudioFileInfoManager::CancelFiles(const std::vector<CString>& filenamesList)
+{
+   std::set<CString> filenamesSet(filenamesList.begin(), filenamesList.end());
+
+   std::vector<AudioFileInfo> resultsList;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      // the handlers posted for the cancelled requests just find fewer requests to process
+      m_pendingRequestsList.erase(
+         std::remove_if(m_pendingRequestsList.begin(), m_pendingRequestsList.end(),
+            [&filenamesSet](const Request& request) { return filenamesSet.find(request.m_filename) != filenamesSet.end(); }),
+         m_pendingRequestsList.end());
+
+      m_numPrioritizedRequests = std::count_if(m_pendingRequestsList.begin(), m_pendingRequestsList.end(),
+         [](const Request& request) { return request.m_isPrioritized; });
+
+      // the current batch is only passed on when a request is processed; when no request is
+      // left, the batch is passed on here, since it may wait for the cancelled requests
+      if (m_pendingRequestsList.empty())
+         resultsList.swap(m_resultsList);
+   }
+
+   bool isStopped = m_stopping;
+   if (isStopped || resultsList.empty())
+      return;
+
+   m_fnCallback(resultsList);
 }
 
 void AudioFileInfoManager::Stop()
@@ -75,6 +157,11 @@ void AudioFileInfoManager::Stop()
    m_stopping = true;
    m_upDefaultWork.reset();
    m_ioService.stop();
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_pendingRequestsList.clear();
+   m_numPrioritizedRequests = 0;
+   m_resultsList.clear();
 }
 
 void AudioFileInfoManager::RunThread(boost::asio::io_service& ioService)
@@ -91,22 +178,60 @@ void AudioFileInfoManager::RunThread(boost::asio::io_service& ioService)
    }
 }
 
-void AudioFileInfoManager::WorkerGetAudioFileInfo(std::atomic<bool>& stopping,
-   const CString& filename, AudioFileInfoManager::T_fnCallback fnCallback)
+void AudioFileInfoManager::WorkerGetAudioFileInfo()
 {
-   if (stopping)
+   if (m_stopping)
       return;
 
-   int lengthInSeconds = 0;
-   int bitrateInBps = 0;
-   int sampleFrequencyInHz = 0;
-   CString errorMessage;
+   Request request;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if (m_pendingRequestsList.empty())
+         return; // request was cancelled
+
+      request = m_pendingRequestsList.front();
+      m_pendingRequestsList.pop_front();
+
+      if (request.m_isPrioritized)
+         m_numPrioritizedRequests--;
+   }
 
-   bool ret = GetAudioFileInfo(filename, lengthInSeconds, bitrateInBps, sampleFrequencyInHz, errorMessage);
+   AudioFileInfo info;
+   info.m_filename = request.m_filename;
+
+   bool ret = m_fnGetAudioFileInfo(request.m_filename,
+      info.m_lengthInSeconds, info.m_bitrateInBps, info.m_sampleFrequencyInHz, info.m_errorMessage);
+
+   info.m_error = !ret;
+
+   AddResult(info, request.m_isPrioritized);
+}
+
+void AudioFileInfoManager::AddResult(const AudioFileInfo& info, bool isPrioritized)
+{
+   std::vector<AudioFileInfo> resultsList;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      m_resultsList.push_back(info);
+
+      // pass on results when the batch is full, when all prioritized requests are done, so
+      // that visible files are updated quickly, or when there's nothing left to do
+      bool passResults =
+         m_resultsList.size() >= c_maxNumResultsPerBatch ||
+         (isPrioritized && m_numPrioritizedRequests == 0) ||
+         m_pendingRequestsList.empty();
+
+      if (!passResults)
+         return;
+
+      resultsList.swap(m_resultsList);
+   }
 
-   bool isStopped = stopping;
+   bool isStopped = m_stopping;
    if (isStopped)
       return;
 
-   fnCallback(!ret, errorMessage, lengthInSeconds, bitrateInBps, sampleFrequencyInHz);
+   m_fnCallback(resultsList);
 }
@@ -23,17 +23,64 @@
 
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <ulib/config/BoostAsio.hpp>
 
-/// Manager to fetch audio file infos asynchronously
+/// \brief Manager to fetch audio file infos asynchronously
+/// \details Requests are processed by a small pool of worker threads. Requests for files that
+/// are prioritized, e.g. the visible rows of a list, are processed first. Results are passed to
+/// the callback in batches, to reduce the number of UI updates.
 class AudioFileInfoManager
 {
 public:
-   /// callback function type
-   typedef std::function<void(bool error, const CString& errorMessage, int lengthInSeconds, int bitrateInBps, int sampleFrequencyInHz)> T_fnCallback;
+   /// audio file infos of a single file
+   struct AudioFileInfo
+   {
+      /// ctor
+      AudioFileInfo()
+         :m_error(false),
+         m_lengthInSeconds(0),
+         m_bitrateInBps(0),
+         m_sampleFrequencyInHz(0)
+      {
+      }
 
-   /// ctor
+      /// filename of audio file
+      CString m_filename;
+
+      /// indicates if an error occured while getting infos
+      bool m_error;
+
+      /// error message, when an error occured
+      CString m_errorMessage;
+
+      /// length, in seconds
+      int m_lengthInSeconds;
+
+      /// bitrate, in bits per second
+      int m_bitrateInBps;
+
+      /// sample frequency, in Hz
+      int m_sampleFrequencyInHz;
+   };
+
+   /// callback function type; called in a worker thread with a batch of audio file infos
+   typedef std::function<void(const std::vector<AudioFileInfo>& audioFileInfoList)> T_fnCallback;
+
+   /// function type to retrieve infos of a single audio file; see GetAudioFileInfo()
+   typedef std::function<bool(LPCTSTR filename,
+      int& lengthInSeconds, int& bitrateInBps, int& sampleFrequencyInHz, CString& errorMessage)> T_fnGetAudioFileInfo;
+
+   /// ctor; audio file infos are retrieved using the module manager
    AudioFileInfoManager();
 
+   /// ctor; audio file infos are retrieved using the given function
+   explicit AudioFileInfoManager(T_fnGetAudioFileInfo fnGetAudioFileInfo);
+
    /// dtor
    ~AudioFileInfoManager();
 
@@ -41,22 +88,47 @@ public:
    static bool GetAudioFileInfo(LPCTSTR filename,
       int& lengthInSeconds, int& bitrateInBps, int& sampleFrequencyInHz, CString& errorMessage);
 
-   /// retrieves info about audio file; asynchronous vesrion
-   void AsyncGetAudioFileInfo(LPCTSTR filename, T_fnCallback fnCallback);
+   /// sets callback that receives batches of retrieved audio file infos
+   void SetCallback(T_fnCallback fnCallback) { m_fnCallback = fnCallback; }
+
+   /// retrieves info about audio file; asynchronous version
+   void AsyncGetAudioFileInfo(LPCTSTR filename);
+
+   /// \brief prioritizes the requests of the given files, e.g. the currently visible files;
+   /// requests that were prioritized before lose their priority
+   void PrioritizeFiles(const std::vector<CString>& filenamesList);
+
+   /// \brief cancels requests of the given files that weren't processed yet
+   /// \details when no requests are left, the current batch of results is passed to the
+   /// callback on the calling thread
+   void CancelFiles(const std::vector<CString>& filenamesList);
 
    /// stops all further processing; no callbacks are called anymore that are not already active
    void Stop();
 
 private:
+   /// a single request to get audio file infos
+   struct Request
+   {
+      /// filename of audio file
+      CString m_filename;
+
+      /// indicates if the request is prioritized
+      bool m_isPrioritized;
+   };
+
    /// thread function
    static void RunThread(boost::asio::io_service& ioService);
 
-   /// worker thread function to get audio file infos and to call callback
-   static void WorkerGetAudioFileInfo(std::atomic<bool>& stopping, const CString& filename, AudioFileInfoManager::T_fnCallback fnCallback);
+   /// worker function to get audio file infos of the next pending request
+   void WorkerGetAudioFileInfo();
+
+   /// adds info to current batch of results, and calls the callback when the batch is complete
+   void AddResult(const AudioFileInfo& info, bool isPrioritized);
 
 private:
-   /// worker thread
-   std::unique_ptr<std::thread> m_upThread;
+   /// worker threads
+   std::vector<std::unique_ptr<std::thread>> m_threadList;
 
    /// io service
    boost::asio::io_service m_ioService;
@@ -66,4 +138,22 @@ private:
 
    /// indicates when manager is currently stopping
    std::atomic<bool> m_stopping;
+
+   /// function to retrieve audio file infos
+   T_fnGetAudioFileInfo m_fnGetAudioFileInfo;
+
+   /// callback for batches of results
+   T_fnCallback m_fnCallback;
+
+   /// mutex to protect pending requests and results
+   std::mutex m_mutex;
+
+   /// pending requests; prioritized requests are at the front
+   std::deque<Request> m_pendingRequestsList;
+
+   /// number of prioritized requests in the pending requests list
+   size_t m_numPrioritizedRequests;
+
+   /// current batch of results that wasn't passed to the callback yet
+   std::vector<AudioFileInfo> m_resultsList;
 };
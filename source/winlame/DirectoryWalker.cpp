@@ -0,0 +1,281 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file DirectoryWalker.cpp
+/// \brief Parallel recursive directory walker
+//
+#include "stdafx.h"
+#include "DirectoryWalker.hpp"
+#include <functional>
+#include <algorithm>
+
+/// max. number of worker threads; walking is bound by the latency of the file system, so
+/// that more threads than CPU cores are useful, but too many would overload network shares
+const unsigned int c_maxNumWorkerThreads = 8;
+
+/// max. number of found files that are passed to the callback at once
+const size_t c_maxNumFilesPerBatch = 256;
+
+/// max. time that found files are held back, in milliseconds
+const DWORD c_maxBatchDelayInMilliseconds = 250;
+
+DirectoryWalker::DirectoryWalker(const std::set<CString>& extensionsSet)
+   :m_extensionsSet(extensionsSet),
+   m_ioService(c_maxNumWorkerThreads),
+   m_upDefaultWork(new boost::asio::io_service::work(m_ioService)),
+   m_cancelled(false),
+   m_numPendingFolders(0),
+   m_rootNode(CString()),
+   m_lastBatchTickCount(GetTickCount())
+{
+   m_rootNode.m_isEnumerated = true;
+
+   CursorPosition rootPosition = { &m_rootNode, 0 };
+   m_cursorStack.push_back(rootPosition);
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+   try
+   {
+      Cancel();
+   }
+   catch (...) // NOSONAR
+   {
+      // ignore errors when cancelling
+   }
+
+   for (auto& upThread : m_threadList)
+      upThread->join();
+}
+
+void DirectoryWalker::Walk(const CString& folderName)
+{
+   ATLASSERT(m_fnCallback != nullptr);
+
+   if (m_cancelled)
+      return;
+
+   if (m_threadList.empty())
+   {
+      unsigned int numThreads = std::max(2U, std::min(std::thread::hardware_concurrency() * 2, c_maxNumWorkerThreads));
+
+      for (unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+      {
+         m_threadList.push_back(std::unique_ptr<std::thread>(
+            new std::thread(std::bind(&DirectoryWalker::RunThread, std::ref(m_ioService)))));
+      }
+   }
+
+   CString folder(folderName);
+   folder.TrimRight(_T('\\'));
+
+   FolderNode* folderNode = nullptr;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      FolderEntry entry;
+      entry.m_name = folder;
+      entry.m_upSubfolder.reset(new FolderNode(folder));
+
+      folderNode = entry.m_upSubfolder.get();
+      m_rootNode.m_entriesList.push_back(std::move(entry));
+
+      m_numPendingFolders++;
+   }
+
+   m_ioService.post(
+      std::bind(&DirectoryWalker::WorkerWalkFolder, this, folderNode));
+}
+
+void DirectoryWalker::Cancel()
+{
+   m_cancelled = true;
+   m_upDefaultWork.reset();
+   m_ioService.stop();
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_resultsList.clear();
+}
+
+void DirectoryWalker::RunThread(boost::asio::io_service& ioService)
+{
+   try
+   {
+      ioService.run();
+   }
+   catch (boost::system::system_error& error)
+   {
+      UNUSED(error);
+      ATLTRACE(_T("system_error: %hs\n"), error.what());
+      ATLASSERT(false);
+   }
+}
+
+void DirectoryWalker::WorkerWalkFolder(FolderNode* folderNode)
+{
+   std::vector<FolderEntry> entriesList;
+
+   WIN32_FIND_DATA findData = { 0 };
+
+   // skip querying short names, and let the file system return more entries per request
+   HANDLE findHandle = ::FindFirstFileEx(folderNode->m_folderName + _T("\\*"),
+      FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+
+   if (findHandle != INVALID_HANDLE_VALUE)
+   {
+      do
+      {
+         // also skips the . and .. entries
+         if (findData.cFileName[0] == _T('.'))
+            continue;
+
+         if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+         {
+            if (m_cancelled)
+               break;
+
+            FolderEntry entry;
+            entry.m_name = findData.cFileName;
+            entry.m_upSubfolder.reset(new FolderNode(folderNode->m_folderName + _T('\\') + findData.cFileName));
+
+            m_numPendingFolders++;
+
+            m_ioService.post(
+               std::bind(&DirectoryWalker::WorkerWalkFolder, this, entry.m_upSubfolder.get()));
+
+            entriesList.push_back(std::move(entry));
+         }
+         else if (IsMatchingExtension(findData.cFileName))
+         {
+            FolderEntry entry;
+            entry.m_name = findData.cFileName;
+            entriesList.push_back(std::move(entry));
+         }
+      } while (!m_cancelled && ::FindNextFile(findHandle, &findData));
+
+      ::FindClose(findHandle);
+   }
+
+   // not all file systems return the entries sorted
+   std::sort(entriesList.begin(), entriesList.end(),
+      [](const FolderEntry& lhs, const FolderEntry& rhs)
+   {
+      return lhs.m_name.CompareNoCase(rhs.m_name) < 0;
+   });
+
+   {
+      // only one worker at a time collects and passes on results, so that the batches arrive
+      // in the order the files were collected
+      std::lock_guard<std::mutex> deliveryLock(m_deliveryMutex);
+
+      std::vector<CString> resultsList;
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+
+         folderNode->m_entriesList.swap(entriesList);
+         folderNode->m_isEnumerated = true;
+
+         CollectResults();
+
+         // when the cursor is back at the end of the root node, all files of all walked
+         // folders were collected
+         bool walkFinished = m_cursorStack.size() == 1 &&
+            m_cursorStack.back().m_entryIndex == m_rootNode.m_entriesList.size();
+
+         TakeDueResults(walkFinished, resultsList);
+      }
+
+      if (!resultsList.empty() && !m_cancelled)
+         m_fnCallback(resultsList);
+   }
+
+   // decremented only after the results were passed on, so that IsWalking() doesn't return
+   // false before the last batch arrived
+   m_numPendingFolders--;
+}
+
+bool DirectoryWalker::IsMatchingExtension(LPCTSTR filename) const
+{
+   LPCTSTR pos = _tcsrchr(filename, _T('.'));
+   if (pos == nullptr)
+      return false;
+
+   CString extension(pos + 1);
+   extension.MakeLower();
+
+   return m_extensionsSet.find(extension) != m_extensionsSet.end();
+}
+
+void DirectoryWalker::CollectResults()
+{
+   while (!m_cursorStack.empty())
+   {
+      CursorPosition& position = m_cursorStack.back();
+
+      // wait for folder to be enumerated
+      if (!position.m_folderNode->m_isEnumerated)
+         break;
+
+      if (position.m_entryIndex >= position.m_folderNode->m_entriesList.size())
+      {
+         // the root node waits for more folders to walk
+         if (m_cursorStack.size() == 1)
+            break;
+
+         m_cursorStack.pop_back();
+
+         // the folder was completely reported and isn't needed anymore
+         CursorPosition& parentPosition = m_cursorStack.back();
+         parentPosition.m_folderNode->m_entriesList[parentPosition.m_entryIndex - 1].m_upSubfolder.reset();
+         continue;
+      }
+
+      FolderNode* folderNode = position.m_folderNode;
+      const FolderEntry& entry = folderNode->m_entriesList[position.m_entryIndex++];
+
+      if (entry.m_upSubfolder != nullptr)
+      {
+         CursorPosition subfolderPosition = { entry.m_upSubfolder.get(), 0 };
+         m_cursorStack.push_back(subfolderPosition);
+      }
+      else
+         m_resultsList.push_back(folderNode->m_folderName + _T('\\') + entry.m_name);
+   }
+}
+
+void DirectoryWalker::TakeDueResults(bool walkFinished, std::vector<CString>& resultsList)
+{
+   if (m_resultsList.empty())
+      return;
+
+   // pass on results when the batch is full, when results were held back for too long, so
+   // that the user sees progress on slow file systems, or when the walk is finished
+   DWORD tickCount = GetTickCount();
+
+   bool passResults =
+      m_resultsList.size() >= c_maxNumFilesPerBatch ||
+      tickCount - m_lastBatchTickCount >= c_maxBatchDelayInMilliseconds ||
+      walkFinished;
+
+   if (!passResults)
+      return;
+
+   m_lastBatchTickCount = tickCount;
+   resultsList.swap(m_resultsList);
+}
@@ -0,0 +1,165 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file DirectoryWalker.hpp
+/// \brief Parallel recursive directory walker
+//
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <ulib/config/BoostAsio.hpp>
+
+/// \brief Walks directories recursively and in parallel, to find audio files
+/// \details Each directory is enumerated by one of a small pool of worker threads, and found
+/// subdirectories are queued for the worker threads, so that deep directory trees on network
+/// shares are walked with multiple requests in flight. Only files with one of the given
+/// extensions are reported. Found files are passed to the callback in batches, while the walk
+/// is still running. Walking can be cancelled at any time.
+/// Files are reported in a deterministic order, regardless of which folder was enumerated
+/// first: folders are reported in the order Walk() was called, and each folder depth-first,
+/// with files and subfolders sorted by name, as when walking the folder sequentially.
+class DirectoryWalker
+{
+public:
+   /// callback function type; called in a worker thread with a batch of found files
+   typedef std::function<void(const std::vector<CString>& filenamesList)> T_fnCallback;
+
+   /// ctor; takes file extensions, without dot, of files to report
+   explicit DirectoryWalker(const std::set<CString>& extensionsSet);
+
+   /// dtor
+   ~DirectoryWalker();
+
+   /// sets callback that receives batches of found files
+   void SetCallback(T_fnCallback fnCallback) { m_fnCallback = fnCallback; }
+
+   /// starts walking given folder recursively; may be called while other folders are walked
+   void Walk(const CString& folderName);
+
+   /// returns if there are folders that are currently walked, or found files that weren't
+   /// passed to the callback yet
+   bool IsWalking() const { return !m_cancelled && m_numPendingFolders > 0; }
+
+   /// cancels walking; no callbacks are called anymore that are not already active
+   void Cancel();
+
+private:
+   struct FolderNode;
+
+   /// entry of a folder; either a file or a subfolder
+   struct FolderEntry
+   {
+      /// file or folder name, without path
+      CString m_name;
+
+      /// subfolder node; nullptr when the entry is a file
+      std::unique_ptr<FolderNode> m_upSubfolder;
+   };
+
+   /// folder in the tree of walked folders
+   struct FolderNode
+   {
+      /// ctor
+      explicit FolderNode(const CString& folderName)
+         :m_folderName(folderName),
+         m_isEnumerated(false)
+      {
+      }
+
+      /// folder name, with path
+      CString m_folderName;
+
+      /// indicates if the folder was enumerated and the entries list is complete
+      bool m_isEnumerated;
+
+      /// entries of the folder, sorted by name
+      std::vector<FolderEntry> m_entriesList;
+   };
+
+   /// position in the tree of walked folders, up to which found files were reported
+   struct CursorPosition
+   {
+      /// folder node
+      FolderNode* m_folderNode;
+
+      /// index of next entry to report
+      size_t m_entryIndex;
+   };
+
+   /// thread function
+   static void RunThread(boost::asio::io_service& ioService);
+
+   /// worker function to enumerate a single folder
+   void WorkerWalkFolder(FolderNode* folderNode);
+
+   /// returns if filename has one of the extensions to report
+   bool IsMatchingExtension(LPCTSTR filename) const;
+
+   /// moves the cursor forward through all enumerated folders and adds their files to the
+   /// current batch; must be called with the mutex locked
+   void CollectResults();
+
+   /// takes current batch when it is due, to pass it on; must be called with the mutex locked
+   void TakeDueResults(bool walkFinished, std::vector<CString>& resultsList);
+
+private:
+   /// lowercase file extensions, without dot, of files to report
+   std::set<CString> m_extensionsSet;
+
+   /// worker threads
+   std::vector<std::unique_ptr<std::thread>> m_threadList;
+
+   /// io service
+   boost::asio::io_service m_ioService;
+
+   /// default work for io service
+   std::unique_ptr<boost::asio::io_service::work> m_upDefaultWork;
+
+   /// indicates when walking was cancelled
+   std::atomic<bool> m_cancelled;
+
+   /// number of folders that were queued or are currently enumerated
+   std::atomic<unsigned int> m_numPendingFolders;
+
+   /// callback for batches of found files
+   T_fnCallback m_fnCallback;
+
+   /// mutex to protect the folder tree, the cursor and the results
+   std::mutex m_mutex;
+
+   /// mutex held while collecting and passing on results, so that batches arrive in order
+   std::mutex m_deliveryMutex;
+
+   /// root node; its entries are the folders passed to Walk(), in order
+   FolderNode m_rootNode;
+
+   /// cursor in the folder tree; a stack of positions, starting with the root node
+   std::vector<CursorPosition> m_cursorStack;
+
+   /// current batch of found files that wasn't passed to the callback yet
+   std::vector<CString> m_resultsList;
+
+   /// tick count when the last batch was passed to the callback
+   DWORD m_lastBatchTickCount;
+};
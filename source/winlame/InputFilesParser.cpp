@@ -34,37 +34,20 @@ void InputFilesParser::Parse(const std::vector<CString>& vecFilenames)
    });
 }
 
+void InputFilesParser::ParseFiles(const std::vector<CString>& vecFilenames)
+{
+   for (const CString& filename : vecFilenames)
+      InsertFilename(filename);
+}
+
 void InputFilesParser::Insert(LPCTSTR filename)
 {
    // check if given filename is a directory
    DWORD dwAttr = ::GetFileAttributes(filename);
    if (dwAttr != INVALID_FILE_ATTRIBUTES && (dwAttr & FILE_ATTRIBUTE_DIRECTORY) != 0)
    {
-      CString cszPathStr(filename);
-      cszPathStr += _T("\\*.*");
-
-      _tfinddata_t fdata;
-      long ffhnd;
-
-      m_bRecursive = true;
-
-      if (-1 != (ffhnd = _tfindfirst(cszPathStr, &fdata)))
-         do
-         {
-         if (fdata.name[0] != '.')
-         {
-            CString fname(filename);
-            fname += _T('\\');
-            fname += fdata.name;
-
-            Insert(fname);
-         }
-         } while (0 == _tfindnext(ffhnd, &fdata));
-
-      _findclose(ffhnd);
-
-      m_bRecursive = false;
-
+      // folders may be huge, and are walked asynchronously
+      m_vecFolderList.push_back(filename);
       return;
    }
 
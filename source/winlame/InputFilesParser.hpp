@@ -24,7 +24,8 @@
 #include <vector>
 
 /// \brief parses input files
-/// \details When input is folder name, the parser adds all files recursively.
+/// \details When input is folder name, the parser adds it to the folder list, to be walked
+/// asynchronously by the DirectoryWalker.
 /// When input is playlists (.m3u, .pls) or cue sheets (.cue), it adds the the referenced files.
 /// When input is a normal existing file, it adds it to the file list.
 class InputFilesParser
@@ -32,7 +33,6 @@ class InputFilesParser
 public:
    /// ctor
    InputFilesParser()
-      :m_bRecursive(false)
    {
    }
 
@@ -41,12 +41,19 @@ public:
    /// returns file list
    std::vector<CString>& FileList() { return m_vecFileList; }
 
+   /// returns list of folders that were passed and still have to be walked
+   const std::vector<CString>& FolderList() const { return m_vecFolderList; }
+
    /// returns playlist name; when a playlist was added, this is the same name (else it is empty)
    CString PlaylistName() { return m_cszPlaylistName; }
 
    /// parses list of filenames
    void Parse(const std::vector<CString>& vecFilenames);
 
+   /// parses list of filenames that are known to be files, e.g. found by the DirectoryWalker;
+   /// imports playlists and cue sheets, but doesn't check for folders
+   void ParseFiles(const std::vector<CString>& vecFilenames);
+
    /// inserts a single file
    void Insert(LPCTSTR filename);
 
@@ -64,12 +71,12 @@ private:
    void ImportCueSheet(LPCTSTR filename);
 
 private:
-   /// indicates if Insert() currently operates recursively
-   bool m_bRecursive;
-
    /// file list
    std::vector<CString> m_vecFileList;
 
+   /// folder list
+   std::vector<CString> m_vecFolderList;
+
    /// possible playlist name
    CString m_cszPlaylistName;
 };
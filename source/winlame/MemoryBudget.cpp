@@ -0,0 +1,72 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file MemoryBudget.cpp
+/// \brief Memory budget for running tasks
+//
+#include "stdafx.h"
+#include "MemoryBudget.hpp"
+
+bool MemoryBudget::Fits(size_t memoryUsage) const
+{
+   return m_budget == 0 ||
+      m_reservedMemory == 0 ||
+      m_reservedMemory + memoryUsage <= m_budget;
+}
+
+void MemoryBudget::Reserve(size_t memoryUsage)
+{
+   m_reservedMemory += memoryUsage;
+}
+
+void MemoryBudget::Release(size_t memoryUsage)
+{
+   ATLASSERT(m_reservedMemory >= memoryUsage);
+
+   m_reservedMemory -= memoryUsage;
+}
+
+std::vector<size_t> MemoryBudget::Admit(std::vector<WaitingTask>& waitingTasks)
+{
+   std::vector<size_t> admittedTasks;
+   std::vector<size_t> passedTasks;
+
+   for (size_t index = 0, maxIndex = waitingTasks.size(); index < maxIndex; index++)
+   {
+      WaitingTask& waitingTask = waitingTasks[index];
+
+      if (Fits(waitingTask.m_memoryUsage))
+      {
+         Reserve(waitingTask.m_memoryUsage);
+         admittedTasks.push_back(index);
+
+         for (size_t passedIndex : passedTasks)
+            waitingTasks[passedIndex].m_numOvertaken++;
+
+         continue;
+      }
+
+      // a task that was overtaken too often gets the memory that is freed next
+      if (waitingTask.m_numOvertaken >= c_maxNumOvertaken)
+         break;
+
+      passedTasks.push_back(index);
+   }
+
+   return admittedTasks;
+}
@@ -0,0 +1,81 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file MemoryBudget.hpp
+/// \brief Memory budget for running tasks
+//
+#pragma once
+
+#include <vector>
+
+/// \brief memory budget that decides which waiting tasks may be started
+/// \details tasks are admitted in queue order; a task that doesn't fit into the remaining
+/// budget may be overtaken by later tasks that do fit, but only c_maxNumOvertaken times; after
+/// that, no later task is admitted until the overtaken task has been started.
+class MemoryBudget
+{
+public:
+   /// number of times a waiting task may be overtaken by later tasks
+   static const unsigned int c_maxNumOvertaken = 4;
+
+   /// task waiting for admission
+   struct WaitingTask
+   {
+      /// estimated memory usage, in bytes
+      size_t m_memoryUsage;
+
+      /// number of times the task was overtaken by later tasks
+      unsigned int m_numOvertaken;
+   };
+
+   /// ctor; a budget of 0 means no limit
+   explicit MemoryBudget(size_t budget)
+      :m_budget(budget),
+      m_reservedMemory(0)
+   {
+   }
+
+   /// returns if the budget limits the number of running tasks
+   bool IsLimited() const { return m_budget != 0; }
+
+   /// returns memory currently reserved, in bytes
+   size_t ReservedMemory() const { return m_reservedMemory; }
+
+   /// \brief returns if a task with given memory usage can be started now
+   /// \details a task that exceeds the budget on its own only fits when nothing is reserved
+   bool Fits(size_t memoryUsage) const;
+
+   /// reserves memory for a started task
+   void Reserve(size_t memoryUsage);
+
+   /// returns memory reserved by a finished task
+   void Release(size_t memoryUsage);
+
+   /// \brief admits waiting tasks and reserves their memory
+   /// \param waitingTasks runnable tasks that weren't started yet, in queue order; the number
+   /// of times each task was overtaken is updated
+   /// \return indices of all tasks in waitingTasks that may be started now
+   std::vector<size_t> Admit(std::vector<WaitingTask>& waitingTasks);
+
+private:
+   /// memory budget, in bytes; 0 means no limit
+   size_t m_budget;
+
+   /// memory currently reserved by running tasks, in bytes
+   size_t m_reservedMemory;
+};
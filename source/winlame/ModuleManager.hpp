@@ -21,9 +21,13 @@
 //
 #pragma once
 
+#include <set>
+
 namespace Encoder
 {
    class InputModule;
+   class TrackInfo;
+   class AudioFileInfoCache;
 
    /// module manager interface
    class ModuleManager
@@ -37,10 +41,19 @@ namespace Encoder
       /// returns currently available filter string for open file dialog
       virtual void GetFilterString(CString& filterstring) const = 0;
 
+      /// returns lowercase file extensions, without dot, of all files supported by input modules
+      virtual std::set<CString> GetInputFileExtensions() const = 0;
+
       /// returns infos about audio file; returns false when not supported
       virtual bool GetAudioFileInfo(LPCTSTR filename,
          int& lengthInSeconds, int& bitrateInBps, int& samplerateInHz, CString& errorMessage) = 0;
 
+      /// returns track infos stored in audio file; returns false when not supported
+      virtual bool GetTrackInfo(LPCTSTR filename, TrackInfo& trackInfo, CString& errorMessage) = 0;
+
+      /// returns cache for audio file infos and track infos; may be nullptr
+      virtual std::shared_ptr<AudioFileInfoCache> GetAudioFileInfoCache() = 0;
+
       // module functions
 
       /// returns the number of available input modules
@@ -31,6 +31,9 @@ public:
    explicit Task(unsigned int dependentTaskId = 0)
       :m_id(0),
       m_dependentTaskId(dependentTaskId),
+      m_numFinishedDependentTaskIds(0),
+      m_reservedMemory(0),
+      m_numOvertaken(0),
       m_isStarted(false)
    {
    }
@@ -52,8 +55,14 @@ public:
    /// returns if task was already started
    bool IsStarted() const { return m_isStarted; }
 
+   /// \brief returns estimated peak memory usage of the running task, in bytes
+   /// \details used to admit tasks only when they fit into the task manager's memory budget;
+   /// 0 means that the task's memory usage is negligible
+   virtual size_t EstimatedMemoryUsage() const { return 0; }
+
 protected:
    friend class TaskManager;
+   friend class TaskJournal;
 
    /// sets task id
    void Id(unsigned int id) { m_id = id; }
@@ -82,6 +91,9 @@ protected:
    /// returns dependent task id
    unsigned int DependentTaskId() const { return m_dependentTaskId; }
 
+   /// sets additional list of task ids that must all be finished before this task can run
+   void DependentTaskIds(const std::vector<unsigned int>& dependentTaskIds) { m_dependentTaskIds = dependentTaskIds; }
+
    /// returns error text, if any
    const CString& ErrorText() const { return m_errorText; }
 
@@ -92,6 +104,18 @@ private:
    /// task id this task depends on; may be 0 for no task
    unsigned int m_dependentTaskId;
 
+   /// additional task ids this task depends on; may be empty
+   std::vector<unsigned int> m_dependentTaskIds;
+
+   /// number of task ids in m_dependentTaskIds that were already checked as finished
+   size_t m_numFinishedDependentTaskIds;
+
+   /// memory reserved from the task manager's memory budget while the task is running
+   size_t m_reservedMemory;
+
+   /// number of times the task was overtaken by later tasks while waiting for memory
+   unsigned int m_numOvertaken;
+
    /// flag that indicates if the task already has been started
    std::atomic<bool> m_isStarted;
 
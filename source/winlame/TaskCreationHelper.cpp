@@ -24,10 +24,13 @@
 #include "TaskManager.hpp"
 #include "EncoderTask.hpp"
 #include "CreatePlaylistTask.hpp"
+#include "UpdateMirrorManifestTask.hpp"
 #include "CDExtractTask.hpp"
 #include "CDRipTitleFormatManager.hpp"
 #include "LameNogapInstanceManager.hpp"
+#include "EncoderBatchPlan.hpp"
 #include <sndfile.h>
+#include <map>
 
 TaskCreationHelper::TaskCreationHelper()
    :m_uiSettings(IoCContainer::Current().Resolve<UISettings>()),
@@ -37,36 +40,11 @@ TaskCreationHelper::TaskCreationHelper()
 
 bool TaskCreationHelper::IsLossyTranscoding() const
 {
-   Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
-
-   bool in_lossy = false;
-
    // only have to check when from input page; CD reading is always lossless
-   if (m_uiSettings.m_bFromInputFilesPage)
-   {
-      Encoder::ModuleManagerImpl& modImpl = reinterpret_cast<Encoder::ModuleManagerImpl&>(moduleManager);
-
-      for (int i = 0, iMax = m_uiSettings.encoderjoblist.size(); i < iMax; i++)
-      {
-         Encoder::EncoderJob& job = m_uiSettings.encoderjoblist[i];
-
-         CString filename = job.InputFilename();
-
-         std::unique_ptr<Encoder::InputModule> inmod(modImpl.ChooseInputModule(filename));
-         if (inmod == nullptr)
-            continue;
-
-         int in_id = inmod->GetModuleID();
-
-         in_lossy |= Encoder::EncoderImpl::IsLossyInputModule(in_id);
-      }
-   }
-
-   int out_id = moduleManager.GetOutputModuleID(m_uiSettings.output_module);
-
-   bool out_lossy = Encoder::EncoderImpl::IsLossyOutputModule(out_id);
+   if (!m_uiSettings.m_bFromInputFilesPage)
+      return false;
 
-   return in_lossy && out_lossy;
+   return GetInputFilesBatchPlan().IsLossyTranscoding();
 }
 
 bool TaskCreationHelper::IsOverwritingOriginalFiles() const
@@ -79,32 +57,46 @@ bool TaskCreationHelper::IsOverwritingOriginalFiles() const
    if (!m_uiSettings.m_defaultSettings.overwrite_existing)
       return false;
 
+   return GetInputFilesBatchPlan().IsOverwritingOriginalFiles();
+}
+
+const Encoder::EncoderBatchPlan& TaskCreationHelper::GetInputFilesBatchPlan() const
+{
+   if (m_upInputFilesBatchPlan == nullptr)
+   {
+      bool mirrorLibrary = m_uiSettings.m_mirrorLibrary && !m_uiSettings.out_location_use_input_dir;
+
+      m_upInputFilesBatchPlan = PlanInputFilesBatch(mirrorLibrary ? FindCommonInputFolder() : CString());
+   }
+
+   return *m_upInputFilesBatchPlan;
+}
+
+std::unique_ptr<Encoder::EncoderBatchPlan> TaskCreationHelper::PlanInputFilesBatch(const CString& mirrorInputRootFolder) const
+{
    Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
    Encoder::ModuleManagerImpl& modImpl = reinterpret_cast<Encoder::ModuleManagerImpl&>(moduleManager);
 
-   int out_module_id = moduleManager.GetOutputModuleID(m_uiSettings.output_module);
+   int outputModuleId = moduleManager.GetOutputModuleID(m_uiSettings.output_module);
 
-   for (int i = 0, iMax = m_uiSettings.encoderjoblist.size(); i < iMax; i++)
-   {
-      Encoder::EncoderJob& job = m_uiSettings.encoderjoblist[i];
+   std::unique_ptr<Encoder::EncoderBatchPlan> upPlan(
+      new Encoder::EncoderBatchPlan(modImpl, outputModuleId, m_uiSettings.settings_manager));
 
-      CString inputFilename = job.InputFilename();
+   for (const Encoder::EncoderJob& job : m_uiSettings.encoderjoblist)
+      upPlan->AddJob(job.InputFilename(), GetOutputFolder(job.InputFilename(), mirrorInputRootFolder));
 
-      std::unique_ptr<Encoder::OutputModule> outputModule(modImpl.GetOutputModule(out_module_id));
-      if (outputModule == nullptr)
-         continue;
+   return upPlan;
+}
 
-      outputModule->PrepareOutput(m_uiSettings.settings_manager);
+CString TaskCreationHelper::GetOutputFolder(const CString& inputFilename, const CString& mirrorInputRootFolder) const
+{
+   if (m_uiSettings.out_location_use_input_dir)
+      return Path::FolderName(inputFilename);
 
-      CString outputFilename = Encoder::EncoderImpl::GetOutputFilename(m_uiSettings.m_defaultSettings.outputdir, inputFilename, *outputModule.get());
+   if (m_uiSettings.m_mirrorLibrary)
+      return GetMirrorOutputFolder(mirrorInputRootFolder, inputFilename);
 
-      if (outputFilename.CompareNoCase(inputFilename) == 0)
-      {
-         return true;
-      }
-   }
-
-   return false;
+   return m_uiSettings.m_defaultSettings.outputdir;
 }
 
 void TaskCreationHelper::AddTasks()
@@ -133,8 +125,17 @@ void TaskCreationHelper::AddInputFilesTasks()
       moduleManager.GetOutputModuleID(m_uiSettings.output_module) == ID_OM_LAME &&
       m_uiSettings.settings_manager.QueryValueInt(LameOptNoGap) == 1;
 
+   // when encoding gapless tracks in parallel, each task encodes the neighbour tracks' audio
+   // before and after its track, instead of passing the LAME instance from task to task; the
+   // neighbour tracks' audio can't be downmixed or resampled, so the tracks are encoded one
+   // after another then
+   bool lameNogapParallel = lameNogapEncoding &&
+      m_uiSettings.settings_manager.QueryValueInt(LameOptNoGapParallel) == 1 &&
+      m_uiSettings.settings_manager.QueryValueInt(GeneralDownmixChannels) == 0 &&
+      m_uiSettings.settings_manager.QueryValueInt(GeneralResampleRate) == 0;
+
    int nogapInstanceId = -1; // valid values start at 0
-   if (lameNogapEncoding)
+   if (lameNogapEncoding && !lameNogapParallel)
    {
       Encoder::LameNogapInstanceManager& nogapInstanceManager =
          IoCContainer::Current().Resolve<Encoder::LameNogapInstanceManager>();
@@ -142,20 +143,53 @@ void TaskCreationHelper::AddInputFilesTasks()
       nogapInstanceId = nogapInstanceManager.NextNogapInstanceId();
    }
 
-   for (int i = 0, iMax = m_uiSettings.encoderjoblist.size(); i < iMax; i++)
+   // when mirroring, only new or changed input files are encoded
+   bool mirrorLibrary = m_uiSettings.m_mirrorLibrary && !m_uiSettings.out_location_use_input_dir;
+
+   CString mirrorInputRootFolder;
+   std::shared_ptr<Encoder::LibraryMirrorManifest> spMirrorManifest;
+   std::vector<Encoder::LibraryMirrorManifest::Entry> mirrorEntriesList;
+   std::vector<unsigned int> mirrorTaskIds;
+
+   // indices of the jobs to encode; the job list itself isn't modified
+   std::vector<size_t> jobIndexList(m_uiSettings.encoderjoblist.size());
+   for (size_t jobIndex = 0; jobIndex < jobIndexList.size(); jobIndex++)
+      jobIndexList[jobIndex] = jobIndex;
+
+   // output files written by the tasks are newer than this time
+   FILETIME encodingStartTime = {};
+   GetSystemTimeAsFileTime(&encodingStartTime);
+
+   if (mirrorLibrary)
+   {
+      mirrorInputRootFolder = FindCommonInputFolder();
+
+      spMirrorManifest = std::make_shared<Encoder::LibraryMirrorManifest>(m_uiSettings.m_defaultSettings.outputdir);
+      spMirrorManifest->Load();
+
+      mirrorEntriesList = RemoveUpToDateMirrorJobs(*spMirrorManifest, mirrorInputRootFolder, jobIndexList);
+
+      if (m_uiSettings.m_mirrorPruneRemoved)
+         spMirrorManifest->PruneRemovedInputFiles(mirrorInputRootFolder);
+   }
+
+   // output filenames of all jobs are determined in one pass, with a single output module;
+   // up-to-date mirrored jobs also get their output filename, for the playlist
+   std::unique_ptr<Encoder::EncoderBatchPlan> upPlan = PlanInputFilesBatch(mirrorInputRootFolder);
+
+   for (size_t jobIndex = 0; jobIndex < m_uiSettings.encoderjoblist.size(); jobIndex++)
+      m_uiSettings.encoderjoblist[jobIndex].OutputFilename(upPlan->OutputFilename(jobIndex));
+
+   for (size_t pos = 0, posMax = jobIndexList.size(); pos < posMax; pos++)
    {
+      size_t i = jobIndexList[pos];
       Encoder::EncoderJob& job = m_uiSettings.encoderjoblist[i];
 
       Encoder::EncoderTaskSettings taskSettings;
 
       taskSettings.m_inputFilename = job.InputFilename();
-
-      if (m_uiSettings.out_location_use_input_dir)
-      {
-         taskSettings.m_outputFolder = Path::FolderName(job.InputFilename());
-      }
-      else
-         taskSettings.m_outputFolder = m_uiSettings.m_defaultSettings.outputdir;
+      taskSettings.m_outputFolder = GetOutputFolder(job.InputFilename(), mirrorInputRootFolder);
+      taskSettings.m_outputFilename = upPlan->OutputFilename(i);
 
       taskSettings.m_title = Path::FilenameAndExt(job.InputFilename());
 
@@ -166,15 +200,29 @@ void TaskCreationHelper::AddInputFilesTasks()
       taskSettings.m_overwriteExisting = m_uiSettings.m_defaultSettings.overwrite_existing;
       taskSettings.m_deleteInputAfterEncode = m_uiSettings.m_defaultSettings.delete_after_encode;
 
+      // outdated mirrored files must always be replaced
+      if (mirrorLibrary)
+         taskSettings.m_overwriteExisting = true;
+
       // set previous task id when encoding with LAME and using nogap encoding
       unsigned int dependentTaskId = 0;
-      if (lameNogapEncoding)
+      if (lameNogapParallel)
+      {
+         // the neighbour tracks are taken from the full job list, since up-to-date mirrored
+         // tracks are still played before and after the track
+         if (i > 0)
+            taskSettings.m_gaplessPreviousInputFilename = m_uiSettings.encoderjoblist[i - 1].InputFilename();
+
+         if (i + 1 < m_uiSettings.encoderjoblist.size())
+            taskSettings.m_gaplessNextInputFilename = m_uiSettings.encoderjoblist[i + 1].InputFilename();
+      }
+      else if (lameNogapEncoding)
       {
          dependentTaskId = m_lastTaskId;
 
          taskSettings.m_settingsManager.setValue(LameNoGapInstanceId, nogapInstanceId);
 
-         if (i == iMax - 1)
+         if (pos == posMax - 1)
             taskSettings.m_settingsManager.setValue(GeneralIsLastFile, 1);
       }
 
@@ -182,10 +230,74 @@ void TaskCreationHelper::AddInputFilesTasks()
 
       taskMgr.AddTask(spTask);
 
-      CString inputTitle = Path::FilenameOnly(job.InputFilename());
-      job.OutputFilename(spTask->GenerateOutputFilename(inputTitle));
-
       m_lastTaskId = spTask->Id();
+
+      if (mirrorLibrary)
+      {
+         mirrorEntriesList[pos].m_outputFilename = job.OutputFilename();
+         mirrorTaskIds.push_back(spTask->Id());
+      }
+   }
+
+   if (mirrorLibrary)
+   {
+      // the manifest is also updated when there's nothing to encode, e.g. to store pruned files
+      std::shared_ptr<Encoder::UpdateMirrorManifestTask> spMirrorTask(
+         new Encoder::UpdateMirrorManifestTask(mirrorTaskIds, spMirrorManifest, mirrorEntriesList,
+            m_uiSettings.m_mirrorUseContentHash,
+            (static_cast<ULONGLONG>(encodingStartTime.dwHighDateTime) << 32) | encodingStartTime.dwLowDateTime));
+
+      taskMgr.AddTask(spMirrorTask);
+   }
+}
+
+void TaskCreationHelper::AddJournaledTasks()
+{
+   TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
+
+   std::vector<TaskJournal::Entry> entriesList = taskMgr.RestoreJournal();
+   if (entriesList.empty())
+      return;
+
+   // task IDs and nogap instance IDs from the last run have to be mapped to new ones
+   std::map<unsigned int, unsigned int> mapJournalTaskIdToTaskId;
+   std::map<int, int> mapJournalNogapInstanceIdToInstanceId;
+
+   for (TaskJournal::Entry& entry : entriesList)
+   {
+      Encoder::EncoderTaskSettings& taskSettings = entry.m_settings;
+
+      // partially written output is restarted from the beginning
+      Encoder::EncoderImpl::DeleteTempOutFiles(taskSettings.m_outputFilename);
+
+      unsigned int dependentTaskId = 0;
+      auto iterTaskId = mapJournalTaskIdToTaskId.find(entry.m_dependentTaskId);
+      if (iterTaskId != mapJournalTaskIdToTaskId.end())
+         dependentTaskId = iterTaskId->second;
+
+      if (taskSettings.m_settingsManager.QueryValueInt(LameOptNoGap) == 1 &&
+         taskSettings.m_settingsManager.QueryValueInt(LameOptNoGapParallel) == 0)
+      {
+         int journalNogapInstanceId = taskSettings.m_settingsManager.QueryValueInt(LameNoGapInstanceId);
+
+         auto iterNogapId = mapJournalNogapInstanceIdToInstanceId.find(journalNogapInstanceId);
+         if (iterNogapId == mapJournalNogapInstanceIdToInstanceId.end())
+         {
+            Encoder::LameNogapInstanceManager& nogapInstanceManager =
+               IoCContainer::Current().Resolve<Encoder::LameNogapInstanceManager>();
+
+            iterNogapId = mapJournalNogapInstanceIdToInstanceId.insert(
+               std::make_pair(journalNogapInstanceId, nogapInstanceManager.NextNogapInstanceId())).first;
+         }
+
+         taskSettings.m_settingsManager.setValue(LameNoGapInstanceId, iterNogapId->second);
+      }
+
+      std::shared_ptr<Encoder::EncoderTask> spTask(new Encoder::EncoderTask(dependentTaskId, taskSettings));
+
+      taskMgr.AddTask(spTask);
+
+      mapJournalTaskIdToTaskId[entry.m_taskId] = spTask->Id();
    }
 }
 
@@ -285,8 +397,13 @@ std::shared_ptr<Encoder::EncoderTask> TaskCreationHelper::CreateEncoderTaskForCD
 
    taskSettings.m_settingsManager = m_uiSettings.settings_manager;
 
+   // extracted tracks are deleted after encoding, so tracks from CD are always encoded by
+   // passing the LAME instance from task to task
    if (nogapInstanceId >= 0)
+   {
       taskSettings.m_settingsManager.setValue(LameNoGapInstanceId, nogapInstanceId);
+      taskSettings.m_settingsManager.setValue(LameOptNoGapParallel, 0);
+   }
 
    Encoder::TrackInfo encodeTrackInfo;
    Encoder::CDExtractTask::SetTrackInfoFromCDTrackInfo(encodeTrackInfo, cdReadJob);
@@ -335,6 +452,93 @@ CString TaskCreationHelper::FindCommonPlaylistOutputFolder() const
    return playlistOutputFolder;
 }
 
+CString TaskCreationHelper::FindCommonInputFolder() const
+{
+   CString inputRootFolder;
+
+   for (auto encoderJob : m_uiSettings.encoderjoblist)
+   {
+      CString inputFolder = Path::FolderName(encoderJob.InputFilename());
+
+      if (inputRootFolder.IsEmpty())
+      {
+         inputRootFolder = inputFolder;
+         continue;
+      }
+
+      CString newCommonRootPath = Path::GetCommonRootPath(inputRootFolder, inputFolder);
+
+      if (newCommonRootPath.IsEmpty())
+         break; // e.g. files on different drives; the other files are stored in the output root
+      else
+         inputRootFolder = newCommonRootPath;
+   }
+
+   if (!inputRootFolder.IsEmpty())
+      Path::AddEndingBackslash(inputRootFolder);
+
+   return inputRootFolder;
+}
+
+CString TaskCreationHelper::GetMirrorOutputFolder(const CString& inputRootFolder, const CString& inputFilename) const
+{
+   CString outputFolder = m_uiSettings.m_defaultSettings.outputdir;
+
+   CString inputFolder = Path::FolderName(inputFilename);
+   Path::AddEndingBackslash(inputFolder);
+
+   if (!inputRootFolder.IsEmpty() &&
+      inputFolder.Left(inputRootFolder.GetLength()).CompareNoCase(inputRootFolder) == 0)
+   {
+      outputFolder = Path::Combine(outputFolder, inputFolder.Mid(inputRootFolder.GetLength()));
+   }
+
+   return outputFolder;
+}
+
+std::vector<Encoder::LibraryMirrorManifest::Entry> TaskCreationHelper::RemoveUpToDateMirrorJobs(
+   Encoder::LibraryMirrorManifest& manifest, const CString& inputRootFolder, std::vector<size_t>& jobIndexList) const
+{
+   Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
+
+   ULONGLONG settingsHash = Encoder::LibraryMirrorManifest::CalcSettingsHash(
+      moduleManager.GetOutputModuleID(m_uiSettings.output_module),
+      m_uiSettings.settings_manager);
+
+   std::vector<size_t> remainingJobIndexList;
+   std::vector<Encoder::LibraryMirrorManifest::Entry> entriesList;
+
+   for (size_t jobIndex : jobIndexList)
+   {
+      const Encoder::EncoderJob& job = m_uiSettings.encoderjoblist[jobIndex];
+
+      Encoder::LibraryMirrorManifest::Entry entry;
+      entry.m_inputFilename = job.InputFilename();
+      entry.m_settingsHash = settingsHash;
+
+      // up-to-date files only need querying input and output file infos; when the input file
+      // info can't be read, the job is kept, so that the encoder reports the error
+      if (Encoder::LibraryMirrorManifest::GetFileInfo(entry.m_inputFilename, entry.m_fileSize, entry.m_lastWriteTime) &&
+         manifest.IsUpToDate(entry,
+            GetMirrorOutputFolder(inputRootFolder, entry.m_inputFilename),
+            m_uiSettings.m_mirrorUseContentHash))
+      {
+         continue;
+      }
+
+      remainingJobIndexList.push_back(jobIndex);
+      entriesList.push_back(entry);
+   }
+
+   ATLTRACE(_T("mirror library: %u of %u files are up-to-date\n"),
+      jobIndexList.size() - remainingJobIndexList.size(),
+      jobIndexList.size());
+
+   jobIndexList.swap(remainingJobIndexList);
+
+   return entriesList;
+}
+
 void TaskCreationHelper::AddPlaylistTask()
 {
    TaskManager& taskMgr = IoCContainer::Current().Resolve<TaskManager>();
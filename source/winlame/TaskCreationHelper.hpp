@@ -21,6 +21,9 @@
 //
 #pragma once
 
+#include "LibraryMirrorManifest.hpp"
+#include "EncoderBatchPlan.hpp"
+
 struct UISettings;
 
 namespace Encoder
@@ -45,10 +48,22 @@ public:
    /// adds tasks to task manager, depending on the options of the global UISettings object
    void AddTasks();
 
+   /// adds tasks again that were recorded in the task journal, but weren't finished
+   void AddJournaledTasks();
+
 private:
    /// adds tasks for input files to task manager
    void AddInputFilesTasks();
 
+   /// returns batch plan for the current input files jobs; created on first call
+   const Encoder::EncoderBatchPlan& GetInputFilesBatchPlan() const;
+
+   /// plans all input files jobs in a single pass
+   std::unique_ptr<Encoder::EncoderBatchPlan> PlanInputFilesBatch(const CString& mirrorInputRootFolder) const;
+
+   /// returns output folder for input file, depending on the output location options
+   CString GetOutputFolder(const CString& inputFilename, const CString& mirrorInputRootFolder) const;
+
    /// adds tasks for CD extraction to task manager
    void AddCDExtractTasks();
 
@@ -60,6 +75,19 @@ private:
    /// finds playlist output folder that is common to all files on the playlist
    CString FindCommonPlaylistOutputFolder() const;
 
+   /// finds input folder that is common to all input files, used as root when mirroring
+   CString FindCommonInputFolder() const;
+
+   /// returns output folder for input file when mirroring the input root folder
+   CString GetMirrorOutputFolder(const CString& inputRootFolder, const CString& inputFilename) const;
+
+   /// removes the indices of all jobs with up-to-date output files from the list of job
+   /// indices when mirroring, and returns manifest entries for the remaining jobs; the job
+   /// list itself isn't modified
+   std::vector<Encoder::LibraryMirrorManifest::Entry> RemoveUpToDateMirrorJobs(
+      Encoder::LibraryMirrorManifest& manifest, const CString& inputRootFolder,
+      std::vector<size_t>& jobIndexList) const;
+
    /// adds task to create a playlist to task manager
    void AddPlaylistTask();
 
@@ -69,4 +97,7 @@ private:
 
    /// last task id used for an encoding task or a CD extract task
    unsigned int m_lastTaskId;
+
+   /// batch plan for the input files jobs, used for the checks before adding tasks
+   mutable std::unique_ptr<Encoder::EncoderBatchPlan> m_upInputFilesBatchPlan;
 };
@@ -0,0 +1,310 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TaskJournal.cpp
+/// \brief Task journal
+//
+#include "stdafx.h"
+#include "TaskJournal.hpp"
+#include "Task.hpp"
+#include <map>
+
+/// journal line type for an added task
+const TCHAR c_journalTaskAdded = _T('A');
+
+/// journal line type for a started task
+const TCHAR c_journalTaskStarted = _T('S');
+
+/// journal line type for a finished task
+const TCHAR c_journalTaskFinished = _T('F');
+
+/// number of fields in an "add task" line
+const size_t c_numAddedLineFields = 15;
+
+/// returns text to write as journal line field; tabs and line breaks would split the line,
+/// and are replaced by spaces
+static CString JournalField(const CString& text)
+{
+   CString field = text;
+   field.Replace(_T('\t'), _T(' '));
+   field.Replace(_T('\r'), _T(' '));
+   field.Replace(_T('\n'), _T(' '));
+
+   return field;
+}
+
+/// splits journal line into tab separated fields; empty fields are kept
+static std::vector<CString> SplitJournalLine(const CString& line)
+{
+   std::vector<CString> fields;
+
+   int start = 0;
+   for (;;)
+   {
+      int pos = line.Find(_T('\t'), start);
+      if (pos == -1)
+      {
+         fields.push_back(line.Mid(start));
+         break;
+      }
+
+      fields.push_back(line.Mid(start, pos - start));
+      start = pos + 1;
+   }
+
+   return fields;
+}
+
+TaskJournal::TaskJournal(const CString& journalFilename)
+   :m_journalFilename(journalFilename),
+   m_journalFile(nullptr)
+{
+   m_journalFile = _tfopen(m_journalFilename, _T("at, ccs=UTF-8"));
+}
+
+TaskJournal::~TaskJournal()
+{
+   Close();
+}
+
+void TaskJournal::TaskAdded(std::shared_ptr<Task> spTask)
+{
+   std::shared_ptr<Encoder::EncoderTask> spEncoderTask =
+      std::dynamic_pointer_cast<Encoder::EncoderTask>(spTask);
+
+   if (spEncoderTask == nullptr)
+      return; // not an encoder task
+
+   // the output filename is generated when the task is created
+   Encoder::EncoderTaskSettings settings = spEncoderTask->Settings();
+   settings.m_outputFilename = spEncoderTask->OutputFilename();
+
+   TaskAdded(spTask->Id(), spEncoderTask->DependentTaskId(), settings);
+}
+
+void TaskJournal::TaskAdded(unsigned int taskId, unsigned int dependentTaskId, const Encoder::EncoderTaskSettings& settings)
+{
+   // tasks for CD tracks use extracted temporary files and provided track infos; skip them
+   if (settings.m_useTrackInfo)
+      return;
+
+   CString settingsText;
+   for (const auto& setting : settings.m_settingsManager.GetSettingsList())
+      settingsText.AppendFormat(_T("%u=%i,"), setting.first, setting.second);
+
+   settingsText.TrimRight(_T(','));
+
+   CString line;
+   line.Format(_T("%c\t%u\t%u\t%i\t%i\t%i\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%i"),
+      c_journalTaskAdded,
+      taskId,
+      dependentTaskId,
+      settings.m_outputModuleID,
+      settings.m_overwriteExisting ? 1 : 0,
+      settings.m_deleteInputAfterEncode ? 1 : 0,
+      JournalField(settings.m_inputFilename).GetString(),
+      JournalField(settings.m_outputFolder).GetString(),
+      JournalField(settings.m_outputFilename).GetString(),
+      JournalField(settings.m_title).GetString(),
+      settingsText.GetString(),
+      JournalField(settings.m_gaplessPreviousInputFilename).GetString(),
+      JournalField(settings.m_gaplessNextInputFilename).GetString(),
+      JournalField(settings.m_playlistFilename).GetString(),
+      settings.m_outputSameFolder ? 1 : 0);
+
+   AppendLine(line);
+}
+
+void TaskJournal::TaskStarted(unsigned int taskId)
+{
+   CString line;
+   line.Format(_T("%c\t%u"), c_journalTaskStarted, taskId);
+
+   AppendLine(line);
+}
+
+void TaskJournal::TaskFinished(unsigned int taskId)
+{
+   CString line;
+   line.Format(_T("%c\t%u"), c_journalTaskFinished, taskId);
+
+   AppendLine(line);
+}
+
+std::vector<TaskJournal::Entry> TaskJournal::ReadUnfinishedEntries() const
+{
+   std::unique_lock<std::mutex> lock(m_mutexJournal);
+
+   std::vector<Entry> entriesList;
+
+   FILE* fd = _tfopen(m_journalFilename, _T("rt, ccs=UTF-8"));
+   if (fd == nullptr)
+      return entriesList;
+
+   std::map<unsigned int, size_t> mapTaskIdToEntryIndex;
+   std::vector<bool> finishedList;
+
+   CString line;
+   while (ReadLine(fd, line))
+   {
+      // a line without line ending was possibly only partly written before a crash
+      if (line.IsEmpty() || line[line.GetLength() - 1] != _T('\n'))
+         continue;
+
+      line.TrimRight(_T("\r\n"));
+
+      std::vector<CString> fields = SplitJournalLine(line);
+      if (fields.size() < 2 || fields[0].GetLength() != 1)
+         continue;
+
+      unsigned int taskId = _tcstoul(fields[1], nullptr, 10);
+
+      switch (fields[0][0])
+      {
+      case c_journalTaskAdded:
+      {
+         Entry entry;
+         if (ParseAddedLine(fields, entry))
+         {
+            mapTaskIdToEntryIndex[taskId] = entriesList.size();
+            entriesList.push_back(entry);
+            finishedList.push_back(false);
+         }
+      }
+      break;
+
+      case c_journalTaskFinished:
+      {
+         auto iter = mapTaskIdToEntryIndex.find(taskId);
+         if (iter != mapTaskIdToEntryIndex.end())
+            finishedList[iter->second] = true;
+      }
+      break;
+
+      case c_journalTaskStarted:
+      default:
+         // started tasks are restarted from the beginning
+         break;
+      }
+   }
+
+   fclose(fd);
+
+   std::vector<Entry> unfinishedEntriesList;
+   for (size_t index = 0; index < entriesList.size(); index++)
+   {
+      if (!finishedList[index])
+         unfinishedEntriesList.push_back(entriesList[index]);
+   }
+
+   return unfinishedEntriesList;
+}
+
+void TaskJournal::Reset()
+{
+   std::unique_lock<std::mutex> lock(m_mutexJournal);
+
+   if (m_journalFile != nullptr)
+      fclose(m_journalFile);
+
+   m_journalFile = _tfopen(m_journalFilename, _T("wt, ccs=UTF-8"));
+}
+
+void TaskJournal::Close()
+{
+   std::unique_lock<std::mutex> lock(m_mutexJournal);
+
+   if (m_journalFile != nullptr)
+   {
+      fclose(m_journalFile);
+      m_journalFile = nullptr;
+   }
+}
+
+void TaskJournal::AppendLine(const CString& line)
+{
+   std::unique_lock<std::mutex> lock(m_mutexJournal);
+
+   if (m_journalFile == nullptr)
+      return;
+
+   _ftprintf(m_journalFile, _T("%s\n"), line.GetString());
+
+   // flush, so that the line survives a crash of the process
+   fflush(m_journalFile);
+}
+
+bool TaskJournal::ReadLine(FILE* fd, CString& line)
+{
+   line.Empty();
+
+   std::vector<TCHAR> buffer(4096, 0);
+   while (_fgetts(buffer.data(), static_cast<int>(buffer.size()), fd) != nullptr)
+   {
+      line += buffer.data();
+
+      // continue reading when the line didn't fit into the buffer
+      if (!line.IsEmpty() && line[line.GetLength() - 1] == _T('\n'))
+         break;
+   }
+
+   return !line.IsEmpty();
+}
+
+bool TaskJournal::ParseAddedLine(const std::vector<CString>& fields, Entry& entry)
+{
+   if (fields.size() != c_numAddedLineFields)
+      return false;
+
+   entry.m_taskId = _tcstoul(fields[1], nullptr, 10);
+   entry.m_dependentTaskId = _tcstoul(fields[2], nullptr, 10);
+
+   Encoder::EncoderTaskSettings& settings = entry.m_settings;
+   settings.m_outputModuleID = _ttoi(fields[3]);
+   settings.m_overwriteExisting = _ttoi(fields[4]) != 0;
+   settings.m_deleteInputAfterEncode = _ttoi(fields[5]) != 0;
+   settings.m_inputFilename = fields[6];
+   settings.m_outputFolder = fields[7];
+   settings.m_outputFilename = fields[8];
+   settings.m_title = fields[9];
+
+   int pos = 0;
+   CString setting = fields[10].Tokenize(_T(","), pos);
+   while (pos != -1)
+   {
+      int equalPos = setting.Find(_T('='));
+      if (equalPos != -1)
+      {
+         unsigned int name = _tcstoul(setting.Left(equalPos), nullptr, 10);
+         int value = _ttoi(setting.Mid(equalPos + 1));
+
+         settings.m_settingsManager.setValue(static_cast<unsigned short>(name), value);
+      }
+
+      setting = fields[10].Tokenize(_T(","), pos);
+   }
+
+   settings.m_gaplessPreviousInputFilename = fields[11];
+   settings.m_gaplessNextInputFilename = fields[12];
+   settings.m_playlistFilename = fields[13];
+   settings.m_outputSameFolder = _ttoi(fields[14]) != 0;
+
+   return entry.m_taskId != 0 &&
+      !settings.m_inputFilename.IsEmpty() &&
+      !settings.m_outputFilename.IsEmpty();
+}
@@ -0,0 +1,107 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TaskJournal.hpp
+/// \brief Task journal
+//
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "EncoderTask.hpp"
+
+class Task;
+
+/// \brief journal file that records task state transitions
+/// \details The journal is appended to each time a task is added, started or finished. When
+/// winLAME is closed or crashes while tasks are still pending, the journal can be read on the
+/// next start to add all unfinished tasks again. Only encoding tasks for input files are
+/// recorded; CD extraction tasks depend on the disc in the drive and on temporary files, and
+/// playlist tasks are recreated by the user.
+class TaskJournal
+{
+public:
+   /// journal entry for a task that wasn't finished yet
+   struct Entry
+   {
+      /// ctor
+      Entry()
+         :m_taskId(0),
+         m_dependentTaskId(0)
+      {
+      }
+
+      /// task id, as used when the entry was written
+      unsigned int m_taskId;
+
+      /// dependent task id, as used when the entry was written; may be 0
+      unsigned int m_dependentTaskId;
+
+      /// encoder task settings, including output filename
+      Encoder::EncoderTaskSettings m_settings;
+   };
+
+   /// ctor; opens journal file for appending
+   explicit TaskJournal(const CString& journalFilename);
+   /// dtor
+   ~TaskJournal();
+
+   /// records that task was added to the task queue
+   void TaskAdded(std::shared_ptr<Task> spTask);
+
+   /// records that encoder task with given settings was added to the task queue; the
+   /// settings must contain the generated output filename
+   void TaskAdded(unsigned int taskId, unsigned int dependentTaskId, const Encoder::EncoderTaskSettings& settings);
+
+   /// records that task was started
+   void TaskStarted(unsigned int taskId);
+
+   /// records that task was finished, either successfully, with an error or by being stopped
+   void TaskFinished(unsigned int taskId);
+
+   /// reads journal file and returns all tasks that were added, but not finished
+   std::vector<Entry> ReadUnfinishedEntries() const;
+
+   /// resets journal by truncating the journal file
+   void Reset();
+
+   /// closes journal; all further state transitions are not recorded anymore
+   void Close();
+
+private:
+   /// appends single line to the journal file and flushes it
+   void AppendLine(const CString& line);
+
+   /// reads a whole line from the journal file, regardless of its length; returns false at
+   /// the end of the file
+   static bool ReadLine(FILE* fd, CString& line);
+
+   /// parses an "add task" line and returns false when line is invalid
+   static bool ParseAddedLine(const std::vector<CString>& fields, Entry& entry);
+
+private:
+   /// journal filename
+   CString m_journalFilename;
+
+   /// mutex protecting journal file
+   mutable std::mutex m_mutexJournal;
+
+   /// journal file; may be nullptr when journal couldn't be opened or is closed
+   FILE* m_journalFile;
+};
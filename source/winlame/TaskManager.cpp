@@ -31,17 +31,33 @@
 TaskManager::TaskManager(const TaskManagerConfig& config)
    :m_nextTaskId(1),
    m_config(config),
+   m_memoryBudget(static_cast<size_t>(config.m_uiMemoryBudgetMB) * 1024 * 1024),
+   m_areTasksWaitingForMemory(false),
    m_upDefaultWork(new boost::asio::io_service::work(m_ioService))
 {
+   if (!m_config.m_journalFilename.IsEmpty())
+      m_upJournal.reset(new TaskJournal(m_config.m_journalFilename));
+
+   Encoder::CpuTopology topology;
+   std::vector<Encoder::CpuTopology::CoreInfo> workerCores =
+      topology.WorkerCores(m_config.m_uiNumReservedCores);
+
    // find out number of threads to start
    unsigned int uiNumThreads = m_config.m_uiUseNumTasks;
    if (m_config.m_bAutoTasksPerCpu)
    {
-      uiNumThreads = std::thread::hardware_concurrency();
+      uiNumThreads = 0;
+      for (const Encoder::CpuTopology::CoreInfo& core : workerCores)
+         uiNumThreads += m_config.m_bOneTaskPerPhysicalCore ? 1 : core.NumLogicalProcessors();
+
       if (uiNumThreads == 0)
          uiNumThreads = m_config.m_uiUseNumTasks;
    }
 
+   ATLTRACE(_T("starting %u worker threads on %u of %u cores, %u NUMA nodes, pinning %s\n"),
+      uiNumThreads, workerCores.size(), topology.PhysicalCores().size(), topology.NumNumaNodes(),
+      m_config.m_bPinWorkerThreads ? _T("on") : _T("off"));
+
    // start up threads
    for (unsigned int i = 0; i < uiNumThreads; i++)
    {
@@ -50,6 +66,8 @@ TaskManager::TaskManager(const TaskManagerConfig& config)
             std::bind(&TaskManager::RunThread, std::ref(m_ioService), i)
          ));
 
+      PlaceWorkerThread(spThread->native_handle(), i, workerCores);
+
       SetBusyFlag(GetThreadId(spThread->native_handle()), false);
 
       m_vecThreadPool.push_back(spThread);
@@ -61,6 +79,10 @@ TaskManager::~TaskManager()
    // stop all tasks
    try
    {
+      // close journal first, so that stopped tasks are resumed on next start
+      if (m_upJournal != nullptr)
+         m_upJournal->Close();
+
       StopAll();
 
       // stop threads
@@ -109,43 +131,46 @@ void TaskManager::AddTask(std::shared_ptr<Task> spTask)
    unsigned int taskId = m_nextTaskId++;
    spTask->Id(taskId);
 
-   {
-      std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
-      m_deqTaskQueue.push_back(spTask);
-   }
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
 
-   ATLASSERT(spTask->IsStarted() == false); // must not be already started
+   // the task is journaled before it becomes visible to CheckRunnableTasks(), so that the
+   // journal never contains started or finished entries before the added entry; the queue
+   // lock also keeps RemoveCompletedTasks() from resetting the journal in between
+   if (m_upJournal != nullptr)
+      m_upJournal->TaskAdded(spTask);
 
-   if (IsTaskRunnable(spTask))
-   {
-      spTask->IsStarted(true);
+   m_deqTaskQueue.push_back(spTask);
 
-      m_ioService.post(
-         std::bind(&TaskManager::RunTask, this, spTask));
-   }
+   if (!IsTaskRunnable(spTask))
+      return;
+
+   // tasks waiting for memory are only overtaken in CheckRunnableTasks(), which counts how
+   // often they were overtaken
+   if (m_areTasksWaitingForMemory)
+      return;
+
+   AdmitTasks({ spTask });
 }
 
 void TaskManager::CheckRunnableTasks()
 {
    std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
 
-   std::for_each(m_deqTaskQueue.begin(), m_deqTaskQueue.end(),
-      [&](std::shared_ptr<Task>& spTask)
+   std::vector<std::shared_ptr<Task>> runnableTasks;
+
+   for (std::shared_ptr<Task> spTask : m_deqTaskQueue)
    {
-      auto iter = m_mapCompletedTaskInfos.find(spTask->Id());
-      if (iter != m_mapCompletedTaskInfos.end())
-         return; // already completed
+      if (spTask->IsStarted() ||
+         m_mapCompletedTaskInfos.find(spTask->Id()) != m_mapCompletedTaskInfos.end())
+         continue; // already running or completed
 
-      if (m_mapCompletedTaskInfos.find(spTask->Id()) == m_mapCompletedTaskInfos.end() &&
-         !spTask->IsStarted() &&
-         IsTaskRunnable(spTask))
-      {
-         spTask->IsStarted(true);
+      if (IsTaskRunnable(spTask))
+         runnableTasks.push_back(spTask);
+   }
 
-         m_ioService.post(
-            std::bind(&TaskManager::RunTask, this, spTask));
-      }
-   });
+   m_areTasksWaitingForMemory = false;
+
+   AdmitTasks(runnableTasks);
 }
 
 bool TaskManager::IsQueueEmpty() const
@@ -266,6 +291,12 @@ void TaskManager::StopAll()
    {
       spTask->Stop();
 
+      if (m_upJournal != nullptr &&
+         m_mapCompletedTaskInfos.find(spTask->Id()) == m_mapCompletedTaskInfos.end())
+      {
+         m_upJournal->TaskFinished(spTask->Id());
+      }
+
       CString errorText;
       StoreCompletedTaskInfo(spTask, errorText);
    }
@@ -288,6 +319,45 @@ void TaskManager::RemoveCompletedTasks()
    {
       RemoveTask(spTask);
    }
+
+   // when all tasks are gone, the journal can start over
+   if (m_deqTaskQueue.empty() && m_upJournal != nullptr)
+      m_upJournal->Reset();
+}
+
+std::vector<TaskJournal::Entry> TaskManager::RestoreJournal()
+{
+   std::vector<TaskJournal::Entry> entriesList;
+
+   if (m_upJournal == nullptr)
+      return entriesList;
+
+   entriesList = m_upJournal->ReadUnfinishedEntries();
+   m_upJournal->Reset();
+
+   return entriesList;
+}
+
+void TaskManager::PlaceWorkerThread(HANDLE threadHandle, unsigned int threadNumber,
+   const std::vector<Encoder::CpuTopology::CoreInfo>& workerCores) const
+{
+   if (workerCores.empty())
+      return;
+
+   // workers are distributed over the cores in NUMA node order; when there are more workers
+   // than cores, the assignment wraps around
+   const Encoder::CpuTopology::CoreInfo& core = workerCores[threadNumber % workerCores.size()];
+
+   if (m_config.m_bPinWorkerThreads)
+   {
+      Encoder::CpuTopology::SetThreadAffinity(threadHandle, core.m_group, core.m_affinityMask);
+   }
+   else if (m_config.m_uiNumReservedCores > 0)
+   {
+      // the thread may run on all cores of its processor group that aren't reserved
+      Encoder::CpuTopology::SetThreadAffinity(threadHandle, core.m_group,
+         Encoder::CpuTopology::CombinedAffinityMask(workerCores, core.m_group));
+   }
 }
 
 void TaskManager::RunThread(boost::asio::io_service& ioService, unsigned int threadNumber)
@@ -323,22 +393,80 @@ bool TaskManager::IsTaskRunnable(std::shared_ptr<Task> spTask) const
    // check dependent task ID
    unsigned int dependentTaskId = spTask->DependentTaskId();
 
-   if (dependentTaskId == 0)
-      return true;
-
-   if (m_setFinishedTaskIds.find(dependentTaskId) == m_setFinishedTaskIds.end())
+   if (dependentTaskId != 0 &&
+      m_setFinishedTaskIds.find(dependentTaskId) == m_setFinishedTaskIds.end())
    {
       // task id wasn't reported as finished yet
       return false;
    }
 
+   // check additional dependent task IDs; continue where the last check stopped, since
+   // finished tasks stay finished and the list may contain a task id for every file
+   const std::vector<unsigned int>& dependentTaskIds = spTask->m_dependentTaskIds;
+   size_t& numFinished = spTask->m_numFinishedDependentTaskIds;
+
+   while (numFinished < dependentTaskIds.size())
+   {
+      if (m_setFinishedTaskIds.find(dependentTaskIds[numFinished]) == m_setFinishedTaskIds.end())
+         return false;
+
+      numFinished++;
+   }
+
    return true;
 }
 
+void TaskManager::AdmitTasks(const std::vector<std::shared_ptr<Task>>& runnableTasks)
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   std::vector<MemoryBudget::WaitingTask> waitingTasks;
+   waitingTasks.reserve(runnableTasks.size());
+
+   for (std::shared_ptr<Task> spTask : runnableTasks)
+   {
+      MemoryBudget::WaitingTask waitingTask;
+      waitingTask.m_memoryUsage = m_memoryBudget.IsLimited() ? spTask->EstimatedMemoryUsage() : 0;
+      waitingTask.m_numOvertaken = spTask->m_numOvertaken;
+
+      waitingTasks.push_back(waitingTask);
+   }
+
+   std::vector<size_t> admittedTasks = m_memoryBudget.Admit(waitingTasks);
+
+   for (size_t index = 0, maxIndex = runnableTasks.size(); index < maxIndex; index++)
+      runnableTasks[index]->m_numOvertaken = waitingTasks[index].m_numOvertaken;
+
+   for (size_t index : admittedTasks)
+   {
+      std::shared_ptr<Task> spTask = runnableTasks[index];
+
+      spTask->m_reservedMemory = waitingTasks[index].m_memoryUsage;
+      spTask->IsStarted(true);
+
+      m_ioService.post(
+         std::bind(&TaskManager::RunTask, this, spTask));
+   }
+
+   if (admittedTasks.size() < runnableTasks.size())
+      m_areTasksWaitingForMemory = true;
+}
+
+void TaskManager::ReleaseTaskMemory(std::shared_ptr<Task> spTask)
+{
+   std::unique_lock<std::recursive_mutex> lock(m_mutexQueue);
+
+   m_memoryBudget.Release(spTask->m_reservedMemory);
+   spTask->m_reservedMemory = 0;
+}
+
 void TaskManager::RunTask(std::shared_ptr<Task> spTask)
 {
    SetBusyFlag(GetCurrentThreadId(), true);
 
+   if (m_upJournal != nullptr)
+      m_upJournal->TaskStarted(spTask->Id());
+
    CString errorText;
    try
    {
@@ -357,6 +485,15 @@ void TaskManager::RunTask(std::shared_ptr<Task> spTask)
    SetBusyFlag(GetCurrentThreadId(), false);
 
    StoreCompletedTaskInfo(spTask, errorText);
+
+   if (m_upJournal != nullptr)
+      m_upJournal->TaskFinished(spTask->Id());
+
+   ReleaseTaskMemory(spTask);
+
+   // start tasks that waited for memory; without a budget, the UI timer does this
+   if (m_memoryBudget.IsLimited())
+      CheckRunnableTasks();
 }
 
 void TaskManager::StoreCompletedTaskInfo(std::shared_ptr<Task> spTask, CString& errorText)
@@ -31,6 +31,9 @@
 #include <ulib/config/BoostAsio.hpp>
 #include "TaskInfo.hpp"
 #include "TaskManagerConfig.hpp"
+#include "TaskJournal.hpp"
+#include "MemoryBudget.hpp"
+#include "CpuTopology.hpp"
 
 class Task;
 
@@ -73,13 +76,27 @@ public:
    /// removes all completed tasks from queue
    void RemoveCompletedTasks();
 
+   /// \brief returns all tasks from the journal that weren't finished in the last run
+   /// \details the journal is reset afterwards; the tasks have to be added again
+   std::vector<TaskJournal::Entry> RestoreJournal();
+
 private:
+   /// sets affinity of worker thread, depending on the configured worker placement
+   void PlaceWorkerThread(HANDLE threadHandle, unsigned int threadNumber,
+      const std::vector<Encoder::CpuTopology::CoreInfo>& workerCores) const;
+
    /// thread function
    static void RunThread(boost::asio::io_service& ioService, unsigned int threadNumber);
 
    /// returns if a task is runnable
    bool IsTaskRunnable(std::shared_ptr<Task> spTask) const;
 
+   /// starts all given runnable tasks that are admitted by the memory budget
+   void AdmitTasks(const std::vector<std::shared_ptr<Task>>& runnableTasks);
+
+   /// returns memory reserved by task to the memory budget
+   void ReleaseTaskMemory(std::shared_ptr<Task> spTask);
+
    /// runs single task
    void RunTask(std::shared_ptr<Task> spTask);
 
@@ -96,6 +113,8 @@ private:
    /// task manager configuration
    TaskManagerConfig m_config;
 
+   /// task journal; may be nullptr when no journal is written
+   std::unique_ptr<TaskJournal> m_upJournal;
 
    // task queue
 
@@ -120,6 +139,12 @@ private:
    /// set with all finished task ids
    std::set<unsigned int> m_setFinishedTaskIds;
 
+   /// memory budget for all running tasks, protected by queue mutex
+   MemoryBudget m_memoryBudget;
+
+   /// indicates if runnable tasks are waiting for memory, protected by queue mutex
+   bool m_areTasksWaitingForMemory;
+
 
    // thread pool
 
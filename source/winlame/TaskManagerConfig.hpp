@@ -28,7 +28,11 @@ struct TaskManagerConfig
    /// ctor
    TaskManagerConfig()
       :m_bAutoTasksPerCpu(true),
-       m_uiUseNumTasks(2)
+       m_uiUseNumTasks(2),
+       m_bOneTaskPerPhysicalCore(false),
+       m_bPinWorkerThreads(false),
+       m_uiNumReservedCores(0),
+       m_uiMemoryBudgetMB(0)
    {
    }
 
@@ -38,4 +42,24 @@ struct TaskManagerConfig
    /// when m_bAutoTasksPerCpu is false, TaskManager uses this many concurrent threads
    /// to run tasks
    unsigned int m_uiUseNumTasks;
+
+   /// when enabled and m_bAutoTasksPerCpu is set, one task per physical CPU core is run,
+   /// instead of one task per logical processor; SMT siblings share the core's FPU units
+   bool m_bOneTaskPerPhysicalCore;
+
+   /// when enabled, each worker thread is pinned to a single physical CPU core; memory the
+   /// thread allocates is then taken from the NUMA node the core is attached to
+   bool m_bPinWorkerThreads;
+
+   /// number of physical CPU cores that aren't used by worker threads, e.g. to keep the UI
+   /// or other services responsive
+   unsigned int m_uiNumReservedCores;
+
+   /// memory budget for all running tasks, in MB; tasks are only started when their estimated
+   /// memory usage fits into the remaining budget. 0 means no limit
+   unsigned int m_uiMemoryBudgetMB;
+
+   /// filename of journal file that records task state transitions; when empty, no journal
+   /// is written
+   CString m_journalFilename;
 };
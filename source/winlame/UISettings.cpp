@@ -33,6 +33,9 @@ LPCTSTR g_pszRegistryRoot = _T("Software\\winLAME");
 LPCTSTR g_pszOutputPath = _T("OutputPath");
 LPCTSTR g_pszOutputModule = _T("OutputModule");
 LPCTSTR g_pszInputOutputSameFolder = _T("InputOutputSameFolder");
+LPCTSTR g_pszMirrorLibrary = _T("MirrorLibrary");
+LPCTSTR g_pszMirrorUseContentHash = _T("MirrorUseContentHash");
+LPCTSTR g_pszMirrorPruneRemoved = _T("MirrorPruneRemoved");
 LPCTSTR g_pszLastInputPath = _T("LastInputPath");
 LPCTSTR g_pszDeleteAfterEncode = _T("DeleteAfterEncode");
 LPCTSTR g_pszOverwriteExisting = _T("OverwriteExisting");
@@ -48,6 +51,10 @@ LPCTSTR g_pszLanguageId = _T("LanguageId");
 LPCTSTR g_pszAppMode = _T("AppMode");
 LPCTSTR g_pszAutoTasksPerCpu = _T("TaskManagerAutoTasksPerCPU");
 LPCTSTR g_pszUseNumTasks = _T("TaskManagerUseNumTasks");
+LPCTSTR g_pszOneTaskPerPhysicalCore = _T("TaskManagerOneTaskPerPhysicalCore");
+LPCTSTR g_pszPinWorkerThreads = _T("TaskManagerPinWorkerThreads");
+LPCTSTR g_pszNumReservedCores = _T("TaskManagerNumReservedCores");
+LPCTSTR g_pszMemoryBudgetMB = _T("TaskManagerMemoryBudgetMB");
 
 
 // EncodingSettings methods
@@ -64,6 +71,9 @@ EncodingSettings::EncodingSettings()
 UISettings::UISettings()
    :output_module(0),
    out_location_use_input_dir(false),
+   m_mirrorLibrary(false),
+   m_mirrorUseContentHash(false),
+   m_mirrorPruneRemoved(false),
    preset_avail(false),
    m_bFromInputFilesPage(true),
    after_encoding_action(-1),
@@ -140,6 +150,11 @@ void UISettings::ReadSettings()
    // read "use input file's folder as output location" value
    ReadBooleanValue(regRoot, g_pszInputOutputSameFolder, out_location_use_input_dir);
 
+   // read "mirror library" values
+   ReadBooleanValue(regRoot, g_pszMirrorLibrary, m_mirrorLibrary);
+   ReadBooleanValue(regRoot, g_pszMirrorUseContentHash, m_mirrorUseContentHash);
+   ReadBooleanValue(regRoot, g_pszMirrorPruneRemoved, m_mirrorPruneRemoved);
+
    // read "delete after encode" value
    ReadBooleanValue(regRoot, g_pszDeleteAfterEncode, m_defaultSettings.delete_after_encode);
 
@@ -209,6 +224,11 @@ void UISettings::ReadSettings()
    ReadUIntValue(regRoot, g_pszUseNumTasks, numCpuCores);
    m_taskManagerConfig.m_uiUseNumTasks = numCpuCores;
 
+   ReadBooleanValue(regRoot, g_pszOneTaskPerPhysicalCore, m_taskManagerConfig.m_bOneTaskPerPhysicalCore);
+   ReadBooleanValue(regRoot, g_pszPinWorkerThreads, m_taskManagerConfig.m_bPinWorkerThreads);
+   ReadUIntValue(regRoot, g_pszNumReservedCores, m_taskManagerConfig.m_uiNumReservedCores);
+   ReadUIntValue(regRoot, g_pszMemoryBudgetMB, m_taskManagerConfig.m_uiMemoryBudgetMB);
+
    regRoot.Close();
 }
 
@@ -239,6 +259,16 @@ void UISettings::StoreSettings()
    DWORD value = out_location_use_input_dir ? 1 : 0;
    regRoot.SetValue(value, g_pszInputOutputSameFolder);
 
+   // write "mirror library" values
+   value = m_mirrorLibrary ? 1 : 0;
+   regRoot.SetValue(value, g_pszMirrorLibrary);
+
+   value = m_mirrorUseContentHash ? 1 : 0;
+   regRoot.SetValue(value, g_pszMirrorUseContentHash);
+
+   value = m_mirrorPruneRemoved ? 1 : 0;
+   regRoot.SetValue(value, g_pszMirrorPruneRemoved);
+
    // write "delete after encode" value
    value = m_defaultSettings.delete_after_encode ? 1 : 0;
    regRoot.SetValue(value, g_pszDeleteAfterEncode);
@@ -298,6 +328,18 @@ void UISettings::StoreSettings()
 
    value = m_taskManagerConfig.m_uiUseNumTasks;
    regRoot.SetValue(value, g_pszUseNumTasks);
+
+   value = m_taskManagerConfig.m_bOneTaskPerPhysicalCore ? 1 : 0;
+   regRoot.SetValue(value, g_pszOneTaskPerPhysicalCore);
+
+   value = m_taskManagerConfig.m_bPinWorkerThreads ? 1 : 0;
+   regRoot.SetValue(value, g_pszPinWorkerThreads);
+
+   value = m_taskManagerConfig.m_uiNumReservedCores;
+   regRoot.SetValue(value, g_pszNumReservedCores);
+
+   value = m_taskManagerConfig.m_uiMemoryBudgetMB;
+   regRoot.SetValue(value, g_pszMemoryBudgetMB);
 #pragma warning(pop)
 
    regRoot.Close();
@@ -99,6 +99,16 @@ struct UISettings
    /// use input dir as output location
    bool out_location_use_input_dir;
 
+   /// indicates if the input folder structure is mirrored to the output folder, and only new
+   /// or changed input files are encoded
+   bool m_mirrorLibrary;
+
+   /// indicates if content hashes are used in mirror mode to detect touched, but unchanged files
+   bool m_mirrorUseContentHash;
+
+   /// indicates if output files of deleted input files are removed in mirror mode
+   bool m_mirrorPruneRemoved;
+
    /// indicates if presets are available
    bool preset_avail;
 
@@ -37,14 +37,18 @@ using Encoder::SampleContainer;
 AacInputModule::AacInputModule()
    :m_decoder(nullptr),
    m_inputBufferHigh(0),
+   m_inputBufferPos(0),
    m_inputFileLength(0),
-   m_currentFilePos(0)
+   m_currentFilePos(0),
+   m_numTotalSamples(0),
+   m_pendingSamples(nullptr)
 {
    m_moduleId = ID_IM_AAC;
 
    std::uninitialized_fill(std::begin(m_inputBuffer), std::end(m_inputBuffer), (unsigned char)0);
 
    memset(&m_info, 0, sizeof(m_info));
+   memset(&m_pendingFrameInfo, 0, sizeof(m_pendingFrameInfo));
 }
 
 Encoder::InputModule* AacInputModule::CloneModule()
@@ -147,6 +151,88 @@ CString AacInputModule::GetFilterString() const
 
 int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    TrackInfo& trackInfo, SampleContainer& samples)
+{
+   // retrieve tag
+   AudioFileTag tag(trackInfo, m_spTrackInfoCache);
+   tag.ReadFromFile(infilename);
+
+   // grab decoder instance
+   m_decoder = NeAACDecOpen();
+
+   // set output format
+   {
+      NeAACDecConfigurationPtr config;
+      config = NeAACDecGetCurrentConfiguration(m_decoder);
+      config->outputFormat = FAAD_FMT_16BIT;  // 32 bit sounds bad for some reason
+      NeAACDecSetConfiguration(m_decoder, config);
+   }
+
+   // MP4 files are read using the sample tables; all other files are read as raw AAC stream
+   int ret = m_demuxer.Open(infilename)
+      ? InitMp4Decoder()
+      : InitRawStreamDecoder(infilename);
+
+   if (ret < 0)
+      return ret;
+
+   // set up input traits
+   samples.SetInputModuleTraits(
+      16,
+      SamplesInterleaved,
+      m_info.sampling_rate,
+      m_info.channels);
+
+   return 0;
+}
+
+int AacInputModule::InitMp4Decoder()
+{
+   std::vector<unsigned char> decoderConfig = m_demuxer.GetDecoderConfig();
+
+   unsigned long sampleRate = 0;
+   unsigned char numChannels = 0;
+   if (NeAACDecInit2(m_decoder, decoderConfig.data(), static_cast<unsigned long>(decoderConfig.size()),
+      &sampleRate, &numChannels) < 0)
+   {
+      m_lastError.LoadString(IDS_ENCODER_ERROR_INIT_DECODER);
+      return -2;
+   }
+
+   m_info.version = 4;
+   m_info.headertype = 0; // raw access units
+   m_info.bitrate = m_demuxer.GetAverageBitrate();
+
+   // decode first access unit to get the right file info (for HE AAC files); the samples are
+   // returned by the first call to DecodeSamples()
+   int ret = DecodeAccessUnit(m_pendingFrameInfo, m_pendingSamples);
+   if (ret < 0)
+      return ret;
+
+   if (ret == 0)
+   {
+      m_lastError.LoadString(IDS_ENCODER_ERROR_INIT_DECODER);
+      return -2;
+   }
+
+   m_info.sampling_rate = m_pendingFrameInfo.samplerate;
+   m_info.channels = m_pendingFrameInfo.channels;
+   m_info.object_type = m_pendingFrameInfo.object_type - 1;
+
+   if (m_info.bitrate == 0 && m_demuxer.GetDuration() > 0)
+   {
+      // calculate from size of the media data
+      m_info.bitrate = static_cast<int>(
+         m_demuxer.GetMediaDataSize() * 8 * m_demuxer.GetTimescale() / m_demuxer.GetDuration());
+   }
+
+   // the sample durations are stored in the media timescale, which may differ from the
+   // output sample rate
+   m_numTotalSamples = m_demuxer.GetDuration() * m_info.sampling_rate / m_demuxer.GetTimescale();
+
+   return 0;
+}
+
+int AacInputModule::InitRawStreamDecoder(LPCTSTR infilename)
 {
    // open infile
    m_inputFile.open(infilename, std::ios::in | std::ios::binary);
@@ -175,24 +261,9 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    // search for begin of aac stream, skipping id3v2 tags; modifies m_currentFilePos
    // ...
 
-   // retrieve id3v2 tag
-   AudioFileTag tag(trackInfo);
-   tag.ReadFromFile(infilename);
-
    // seek to begin
    m_inputFile.seekg(m_currentFilePos, std::ios::beg);
 
-   // grab decoder instance
-   m_decoder = NeAACDecOpen();
-
-   // set output format
-   {
-      NeAACDecConfigurationPtr config;
-      config = NeAACDecGetCurrentConfiguration(m_decoder);
-      config->outputFormat = FAAD_FMT_16BIT;  // 32 bit sounds bad for some reason
-      NeAACDecSetConfiguration(m_decoder, config);
-   }
-
    // read first frame(s) and get infos about the aac file
    m_inputFile.read(reinterpret_cast<char*>(m_inputBuffer), c_aacInputBufferSize);
 
@@ -207,6 +278,7 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    }
 
    m_inputBufferHigh = 0;
+   m_inputBufferPos = 0;
 
    // seek to the next start
    m_currentFilePos += result;
@@ -227,13 +299,6 @@ int AacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
       m_info.object_type = frameInfo.object_type - 1;
    }
 
-   // set up input traits
-   samples.SetInputModuleTraits(
-      16,
-      SamplesInterleaved,
-      m_info.sampling_rate,
-      m_info.channels);
-
    return 0;
 }
 
@@ -241,44 +306,55 @@ void AacInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengthInS
 {
    numChannels = m_info.channels;
    bitrateInBps = m_info.bitrate;
-   lengthInSeconds = (m_inputFileLength << 3) / m_info.bitrate;
    samplerateInHz = m_info.sampling_rate;
+
+   if (m_demuxer.IsOpen())
+      lengthInSeconds = m_info.sampling_rate == 0 ? 0 : static_cast<int>(m_numTotalSamples / m_info.sampling_rate);
+   else
+      lengthInSeconds = m_info.bitrate == 0 ? 0 : (m_inputFileLength << 3) / m_info.bitrate;
+}
+
+bool AacInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   // only MP4 files store the exact length
+   Mp4Demuxer demuxer;
+   if (!demuxer.Open(filename) ||
+      demuxer.GetSampleRate() == 0)
+      return false;
+
+   info.m_numChannels = demuxer.GetNumChannels();
+   info.m_samplerateInHz = demuxer.GetSampleRate();
+   info.m_numSamples = demuxer.GetDuration() * demuxer.GetSampleRate() / demuxer.GetTimescale();
+   info.m_bitrateInBps = demuxer.GetAverageBitrate() != 0 ? demuxer.GetAverageBitrate() : -1;
+   info.m_lengthInSeconds = static_cast<int>(info.m_numSamples / info.m_samplerateInHz);
+
+   return true;
 }
 
 int AacInputModule::DecodeSamples(SampleContainer& samples)
 {
    // frame decoding info
    NeAACDecFrameInfo frameInfo;
+   short* sampleBuffer = nullptr;
 
    // temporary sample buffer
    short* outputBuffer;
    short tempBuffer[2048 * c_aacNumMaxChannels];
 
-   // fill input buffer
-   if (m_inputBufferHigh < c_aacInputBufferSize)
+   if (m_pendingSamples != nullptr)
    {
-      m_inputFile.read(reinterpret_cast<char*>(m_inputBuffer + m_inputBufferHigh), c_aacInputBufferSize - m_inputBufferHigh);
-      int read = static_cast<int>(m_inputFile.gcount());
-
-      if (read == 0 && m_inputBufferHigh == 0)
-         return 0;
-
-      m_inputBufferHigh += read;
-      m_currentFilePos += read;
+      frameInfo = m_pendingFrameInfo;
+      sampleBuffer = m_pendingSamples;
+      m_pendingSamples = nullptr;
    }
-
-   // decode buffer
-   short* sampleBuffer = (short *)NeAACDecDecode(m_decoder, &frameInfo, m_inputBuffer, m_inputBufferHigh);
-
-   m_inputBufferHigh -= frameInfo.bytesconsumed;
-   memmove(m_inputBuffer, m_inputBuffer + frameInfo.bytesconsumed,
-      c_aacInputBufferSize - frameInfo.bytesconsumed);
-
-   // check for return codes
-   if (frameInfo.error > 0)
+   else
    {
-      m_lastError = NeAACDecGetErrorMessage(frameInfo.error);
-      return -(int)frameInfo.error;
+      int ret = m_demuxer.IsOpen()
+         ? DecodeAccessUnit(frameInfo, sampleBuffer)
+         : DecodeRawStreamFrame(frameInfo, sampleBuffer);
+
+      if (ret <= 0)
+         return ret;
    }
 
    int numSamples = frameInfo.samples / frameInfo.channels;
@@ -299,8 +375,84 @@ int AacInputModule::DecodeSamples(SampleContainer& samples)
    return numSamples;
 }
 
+float AacInputModule::PercentDone() const
+{
+   if (m_demuxer.IsOpen())
+   {
+      size_t numAccessUnits = m_demuxer.GetNumAccessUnits();
+      return numAccessUnits == 0 ? 0.0f : float(m_demuxer.GetCurrentAccessUnit()) * 100.f / numAccessUnits;
+   }
+
+   return m_inputFileLength == 0 ? 0.0f : float(m_currentFilePos) * 100.f / m_inputFileLength;
+}
+
+int AacInputModule::DecodeAccessUnit(NeAACDecFrameInfo& frameInfo, short*& sampleBuffer)
+{
+   do
+   {
+      const unsigned char* accessUnit = nullptr;
+      size_t accessUnitSize = 0;
+
+      if (!m_demuxer.ReadAccessUnit(accessUnit, accessUnitSize))
+         return 0;
+
+      // the decoder doesn't modify the buffer, so the mapped file can be passed directly
+      sampleBuffer = (short *)NeAACDecDecode(m_decoder, &frameInfo,
+         const_cast<unsigned char*>(accessUnit), static_cast<unsigned long>(accessUnitSize));
+
+      if (frameInfo.error > 0)
+      {
+         m_lastError = NeAACDecGetErrorMessage(frameInfo.error);
+         return -(int)frameInfo.error;
+      }
+
+   } while (frameInfo.samples == 0);
+
+   return 1;
+}
+
+int AacInputModule::DecodeRawStreamFrame(NeAACDecFrameInfo& frameInfo, short*& sampleBuffer)
+{
+   // fill input buffer, when it doesn't contain a complete frame anymore; the remaining
+   // bytes are moved to the start
+   const int c_maxFrameBytes = 768 * c_aacNumMaxChannels;
+
+   if (m_inputBufferHigh - m_inputBufferPos < c_maxFrameBytes)
+   {
+      m_inputBufferHigh -= m_inputBufferPos;
+      memmove(m_inputBuffer, m_inputBuffer + m_inputBufferPos, m_inputBufferHigh);
+      m_inputBufferPos = 0;
+
+      m_inputFile.read(reinterpret_cast<char*>(m_inputBuffer + m_inputBufferHigh), c_aacInputBufferSize - m_inputBufferHigh);
+      int read = static_cast<int>(m_inputFile.gcount());
+
+      m_inputBufferHigh += read;
+      m_currentFilePos += read;
+   }
+
+   if (m_inputBufferHigh == m_inputBufferPos)
+      return 0;
+
+   // decode buffer
+   sampleBuffer = (short *)NeAACDecDecode(m_decoder, &frameInfo,
+      m_inputBuffer + m_inputBufferPos, m_inputBufferHigh - m_inputBufferPos);
+
+   m_inputBufferPos += frameInfo.bytesconsumed;
+
+   // check for return codes
+   if (frameInfo.error > 0)
+   {
+      m_lastError = NeAACDecGetErrorMessage(frameInfo.error);
+      return -(int)frameInfo.error;
+   }
+
+   return 1;
+}
+
 void AacInputModule::DoneInput()
 {
    NeAACDecClose(m_decoder);
    m_inputFile.close();
+   m_demuxer.Close();
+   m_pendingSamples = nullptr;
 }
@@ -25,6 +25,7 @@
 #include "ModuleInterface.hpp"
 #include <iosfwd>
 #include "neaacdec.h"
+#include "Mp4Demuxer.hpp"
 
 extern "C"
 {
@@ -79,18 +80,32 @@ namespace Encoder
       // returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the sample tables of MP4 files
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       // decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
       // returns the number of percent done
-      virtual float PercentDone() const override
-      {
-         return m_inputFileLength == 0 ? 0.0f : float(m_currentFilePos) * 100.f / m_inputFileLength;
-      }
+      virtual float PercentDone() const override;
 
       // called when done with decoding
       virtual void DoneInput() override;
 
+   private:
+      /// initializes decoder for the AAC track of an MP4 file opened by the demuxer
+      int InitMp4Decoder();
+
+      /// initializes decoder for a raw AAC stream, e.g. ADTS
+      int InitRawStreamDecoder(LPCTSTR infilename);
+
+      /// decodes next access unit of the MP4 file, skipping access units without samples;
+      /// returns 0 at the end of the track, or a negative value on errors
+      int DecodeAccessUnit(NeAACDecFrameInfo& frameInfo, short*& sampleBuffer);
+
+      /// decodes next frame of the raw AAC stream; returns 0 at the end of the stream
+      int DecodeRawStreamFrame(NeAACDecFrameInfo& frameInfo, short*& sampleBuffer);
+
    private:
       /// libfaad handle
       faacDecHandle m_decoder;
@@ -101,6 +116,9 @@ namespace Encoder
       /// high watermark for the m_inputBuffer
       int m_inputBufferHigh;
 
+      /// position of the next frame in m_inputBuffer
+      int m_inputBufferPos;
+
       /// length of input file
       unsigned long m_inputFileLength;
 
@@ -113,6 +131,18 @@ namespace Encoder
       /// input file stream
       std::ifstream m_inputFile;
 
+      /// MP4 demuxer; only opened for MP4 files
+      Mp4Demuxer m_demuxer;
+
+      /// exact number of samples per channel, for MP4 files
+      unsigned long long m_numTotalSamples;
+
+      /// frame info of the first decoded access unit, which wasn't returned yet
+      NeAACDecFrameInfo m_pendingFrameInfo;
+
+      /// samples of the first decoded access unit; nullptr when there are no pending samples
+      short* m_pendingSamples;
+
       /// last error occured
       CString m_lastError;
    };
@@ -223,7 +223,7 @@ int AacOutputModule::EncodeSamples(SampleContainer& samples)
    return numInputSamples;
 }
 
-void AacOutputModule::DoneOutput()
+int AacOutputModule::DoneOutput()
 {
    int ret = 0;
 
@@ -255,4 +255,6 @@ void AacOutputModule::DoneOutput()
    m_outputFile.close();
 
    faacEncClose(m_handle);
+
+   return 0;
 }
@@ -61,7 +61,7 @@ namespace Encoder
       virtual int EncodeSamples(SampleContainer& samples) override;
 
       /// cleans up the output module
-      virtual void DoneOutput() override;
+      virtual int DoneOutput() override;
 
    private:
       /// encoder handle
@@ -0,0 +1,702 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file AudioFileInfoCache.cpp
+/// \brief Audio file info cache class
+//
+#include "stdafx.h"
+#include "AudioFileInfoCache.hpp"
+#include "LibraryMirrorManifest.hpp"
+#include <ulib/Path.hpp>
+#include <algorithm>
+
+using Encoder::AudioFileInfoCache;
+using Encoder::TrackInfo;
+
+// The cache file consists of a header, an index and the records. All values are stored in
+// little-endian byte order, without padding.
+//
+// header: 4 bytes magic "WLIC", uint32 format version, uint64 number of entries
+// index: per entry: uint64 hash of the key, uint64 offset of the record; sorted by hash
+// record: uint32 record length, uint16 key length, key characters, uint64 file size,
+//   uint64 last write time, uint8 flags, audio file infos (int32 channels, int32 sample rate,
+//   uint64 number of samples, int32 bitrate, int32 length), then the track infos, each as
+//   uint8 count, followed by the entries: text infos (uint8 type, uint32 length, characters),
+//   number infos (uint8 type, int32 value) and binary infos (uint8 type, uint32 length, data)
+
+/// magic bytes at the start of the cache file
+const BYTE c_cacheFileMagic[4] = { 'W', 'L', 'I', 'C' };
+
+/// cache file format version
+const unsigned int c_cacheFileVersion = 1;
+
+/// size of the cache file header
+const size_t c_headerSize = 16;
+
+/// size of a single index entry
+const size_t c_indexEntrySize = 16;
+
+/// record flag: audio file infos are stored
+const BYTE c_flagAudioFileInfo = 0x01;
+
+/// record flag: track infos are stored
+const BYTE c_flagTrackInfo = 0x02;
+
+/// FNV-1a 64-bit offset basis
+const ULONGLONG c_fnvOffsetBasis = 14695981039346656037ULL;
+
+/// FNV-1a 64-bit prime
+const ULONGLONG c_fnvPrime = 1099511628211ULL;
+
+/// appends value to the record
+template <typename T>
+static void AppendValue(std::vector<BYTE>& record, T value)
+{
+   const BYTE* data = reinterpret_cast<const BYTE*>(&value);
+   record.insert(record.end(), data, data + sizeof(T));
+}
+
+/// appends string to the record, preceded by its length
+template <typename TLength>
+static void AppendString(std::vector<BYTE>& record, const CString& text)
+{
+   AppendValue<TLength>(record, static_cast<TLength>(text.GetLength()));
+
+   const BYTE* data = reinterpret_cast<const BYTE*>(text.GetString());
+   record.insert(record.end(), data, data + text.GetLength() * sizeof(TCHAR));
+}
+
+/// reads value from record and advances the position; returns false at the end of the record
+template <typename T>
+static bool ReadValue(const BYTE*& pos, const BYTE* end, T& value)
+{
+   if (end - pos < static_cast<ptrdiff_t>(sizeof(T)))
+      return false;
+
+   memcpy(&value, pos, sizeof(T));
+   pos += sizeof(T);
+
+   return true;
+}
+
+/// reads string from record and advances the position; returns false at the end of the record
+template <typename TLength>
+static bool ReadString(const BYTE*& pos, const BYTE* end, CString& text)
+{
+   TLength length = 0;
+   if (!ReadValue(pos, end, length) ||
+      static_cast<size_t>(end - pos) < length * sizeof(TCHAR))
+      return false;
+
+   text = CString(reinterpret_cast<LPCTSTR>(pos), static_cast<int>(length));
+   pos += length * sizeof(TCHAR);
+
+   return true;
+}
+
+AudioFileInfoCache::AudioFileInfoCache(const CString& cacheFilename)
+   :m_cacheFilename(cacheFilename),
+   m_fileHandle(INVALID_HANDLE_VALUE),
+   m_mappingHandle(nullptr),
+   m_mappedData(nullptr),
+   m_mappedSize(0),
+   m_numMappedEntries(0)
+{
+}
+
+AudioFileInfoCache::~AudioFileInfoCache()
+{
+   Unmap();
+}
+
+bool AudioFileInfoCache::Load()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Unmap();
+
+   return MapFile();
+}
+
+bool AudioFileInfoCache::Save()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   if (m_mapNewEntries.empty() && m_setEvictedKeys.empty())
+      return true;
+
+   // record to write; either points into the mapped file or to a newly encoded record
+   struct RecordRef
+   {
+      ULONGLONG m_hash;
+      const BYTE* m_data;
+      size_t m_length;
+   };
+
+   std::vector<RecordRef> recordsList;
+   std::vector<std::vector<BYTE>> newRecordsList;
+   newRecordsList.reserve(m_mapNewEntries.size());
+
+   for (const auto& iter : m_mapNewEntries)
+   {
+      newRecordsList.push_back(std::vector<BYTE>());
+      EncodeRecord(iter.first, iter.second, newRecordsList.back());
+
+      RecordRef ref = { HashFromKey(iter.first), newRecordsList.back().data(), newRecordsList.back().size() };
+      recordsList.push_back(ref);
+   }
+
+   // copy all loaded records that weren't replaced by new entries or evicted
+   for (size_t index = 0; index < m_numMappedEntries; index++)
+   {
+      ULONGLONG hash = 0;
+      CString key;
+      const BYTE* record = nullptr;
+      size_t recordLength = 0;
+
+      if (!ReadMappedIndexEntry(index, hash, key, record, recordLength))
+         continue;
+
+      if (m_mapNewEntries.find(key) != m_mapNewEntries.end() ||
+         m_setEvictedKeys.find(key) != m_setEvictedKeys.end())
+         continue;
+
+      RecordRef ref = { hash, record, recordLength };
+      recordsList.push_back(ref);
+   }
+
+   std::sort(recordsList.begin(), recordsList.end(),
+      [](const RecordRef& lhs, const RecordRef& rhs) { return lhs.m_hash < rhs.m_hash; });
+
+   // write to a temporary file first, so that an interrupted write keeps the old cache file
+   CString tempFilename = m_cacheFilename + _T(".temp");
+
+   FILE* fd = _tfopen(tempFilename, _T("wb"));
+   if (fd == nullptr)
+      return false;
+
+   fwrite(c_cacheFileMagic, 1, sizeof(c_cacheFileMagic), fd);
+
+   unsigned int version = c_cacheFileVersion;
+   ULONGLONG numEntries = recordsList.size();
+   fwrite(&version, sizeof(version), 1, fd);
+   fwrite(&numEntries, sizeof(numEntries), 1, fd);
+
+   ULONGLONG offset = c_headerSize + recordsList.size() * c_indexEntrySize;
+   for (const RecordRef& ref : recordsList)
+   {
+      fwrite(&ref.m_hash, sizeof(ref.m_hash), 1, fd);
+      fwrite(&offset, sizeof(offset), 1, fd);
+
+      offset += ref.m_length;
+   }
+
+   for (const RecordRef& ref : recordsList)
+      fwrite(ref.m_data, 1, ref.m_length, fd);
+
+   bool writeError = ferror(fd) != 0;
+   fclose(fd);
+
+   if (writeError)
+   {
+      DeleteFile(tempFilename);
+      return false;
+   }
+
+   // the mapped file can only be replaced when it's not mapped anymore
+   Unmap();
+
+   if (!MoveFileEx(tempFilename, m_cacheFilename, MOVEFILE_REPLACE_EXISTING))
+   {
+      DeleteFile(tempFilename);
+      MapFile();
+      return false;
+   }
+
+   m_mapNewEntries.clear();
+   m_setEvictedKeys.clear();
+
+   return MapFile();
+}
+
+size_t AudioFileInfoCache::NumUnsavedEntries() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   return m_mapNewEntries.size();
+}
+
+size_t AudioFileInfoCache::NumEvictedEntries() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   return m_setEvictedKeys.size();
+}
+
+bool AudioFileInfoCache::LookupAudioFileInfo(const CString& filename, ProbeInfo& info)
+{
+   ULONGLONG fileSize = 0, lastWriteTime = 0;
+   if (!LibraryMirrorManifest::GetFileInfo(filename, fileSize, lastWriteTime))
+   {
+      EvictMissingFile(filename);
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Entry entry;
+   if (!FindEntry(KeyFromFilename(filename), fileSize, lastWriteTime, false, entry) ||
+      !entry.m_hasAudioFileInfo)
+      return false;
+
+   info = entry.m_audioFileInfo;
+
+   return true;
+}
+
+bool AudioFileInfoCache::LookupTrackInfo(const CString& filename, TrackInfo& trackInfo)
+{
+   ULONGLONG fileSize = 0, lastWriteTime = 0;
+   if (!LibraryMirrorManifest::GetFileInfo(filename, fileSize, lastWriteTime))
+   {
+      EvictMissingFile(filename);
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Entry entry;
+   if (!FindEntry(KeyFromFilename(filename), fileSize, lastWriteTime, true, entry) ||
+      !entry.m_hasTrackInfo)
+      return false;
+
+   trackInfo = entry.m_trackInfo;
+
+   return true;
+}
+
+void AudioFileInfoCache::StoreAudioFileInfo(const CString& filename, const ProbeInfo& info)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Entry* entry = EntryForStoring(filename);
+   if (entry == nullptr)
+      return;
+
+   entry->m_hasAudioFileInfo = true;
+   entry->m_audioFileInfo = info;
+}
+
+void AudioFileInfoCache::StoreTrackInfo(const CString& filename, const TrackInfo& trackInfo)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   Entry* entry = EntryForStoring(filename);
+   if (entry == nullptr)
+      return;
+
+   entry->m_hasTrackInfo = true;
+   entry->m_trackInfo = trackInfo;
+}
+
+bool AudioFileInfoCache::FindEntry(const CString& key, ULONGLONG fileSize, ULONGLONG lastWriteTime,
+   bool decodeTrackInfo, Entry& entry) const
+{
+   // new entries replace the entries of the cache file
+   auto iter = m_mapNewEntries.find(key);
+   if (iter != m_mapNewEntries.end())
+   {
+      entry = iter->second;
+   }
+   else
+   {
+      // evicted entries are only removed from the cache file with the next Save()
+      if (m_setEvictedKeys.find(key) != m_setEvictedKeys.end())
+         return false;
+
+      const BYTE* record = FindMappedRecord(key);
+      if (record == nullptr)
+         return false;
+
+      CString recordKey;
+      if (!DecodeRecord(record, m_mappedSize - (record - m_mappedData), decodeTrackInfo, recordKey, entry))
+         return false;
+   }
+
+   return entry.m_fileSize == fileSize &&
+      entry.m_lastWriteTime == lastWriteTime;
+}
+
+const BYTE* AudioFileInfoCache::FindMappedRecord(const CString& key) const
+{
+   if (m_mappedData == nullptr)
+      return nullptr;
+
+   ULONGLONG hash = HashFromKey(key);
+
+   // binary search for the first index entry with the hash
+   size_t first = 0, count = m_numMappedEntries;
+   while (count > 0)
+   {
+      size_t step = count / 2;
+
+      ULONGLONG indexHash = 0;
+      memcpy(&indexHash, m_mappedData + c_headerSize + (first + step) * c_indexEntrySize, sizeof(indexHash));
+
+      if (indexHash < hash)
+      {
+         first += step + 1;
+         count -= step + 1;
+      }
+      else
+         count = step;
+   }
+
+   // check all records with the same hash
+   for (size_t index = first; index < m_numMappedEntries; index++)
+   {
+      const BYTE* indexEntry = m_mappedData + c_headerSize + index * c_indexEntrySize;
+
+      ULONGLONG indexHash = 0, offset = 0;
+      memcpy(&indexHash, indexEntry, sizeof(indexHash));
+      memcpy(&offset, indexEntry + sizeof(indexHash), sizeof(offset));
+
+      if (indexHash != hash)
+         break;
+
+      if (offset >= m_mappedSize)
+         continue;
+
+      const BYTE* pos = m_mappedData + offset;
+      const BYTE* end = m_mappedData + m_mappedSize;
+
+      unsigned int recordLength = 0;
+      CString recordKey;
+      if (ReadValue(pos, end, recordLength) &&
+         ReadString<unsigned short>(pos, end, recordKey) &&
+         recordKey == key)
+         return m_mappedData + offset;
+   }
+
+   return nullptr;
+}
+
+bool AudioFileInfoCache::ReadMappedIndexEntry(size_t index, ULONGLONG& hash, CString& key,
+   const BYTE*& record, size_t& recordLength) const
+{
+   const BYTE* indexEntry = m_mappedData + c_headerSize + index * c_indexEntrySize;
+
+   ULONGLONG offset = 0;
+   memcpy(&hash, indexEntry, sizeof(hash));
+   memcpy(&offset, indexEntry + sizeof(hash), sizeof(offset));
+
+   if (offset >= m_mappedSize)
+      return false;
+
+   const BYTE* pos = m_mappedData + offset;
+   const BYTE* end = m_mappedData + m_mappedSize;
+
+   unsigned int length = 0;
+   if (!ReadValue(pos, end, length) ||
+      !ReadString<unsigned short>(pos, end, key) ||
+      length > m_mappedSize - offset)
+      return false;
+
+   record = m_mappedData + offset;
+   recordLength = length;
+
+   return true;
+}
+
+void AudioFileInfoCache::EvictMissingFile(const CString& filename)
+{
+   // only the files that are looked up are checked, since checking all entries would take
+   // long on network drives
+   if (Path::FileExists(filename) ||
+      !Path::FolderExists(Path::FolderName(filename)))
+      return;
+
+   CString key = KeyFromFilename(filename);
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+
+   m_mapNewEntries.erase(key);
+
+   if (FindMappedRecord(key) != nullptr)
+      m_setEvictedKeys.insert(key);
+}
+
+AudioFileInfoCache::Entry* AudioFileInfoCache::EntryForStoring(const CString& filename)
+{
+   ULONGLONG fileSize = 0, lastWriteTime = 0;
+   if (!LibraryMirrorManifest::GetFileInfo(filename, fileSize, lastWriteTime))
+      return nullptr;
+
+   CString key = KeyFromFilename(filename);
+
+   // keep the other infos when the file didn't change
+   Entry entry;
+   if (!FindEntry(key, fileSize, lastWriteTime, true, entry))
+   {
+      entry = Entry();
+      entry.m_fileSize = fileSize;
+      entry.m_lastWriteTime = lastWriteTime;
+   }
+
+   Entry& newEntry = m_mapNewEntries[key];
+   newEntry = entry;
+
+   return &newEntry;
+}
+
+bool AudioFileInfoCache::MapFile()
+{
+   m_fileHandle = CreateFile(m_cacheFilename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+   if (m_fileHandle == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER fileSize = {};
+   if (!GetFileSizeEx(m_fileHandle, &fileSize) ||
+      fileSize.QuadPart < static_cast<LONGLONG>(c_headerSize) ||
+      static_cast<ULONGLONG>(fileSize.QuadPart) > SIZE_MAX)
+   {
+      Unmap();
+      return false;
+   }
+
+   m_mappingHandle = CreateFileMapping(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (m_mappingHandle != nullptr)
+      m_mappedData = reinterpret_cast<const BYTE*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+   if (m_mappedData == nullptr)
+   {
+      Unmap();
+      return false;
+   }
+
+   m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+   unsigned int version = 0;
+   ULONGLONG numEntries = 0;
+   memcpy(&version, m_mappedData + 4, sizeof(version));
+   memcpy(&numEntries, m_mappedData + 8, sizeof(numEntries));
+
+   if (memcmp(m_mappedData, c_cacheFileMagic, sizeof(c_cacheFileMagic)) != 0 ||
+      version != c_cacheFileVersion ||
+      numEntries > (m_mappedSize - c_headerSize) / c_indexEntrySize)
+   {
+      // unknown format; start with an empty cache
+      Unmap();
+      return false;
+   }
+
+   m_numMappedEntries = static_cast<size_t>(numEntries);
+
+   return true;
+}
+
+void AudioFileInfoCache::Unmap()
+{
+   if (m_mappedData != nullptr)
+      UnmapViewOfFile(m_mappedData);
+
+   if (m_mappingHandle != nullptr)
+      CloseHandle(m_mappingHandle);
+
+   if (m_fileHandle != INVALID_HANDLE_VALUE)
+      CloseHandle(m_fileHandle);
+
+   m_mappedData = nullptr;
+   m_mappingHandle = nullptr;
+   m_fileHandle = INVALID_HANDLE_VALUE;
+   m_mappedSize = 0;
+   m_numMappedEntries = 0;
+}
+
+CString AudioFileInfoCache::KeyFromFilename(const CString& filename)
+{
+   CString key = filename;
+   key.MakeLower();
+   return key;
+}
+
+ULONGLONG AudioFileInfoCache::HashFromKey(const CString& key)
+{
+   ULONGLONG hash = c_fnvOffsetBasis;
+
+   const BYTE* data = reinterpret_cast<const BYTE*>(key.GetString());
+   for (size_t index = 0, length = key.GetLength() * sizeof(TCHAR); index < length; index++)
+   {
+      hash ^= data[index];
+      hash *= c_fnvPrime;
+   }
+
+   return hash;
+}
+
+void AudioFileInfoCache::EncodeRecord(const CString& key, const Entry& entry, std::vector<BYTE>& record)
+{
+   record.clear();
+
+   AppendValue<unsigned int>(record, 0); // record length; set below
+   AppendString<unsigned short>(record, key);
+   AppendValue<ULONGLONG>(record, entry.m_fileSize);
+   AppendValue<ULONGLONG>(record, entry.m_lastWriteTime);
+
+   BYTE flags =
+      (entry.m_hasAudioFileInfo ? c_flagAudioFileInfo : 0) |
+      (entry.m_hasTrackInfo ? c_flagTrackInfo : 0);
+   AppendValue<BYTE>(record, flags);
+
+   AppendValue<int>(record, entry.m_audioFileInfo.m_numChannels);
+   AppendValue<int>(record, entry.m_audioFileInfo.m_samplerateInHz);
+   AppendValue<ULONGLONG>(record, entry.m_audioFileInfo.m_numSamples);
+   AppendValue<int>(record, entry.m_audioFileInfo.m_bitrateInBps);
+   AppendValue<int>(record, entry.m_audioFileInfo.m_lengthInSeconds);
+
+   // text infos
+   size_t countPos = record.size();
+   AppendValue<BYTE>(record, 0);
+
+   for (int type = TrackInfoTitle; type <= TrackInfoComposer; type++)
+   {
+      bool avail = false;
+      CString text = entry.m_trackInfo.GetTextInfo(static_cast<TrackInfoTextType>(type), avail);
+      if (avail)
+      {
+         AppendValue<BYTE>(record, static_cast<BYTE>(type));
+         AppendString<unsigned int>(record, text);
+         record[countPos]++;
+      }
+   }
+
+   // number infos
+   countPos = record.size();
+   AppendValue<BYTE>(record, 0);
+
+   for (int type = TrackInfoYear; type <= TrackInfoDiscNumber; type++)
+   {
+      bool avail = false;
+      int value = entry.m_trackInfo.GetNumberInfo(static_cast<TrackInfoNumberType>(type), avail);
+      if (avail)
+      {
+         AppendValue<BYTE>(record, static_cast<BYTE>(type));
+         AppendValue<int>(record, value);
+         record[countPos]++;
+      }
+   }
+
+   // binary infos
+   countPos = record.size();
+   AppendValue<BYTE>(record, 0);
+
+   std::vector<unsigned char> binaryInfo;
+   if (entry.m_trackInfo.GetBinaryInfo(TrackInfoFrontCover, binaryInfo))
+   {
+      AppendValue<BYTE>(record, static_cast<BYTE>(TrackInfoFrontCover));
+      AppendValue<unsigned int>(record, static_cast<unsigned int>(binaryInfo.size()));
+      record.insert(record.end(), binaryInfo.begin(), binaryInfo.end());
+      record[countPos]++;
+   }
+
+   unsigned int recordLength = static_cast<unsigned int>(record.size());
+   memcpy(record.data(), &recordLength, sizeof(recordLength));
+}
+
+bool AudioFileInfoCache::DecodeRecord(const BYTE* record, size_t maxLength, bool decodeTrackInfo,
+   CString& key, Entry& entry)
+{
+   const BYTE* pos = record;
+   const BYTE* end = record + maxLength;
+
+   unsigned int recordLength = 0;
+   if (!ReadValue(pos, end, recordLength) ||
+      recordLength > maxLength)
+      return false;
+
+   end = record + recordLength;
+
+   BYTE flags = 0;
+   if (!ReadString<unsigned short>(pos, end, key) ||
+      !ReadValue(pos, end, entry.m_fileSize) ||
+      !ReadValue(pos, end, entry.m_lastWriteTime) ||
+      !ReadValue(pos, end, flags) ||
+      !ReadValue(pos, end, entry.m_audioFileInfo.m_numChannels) ||
+      !ReadValue(pos, end, entry.m_audioFileInfo.m_samplerateInHz) ||
+      !ReadValue(pos, end, entry.m_audioFileInfo.m_numSamples) ||
+      !ReadValue(pos, end, entry.m_audioFileInfo.m_bitrateInBps) ||
+      !ReadValue(pos, end, entry.m_audioFileInfo.m_lengthInSeconds))
+      return false;
+
+   entry.m_hasAudioFileInfo = (flags & c_flagAudioFileInfo) != 0;
+   entry.m_hasTrackInfo = (flags & c_flagTrackInfo) != 0;
+
+   if (!decodeTrackInfo)
+      return true;
+
+   BYTE count = 0;
+   if (!ReadValue(pos, end, count))
+      return false;
+
+   for (BYTE index = 0; index < count; index++)
+   {
+      BYTE type = 0;
+      CString text;
+      if (!ReadValue(pos, end, type) ||
+         !ReadString<unsigned int>(pos, end, text))
+         return false;
+
+      entry.m_trackInfo.SetTextInfo(static_cast<TrackInfoTextType>(type), text);
+   }
+
+   if (!ReadValue(pos, end, count))
+      return false;
+
+   for (BYTE index = 0; index < count; index++)
+   {
+      BYTE type = 0;
+      int value = 0;
+      if (!ReadValue(pos, end, type) ||
+         !ReadValue(pos, end, value))
+         return false;
+
+      entry.m_trackInfo.SetNumberInfo(static_cast<TrackInfoNumberType>(type), value);
+   }
+
+   if (!ReadValue(pos, end, count))
+      return false;
+
+   for (BYTE index = 0; index < count; index++)
+   {
+      BYTE type = 0;
+      unsigned int length = 0;
+      if (!ReadValue(pos, end, type) ||
+         !ReadValue(pos, end, length) ||
+         static_cast<size_t>(end - pos) < length)
+         return false;
+
+      entry.m_trackInfo.SetBinaryInfo(static_cast<TrackInfoBinaryType>(type),
+         std::vector<unsigned char>(pos, pos + length));
+
+      pos += length;
+   }
+
+   return true;
+}
@@ -0,0 +1,173 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file AudioFileInfoCache.hpp
+/// \brief Audio file info cache class
+//
+#pragma once
+
+#include <map>
+#include <set>
+#include <mutex>
+#include "InputModule.hpp"
+#include "TrackInfo.hpp"
+
+namespace Encoder
+{
+   /// \brief persistent cache of audio file infos and track infos
+   /// \details Stores the probed audio file infos and the track infos (tags) of input files,
+   /// keyed by filename, file size and last write time, so that adding the same files again
+   /// doesn't need to open them. The cache file is stored in a compact binary format, with a
+   /// sorted hash index in front of the entries, and is memory-mapped when loaded, so that
+   /// lookups only touch the pages of the entries found. New entries are kept in memory until
+   /// Save() is called. Entries of files that don't exist anymore are removed when they are
+   /// looked up. The class is thread-safe.
+   class AudioFileInfoCache
+   {
+   public:
+      /// ctor; takes filename of cache file
+      explicit AudioFileInfoCache(const CString& cacheFilename);
+
+      /// dtor
+      ~AudioFileInfoCache();
+
+      /// maps cache file into memory; returns false when there's no valid cache file
+      bool Load();
+
+      /// writes cache file, containing both the loaded and the new entries
+      bool Save();
+
+      /// returns number of new entries that weren't saved yet
+      size_t NumUnsavedEntries() const;
+
+      /// returns number of entries of the cache file that are removed with the next Save()
+      size_t NumEvictedEntries() const;
+
+      /// looks up cached audio file infos; returns false when not cached or the file changed
+      bool LookupAudioFileInfo(const CString& filename, ProbeInfo& info);
+
+      /// looks up cached track infos; returns false when not cached or the file changed
+      bool LookupTrackInfo(const CString& filename, TrackInfo& trackInfo);
+
+      /// stores audio file infos of the given file
+      void StoreAudioFileInfo(const CString& filename, const ProbeInfo& info);
+
+      /// stores track infos of the given file
+      void StoreTrackInfo(const CString& filename, const TrackInfo& trackInfo);
+
+   private:
+      /// cache entry
+      struct Entry
+      {
+         /// ctor
+         Entry()
+            :m_fileSize(0),
+            m_lastWriteTime(0),
+            m_hasAudioFileInfo(false),
+            m_hasTrackInfo(false)
+         {
+         }
+
+         /// file size, in bytes
+         ULONGLONG m_fileSize;
+
+         /// last write time, as FILETIME value
+         ULONGLONG m_lastWriteTime;
+
+         /// indicates if audio file infos are stored
+         bool m_hasAudioFileInfo;
+
+         /// audio file infos
+         ProbeInfo m_audioFileInfo;
+
+         /// indicates if track infos are stored
+         bool m_hasTrackInfo;
+
+         /// track infos
+         TrackInfo m_trackInfo;
+      };
+
+      /// finds entry of given file that is still valid; must be called with the mutex locked
+      bool FindEntry(const CString& key, ULONGLONG fileSize, ULONGLONG lastWriteTime,
+         bool decodeTrackInfo, Entry& entry) const;
+
+      /// finds record of given key in the mapped cache file; returns nullptr when not found
+      const BYTE* FindMappedRecord(const CString& key) const;
+
+      /// reads index entry and key of the record with given index in the mapped cache file
+      bool ReadMappedIndexEntry(size_t index, ULONGLONG& hash, CString& key,
+         const BYTE*& record, size_t& recordLength) const;
+
+      /// \brief removes entry of given file when the file doesn't exist anymore; the cache
+      /// file is updated with the next Save() call
+      /// \details entries of files in folders that don't exist are kept, e.g. when a network
+      /// drive or removable drive is unavailable
+      void EvictMissingFile(const CString& filename);
+
+      /// returns entry to store infos for the given file; must be called with the mutex locked
+      Entry* EntryForStoring(const CString& filename);
+
+      /// maps cache file; must be called with the mutex locked
+      bool MapFile();
+
+      /// unmaps cache file; must be called with the mutex locked
+      void Unmap();
+
+      /// returns map key for given filename
+      static CString KeyFromFilename(const CString& filename);
+
+      /// calculates hash of map key
+      static ULONGLONG HashFromKey(const CString& key);
+
+      /// encodes entry as record
+      static void EncodeRecord(const CString& key, const Entry& entry, std::vector<BYTE>& record);
+
+      /// \brief decodes record; returns false when the record is invalid
+      /// \details track infos are only decoded when requested, since they may contain cover art
+      static bool DecodeRecord(const BYTE* record, size_t maxLength, bool decodeTrackInfo, CString& key, Entry& entry);
+
+   private:
+      /// filename of cache file
+      CString m_cacheFilename;
+
+      /// mutex to protect all members
+      mutable std::mutex m_mutex;
+
+      /// handle of the mapped cache file
+      HANDLE m_fileHandle;
+
+      /// handle of the file mapping
+      HANDLE m_mappingHandle;
+
+      /// start of the mapped cache file; nullptr when not mapped
+      const BYTE* m_mappedData;
+
+      /// size of the mapped cache file
+      size_t m_mappedSize;
+
+      /// number of entries in the mapped cache file
+      size_t m_numMappedEntries;
+
+      /// new entries, keyed by lowercase filename
+      std::map<CString, Entry> m_mapNewEntries;
+
+      /// keys of entries in the mapped cache file that are removed with the next Save()
+      std::set<CString> m_setEvictedKeys;
+   };
+
+} // namespace Encoder
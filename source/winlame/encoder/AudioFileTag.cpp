@@ -23,6 +23,7 @@
 #include "stdafx.h"
 #include "AudioFileTag.hpp"
 #include "TrackInfo.hpp"
+#include "AudioFileInfoCache.hpp"
 #pragma warning(push)
 #pragma warning(disable: 4251) // class 'T' needs to have dll-interface to be used by clients of class 'C'
 #include <taglib/fileref.h>
@@ -44,9 +45,14 @@
 
 using Encoder::AudioFileTag;
 using Encoder::TrackInfo;
+using Encoder::AudioFileInfoCache;
 
 bool AudioFileTag::ReadFromFile(const CString& filename, AudioFileType audioFileType)
 {
+   if (m_spTrackInfoCache != nullptr &&
+      m_spTrackInfoCache->LookupTrackInfo(filename, m_trackInfo))
+      return true;
+
    std::shared_ptr<TagLib::File> spFile = OpenFile(filename, audioFileType);
 
    if (spFile == nullptr)
@@ -70,6 +76,9 @@ bool AudioFileTag::ReadFromFile(const CString& filename, AudioFileType audioFile
    if (flacFile != nullptr)
       ReadTrackInfoFromFlacFile(&*flacFile);
 
+   if (m_spTrackInfoCache != nullptr)
+      m_spTrackInfoCache->StoreTrackInfo(filename, m_trackInfo);
+
    return true;
 }
 
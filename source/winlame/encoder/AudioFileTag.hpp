@@ -47,6 +47,7 @@ namespace TagLib
 namespace Encoder
 {
    class TrackInfo;
+   class AudioFileInfoCache;
 
    /// audio file tag reading/writing
    /// \see https://help.mp3tag.de/main_tags.html
@@ -60,9 +61,13 @@ namespace Encoder
          MPEG = 1,            ///< treat audio file as MPEG Layer 1/2/3 file
       };
 
-      /// creates tag instance using track info
-      explicit AudioFileTag(TrackInfo& trackInfo)
-         :m_trackInfo(trackInfo)
+      /// \brief creates tag instance using track info
+      /// \details the cache is used by ReadFromFile() to look up track infos before reading
+      /// the tag, and to store the track infos read; may be nullptr
+      explicit AudioFileTag(TrackInfo& trackInfo,
+         std::shared_ptr<AudioFileInfoCache> spTrackInfoCache = nullptr)
+         :m_trackInfo(trackInfo),
+         m_spTrackInfoCache(spTrackInfoCache)
       {
       }
 
@@ -112,6 +117,9 @@ namespace Encoder
    private:
       /// track info to read or store
       TrackInfo& m_trackInfo;
+
+      /// cache for track infos read from files; may be nullptr
+      std::shared_ptr<AudioFileInfoCache> m_spTrackInfoCache;
    };
 
 } // namespace Encoder
@@ -199,7 +199,7 @@ int BassWmaOutputModule::EncodeSamples(SampleContainer& samples)
    return ret;
 }
 
-void BassWmaOutputModule::DoneOutput()
+int BassWmaOutputModule::DoneOutput()
 {
    BASS_WMA_EncodeClose(m_handle);
 
@@ -207,6 +207,8 @@ void BassWmaOutputModule::DoneOutput()
    {
       BASS_Free();
    }
+
+   return 0;
 }
 
 void BassWmaOutputModule::AddTrackInfo(const TrackInfo& trackInfo)
@@ -217,7 +217,8 @@ bool CDExtractTask::ExtractTrack(const CString& tempFilename)
       BASS_Free();
    }
 
-   outputModule.DoneOutput();
+   if (outputModule.DoneOutput() < 0)
+      isFinished = false;
 
    return isFinished;
 }
@@ -249,6 +250,6 @@ void CDExtractTask::SetTrackInfoFromCDTrackInfo(TrackInfo& encodeTrackInfo, cons
    // cover art
    if (!cdReadJob.FrontCoverArtImage().empty())
    {
-      encodeTrackInfo.SetBinaryInfo(TrackInfoFrontCover, cdReadJob.FrontCoverArtImage());
+      encodeTrackInfo.SetBinaryInfo(TrackInfoFrontCover, cdReadJob.SharedFrontCoverArtImage());
    }
 }
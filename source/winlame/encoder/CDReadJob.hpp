@@ -23,6 +23,7 @@
 
 #include "CDRipDiscInfo.hpp"
 #include "CDRipTrackInfo.hpp"
+#include "TrackInfo.hpp"
 
 namespace Encoder
 {
@@ -57,7 +58,14 @@ namespace Encoder
       /// return front cover art image
       const std::vector<unsigned char>& FrontCoverArtImage() const
       {
-         return m_covertArtImageData;
+         static const std::vector<unsigned char> s_emptyImageData;
+         return m_spCovertArtImageData != nullptr ? *m_spCovertArtImageData : s_emptyImageData;
+      }
+
+      /// return front cover art image, shared between all jobs of a disc
+      const SharedBinaryInfo& SharedFrontCoverArtImage() const
+      {
+         return m_spCovertArtImageData;
       }
 
       // setter
@@ -71,7 +79,13 @@ namespace Encoder
       /// sets front cover art image
       void FrontCoverArtImage(const std::vector<unsigned char>& covertArtImageData)
       {
-         m_covertArtImageData = covertArtImageData;
+         m_spCovertArtImageData = std::make_shared<const std::vector<unsigned char>>(covertArtImageData);
+      }
+
+      /// sets front cover art image, sharing the data with other jobs
+      void FrontCoverArtImage(const SharedBinaryInfo& spCovertArtImageData)
+      {
+         m_spCovertArtImageData = spCovertArtImageData;
       }
 
    private:
@@ -80,8 +94,8 @@ namespace Encoder
       CDRipTrackInfo m_trackInfo;   ///< track info
       CString m_title;              ///< track title
 
-      /// front cover art image; empty when not set
-      std::vector<unsigned char> m_covertArtImageData;
+      /// front cover art image; nullptr when not set
+      SharedBinaryInfo m_spCovertArtImageData;
    };
 
 } // namespace Encoder
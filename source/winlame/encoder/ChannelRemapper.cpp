@@ -24,105 +24,220 @@
 #include "ChannelRemapper.hpp"
 
 using Encoder::ChannelRemapper;
+using Encoder::ChannelRemapPlan;
 
-const int MAX_CHANNELS = 6; ///< make this higher to support files with more channels
+/// max. number of channels with channel map
+const size_t c_maxMappedChannels = ChannelRemapPlan::c_maxMappedChannels;
 
-/// channel remapping map
-const int g_channelMap[4][MAX_CHANNELS][MAX_CHANNELS] =
+/// channel remapping map; each output channel is taken from the given input channel
+const unsigned char g_channelMap[4][c_maxMappedChannels][c_maxMappedChannels] =
 {
    // aacInputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 1, 2, 0, },         // c, l, r -> l, r, c
-      { 1, 2, 0, 3, },      // c, l, r, bc -> l, r, c, bc
-      { 1, 2, 0, 3, 4, },   // c, l, r, bl, br -> l, r, c, bl, br
-      { 1, 2, 0, 5, 3, 4 }  // c, l, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 1, 2, 0, },               // c, l, r -> l, r, c
+      { 1, 2, 0, 3, },            // c, l, r, bc -> l, r, c, bc
+      { 1, 2, 0, 3, 4, },         // c, l, r, bl, br -> l, r, c, bl, br
+      { 1, 2, 0, 5, 3, 4 },       // c, l, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, 1, 2, 3, 4, 5, 6 },    // 6.1 and 7.1 are passed unchanged
+      { 0, 1, 2, 3, 4, 5, 6, 7 },
    },
    // aacOutputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 2, 0, 1, },         // l, r, c -> c, l, r
-      { 2, 0, 1, 3, },      // l, r, c, bc -> c, l, r, bc
-      { 2, 0, 1, 3, 4, },   // l, r, c, bl, br -> c, l, r, bl, br
-      { 2, 0, 1, 4, 5, 3 }  // l, r, c, lfe, bl, br -> c, l, r, bl, br, lfe
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 2, 0, 1, },               // l, r, c -> c, l, r
+      { 2, 0, 1, 3, },            // l, r, c, bc -> c, l, r, bc
+      { 2, 0, 1, 3, 4, },         // l, r, c, bl, br -> c, l, r, bl, br
+      { 2, 0, 1, 4, 5, 3 },       // l, r, c, lfe, bl, br -> c, l, r, bl, br, lfe
+      { 0, 1, 2, 3, 4, 5, 6 },    // 6.1 and 7.1 are passed unchanged
+      { 0, 1, 2, 3, 4, 5, 6, 7 },
    },
    // oggVorbisInputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 0, 2, 1, },         // l, c, r -> l, r, c
-      { 0, 1, 2, 3, },      // l, r, bl, br
-      { 0, 2, 1, 3, 4, },   // l, c, r, bl, br -> l, r, c, bl, br
-      { 0, 2, 1, 5, 3, 4 }  // l, c, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 0, 2, 1, },               // l, c, r -> l, r, c
+      { 0, 1, 2, 3, },            // l, r, bl, br
+      { 0, 2, 1, 3, 4, },         // l, c, r, bl, br -> l, r, c, bl, br
+      { 0, 2, 1, 5, 3, 4 },       // l, c, r, bl, br, lfe -> l, r, c, lfe, bl, br
+      { 0, 2, 1, 6, 5, 3, 4 },    // l, c, r, sl, sr, bc, lfe -> l, r, c, lfe, bc, sl, sr
+      { 0, 2, 1, 7, 5, 6, 3, 4 }, // l, c, r, sl, sr, bl, br, lfe -> l, r, c, lfe, bl, br, sl, sr
    },
    // oggVorbisOutputChannelMap
    {
-      { 0, },               // mono
-      { 0, 1, },            // l, r
-      { 0, 2, 1, },         // l, r, c -> l, c, r
-      { 0, 1, 2, 3, },      // l, r, bl, br
-      { 0, 2, 1, 3, 4, },   // l, r, c, bl, br -> l, c, r, bl, br
-      { 0, 2, 1, 4, 5, 3 }  // l, r, c, lfe, bl, br -> l, c, r, bl, br, lfe
+      { 0, },                     // mono
+      { 0, 1, },                  // l, r
+      { 0, 2, 1, },               // l, r, c -> l, c, r
+      { 0, 1, 2, 3, },            // l, r, bl, br
+      { 0, 2, 1, 3, 4, },         // l, r, c, bl, br -> l, c, r, bl, br
+      { 0, 2, 1, 4, 5, 3 },       // l, r, c, lfe, bl, br -> l, c, r, bl, br, lfe
+      { 0, 2, 1, 5, 6, 4, 3 },    // l, r, c, lfe, bc, sl, sr -> l, c, r, sl, sr, bc, lfe
+      { 0, 2, 1, 6, 7, 4, 5, 3 }, // l, r, c, lfe, bl, br, sl, sr -> l, c, r, sl, sr, bl, br, lfe
    }
 };
 
-size_t ChannelRemapper::GetMaxMappedChannel()
+/// \brief remaps interleaved samples with a fixed number of channels, converting each sample
+/// \details the number of channels is a template parameter, so that the compiler can unroll
+/// the loop over the channels
+template <size_t NumChannels, typename TInput, typename TOutput, typename TConvert>
+static void RemapFrames(const unsigned char* sourceChannels,
+   const TInput* sampleBuffer, size_t numSamples, TOutput* outputBuffer, TConvert convert)
 {
-   return MAX_CHANNELS;
+   unsigned char channels[NumChannels];
+   std::copy_n(sourceChannels, NumChannels, channels);
+
+   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+   {
+      for (size_t channelIndex = 0; channelIndex < NumChannels; channelIndex++)
+         outputBuffer[channelIndex] = convert(sampleBuffer[channels[channelIndex]]);
+
+      sampleBuffer += NumChannels;
+      outputBuffer += NumChannels;
+   }
 }
 
-size_t ChannelRemapper::GetMappedChannel(T_enChannelMapType channelMapType, size_t numChannels, size_t inputChannel)
+/// remaps interleaved samples, converting each sample; chooses implementation for the
+/// number of channels
+template <typename TInput, typename TOutput, typename TConvert>
+static void RemapInterleavedSamples(const ChannelRemapPlan& plan, const unsigned char* sourceChannels,
+   const TInput* sampleBuffer, size_t numSamples, TOutput* outputBuffer, TConvert convert)
 {
-   if (numChannels >= MAX_CHANNELS ||
-      inputChannel >= MAX_CHANNELS)
-      return 0;
+   if (plan.IsIdentity())
+   {
+      size_t numValues = numSamples * plan.GetNumChannels();
+      for (size_t index = 0; index < numValues; index++)
+         outputBuffer[index] = convert(sampleBuffer[index]);
 
-   return g_channelMap[channelMapType][numChannels - 1][inputChannel];
+      return;
+   }
+
+   switch (plan.GetNumChannels())
+   {
+   case 3: RemapFrames<3>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   case 4: RemapFrames<4>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   case 5: RemapFrames<5>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   case 6: RemapFrames<6>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   case 7: RemapFrames<7>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   case 8: RemapFrames<8>(sourceChannels, sampleBuffer, numSamples, outputBuffer, convert); break;
+   default:
+      ATLASSERT(false); // mono and stereo are never remapped
+      break;
+   }
 }
 
-void ChannelRemapper::ConvertSamplesToFloat(
-   short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer)
+/// factor to convert 16-bit samples to float, in the same way as the sample container does
+const float c_shortToFloatFactor = 1.0f / 32768.0f;
+
+/// factor to convert 32-bit samples to float, in the same way as the sample container does
+const float c_intToFloatFactor = 1.0f / 2147483648.0f;
+
+ChannelRemapPlan::ChannelRemapPlan()
+   :m_numChannels(0),
+   m_isIdentity(true)
 {
-   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         outputBuffer[channelIndex][sampleIndex] = float(sampleBuffer[channelIndex][sampleIndex]) / 32768.f;
+   std::fill_n(m_sourceChannels, c_maxMappedChannels, 0);
 }
 
-void ChannelRemapper::RemapInterleaved(T_enChannelMapType channelMapType,
-   short* sampleBuffer, size_t numSamples, size_t numChannels, short* outputBuffer)
+ChannelRemapPlan::ChannelRemapPlan(T_enChannelMapType channelMapType, size_t numChannels)
+   :m_numChannels(numChannels),
+   m_isIdentity(true)
 {
-   auto channelMap = g_channelMap[channelMapType];
+   std::fill_n(m_sourceChannels, c_maxMappedChannels, 0);
 
-   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-      for (size_t channelIndex = 0; channelIndex < std::min<size_t>(numChannels, MAX_CHANNELS); channelIndex++)
-         outputBuffer[sampleIndex * numChannels + channelIndex] =
-         sampleBuffer[sampleIndex * numChannels + (channelMap[numChannels - 1][channelIndex])];
+   if (numChannels == 0 || numChannels > c_maxMappedChannels)
+      return;
 
-   // copy the remaining channels
-   if (numChannels > MAX_CHANNELS)
+   const unsigned char* channelMap = g_channelMap[channelMapType][numChannels - 1];
+   for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
    {
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         for (size_t channelIndex = MAX_CHANNELS; channelIndex < numChannels; channelIndex++)
-            outputBuffer[sampleIndex * numChannels + channelIndex] = sampleBuffer[sampleIndex * numChannels + channelIndex];
+      m_sourceChannels[channelIndex] = channelMap[channelIndex];
+
+      if (channelMap[channelIndex] != channelIndex)
+         m_isIdentity = false;
    }
 }
 
-void ChannelRemapper::RemapArrayToFloat(T_enChannelMapType channelMapType,
-   short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer)
+size_t ChannelRemapPlan::GetSourceChannel(size_t outputChannel) const
 {
-   auto channelMap = g_channelMap[channelMapType];
+   return m_isIdentity || outputChannel >= m_numChannels
+      ? outputChannel
+      : m_sourceChannels[outputChannel];
+}
 
-   for (size_t channelIndex = 0; channelIndex < std::min<size_t>(numChannels, MAX_CHANNELS); channelIndex++)
-      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-         outputBuffer[channelIndex][sampleIndex] =
-         float(sampleBuffer[channelMap[numChannels - 1][channelIndex]][sampleIndex]) / 32768.f;
+void ChannelRemapPlan::RemapInterleaved(const short* sampleBuffer, size_t numSamples, short* outputBuffer) const
+{
+   RemapInterleavedSamples(*this, m_sourceChannels, sampleBuffer, numSamples, outputBuffer,
+      [](short sample) { return sample; });
+}
 
-   if (numChannels > MAX_CHANNELS)
-   {
-      for (size_t channelIndex = MAX_CHANNELS; channelIndex < numChannels; channelIndex++)
-         for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
-            outputBuffer[channelIndex][sampleIndex] = float(sampleBuffer[channelIndex][sampleIndex]) / 32768.f;
-   }
+void ChannelRemapPlan::RemapInterleaved(const int* sampleBuffer, size_t numSamples, int* outputBuffer) const
+{
+   RemapInterleavedSamples(*this, m_sourceChannels, sampleBuffer, numSamples, outputBuffer,
+      [](int sample) { return sample; });
+}
+
+void ChannelRemapPlan::RemapInterleaved(const float* sampleBuffer, size_t numSamples, float* outputBuffer) const
+{
+   RemapInterleavedSamples(*this, m_sourceChannels, sampleBuffer, numSamples, outputBuffer,
+      [](float sample) { return sample; });
+}
+
+void ChannelRemapPlan::RemapInterleavedToFloat(const short* sampleBuffer, size_t numSamples, float* outputBuffer) const
+{
+   RemapInterleavedSamples(*this, m_sourceChannels, sampleBuffer, numSamples, outputBuffer,
+      [](short sample) { return float(sample) * c_shortToFloatFactor; });
+}
+
+void ChannelRemapPlan::RemapInterleavedToFloat(const int* sampleBuffer, size_t numSamples, float* outputBuffer) const
+{
+   RemapInterleavedSamples(*this, m_sourceChannels, sampleBuffer, numSamples, outputBuffer,
+      [](int sample) { return float(sample) * c_intToFloatFactor; });
+}
+
+void ChannelRemapPlan::RemapArray(float** sampleBuffer, size_t numSamples, float** outputBuffer) const
+{
+   for (size_t channelIndex = 0; channelIndex < m_numChannels; channelIndex++)
+      std::copy_n(sampleBuffer[GetSourceChannel(channelIndex)], numSamples, outputBuffer[channelIndex]);
+}
+
+void ChannelRemapPlan::RemapArrayPointers(float** sampleBuffer, float** outputBuffer) const
+{
+   for (size_t channelIndex = 0; channelIndex < m_numChannels; channelIndex++)
+      outputBuffer[channelIndex] = sampleBuffer[GetSourceChannel(channelIndex)];
+}
+
+size_t ChannelRemapper::GetMaxMappedChannel()
+{
+   return c_maxMappedChannels;
+}
+
+size_t ChannelRemapper::GetMappedChannel(T_enChannelMapType channelMapType, size_t numChannels, size_t inputChannel)
+{
+   return ChannelRemapPlan(channelMapType, numChannels).GetSourceChannel(inputChannel);
+}
+
+void ChannelRemapper::RemapInterleaved(T_enChannelMapType channelMapType,
+   short* sampleBuffer, size_t numSamples, size_t numChannels, short* outputBuffer)
+{
+   ChannelRemapPlan(channelMapType, numChannels).RemapInterleaved(sampleBuffer, numSamples, outputBuffer);
+}
+
+void ChannelRemapper::RemapInterleaved(T_enChannelMapType channelMapType,
+   float* sampleBuffer, size_t numSamples, size_t numChannels, float* outputBuffer)
+{
+   ChannelRemapPlan(channelMapType, numChannels).RemapInterleaved(sampleBuffer, numSamples, outputBuffer);
+}
+
+void ChannelRemapper::RemapArray(T_enChannelMapType channelMapType,
+   float** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer)
+{
+   ChannelRemapPlan(channelMapType, numChannels).RemapArray(sampleBuffer, numSamples, outputBuffer);
+}
+
+void ChannelRemapper::RemapArrayPointers(T_enChannelMapType channelMapType,
+   float** sampleBuffer, size_t numChannels, float** outputBuffer)
+{
+   ChannelRemapPlan(channelMapType, numChannels).RemapArrayPointers(sampleBuffer, outputBuffer);
 }
@@ -32,6 +32,63 @@ namespace Encoder
       oggVorbisOutputChannelMap = 3,
    };
 
+   /// \brief channel remap plan for a stream
+   /// \details Looks up the channel map for the number of channels of a stream once, so that
+   /// remapping only has to pick the source channel of each output channel. Channel counts
+   /// without a channel map are passed through unchanged.
+   class ChannelRemapPlan
+   {
+   public:
+      /// max. number of channels that have a channel map
+      static const size_t c_maxMappedChannels = 8;
+
+      /// ctor; creates plan that doesn't remap any channels
+      ChannelRemapPlan();
+
+      /// ctor; creates plan for given channel map type and number of channels
+      ChannelRemapPlan(T_enChannelMapType channelMapType, size_t numChannels);
+
+      /// returns number of channels
+      size_t GetNumChannels() const { return m_numChannels; }
+
+      /// returns if the plan leaves all channels in place
+      bool IsIdentity() const { return m_isIdentity; }
+
+      /// returns source channel for given output channel
+      size_t GetSourceChannel(size_t outputChannel) const;
+
+      /// remaps an interleaved 16-bit sample buffer to an output buffer
+      void RemapInterleaved(const short* sampleBuffer, size_t numSamples, short* outputBuffer) const;
+
+      /// remaps an interleaved 32-bit sample buffer to an output buffer
+      void RemapInterleaved(const int* sampleBuffer, size_t numSamples, int* outputBuffer) const;
+
+      /// remaps an interleaved float sample buffer to an output buffer
+      void RemapInterleaved(const float* sampleBuffer, size_t numSamples, float* outputBuffer) const;
+
+      /// remaps an interleaved 16-bit sample buffer and converts the samples to float
+      void RemapInterleavedToFloat(const short* sampleBuffer, size_t numSamples, float* outputBuffer) const;
+
+      /// remaps an interleaved 32-bit sample buffer and converts the samples to float
+      void RemapInterleavedToFloat(const int* sampleBuffer, size_t numSamples, float* outputBuffer) const;
+
+      /// remaps an array float sample buffer to an output buffer
+      void RemapArray(float** sampleBuffer, size_t numSamples, float** outputBuffer) const;
+
+      /// remaps the channel pointers of an array sample buffer, without moving any samples
+      void RemapArrayPointers(float** sampleBuffer, float** outputBuffer) const;
+
+   private:
+      /// number of channels
+      size_t m_numChannels;
+
+      /// indicates if the plan leaves all channels in place
+      bool m_isIdentity;
+
+      /// source channel of each output channel; only used when not identity
+      unsigned char m_sourceChannels[c_maxMappedChannels];
+   };
+
    /// channel remapper helper class
    class ChannelRemapper
    {
@@ -39,20 +96,26 @@ namespace Encoder
       /// returns number of mappable channels
       static size_t GetMaxMappedChannel();
 
-      /// returns mapped output channel for a given input channel
+      /// \brief returns mapped output channel for a given input channel
+      /// \details returns the input channel when there's no channel map for the number of channels
       static size_t GetMappedChannel(T_enChannelMapType channelMapType, size_t numChannels, size_t inputChannel);
 
-      /// converts a sample buffer to float, without remapping
-      static void ConvertSamplesToFloat(
-         short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer);
-
       /// remaps an interleaved sample buffer with number of samples and channels to a stereo output buffer
       static void RemapInterleaved(T_enChannelMapType channelMapType,
          short* sampleBuffer, size_t numSamples, size_t numChannels, short* outputBuffer);
 
-      /// remaps an array sample buffer with number of samples and channels to a float stereo output buffer
-      static void RemapArrayToFloat(T_enChannelMapType channelMapType,
-         short** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer);
+      /// remaps an interleaved float sample buffer with number of samples and channels to an output buffer
+      static void RemapInterleaved(T_enChannelMapType channelMapType,
+         float* sampleBuffer, size_t numSamples, size_t numChannels, float* outputBuffer);
+
+      /// \brief remaps the channel pointers of an array sample buffer, without moving any samples
+      /// \details channels that can't be mapped keep their position
+      static void RemapArrayPointers(T_enChannelMapType channelMapType,
+         float** sampleBuffer, size_t numChannels, float** outputBuffer);
+
+      /// remaps an array float sample buffer with number of samples and channels to an output buffer
+      static void RemapArray(T_enChannelMapType channelMapType,
+         float** sampleBuffer, size_t numSamples, size_t numChannels, float** outputBuffer);
    };
 
 } // namespace Encoder
@@ -0,0 +1,179 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CpuTopology.cpp
+/// \brief CPU topology class
+//
+#include "stdafx.h"
+#include "CpuTopology.hpp"
+#include <algorithm>
+#include <thread>
+
+using Encoder::CpuTopology;
+
+unsigned int CpuTopology::CoreInfo::NumLogicalProcessors() const
+{
+   unsigned int count = 0;
+   for (KAFFINITY mask = m_affinityMask; mask != 0; mask &= mask - 1)
+      count++;
+
+   return count;
+}
+
+CpuTopology::CpuTopology()
+{
+   if (!QueryTopology() || m_physicalCores.empty())
+      SetupFallbackTopology();
+}
+
+unsigned int CpuTopology::NumLogicalProcessors() const
+{
+   unsigned int count = 0;
+   for (const CoreInfo& core : m_physicalCores)
+      count += core.NumLogicalProcessors();
+
+   return count;
+}
+
+unsigned int CpuTopology::NumNumaNodes() const
+{
+   std::vector<DWORD> numaNodesList;
+   for (const CoreInfo& core : m_physicalCores)
+   {
+      if (std::find(numaNodesList.begin(), numaNodesList.end(), core.m_numaNode) == numaNodesList.end())
+         numaNodesList.push_back(core.m_numaNode);
+   }
+
+   return numaNodesList.size();
+}
+
+std::vector<CpuTopology::CoreInfo> CpuTopology::WorkerCores(unsigned int numReservedCores) const
+{
+   if (numReservedCores >= m_physicalCores.size())
+      numReservedCores = m_physicalCores.size() - 1;
+
+   return std::vector<CoreInfo>(m_physicalCores.begin() + numReservedCores, m_physicalCores.end());
+}
+
+bool CpuTopology::SetThreadAffinity(HANDLE threadHandle, WORD group, KAFFINITY affinityMask)
+{
+   if (affinityMask == 0)
+      return false;
+
+   GROUP_AFFINITY groupAffinity = {};
+   groupAffinity.Group = group;
+   groupAffinity.Mask = affinityMask;
+
+   if (!SetThreadGroupAffinity(threadHandle, &groupAffinity, nullptr))
+   {
+      ATLTRACE(_T("couldn't set thread affinity, group %u, mask %08Ix, error %u\n"),
+         group, affinityMask, GetLastError());
+      return false;
+   }
+
+   return true;
+}
+
+KAFFINITY CpuTopology::CombinedAffinityMask(const std::vector<CoreInfo>& coresList, WORD group)
+{
+   KAFFINITY affinityMask = 0;
+   for (const CoreInfo& core : coresList)
+   {
+      if (core.m_group == group)
+         affinityMask |= core.m_affinityMask;
+   }
+
+   return affinityMask;
+}
+
+bool CpuTopology::QueryTopology()
+{
+   DWORD length = 0;
+   GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+   if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || length == 0)
+      return false;
+
+   std::vector<BYTE> buffer(length);
+   auto firstInfo = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+
+   if (!GetLogicalProcessorInformationEx(RelationAll, firstInfo, &length))
+      return false;
+
+   std::vector<GROUP_AFFINITY> numaNodesList;
+   std::vector<DWORD> numaNodeNumbersList;
+
+   for (DWORD offset = 0; offset < length;)
+   {
+      auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+
+      if (info->Relationship == RelationProcessorCore &&
+         info->Processor.GroupCount > 0)
+      {
+         CoreInfo core;
+         core.m_group = info->Processor.GroupMask[0].Group;
+         core.m_affinityMask = info->Processor.GroupMask[0].Mask;
+
+         m_physicalCores.push_back(core);
+      }
+      else if (info->Relationship == RelationNumaNode)
+      {
+         numaNodesList.push_back(info->NumaNode.GroupMask);
+         numaNodeNumbersList.push_back(info->NumaNode.NodeNumber);
+      }
+
+      offset += info->Size;
+   }
+
+   for (CoreInfo& core : m_physicalCores)
+   {
+      for (size_t nodeIndex = 0; nodeIndex < numaNodesList.size(); nodeIndex++)
+      {
+         if (numaNodesList[nodeIndex].Group == core.m_group &&
+            (numaNodesList[nodeIndex].Mask & core.m_affinityMask) != 0)
+         {
+            core.m_numaNode = numaNodeNumbersList[nodeIndex];
+            break;
+         }
+      }
+   }
+
+   std::stable_sort(m_physicalCores.begin(), m_physicalCores.end(),
+      [](const CoreInfo& lhs, const CoreInfo& rhs) { return lhs.m_numaNode < rhs.m_numaNode; });
+
+   return true;
+}
+
+void CpuTopology::SetupFallbackTopology()
+{
+   m_physicalCores.clear();
+
+   unsigned int numProcessors = std::thread::hardware_concurrency();
+   if (numProcessors == 0)
+      numProcessors = 1;
+
+   const unsigned int maxProcessorsPerGroup = sizeof(KAFFINITY) * 8;
+
+   for (unsigned int processorIndex = 0; processorIndex < numProcessors; processorIndex++)
+   {
+      CoreInfo core;
+      core.m_group = static_cast<WORD>(processorIndex / maxProcessorsPerGroup);
+      core.m_affinityMask = static_cast<KAFFINITY>(1) << (processorIndex % maxProcessorsPerGroup);
+
+      m_physicalCores.push_back(core);
+   }
+}
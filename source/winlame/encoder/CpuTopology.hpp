@@ -0,0 +1,94 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file CpuTopology.hpp
+/// \brief CPU topology class
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief CPU topology of the system
+   /// \details Lists all physical CPU cores, with the logical processors (SMT siblings) that
+   /// belong to each core, and the NUMA node the core is attached to. Used to place worker
+   /// threads on cores.
+   class CpuTopology
+   {
+   public:
+      /// infos about a single physical core
+      struct CoreInfo
+      {
+         /// ctor
+         CoreInfo()
+            :m_group(0),
+            m_affinityMask(0),
+            m_numaNode(0)
+         {
+         }
+
+         /// processor group of the core
+         WORD m_group;
+
+         /// affinity mask of all logical processors of the core, in the processor group
+         KAFFINITY m_affinityMask;
+
+         /// NUMA node number of the core
+         DWORD m_numaNode;
+
+         /// returns number of logical processors of the core
+         unsigned int NumLogicalProcessors() const;
+      };
+
+      /// ctor; queries topology of the system
+      CpuTopology();
+
+      /// returns all physical cores, sorted by NUMA node
+      const std::vector<CoreInfo>& PhysicalCores() const { return m_physicalCores; }
+
+      /// returns number of logical processors of all physical cores
+      unsigned int NumLogicalProcessors() const;
+
+      /// returns number of NUMA nodes
+      unsigned int NumNumaNodes() const;
+
+      /// \brief returns cores to use for worker threads
+      /// \details the first cores are reserved, since the system places most interrupts and
+      /// deferred procedure calls on them; at least one core is always returned
+      std::vector<CoreInfo> WorkerCores(unsigned int numReservedCores) const;
+
+      /// restricts thread to the logical processors in the given processor group
+      static bool SetThreadAffinity(HANDLE threadHandle, WORD group, KAFFINITY affinityMask);
+
+      /// combines affinity masks of all given cores in the given processor group
+      static KAFFINITY CombinedAffinityMask(const std::vector<CoreInfo>& coresList, WORD group);
+
+   private:
+      /// queries topology using GetLogicalProcessorInformationEx()
+      bool QueryTopology();
+
+      /// sets up topology with one core per logical processor, when the topology is unknown
+      void SetupFallbackTopology();
+
+   private:
+      /// list of all physical cores
+      std::vector<CoreInfo> m_physicalCores;
+   };
+
+} // namespace Encoder
@@ -0,0 +1,204 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Downmixer.cpp
+/// \brief Downmixer class
+//
+#include "stdafx.h"
+#include "Downmixer.hpp"
+#include "ChannelRemapper.hpp"
+
+using Encoder::Downmixer;
+
+// Note: The stupid_matrix table and the code in Downmixer::Init() is taken
+// from opus-tools' audio-in.c file:
+// https://github.com/xiph/opus-tools/blob/master/src/audio-in.c
+// The following copyright header appears in the file
+//
+/* Copyright 2000-2002, Michael Smith <msmith@xiph.org>
+             2010, Monty <monty@xiph.org>
+   AIFF/AIFC support from OggSquish, (c) 1994-1996 Monty <xiphmont@xiph.org>
+   (From GPL code in oggenc relicensed by permission from Monty and Msmith)
+   File: audio-in.c
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \brief matrix for downsampling from N channels to 2 channels
+static const float stupid_matrix[7][8][2] =
+{
+   /*2*/  {{1,0}, {0,1}},
+   /*3*/  {{1,0}, {0.7071f,0.7071f}, {0,1}},
+   /*4*/  {{1,0}, {0,1},{0.866f,0.5f}, {0.5f,0.866f}},
+   /*5*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}},
+   /*6*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.7071f,0.7071f}},
+   /*7*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.6123f,0.6123f}, {0.7071f,0.7071f}},
+   /*8*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.866f,0.5f}, {0.5f,0.866f}, {0.7071f,0.7071f}},
+};
+
+/// \brief mixes interleaved samples with a fixed number of input and output channels
+/// \details the numbers of channels are template parameters, so that the compiler can unroll
+/// the loops over the channels; the products are summed up in input channel order
+template <size_t InputNumChannels, size_t OutputNumChannels>
+static void MixFrames(const float* matrix, const float* sampleBuffer, size_t numSamples, float* outputBuffer)
+{
+   float factors[OutputNumChannels][InputNumChannels];
+   for (size_t outputChannel = 0; outputChannel < OutputNumChannels; outputChannel++)
+      for (size_t inputChannel = 0; inputChannel < InputNumChannels; inputChannel++)
+         factors[outputChannel][inputChannel] = matrix[outputChannel * InputNumChannels + inputChannel];
+
+   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+   {
+      for (size_t outputChannel = 0; outputChannel < OutputNumChannels; outputChannel++)
+      {
+         float sample = 0.f;
+         for (size_t inputChannel = 0; inputChannel < InputNumChannels; inputChannel++)
+            sample += sampleBuffer[inputChannel] * factors[outputChannel][inputChannel];
+
+         outputBuffer[outputChannel] = sample;
+      }
+
+      sampleBuffer += InputNumChannels;
+      outputBuffer += OutputNumChannels;
+   }
+}
+
+/// mixes interleaved samples with a fixed number of output channels; chooses implementation
+/// for the number of input channels
+template <size_t OutputNumChannels>
+static void MixSamples(const float* matrix, size_t inputNumChannels,
+   const float* sampleBuffer, size_t numSamples, float* outputBuffer)
+{
+   switch (inputNumChannels)
+   {
+   case 2: MixFrames<2, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 3: MixFrames<3, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 4: MixFrames<4, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 5: MixFrames<5, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 6: MixFrames<6, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 7: MixFrames<7, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   case 8: MixFrames<8, OutputNumChannels>(matrix, sampleBuffer, numSamples, outputBuffer); return;
+   default:
+      break;
+   }
+
+   // more than 8 channels
+   for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+   {
+      for (size_t outputChannel = 0; outputChannel < OutputNumChannels; outputChannel++)
+      {
+         float sample = 0.f;
+         for (size_t inputChannel = 0; inputChannel < inputNumChannels; inputChannel++)
+            sample += sampleBuffer[inputChannel] * matrix[outputChannel * inputNumChannels + inputChannel];
+
+         outputBuffer[outputChannel] = sample;
+      }
+
+      sampleBuffer += inputNumChannels;
+      outputBuffer += OutputNumChannels;
+   }
+}
+
+Downmixer::Downmixer()
+   :m_inputNumChannels(0),
+   m_outputNumChannels(0)
+{
+}
+
+bool Downmixer::IsSupported(size_t inputNumChannels, size_t outputNumChannels)
+{
+   if (inputNumChannels <= outputNumChannels || outputNumChannels > 2 || outputNumChannels == 0)
+      return false; // must actually downmix, and only knows mono and stereo output
+
+   if (outputNumChannels == 2 && inputNumChannels > 8)
+      return false; // only knows how to mix more than 8 channels to mono
+
+   return true;
+}
+
+bool Downmixer::Init(size_t inputNumChannels, size_t outputNumChannels, bool vorbisChannelOrder)
+{
+   m_matrix.clear();
+
+   if (!IsSupported(inputNumChannels, outputNumChannels))
+      return false;
+
+   m_inputNumChannels = inputNumChannels;
+   m_outputNumChannels = outputNumChannels;
+
+   // the matrix is in Vorbis channel order; the plan returns the WAVE channel for each Vorbis channel
+   ChannelRemapPlan plan;
+   if (!vorbisChannelOrder)
+      plan = ChannelRemapPlan(oggVorbisOutputChannelMap, inputNumChannels);
+
+   m_matrix.resize(inputNumChannels * outputNumChannels);
+
+   if (outputNumChannels == 1 && inputNumChannels > 8)
+   {
+      for (size_t i = 0; i < inputNumChannels; i++)
+         m_matrix[i] = 1.0f / inputNumChannels;
+   }
+   else if (outputNumChannels == 2)
+   {
+      for (size_t j = 0; j < outputNumChannels; j++)
+         for (size_t i = 0; i < inputNumChannels; i++)
+            m_matrix[inputNumChannels * j + plan.GetSourceChannel(i)] = stupid_matrix[inputNumChannels - 2][i][j];
+   }
+   else
+   {
+      for (size_t i = 0; i < inputNumChannels; i++)
+         m_matrix[plan.GetSourceChannel(i)] = stupid_matrix[inputNumChannels - 2][i][0] + stupid_matrix[inputNumChannels - 2][i][1];
+   }
+
+   float sum = 0.f;
+   for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
+      sum += m_matrix[i];
+
+   sum = (float)outputNumChannels / sum;
+   for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
+      m_matrix[i] *= sum;
+
+   return true;
+}
+
+void Downmixer::Mix(const float* sampleBuffer, size_t numSamples, float* outputBuffer) const
+{
+   ATLASSERT(IsActive()); // must have been set up
+
+   if (m_outputNumChannels == 1)
+      MixSamples<1>(m_matrix.data(), m_inputNumChannels, sampleBuffer, numSamples, outputBuffer);
+   else
+      MixSamples<2>(m_matrix.data(), m_inputNumChannels, sampleBuffer, numSamples, outputBuffer);
+}
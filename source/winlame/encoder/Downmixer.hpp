@@ -0,0 +1,72 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Downmixer.hpp
+/// \brief Downmixer class
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief downmixes interleaved float samples to stereo or mono
+   /// \details Uses the downmix matrix of opus-tools for up to 8 channels, and mixes all
+   /// channels with the same weight when downmixing more than 8 channels to mono. The input
+   /// channels can be in the Vorbis channel order, as used by the Opus encoder, or in the
+   /// WAVE channel order used by the sample container.
+   class Downmixer
+   {
+   public:
+      /// ctor
+      Downmixer();
+
+      /// returns if given number of input channels can be downmixed to given number of
+      /// output channels
+      static bool IsSupported(size_t inputNumChannels, size_t outputNumChannels);
+
+      /// sets up the downmix matrix; returns false when the channels can't be downmixed
+      bool Init(size_t inputNumChannels, size_t outputNumChannels, bool vorbisChannelOrder);
+
+      /// returns if the downmixer was set up
+      bool IsActive() const { return !m_matrix.empty(); }
+
+      /// returns number of input channels
+      size_t GetInputNumChannels() const { return m_inputNumChannels; }
+
+      /// returns number of output channels
+      size_t GetOutputNumChannels() const { return m_outputNumChannels; }
+
+      /// \brief downmixes samples
+      /// \param sampleBuffer interleaved input samples
+      /// \param numSamples number of samples, per channel
+      /// \param outputBuffer buffer for the interleaved output samples
+      void Mix(const float* sampleBuffer, size_t numSamples, float* outputBuffer) const;
+
+   private:
+      /// number of input channels
+      size_t m_inputNumChannels;
+
+      /// number of output channels
+      size_t m_outputNumChannels;
+
+      /// downmix matrix; contains the input channel factors for each output channel
+      std::vector<float> m_matrix;
+   };
+
+} // namespace Encoder
@@ -0,0 +1,59 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file EncoderBatchPlan.cpp
+/// \brief Encoder batch plan class
+//
+#include "stdafx.h"
+#include "EncoderBatchPlan.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "EncoderImpl.hpp"
+
+using Encoder::EncoderBatchPlan;
+
+EncoderBatchPlan::EncoderBatchPlan(ModuleManagerImpl& moduleManager, int outputModuleId, SettingsManager& settingsManager)
+   :m_moduleManager(moduleManager),
+   m_isLossyOutput(EncoderImpl::IsLossyOutputModule(outputModuleId)),
+   m_isLossyInput(false),
+   m_isOverwritingOriginalFiles(false)
+{
+   // the output extension may depend on the settings, but is the same for all jobs
+   std::unique_ptr<OutputModule> outputModule(moduleManager.GetOutputModule(outputModuleId));
+   if (outputModule != nullptr)
+   {
+      outputModule->PrepareOutput(settingsManager);
+      m_outputExtension = outputModule->GetOutputExtension();
+   }
+}
+
+void EncoderBatchPlan::AddJob(const CString& inputFilename, const CString& outputFolder)
+{
+   if (m_isLossyOutput && !m_isLossyInput)
+   {
+      int inputModuleId = m_moduleManager.ChooseInputModuleID(inputFilename);
+      m_isLossyInput = inputModuleId != -1 && EncoderImpl::IsLossyInputModule(inputModuleId);
+   }
+
+   CString outputFilename = EncoderImpl::GetOutputFilenameByInputTitle(
+      outputFolder, Path::FilenameOnly(inputFilename), m_outputExtension);
+
+   if (outputFilename.CompareNoCase(inputFilename) == 0)
+      m_isOverwritingOriginalFiles = true;
+
+   m_outputFilenamesList.push_back(outputFilename);
+}
@@ -0,0 +1,78 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file EncoderBatchPlan.hpp
+/// \brief Encoder batch plan class
+//
+#pragma once
+
+#include <vector>
+
+class SettingsManager;
+
+namespace Encoder
+{
+   class ModuleManagerImpl;
+
+   /// \brief plan for a batch of encoder jobs
+   /// \details Computes the infos that are needed before starting a batch of encoder jobs in a
+   /// single pass over all jobs: if any job transcodes from a lossy to a lossy format, if any
+   /// output file would overwrite its input file, and the output filenames. The output module
+   /// is only created once per batch, and input modules are chosen without creating instances.
+   class EncoderBatchPlan
+   {
+   public:
+      /// ctor; takes output module and settings used for all jobs
+      EncoderBatchPlan(ModuleManagerImpl& moduleManager, int outputModuleId, SettingsManager& settingsManager);
+
+      /// plans job with given input filename, to be encoded into given output folder
+      void AddJob(const CString& inputFilename, const CString& outputFolder);
+
+      /// returns number of planned jobs
+      size_t NumJobs() const { return m_outputFilenamesList.size(); }
+
+      /// returns if any file would be transcoded from a lossy to a lossy format
+      bool IsLossyTranscoding() const { return m_isLossyInput && m_isLossyOutput; }
+
+      /// returns if any output filename is the same as its input filename
+      bool IsOverwritingOriginalFiles() const { return m_isOverwritingOriginalFiles; }
+
+      /// returns output filename of job with given index
+      const CString& OutputFilename(size_t jobIndex) const { return m_outputFilenamesList[jobIndex]; }
+
+   private:
+      /// module manager
+      ModuleManagerImpl& m_moduleManager;
+
+      /// output file extension of the output module, without dot
+      CString m_outputExtension;
+
+      /// indicates if the output module is lossy
+      bool m_isLossyOutput;
+
+      /// indicates if any input file is in a lossy format
+      bool m_isLossyInput;
+
+      /// indicates if any output filename is the same as its input filename
+      bool m_isOverwritingOriginalFiles;
+
+      /// output filenames of all jobs
+      std::vector<CString> m_outputFilenamesList;
+   };
+
+} // namespace Encoder
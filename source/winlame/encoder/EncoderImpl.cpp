@@ -41,6 +41,11 @@ EncoderInterface* EncoderInterface::CreateEncoder()
 /// mutex to protect threads from generating the same output filenames
 static LightweightMutex s_mutexTempOutputFile;
 
+/// number of samples of neighbour tracks that are encoded before and after a track, when
+/// encoding gapless tracks in parallel; one frame covers the MDCT overlap and the
+/// psychoacoustic model's lookahead, and keeps delay and padding in the info tag's range
+const unsigned int c_numGaplessContextSamples = 1152;
+
 // EncoderImpl methods
 
 EncoderImpl::EncoderImpl()
@@ -170,7 +175,8 @@ void EncoderImpl::Encode()
 
    bool skipFile = false;
 
-   if (!PrepareInputModule(trackInfo))
+   if (!PrepareInputModule(trackInfo) ||
+      !PrepareSampleProcessing())
       skipFile = true;
 
    CString tempOutputFilename;
@@ -214,29 +220,80 @@ void EncoderImpl::Encode()
 
    lock.unlock();
 
+   // when encoding gapless tracks in parallel, the neighbour tracks' audio is encoded before
+   // and after the track, so that the encoder sees the same signal as when encoding the
+   // tracks in one go
+   LameOutputModule* lameOutputModule = dynamic_cast<LameOutputModule*>(m_outputModule.get());
+   bool encodeGaplessContext = !skipFile &&
+      lameOutputModule != nullptr &&
+      lameOutputModule->CanTrimGaplessContext();
+
+   // the neighbour tracks' samples are passed to the output module unprocessed, so they can't
+   // be used when downmixing or resampling; the track is encoded, but without them
+   if (encodeGaplessContext && IsProcessingSamples())
+   {
+      encodeGaplessContext = false;
+
+      if (!m_encoderSettings.m_gaplessPreviousInputFilename.IsEmpty() ||
+         !m_encoderSettings.m_gaplessNextInputFilename.IsEmpty())
+      {
+         CString errorMessage;
+         errorMessage.LoadString(IDS_ENCODER_ERROR_GAPLESS_CONTEXT_SKIPPED);
+
+         HandleError(m_encoderSettings.m_inputFilename, _T("Encoder"), -1, errorMessage);
+      }
+   }
+
+   unsigned int numPrerollSamples = 0;
+   if (encodeGaplessContext && !m_encoderSettings.m_gaplessPreviousInputFilename.IsEmpty())
+      numPrerollSamples = EncodeGaplessContext(m_encoderSettings.m_gaplessPreviousInputFilename, true);
+
    if (!skipFile && !skipMoveFile)
       skipFile = MainLoop();
 
-   if (!skipFile)
-   {
-      // write playlist entry, when enabled
-      if (m_encoderState.m_running && !m_encoderSettings.m_playlistFilename.IsEmpty())
-         WritePlaylistEntry(m_encoderSettings.m_outputFilename);
-   }
+   unsigned int numPostrollSamples = 0;
+   if (encodeGaplessContext && !skipFile && m_encoderState.m_running &&
+      !m_encoderSettings.m_gaplessNextInputFilename.IsEmpty())
+      numPostrollSamples = EncodeGaplessContext(m_encoderSettings.m_gaplessNextInputFilename, false);
+
+   if (encodeGaplessContext)
+      lameOutputModule->SetGaplessContextSamples(numPrerollSamples, numPostrollSamples);
+
+   // when encoding was stopped, the output is incomplete and must not replace the output file
+   bool stopped = !m_encoderState.m_running;
 
    // done with modules
    if (m_inputModule != nullptr)
       m_inputModule->DoneInput();
 
    if (initOutputModule && m_outputModule != nullptr)
-      m_outputModule->DoneOutput();
+   {
+      int ret = m_outputModule->DoneOutput();
+
+      // errors while finishing the output file make it unusable
+      if (ret < 0 && !skipFile)
+      {
+         HandleError(m_encoderSettings.m_inputFilename, m_outputModule->GetModuleName(),
+            -ret, m_outputModule->GetLastError());
+
+         m_encoderState.m_errorCode = 4;
+         skipFile = true;
+      }
+   }
+
+   if (!skipFile)
+   {
+      // write playlist entry, when enabled
+      if (m_encoderState.m_running && !m_encoderSettings.m_playlistFilename.IsEmpty())
+         WritePlaylistEntry(m_encoderSettings.m_outputFilename);
+   }
 
    // delete modules
    m_inputModule.reset();
    m_outputModule.reset();
 
    // rename when we used a temporary filename
-   if (!skipFile)
+   if (!skipFile && !stopped)
    {
       if (!tempOutputFilename.IsEmpty() &&
          m_encoderSettings.m_outputFilename != tempOutputFilename)
@@ -259,6 +316,11 @@ void EncoderImpl::Encode()
             DeleteFile(m_encoderSettings.m_inputFilename);
       }
    }
+   else if (!tempOutputFilename.IsEmpty() &&
+      m_encoderSettings.m_outputFilename != tempOutputFilename)
+   {
+      DeleteFile(tempOutputFilename);
+   }
 
    // end thread
    m_encoderState.m_running = false;
@@ -269,11 +331,43 @@ void EncoderImpl::Encode()
 bool EncoderImpl::PrepareInputModule(TrackInfo& trackInfo)
 {
    // init new
+   bool prefersFloat = m_outputModule->PrefersFloatSamples() ||
+      m_settingsManager->QueryValueInt(GeneralDownmixChannels) > 0 ||
+      m_settingsManager->QueryValueInt(GeneralResampleRate) > 0;
+
    m_sampleContainer = SampleContainer();
+   m_sampleContainer.SetOutputModulePrefersFloat(prefersFloat);
 
    int res = m_inputModule->InitInput(m_encoderSettings.m_inputFilename, *m_settingsManager,
       trackInfo, m_sampleContainer);
 
+   if (res < 0)
+   {
+      // the file may have a wrong extension; retry with the module matching the file's content
+      ModuleManagerImpl* modimpl = reinterpret_cast<ModuleManagerImpl*>(&m_moduleManager);
+      std::unique_ptr<InputModule> contentInputModule(
+         modimpl->ChooseInputModuleByContent(m_encoderSettings.m_inputFilename, m_inputModule->GetModuleID()));
+
+      if (contentInputModule != nullptr)
+      {
+         m_sampleContainer = SampleContainer();
+         m_sampleContainer.SetOutputModulePrefersFloat(prefersFloat);
+         trackInfo.ResetInfos();
+
+         if (contentInputModule->InitInput(m_encoderSettings.m_inputFilename, *m_settingsManager,
+            trackInfo, m_sampleContainer) >= 0)
+         {
+            // the failed module may have opened the file or allocated its decoder
+            m_inputModule->DoneInput();
+
+            m_inputModule = std::move(contentInputModule);
+            res = 0;
+         }
+         else
+            contentInputModule->DoneInput();
+      }
+   }
+
    m_inputModule->ResolveRealFilename(m_encoderSettings.m_inputFilename);
 
    // catch errors
@@ -288,6 +382,114 @@ bool EncoderImpl::PrepareInputModule(TrackInfo& trackInfo)
       return false;
    }
 
+   // the input module has read the tags anyway; cache them, so that adding the file again
+   // doesn't need to read them
+   std::shared_ptr<AudioFileInfoCache> spAudioFileInfoCache = m_moduleManager.GetAudioFileInfoCache();
+   if (spAudioFileInfoCache != nullptr)
+      spAudioFileInfoCache->StoreTrackInfo(m_encoderSettings.m_inputFilename, trackInfo);
+
+   return true;
+}
+
+bool EncoderImpl::PrepareSampleProcessing()
+{
+   m_downmixer = Downmixer();
+   m_resampler = Resampler();
+
+   int numChannels = m_sampleContainer.GetInputModuleChannels();
+   int sampleRate = m_sampleContainer.GetInputModuleSampleRate();
+
+   int downmixNumChannels = m_settingsManager->QueryValueInt(GeneralDownmixChannels);
+   if (downmixNumChannels > 0 &&
+      downmixNumChannels < numChannels &&
+      m_downmixer.Init(numChannels, downmixNumChannels, false))
+      numChannels = downmixNumChannels;
+
+   // resampling is done after downmixing, so that fewer channels have to be resampled
+   int resampleRate = m_settingsManager->QueryValueInt(GeneralResampleRate);
+   int resampleQuality = m_settingsManager->QueryValueInt(GeneralResampleQuality);
+   if (resampleRate > 0 &&
+      resampleRate != sampleRate)
+   {
+      // encoding with the input sample rate would silently ignore the setting
+      if (!m_resampler.Init(numChannels, sampleRate, resampleRate, static_cast<T_enResamplerQuality>(resampleQuality)))
+      {
+         CString errorMessage;
+         errorMessage.LoadString(IDS_ENCODER_ERROR_INIT_RESAMPLER);
+         errorMessage.AppendFormat(_T(" (%i Hz to %i Hz)"), sampleRate, resampleRate);
+
+         HandleError(m_encoderSettings.m_inputFilename, _T("Encoder"), -1, errorMessage);
+
+         m_encoderState.m_errorCode = 2;
+         return false;
+      }
+
+      sampleRate = resampleRate;
+   }
+
+   if (!IsProcessingSamples())
+      return true;
+
+   // the decoded samples are processed as float samples, in the input module's channel order
+   m_sampleContainer.SetOutputModuleTraits(32, SamplesInterleaved, -1, -1, true);
+
+   m_processedSampleContainer = SampleContainer();
+   m_processedSampleContainer.SetOutputModulePrefersFloat(m_outputModule->PrefersFloatSamples());
+   m_processedSampleContainer.SetInputModuleTraits(32, SamplesInterleaved,
+      sampleRate, numChannels, true);
+
+   return true;
+}
+
+SampleContainer& EncoderImpl::GetOutputSampleContainer()
+{
+   return IsProcessingSamples() ? m_processedSampleContainer : m_sampleContainer;
+}
+
+int EncoderImpl::ProcessSamples()
+{
+   int numSamples = 0;
+   float* samples = reinterpret_cast<float*>(m_sampleContainer.GetSamplesInterleaved(numSamples));
+
+   if (m_downmixer.IsActive())
+   {
+      m_downmixBuffer.resize(numSamples * m_downmixer.GetOutputNumChannels());
+
+      m_downmixer.Mix(samples, numSamples, m_downmixBuffer.data());
+
+      samples = m_downmixBuffer.data();
+   }
+
+   if (m_resampler.IsActive())
+   {
+      numSamples = static_cast<int>(m_resampler.Process(samples, numSamples, m_resampleBuffer));
+
+      samples = m_resampleBuffer.data();
+   }
+
+   m_processedSampleContainer.PutSamplesInterleaved(samples, numSamples);
+
+   return numSamples;
+}
+
+bool EncoderImpl::FlushResampler()
+{
+   int numSamples = static_cast<int>(m_resampler.Flush(m_resampleBuffer));
+   if (numSamples == 0)
+      return true;
+
+   m_processedSampleContainer.PutSamplesInterleaved(m_resampleBuffer.data(), numSamples);
+
+   int ret = m_outputModule->EncodeSamples(m_processedSampleContainer);
+   if (ret < 0)
+   {
+      HandleError(m_encoderSettings.m_inputFilename, m_outputModule->GetModuleName(),
+         -ret, m_outputModule->GetLastError());
+
+      m_encoderState.m_errorCode = 4;
+      return false;
+   }
+
    return true;
 }
 
@@ -319,10 +521,15 @@ bool EncoderImpl::PrepareOutputModule()
 }
 
 CString EncoderImpl::GetOutputFilenameByInputTitle(const CString& outputPath, const CString& inputTitle, OutputModule& outputModule)
+{
+   return GetOutputFilenameByInputTitle(outputPath, inputTitle, outputModule.GetOutputExtension());
+}
+
+CString EncoderImpl::GetOutputFilenameByInputTitle(const CString& outputPath, const CString& inputTitle, const CString& outputExtension)
 {
    CString outputFilename = Path::Combine(outputPath, inputTitle);
 
-   outputFilename += _T(".") + outputModule.GetOutputExtension();
+   outputFilename += _T(".") + outputExtension;
 
    return outputFilename;
 }
@@ -386,23 +593,13 @@ void EncoderImpl::GenerateTempOutFilename(const CString& originalFilename, CStri
 {
    LightweightMutex::LockType lock(s_mutexTempOutputFile);
 
-   tempFilename = originalFilename;
-
-   CString pathName = Path::FolderName(originalFilename);
-   CString fileName = Path::FilenameAndExt(originalFilename);
-
-   // find short name of path
-   CString shortPathName = Path::ShortPathName(pathName);
-
-   // convert filename to ansi and back, and remove '?' chars
-   fileName = CString(CStringA(fileName));
-   fileName.Replace(_T('?'), _T('_'));
+   CString tempFilenameBase = GetTempOutFilenameBase(originalFilename);
 
-   // now add a ".part" suffix
+   // now add a ".temp" suffix
    unsigned int fileIndex = 0;
    do
    {
-      tempFilename = Path::Combine(shortPathName, fileName);
+      tempFilename = tempFilenameBase;
       if (fileIndex == 0)
          tempFilename += _T(".temp");
       else
@@ -420,11 +617,60 @@ void EncoderImpl::GenerateTempOutFilename(const CString& originalFilename, CStri
       fclose(fd);
 }
 
+CString EncoderImpl::GetTempOutFilenameBase(const CString& originalFilename)
+{
+   CString pathName = Path::FolderName(originalFilename);
+   CString fileName = Path::FilenameAndExt(originalFilename);
+
+   // find short name of path
+   CString shortPathName = Path::ShortPathName(pathName);
+
+   // convert filename to ansi and back, and remove '?' chars
+   fileName = CString(CStringA(fileName));
+   fileName.Replace(_T('?'), _T('_'));
+
+   return Path::Combine(shortPathName, fileName);
+}
+
+void EncoderImpl::DeleteTempOutFiles(const CString& outputFilename)
+{
+   LightweightMutex::LockType lock(s_mutexTempOutputFile);
+
+   CString tempFilenameBase = GetTempOutFilenameBase(outputFilename);
+
+   DeleteFile(tempFilenameBase + _T(".temp"));
+
+   // also delete all numbered temp files, e.g. "file.mp3.1.temp"
+   WIN32_FIND_DATA findData = { 0 };
+   HANDLE findHandle = FindFirstFile(tempFilenameBase + _T(".*.temp"), &findData);
+   if (findHandle == INVALID_HANDLE_VALUE)
+      return;
+
+   CString folderName = Path::FolderName(tempFilenameBase);
+   CString prefix = Path::FilenameAndExt(tempFilenameBase) + _T(".");
+
+   do
+   {
+      CString fileIndex(findData.cFileName);
+      if (fileIndex.Find(prefix) != 0)
+         continue;
+
+      fileIndex = fileIndex.Mid(prefix.GetLength());
+      fileIndex = fileIndex.Left(fileIndex.GetLength() - 5); // remove ".temp"
+
+      if (!fileIndex.IsEmpty() && fileIndex.SpanIncluding(_T("0123456789")) == fileIndex)
+         DeleteFile(Path::Combine(folderName, findData.cFileName));
+
+   } while (FindNextFile(findHandle, &findData));
+
+   FindClose(findHandle);
+}
+
 bool EncoderImpl::InitOutputModule(const CString& tempOutputFilename, TrackInfo& trackInfo)
 {
    // init output module
    int res = m_outputModule->InitOutput(tempOutputFilename, *m_settingsManager,
-      trackInfo, m_sampleContainer);
+      trackInfo, GetOutputSampleContainer());
 
    // catch errors
    if (res < 0)
@@ -449,12 +695,14 @@ void EncoderImpl::FormatEncodingDescription()
    // get sample container description
    containerInfo.Format(
       _T("Sample Container: ")
-      _T("Input: %i bit, %i channels, sample rate %i Hz, ")
-      _T("Output: %i bit\r\n"),
+      _T("Input: %i bit%s, %i channels, sample rate %i Hz, ")
+      _T("Output: %i bit%s\r\n"),
       m_sampleContainer.GetInputModuleBitsPerSample(),
+      m_sampleContainer.IsInputModuleFloat() ? _T(" float") : _T(""),
       m_sampleContainer.GetInputModuleChannels(),
       m_sampleContainer.GetInputModuleSampleRate(),
-      m_sampleContainer.GetOutputModuleBitsPerSample());
+      m_sampleContainer.GetOutputModuleBitsPerSample(),
+      m_sampleContainer.IsOutputModuleFloat() ? _T(" float") : _T(""));
 #endif
 
    m_encoderState.m_encodingDescription.Format(
@@ -495,7 +743,12 @@ bool EncoderImpl::MainLoop()
 
       // no more samples?
       if (ret == 0)
+      {
+         if (m_resampler.IsActive() && !FlushResampler())
+            skipFile = true;
+
          break;
+      }
 
       // catch errors
       if (ret < 0)
@@ -512,8 +765,12 @@ bool EncoderImpl::MainLoop()
       // get percent done
       m_encoderState.m_percent = m_inputModule->PercentDone();
 
+      // the resampler may not produce output samples for small chunks; passing no samples
+      // would signal the end of the stream to some output modules, e.g. Ogg Vorbis
+      bool hasSamples = !IsProcessingSamples() || ProcessSamples() > 0;
+
       // stuff all samples received into output module
-      ret = m_outputModule->EncodeSamples(m_sampleContainer);
+      ret = hasSamples ? m_outputModule->EncodeSamples(GetOutputSampleContainer()) : 0;
 
       // catch errors
       if (ret < 0)
@@ -539,6 +796,87 @@ bool EncoderImpl::MainLoop()
    return skipFile;
 }
 
+unsigned int EncoderImpl::EncodeGaplessContext(const CString& inputFilename, bool useEnd)
+{
+   ModuleManagerImpl* modimpl = reinterpret_cast<ModuleManagerImpl*>(&m_moduleManager);
+   std::unique_ptr<InputModule> inputModule(modimpl->ChooseInputModule(inputFilename));
+   if (inputModule == nullptr)
+      return 0;
+
+   int samplerateInHz = m_sampleContainer.GetInputModuleSampleRate();
+   int numChannels = m_sampleContainer.GetInputModuleChannels();
+   int bitsPerSample = m_sampleContainer.GetOutputModuleBitsPerSample();
+   bool isFloat = m_sampleContainer.IsOutputModuleFloat();
+
+   size_t bytesPerSample = numChannels * (bitsPerSample >> 3);
+   size_t maxContextBytes = c_numGaplessContextSamples * bytesPerSample;
+
+   TrackInfo trackInfo;
+   SampleContainer contextSamples;
+   std::vector<unsigned char> contextData;
+
+   int ret = inputModule->InitInput(inputFilename, *m_settingsManager, trackInfo, contextSamples);
+
+   // samples of tracks with another format can't be encoded together with this track
+   if (ret >= 0 &&
+      contextSamples.GetInputModuleSampleRate() == samplerateInHz &&
+      contextSamples.GetInputModuleChannels() == numChannels)
+   {
+      contextSamples.SetOutputModuleTraits(bitsPerSample, SamplesInterleaved, -1, -1, isFloat);
+
+      // modules that can seek only decode the last frames of the track
+      if (useEnd)
+         inputModule->SeekToEnd(c_numGaplessContextSamples);
+
+      do
+      {
+         ret = inputModule->DecodeSamples(contextSamples);
+         if (ret <= 0)
+            break;
+
+         int numSamples = 0;
+         unsigned char* samples = static_cast<unsigned char*>(contextSamples.GetSamplesInterleaved(numSamples));
+
+         contextData.insert(contextData.end(), samples, samples + numSamples * bytesPerSample);
+
+         // when the module couldn't seek, the whole track is decoded; keep only the last samples
+         if (useEnd && contextData.size() > 2 * maxContextBytes)
+            contextData.erase(contextData.begin(), contextData.end() - maxContextBytes);
+
+      } while (m_encoderState.m_running &&
+         (useEnd || contextData.size() < maxContextBytes));
+   }
+
+   inputModule->DoneInput();
+
+   // when the end of the track couldn't be decoded, the samples don't fit to this track
+   if (useEnd && ret != 0)
+      return 0;
+
+   if (contextData.size() > maxContextBytes)
+   {
+      if (useEnd)
+         contextData.erase(contextData.begin(), contextData.end() - maxContextBytes);
+      else
+         contextData.resize(maxContextBytes);
+   }
+
+   int numContextSamples = static_cast<int>(contextData.size() / bytesPerSample);
+   if (numContextSamples == 0)
+      return 0;
+
+   // the samples already have the output module's format
+   SampleContainer outputSamples;
+   outputSamples.SetInputModuleTraits(bitsPerSample, SamplesInterleaved, samplerateInHz, numChannels, isFloat);
+   outputSamples.SetOutputModuleTraits(bitsPerSample, SamplesInterleaved, -1, -1, isFloat);
+   outputSamples.PutSamplesInterleaved(contextData.data(), numContextSamples);
+
+   if (m_outputModule->EncodeSamples(outputSamples) < 0)
+      return 0;
+
+   return static_cast<unsigned int>(numContextSamples);
+}
+
 void EncoderImpl::WritePlaylistEntry(const CString& outputFilename)
 {
    CString playlistPathAndFilename = Path::Combine(m_encoderSettings.m_outputFolder, m_encoderSettings.m_playlistFilename);
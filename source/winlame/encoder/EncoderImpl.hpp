@@ -30,6 +30,8 @@
 #include <mutex>
 #include "EncoderState.hpp"
 #include "EncoderSettings.hpp"
+#include "Downmixer.hpp"
+#include "Resampler.hpp"
 
 namespace Encoder
 {
@@ -87,6 +89,9 @@ namespace Encoder
       /// creates output filename from input title (for reading CDs)
       static CString GetOutputFilenameByInputTitle(const CString& outputPath, const CString& inputTitle, OutputModule& outputModule);
 
+      /// creates output filename from input title and output file extension
+      static CString GetOutputFilenameByInputTitle(const CString& outputPath, const CString& inputTitle, const CString& outputExtension);
+
       /// creates output filename from input filename
       static CString GetOutputFilename(const CString& outputPath, const CString& inputFilename, OutputModule& outputModule);
 
@@ -96,6 +101,10 @@ namespace Encoder
       /// returns if output module with given id is lossy
       static bool IsLossyOutputModule(int outputModuleID);
 
+      /// deletes temporary output files for given output filename, left over from an encoding
+      /// that was interrupted
+      static void DeleteTempOutFiles(const CString& outputFilename);
+
    protected:
       /// encodes using encoder settings
       void Encode();
@@ -103,6 +112,25 @@ namespace Encoder
       /// prepares input module for work
       bool PrepareInputModule(TrackInfo& trackInfo);
 
+      /// \brief sets up the downmix and resample stages, when enabled in the settings
+      /// \details when processing samples, the input module's samples are converted to float,
+      /// downmixed and/or resampled, and passed to the output module using the processed
+      /// sample container; returns false when the resampler can't be set up
+      bool PrepareSampleProcessing();
+
+      /// returns if the decoded samples are downmixed or resampled
+      bool IsProcessingSamples() const { return m_downmixer.IsActive() || m_resampler.IsActive(); }
+
+      /// returns sample container that passes the samples to the output module
+      SampleContainer& GetOutputSampleContainer();
+
+      /// downmixes and/or resamples the decoded samples into the processed sample container;
+      /// returns number of processed samples, which may be 0 when resampling small chunks
+      int ProcessSamples();
+
+      /// encodes the samples still buffered in the resampler; returns false on errors
+      bool FlushResampler();
+
       /// prepares output module for work; step 1 of 2; see InitOutputModule()
       bool PrepareOutputModule();
 
@@ -113,6 +141,9 @@ namespace Encoder
       /// generates temporary output filename
       void GenerateTempOutFilename(const CString& originalFilename, CString& tempFilename);
 
+      /// returns temporary output filename for given original filename, without ".temp" suffix
+      static CString GetTempOutFilenameBase(const CString& originalFilename);
+
       /// inits output module; step 2 of 2; see PrepareOutputModule()
       bool InitOutputModule(const CString& tempOutputFilename, TrackInfo& trackInfo);
 
@@ -122,6 +153,13 @@ namespace Encoder
       /// main encoding loop; returns if file should be skipped
       bool MainLoop();
 
+      /// \brief encodes samples of a neighbour track, when encoding gapless tracks in parallel
+      /// \param inputFilename input file of the neighbour track
+      /// \param useEnd when true, the end of the neighbour track is encoded, else the start
+      /// \return number of samples encoded; 0 when the neighbour track couldn't be decoded or
+      /// has another sample rate or number of channels
+      unsigned int EncodeGaplessContext(const CString& inputFilename, bool useEnd);
+
       /// writes playlist entry
       void WritePlaylistEntry(const CString& outputFilename);
 
@@ -161,6 +199,21 @@ namespace Encoder
       /// sample container
       SampleContainer m_sampleContainer;
 
+      /// downmixer for the decoded samples; only active when downmixing
+      Downmixer m_downmixer;
+
+      /// resampler for the decoded samples; only active when resampling
+      Resampler m_resampler;
+
+      /// sample container for the downmixed and/or resampled samples
+      SampleContainer m_processedSampleContainer;
+
+      /// buffer for the downmixed samples
+      std::vector<float> m_downmixBuffer;
+
+      /// buffer for the resampled samples
+      std::vector<float> m_resampleBuffer;
+
       /// mutex to protect encoder state
       mutable std::recursive_mutex m_mutex;
 
@@ -42,6 +42,14 @@ namespace Encoder
       /// the input file
       bool m_useTrackInfo;
 
+      /// input file of the previous track, when encoding gapless tracks in parallel; the end
+      /// of its audio is encoded before this track, and trimmed again by the decoder
+      CString m_gaplessPreviousInputFilename;
+
+      /// input file of the next track, when encoding gapless tracks in parallel; the start
+      /// of its audio is encoded after this track, and trimmed again by the decoder
+      CString m_gaplessNextInputFilename;
+
       /// default ctor
       EncoderSettings()
          :m_outputSameFolder(false),
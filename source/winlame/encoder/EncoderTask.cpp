@@ -25,14 +25,29 @@
 using Encoder::EncoderTask;
 using Encoder::EncoderTaskSettings;
 
+/// estimated memory usage of the decoder and encoder states, without the sample buffers
+const size_t c_encoderBaseMemoryUsage = 32 * 1024 * 1024;
+
+/// number of channels assumed for the estimate, since the input file isn't opened before encoding
+const size_t c_estimateNumChannels = 2;
+
+/// number of samples per channel decoded at once, when no input module is found for the file
+const size_t c_estimateMaxNumDecodedSamples = 65536;
+
+/// lowest input sample rate assumed for estimating the resampler's output buffers
+const int c_estimateMinInputSampleRate = 22050;
+
 EncoderTask::EncoderTask(unsigned int dependentTaskId, const EncoderTaskSettings& settings)
    :Task(dependentTaskId),
    m_settings(settings),
-   m_stopped(false)
+   m_stopped(false),
+   m_estimatedMemoryUsage(0)
 {
    EncoderImpl::SetEncoderSettings(m_settings);
 
    EncoderImpl::SetSettingsManager(&m_settings.m_settingsManager);
+
+   m_estimatedMemoryUsage = CalcEstimatedMemoryUsage();
 }
 
 CString EncoderTask::GenerateOutputFilename(const CString& inputTitle)
@@ -54,6 +69,61 @@ CString EncoderTask::GenerateOutputFilename(const CString& inputTitle)
    return EncoderImpl::GetEncoderSettings().m_outputFilename;
 }
 
+size_t EncoderTask::EstimatedMemoryUsage() const
+{
+   return m_estimatedMemoryUsage;
+}
+
+size_t EncoderTask::CalcEstimatedMemoryUsage() const
+{
+   Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
+   Encoder::ModuleManagerImpl& modImpl = reinterpret_cast<Encoder::ModuleManagerImpl&>(moduleManager);
+
+   // the input module determines how many samples are decoded and processed at once
+   size_t inputBufferMemoryUsage = 0;
+   size_t maxNumDecodedSamples = c_estimateMaxNumDecodedSamples;
+
+   std::unique_ptr<Encoder::InputModule> inputModule(modImpl.ChooseInputModule(m_settings.m_inputFilename));
+   if (inputModule != nullptr)
+      inputModule->EstimateDecodingMemoryUsage(inputBufferMemoryUsage, maxNumDecodedSamples);
+
+   // samples are stored as 32-bit values; the sample container stores the decoded block and
+   // the block converted for the output module
+   size_t blockSize = maxNumDecodedSamples * c_estimateNumChannels * sizeof(int);
+   size_t memoryUsage = c_encoderBaseMemoryUsage + inputBufferMemoryUsage + 2 * blockSize;
+
+   bool isDownmixing = m_settings.m_settingsManager.QueryValueInt(GeneralDownmixChannels) > 0;
+   int resampleRate = m_settings.m_settingsManager.QueryValueInt(GeneralResampleRate);
+
+   // downmix buffer
+   if (isDownmixing)
+      memoryUsage += blockSize;
+
+   // the resampler's history keeps about one block of input samples, and its output buffer
+   // stores the resampled block
+   size_t processedBlockSize = blockSize;
+   if (resampleRate > c_estimateMinInputSampleRate)
+      processedBlockSize = static_cast<size_t>(blockSize * (double(resampleRate) / c_estimateMinInputSampleRate));
+
+   if (resampleRate > 0)
+      memoryUsage += blockSize + processedBlockSize;
+
+   // the processed samples are stored in another sample container
+   if (isDownmixing || resampleRate > 0)
+      memoryUsage += processedBlockSize;
+
+   std::unique_ptr<Encoder::OutputModule> outputModule(modImpl.GetOutputModule(m_settings.m_outputModuleID));
+   if (outputModule != nullptr)
+      memoryUsage += outputModule->EstimatedBufferMemoryUsage(processedBlockSize);
+
+   // binary infos (e.g. cover art) are additionally copied by the input module's track info
+   // and by the output module when writing tags
+   memoryUsage += 3 * m_settings.m_trackInfo.BinaryInfosSize();
+
+   // the estimate is rough; add a margin for allocations that aren't accounted for
+   return memoryUsage + memoryUsage / 4;
+}
+
 TaskInfo EncoderTask::GetTaskInfo()
 {
    TaskInfo info(Id(), TaskInfo::taskEncoding);
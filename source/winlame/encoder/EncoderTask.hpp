@@ -63,16 +63,27 @@ namespace Encoder
       /// task should be aborted, e.g. when program is closed
       virtual void Stop();
 
+      /// \brief returns estimated peak memory usage of the running task, in bytes
+      /// \details the estimate is a rough heuristic, calculated from the sample buffers of the
+      /// input module, the processing stages and the output module, with a margin
+      virtual size_t EstimatedMemoryUsage() const;
+
       /// output filename for this task
       const CString& OutputFilename() const { return EncoderImpl::GetEncoderSettings().m_outputFilename; }
 
       /// generates output filename for this task
       CString GenerateOutputFilename(const CString& inputTitle);
 
+      /// returns encoder task settings
+      const EncoderTaskSettings& Settings() const { return m_settings; }
+
    private:
       /// checks errors and adds error texts from error handler to task result
       void CheckErrors();
 
+      /// calculates the estimated peak memory usage from the task settings
+      size_t CalcEstimatedMemoryUsage() const;
+
    private:
       /// encoder task settings
       EncoderTaskSettings m_settings;
@@ -82,6 +93,9 @@ namespace Encoder
 
       /// indicates if encoder thread has stopped
       std::atomic<bool> m_stopped;
+
+      /// estimated peak memory usage, in bytes
+      size_t m_estimatedMemoryUsage;
    };
 
 } // namespace Encoder
@@ -35,11 +35,6 @@ using Encoder::TrackInfo;
 using Encoder::SampleContainer;
 using Encoder::FLAC_context;
 
-// constants
-
-/// frame size; default = 4608
-const unsigned int m_flacFrameSize = 576;
-
 // callbacks
 
 static FLAC__StreamDecoderWriteStatus FLAC_WriteCallback(
@@ -50,24 +45,22 @@ static FLAC__StreamDecoderWriteStatus FLAC_WriteCallback(
 {
    FLAC_context* context = (FLAC_context*)clientData;
 
-   const unsigned numChannels = context->streamInfo.channels;
-   const unsigned wide_samples = frame->header.blocksize;
-   unsigned wide_sample, sample, channel;
+   if (context->isSeeking && !context->abortFlag)
+      return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 
-   if (context->abortFlag)
+   if (context->abortFlag || context->samples == nullptr)
       return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
 
-   for (sample = context->numSamplesInReservoir * numChannels, wide_sample = 0;
-      wide_sample < wide_samples;
-      wide_sample++)
-   {
-      for (channel = 0; channel < numChannels; channel++, sample++)
-      {
-         context->reservoir[sample] = buffer[channel][wide_sample];
-      }
-   }
+   // the whole block is passed on directly from libFLAC's channel buffers, which store each
+   // sample in a 32-bit integer
+   const unsigned numSamples = frame->header.blocksize;
+
+   context->samples->PutSamplesArray(
+      reinterpret_cast<void**>(const_cast<FLAC__int32**>(buffer)),
+      numSamples,
+      sizeof(FLAC__int32));
 
-   context->numSamplesInReservoir += wide_samples;
+   context->numDecodedSamples = numSamples;
 
    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
@@ -164,51 +157,11 @@ static void FLAC_ErrorCallback(const FLAC__StreamDecoder* decoder,
       context->abortFlag = true;
 }
 
-/// pack function to store sample data in byte array
-unsigned FLAC__pack_pcm_signed_little_endian(FLAC__byte* data, FLAC__int32* input,
-   unsigned wide_samples, unsigned numChannels, unsigned sourceBitsPerSample)
-{
-   FLAC__byte* const start = data;
-   FLAC__int32 sample;
-   unsigned samples = wide_samples * numChannels;
-   const unsigned bytesPerSample = sourceBitsPerSample / 8;
-
-   while (samples--)
-   {
-      sample = *input++;
-
-      switch (sourceBitsPerSample)
-      {
-      case 8:
-         data[0] = static_cast<FLAC__byte>(sample ^ 0x80);
-         break;
-      case 24:
-         data[2] = (FLAC__byte)(sample >> 16);
-         data[1] = (FLAC__byte)(sample >> 8);
-         data[0] = (FLAC__byte)sample;
-         break;
-      case 16:
-         data[1] = (FLAC__byte)(sample >> 8);
-         data[0] = (FLAC__byte)sample;
-         break;
-      default:
-         ATLASSERT(false); // invalid bits per sample
-         break;
-      }
-
-      data += bytesPerSample;
-   }
-
-   return data - start;
-}
-
-
 FlacInputModule::FlacInputModule()
    :m_fileLength(0),
    m_flacDecoder(nullptr),
    m_flacContext(nullptr),
-   m_samplePosition(0),
-   m_pcmBufferLength(0)
+   m_samplePosition(0)
 {
    m_moduleId = ID_IM_FLAC;
 }
@@ -302,11 +255,6 @@ int FlacInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    m_samplePosition = 0;
    m_flacContext->totalLengthInMs =
       static_cast<unsigned int>(m_flacContext->streamInfo.total_samples * 1000 / m_flacContext->streamInfo.sample_rate);
-   m_pcmBufferLength = (m_flacFrameSize * m_flacContext->streamInfo.channels * m_flacContext->streamInfo.bits_per_sample);
-   m_flacContext->reservoir = new FLAC__int32[m_flacContext->streamInfo.max_blocksize * m_flacContext->streamInfo.channels * 2];
-
-   m_inputBuffer.resize(m_pcmBufferLength);
-
    // set up input traits
    samplecont.SetInputModuleTraits(m_flacContext->streamInfo.bits_per_sample, SamplesChannelArray,
       m_flacContext->streamInfo.sample_rate, m_flacContext->streamInfo.channels);
@@ -322,9 +270,41 @@ void FlacInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengthIn
    samplerateInHz = m_flacContext->streamInfo.sample_rate;
 }
 
+bool FlacInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   // only reads the STREAMINFO block; doesn't need a decoder
+   FLAC__StreamMetadata streamInfo;
+   CStringA ansiFilename{ GetAnsiCompatFilename(filename) };
+
+   if (!FLAC__metadata_get_streaminfo(ansiFilename, &streamInfo) ||
+      streamInfo.data.stream_info.sample_rate == 0)
+      return false;
+
+   const FLAC__StreamMetadata_StreamInfo& stream = streamInfo.data.stream_info;
+
+   info.m_numChannels = stream.channels;
+   info.m_samplerateInHz = stream.sample_rate;
+   info.m_numSamples = stream.total_samples;
+   info.m_lengthInSeconds = static_cast<int>(stream.total_samples / stream.sample_rate);
+
+   struct _stat statbuf;
+   if (stream.total_samples > 0 &&
+      ::_tstat(filename, &statbuf) == 0)
+   {
+      info.m_bitrateInBps = static_cast<int>(
+         statbuf.st_size * 8ULL * stream.sample_rate / stream.total_samples);
+   }
+
+   return true;
+}
+
 int FlacInputModule::DecodeSamples(SampleContainer& samples)
 {
-   while (m_flacContext->numSamplesInReservoir < m_flacFrameSize)
+   m_flacContext->samples = &samples;
+   m_flacContext->numDecodedSamples = 0;
+
+   // decode until the write callback got the next block; metadata blocks produce no samples
+   while (m_flacContext->numDecodedSamples == 0)
    {
       if (FLAC__stream_decoder_get_state(m_flacDecoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
       {
@@ -336,26 +316,40 @@ int FlacInputModule::DecodeSamples(SampleContainer& samples)
       }
    }
 
-   unsigned int numSamples = std::min(m_flacContext->numSamplesInReservoir, m_flacFrameSize);
+   m_flacContext->samples = nullptr;
 
-   FLAC__pack_pcm_signed_little_endian(
-      (unsigned char*)m_inputBuffer.data(),
-      m_flacContext->reservoir,
-      numSamples,
-      m_flacContext->streamInfo.channels,
-      m_flacContext->streamInfo.bits_per_sample);
+   unsigned int numSamples = m_flacContext->numDecodedSamples;
+   m_samplePosition += numSamples;
 
-   unsigned int delta = numSamples * m_flacContext->streamInfo.channels;
-   for (unsigned int i = delta; i < m_flacContext->numSamplesInReservoir * m_flacContext->streamInfo.channels; i++)
-      m_flacContext->reservoir[i - delta] = m_flacContext->reservoir[i];
+   return numSamples;
+}
 
-   m_flacContext->numSamplesInReservoir -= numSamples;
-   m_samplePosition += numSamples;
+bool FlacInputModule::SeekToEnd(unsigned int numSamples)
+{
+   FLAC__uint64 totalSamples = m_flacContext->streamInfo.total_samples;
+   if (totalSamples == 0)
+      return false;
 
-   // copy the samples to the sample container
-   samples.PutSamplesInterleaved(m_inputBuffer.data(), numSamples);
+   // libFLAC passes the rest of the block containing the seek target to the write callback,
+   // which is dropped; seeking one more block back still leaves numSamples to decode
+   FLAC__uint64 numSkipSamples = numSamples + m_flacContext->streamInfo.max_blocksize;
+   FLAC__uint64 startSample = totalSamples > numSkipSamples ? totalSamples - numSkipSamples : 0;
 
-   return numSamples;
+   m_flacContext->isSeeking = true;
+   bool ret = FLAC__stream_decoder_seek_absolute(m_flacDecoder, startSample) != 0;
+
+   if (!ret)
+   {
+      // a failed seek leaves the decoder in an error state; go back to the start
+      FLAC__stream_decoder_flush(m_flacDecoder);
+      FLAC__stream_decoder_seek_absolute(m_flacDecoder, 0);
+      startSample = 0;
+   }
+
+   m_flacContext->isSeeking = false;
+   m_samplePosition = startSample;
+
+   return ret;
 }
 
 float FlacInputModule::PercentDone() const
@@ -375,11 +369,6 @@ void FlacInputModule::DoneInput()
 
    if (m_flacContext)
    {
-      if (m_flacContext->reservoir)
-         delete[] m_flacContext->reservoir;
-
-      m_flacContext->reservoir = nullptr;
-
       delete m_flacContext;
       m_flacContext = nullptr;
    }
@@ -387,7 +376,7 @@ void FlacInputModule::DoneInput()
 
 void FlacInputModule::ReadTrackMetadata(LPCTSTR filename, TrackInfo& trackInfo)
 {
-   AudioFileTag tag{ trackInfo };
+   AudioFileTag tag{ trackInfo, m_spTrackInfoCache };
    tag.ReadFromFile(filename);
 
    // since AudioFileTag (via TagLib library) can't currently read the PICTURE
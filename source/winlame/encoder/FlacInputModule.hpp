@@ -31,18 +31,20 @@ namespace Encoder
    struct FLAC_context
    {
       FLAC__StreamMetadata_StreamInfo streamInfo;  ///< stream info
-      FLAC__int32* reservoir;                      ///< reservoir
-      unsigned int numSamplesInReservoir;          ///< number of samples in reservoir
+      SampleContainer* samples;                    ///< sample container to store decoded block in
+      unsigned int numDecodedSamples;              ///< number of samples in last decoded block
       unsigned int totalLengthInMs;                ///< total length in ms
       bool abortFlag;                              ///< abort flag
+      bool isSeeking;                              ///< set while seeking; decoded blocks are dropped
       TrackInfo* trackInfo;                        ///< track info
 
       /// ctor
       FLAC_context()
-         :reservoir(nullptr),
-         numSamplesInReservoir(0),
+         :samples(nullptr),
+         numDecodedSamples(0),
          totalLengthInMs(0),
          abortFlag(false),
+         isSeeking(false),
          trackInfo(nullptr)
       {
          memset(&streamInfo, 0, sizeof(streamInfo));
@@ -84,9 +86,15 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
+      /// seeks to the last samples of the track
+      virtual bool SeekToEnd(unsigned int numSamples) override;
+
       /// returns the number of percent done
       virtual float PercentDone() const override;
 
@@ -109,14 +117,8 @@ namespace Encoder
       /// flac context
       FLAC_context* m_flacContext;
 
-      /// input buffer
-      std::vector<FLAC__int32> m_inputBuffer;
-
       /// sample position
       FLAC__uint64 m_samplePosition;
-
-      /// buffer length
-      unsigned int m_pcmBufferLength;
    };
 
 } // namespace Encoder
@@ -29,6 +29,36 @@ namespace Encoder
 {
    class TrackInfo;
    class SampleContainer;
+   class AudioFileInfoCache;
+
+   /// audio file infos, as returned by InputModule::Probe()
+   struct ProbeInfo
+   {
+      /// ctor
+      ProbeInfo()
+         :m_numChannels(0),
+         m_samplerateInHz(0),
+         m_numSamples(0),
+         m_bitrateInBps(-1),
+         m_lengthInSeconds(0)
+      {
+      }
+
+      /// number of channels
+      int m_numChannels;
+
+      /// sample rate, in Hz
+      int m_samplerateInHz;
+
+      /// exact number of samples per channel; 0 when the container doesn't store it
+      unsigned long long m_numSamples;
+
+      /// (average) bitrate, in bits per second; -1 when unknown
+      int m_bitrateInBps;
+
+      /// length of audio file, in seconds
+      int m_lengthInSeconds;
+   };
 
    /// input module base class
    class InputModule : public ModuleBase
@@ -50,16 +80,58 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const = 0;
 
+      /// \brief reads audio file infos from the container headers only, without setting up
+      /// the decoder or reading tags
+      /// \details the module must not be initialized with InitInput() when probing; modules
+      /// that can't probe return false, and the caller has to use InitInput() and GetInfo()
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info)
+      {
+         UNUSED(filename);
+         UNUSED(info);
+         return false;
+      }
+
       /// \brief decodes samples and stores them in the sample container
       /// \details returns number of samples decoded, or 0 if finished
       /// a negative value indicates an error
       virtual int DecodeSamples(SampleContainer& samples) = 0;
 
+      /// \brief seeks to the end of the track, so that the following DecodeSamples() calls
+      /// return at least the last numSamples samples of the track, but not much more
+      /// \details must be called after InitInput(), before decoding; modules that can't seek
+      /// return false, and the caller has to decode the whole track
+      virtual bool SeekToEnd(unsigned int numSamples)
+      {
+         UNUSED(numSamples);
+         return false;
+      }
+
       /// returns the number of percent done
       virtual float PercentDone() const { return 0.f; }
 
+      /// \brief estimates the memory used by the module's sample buffers, in bytes, and the
+      /// max. number of samples per channel that one DecodeSamples() call returns
+      /// \details the module isn't initialized with InitInput(), so it assumes stereo samples
+      /// and the largest frames of its format
+      virtual void EstimateDecodingMemoryUsage(size_t& bufferMemoryUsage, size_t& maxNumDecodedSamples) const
+      {
+         bufferMemoryUsage = 0;
+         maxNumDecodedSamples = 65536; // max. block size of FLAC files
+      }
+
       /// called when done with decoding
       virtual void DoneInput() = 0;
+
+      /// \brief sets cache that is used when reading tags, to look up track infos before
+      /// reading the tags, and to store the track infos read; may be nullptr
+      void SetTrackInfoCache(std::shared_ptr<AudioFileInfoCache> spTrackInfoCache)
+      {
+         m_spTrackInfoCache = spTrackInfoCache;
+      }
+
+   protected:
+      /// cache for track infos read from tags; may be nullptr
+      std::shared_ptr<AudioFileInfoCache> m_spTrackInfoCache;
    };
 
 } // namespace Encoder
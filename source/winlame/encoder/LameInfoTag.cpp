@@ -0,0 +1,215 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LameInfoTag.cpp
+/// \brief LAME info tag class
+//
+#include "stdafx.h"
+#include "LameInfoTag.hpp"
+
+using Encoder::LameInfoTag;
+
+/// max. size of an mp3 frame; the free format frame size at 640 kbps, 32 kHz
+const size_t c_maxFrameSize = 2880;
+
+/// offset of the encoder delay and padding values in the LAME extension
+const size_t c_delayAndPaddingOffset = 21;
+
+/// offset of the tag CRC in the LAME extension; the CRC covers all frame bytes before it
+const size_t c_tagCrcOffset = 34;
+
+/// max. value of the 12-bit delay and padding fields
+const unsigned int c_maxDelayOrPadding = 0xFFF;
+
+bool LameInfoTag::GetDelayAndPadding(const std::vector<unsigned char>& frameData,
+   unsigned int& encoderDelay, unsigned int& padding)
+{
+   size_t lameTagOffset = FindLameTagOffset(frameData);
+   if (lameTagOffset == 0)
+      return false;
+
+   const unsigned char* values = frameData.data() + lameTagOffset + c_delayAndPaddingOffset;
+
+   encoderDelay = (values[0] << 4) | (values[1] >> 4);
+   padding = ((values[1] & 0x0F) << 8) | values[2];
+
+   return true;
+}
+
+bool LameInfoTag::GetDelayAndPadding(const CString& mp3Filename,
+   unsigned int& encoderDelay, unsigned int& padding)
+{
+   FILE* fd = _tfopen(mp3Filename, _T("rb"));
+   if (fd == nullptr)
+      return false;
+
+   long frameOffset = 0;
+   std::vector<unsigned char> frameData;
+
+   bool ret =
+      ReadFirstFrame(fd, frameOffset, frameData) &&
+      GetDelayAndPadding(frameData, encoderDelay, padding);
+
+   fclose(fd);
+
+   return ret;
+}
+
+bool LameInfoTag::AddDelayAndPadding(std::vector<unsigned char>& frameData,
+   unsigned int additionalDelay, unsigned int additionalPadding)
+{
+   unsigned int encoderDelay = 0, padding = 0;
+   if (!GetDelayAndPadding(frameData, encoderDelay, padding))
+      return false;
+
+   encoderDelay += additionalDelay;
+   padding += additionalPadding;
+
+   if (encoderDelay > c_maxDelayOrPadding || padding > c_maxDelayOrPadding)
+      return false;
+
+   size_t lameTagOffset = FindLameTagOffset(frameData);
+
+   unsigned char* values = frameData.data() + lameTagOffset + c_delayAndPaddingOffset;
+   values[0] = static_cast<unsigned char>(encoderDelay >> 4);
+   values[1] = static_cast<unsigned char>(((encoderDelay & 0x0F) << 4) | (padding >> 8));
+   values[2] = static_cast<unsigned char>(padding & 0xFF);
+
+   size_t crcOffset = lameTagOffset + c_tagCrcOffset;
+   unsigned short crc = CalcCrc16(frameData.data(), crcOffset);
+
+   frameData[crcOffset] = static_cast<unsigned char>(crc >> 8);
+   frameData[crcOffset + 1] = static_cast<unsigned char>(crc & 0xFF);
+
+   return true;
+}
+
+bool LameInfoTag::AddDelayAndPadding(const CString& mp3Filename,
+   unsigned int additionalDelay, unsigned int additionalPadding)
+{
+   FILE* fd = _tfopen(mp3Filename, _T("r+b"));
+   if (fd == nullptr)
+      return false;
+
+   long frameOffset = 0;
+   std::vector<unsigned char> frameData;
+
+   bool ret =
+      ReadFirstFrame(fd, frameOffset, frameData) &&
+      AddDelayAndPadding(frameData, additionalDelay, additionalPadding);
+
+   if (ret)
+   {
+      // only write back the frame up to the end of the tag
+      size_t tagEndOffset = FindLameTagOffset(frameData) + c_tagCrcOffset + 2;
+
+      ret =
+         fseek(fd, frameOffset, SEEK_SET) == 0 &&
+         fwrite(frameData.data(), 1, tagEndOffset, fd) == tagEndOffset;
+   }
+
+   fclose(fd);
+
+   return ret;
+}
+
+bool LameInfoTag::ReadFirstFrame(FILE* fd, long& frameOffset, std::vector<unsigned char>& frameData)
+{
+   // skip ID3v2 tag, if present
+   frameOffset = 0;
+
+   unsigned char id3v2Header[10] = {};
+   if (fread(id3v2Header, 1, sizeof(id3v2Header), fd) == sizeof(id3v2Header) &&
+      memcmp(id3v2Header, "ID3", 3) == 0)
+   {
+      // tag size is stored as 4 "sync safe" bytes with 7 bits each
+      frameOffset = sizeof(id3v2Header) +
+         (((id3v2Header[6] & 0x7F) << 21) |
+         ((id3v2Header[7] & 0x7F) << 14) |
+         ((id3v2Header[8] & 0x7F) << 7) |
+         (id3v2Header[9] & 0x7F));
+
+      // footer present?
+      if ((id3v2Header[5] & 0x10) != 0)
+         frameOffset += sizeof(id3v2Header);
+   }
+
+   frameData.assign(c_maxFrameSize, 0);
+
+   return
+      fseek(fd, frameOffset, SEEK_SET) == 0 &&
+      fread(frameData.data(), 1, frameData.size(), fd) > 0;
+}
+
+size_t LameInfoTag::FindLameTagOffset(const std::vector<unsigned char>& frameData)
+{
+   if (frameData.size() < 4 ||
+      frameData[0] != 0xFF || (frameData[1] & 0xE0) != 0xE0)
+      return 0; // no frame sync
+
+   // the info tag is stored after the side info, which depends on MPEG version and channel mode
+   bool isMpeg1 = ((frameData[1] >> 3) & 3) == 3;
+   bool isMono = ((frameData[3] >> 6) & 3) == 3;
+   bool hasCrc = (frameData[1] & 1) == 0;
+
+   size_t offset = 4 + (hasCrc ? 2 : 0) +
+      (isMpeg1 ? (isMono ? 17 : 32) : (isMono ? 9 : 17));
+
+   if (offset + 8 > frameData.size() ||
+      (memcmp(frameData.data() + offset, "Xing", 4) != 0 &&
+         memcmp(frameData.data() + offset, "Info", 4) != 0))
+      return 0;
+
+   // skip optional fields, depending on the flags
+   unsigned char flags = frameData[offset + 7];
+   offset += 8;
+
+   if ((flags & 0x01) != 0)
+      offset += 4; // frame count
+
+   if ((flags & 0x02) != 0)
+      offset += 4; // byte count
+
+   if ((flags & 0x04) != 0)
+      offset += 100; // table of contents
+
+   if ((flags & 0x08) != 0)
+      offset += 4; // VBR quality
+
+   if (offset + c_tagCrcOffset + 2 > frameData.size() ||
+      memcmp(frameData.data() + offset, "LAME", 4) != 0)
+      return 0;
+
+   return offset;
+}
+
+unsigned short LameInfoTag::CalcCrc16(const unsigned char* data, size_t length)
+{
+   // CRC-16 with reflected polynomial 0x8005, as used by LAME's CRC_update_lookup()
+   unsigned short crc = 0;
+
+   for (size_t index = 0; index < length; index++)
+   {
+      crc ^= data[index];
+
+      for (int bit = 0; bit < 8; bit++)
+         crc = (crc & 1) != 0 ? static_cast<unsigned short>((crc >> 1) ^ 0xA001) : static_cast<unsigned short>(crc >> 1);
+   }
+
+   return crc;
+}
@@ -0,0 +1,67 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LameInfoTag.hpp
+/// \brief LAME info tag class
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief access to the LAME info tag in the first frame of an mp3 file
+   /// \details The LAME info tag stores the encoder delay and padding, in samples, that
+   /// decoders trim from the start and the end of the decoded audio for gapless playback.
+   class LameInfoTag
+   {
+   public:
+      /// \brief reads encoder delay and padding from the info tag frame
+      /// \param frameData data of the first mp3 frame, containing the info tag
+      /// \param encoderDelay encoder delay, in samples
+      /// \param padding padding, in samples
+      /// \return true when a LAME info tag was found
+      static bool GetDelayAndPadding(const std::vector<unsigned char>& frameData,
+         unsigned int& encoderDelay, unsigned int& padding);
+
+      /// reads encoder delay and padding from the info tag of the given mp3 file
+      static bool GetDelayAndPadding(const CString& mp3Filename,
+         unsigned int& encoderDelay, unsigned int& padding);
+
+      /// \brief adds samples to encoder delay and padding of the info tag frame, and updates
+      /// the tag's checksum
+      /// \return false when no LAME info tag was found, or the values don't fit into the tag
+      static bool AddDelayAndPadding(std::vector<unsigned char>& frameData,
+         unsigned int additionalDelay, unsigned int additionalPadding);
+
+      /// adds samples to encoder delay and padding of the info tag of the given mp3 file
+      static bool AddDelayAndPadding(const CString& mp3Filename,
+         unsigned int additionalDelay, unsigned int additionalPadding);
+
+   private:
+      /// reads first mp3 frame after an ID3v2 tag, if present, and returns the frame's offset
+      static bool ReadFirstFrame(FILE* fd, long& frameOffset, std::vector<unsigned char>& frameData);
+
+      /// returns offset of the LAME extension of the info tag in the frame, or 0 when not found
+      static size_t FindLameTagOffset(const std::vector<unsigned char>& frameData);
+
+      /// calculates CRC-16 checksum of the info tag, like LAME does
+      static unsigned short CalcCrc16(const unsigned char* data, size_t length);
+   };
+
+} // namespace Encoder
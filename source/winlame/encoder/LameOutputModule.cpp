@@ -25,6 +25,7 @@
 #include "resource.h"
 #include "LameOutputModule.hpp"
 #include "LameNogapInstanceManager.hpp"
+#include "LameInfoTag.hpp"
 #include "WaveMp3Header.hpp"
 #include "Id3v1Tag.hpp"
 #include "AudioFileTag.hpp"
@@ -34,16 +35,19 @@ using Encoder::LameOutputModule;
 using Encoder::TrackInfo;
 using Encoder::SampleContainer;
 
+/// size of the output file stream buffer; encoded data is written in chunks of this size
+const size_t c_outputFileBufferSize = 256 * 1024;
+
 LameOutputModule::LameOutputModule()
    :m_instance(nullptr),
    m_writeInfoTag(true),
-   m_inputBufferFill(0),
    m_bufferType(nle_buffer_short),
-   m_inputBufferSize(1152),
    m_nogapEncoding(false),
    m_nogapIsLastFile(false),
    m_nogapInstanceManager(IoCContainer::Current().Resolve<LameNogapInstanceManager>()),
    m_nogapInstanceId(-1),
+   m_numPrerollSamples(0),
+   m_numPostrollSamples(0),
    m_writeWaveHeader(false),
    m_numSamplesEncoded(0),
    m_numDataBytesWritten(0)
@@ -121,6 +125,11 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
       return -1;
    }
 
+   // the buffer must be set after opening the file, but before the first write; the MSVC
+   // implementation ignores a buffer set on a file stream that isn't open yet
+   m_outputFileBuffer.resize(c_outputFileBufferSize);
+   m_outputFile.rdbuf()->pubsetbuf(m_outputFileBuffer.data(), m_outputFileBuffer.size());
+
    // alloc memory for output mp3 buffer
    m_mp3OutputBuffer.resize(nlame_const_maxmp3buffer);
 
@@ -130,8 +139,10 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
    // store track info for ID3v2 tag
    m_trackInfoID3v2 = trackInfo;
 
-   // check if we do nogap encoding
-   m_nogapEncoding = mgr.QueryValueInt(LameOptNoGap) == 1;
+   // check if we do nogap encoding; when encoding gapless tracks in parallel, each track uses
+   // its own instance, and the encoder delay and padding are trimmed by the decoder
+   m_nogapEncoding = mgr.QueryValueInt(LameOptNoGap) == 1 &&
+      mgr.QueryValueInt(LameOptNoGapParallel) == 0;
 
    if (m_nogapEncoding)
    {
@@ -203,11 +214,21 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
 
    // set up output traits
    int bitsPerSample = 16;
+   bool isFloat = false;
    m_bufferType = nle_buffer_short;
 
-   // beginning with version 6 of the nLAME API, the encoder really can handle 32-bit
-   // input samples
-   if (samples.GetInputModuleBitsPerSample() > 16 &&
+   // beginning with version 7 of the nLAME API, float samples can be passed to the encoder
+   // without converting them to integer samples first; beginning with version 6, the
+   // encoder really can handle 32-bit input samples
+   if (samples.IsInputModuleFloat() &&
+      nlame_get_api_version() >= 7 &&
+      nlame_var_get_int(m_instance, nle_var_is_avail_encode_buffer_ieee_float) == 1)
+   {
+      bitsPerSample = 32;
+      isFloat = true;
+      m_bufferType = nle_buffer_ieee_float;
+   }
+   else if (samples.GetInputModuleBitsPerSample() > 16 &&
       nlame_get_api_version() >= 6 &&
       nlame_var_get_int(m_instance, nle_var_is_avail_encode_buffer_interleaved_int) == 1)
    {
@@ -215,17 +236,7 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
       m_bufferType = nle_buffer_int;
    }
 
-   samples.SetOutputModuleTraits(bitsPerSample, SamplesInterleaved);
-
-   // retrieve framesize from LAME encoder; varies from MPEG version and layer number
-   int frameSize = nlame_var_get_int(m_instance, nle_var_framesize);
-   if (frameSize <= 0)
-      return -1;
-
-   m_inputBufferSize = static_cast<unsigned int>(frameSize);
-
-   m_inputBuffer.resize(m_inputBufferSize * m_channels * (bitsPerSample >> 3));
-   m_inputBufferFill = 0;
+   samples.SetOutputModuleTraits(bitsPerSample, SamplesInterleaved, -1, -1, isFloat);
 
    m_numSamplesEncoded = 0;
    m_numDataBytesWritten = 0;
@@ -244,30 +255,36 @@ int LameOutputModule::InitOutput(LPCTSTR outfilename,
    return 0;
 }
 
-/// encodes exactly one frame, consisting of 576 samples per channel. this is
-/// done due to the fact that LAME expects that number of samples, or it will
-/// produce different output, e.g. when feeding less than 576 samples per call
-/// to nlame_encode_buffer_*().
-int LameOutputModule::EncodeFrame()
+/// encodes all samples of the buffer with a single call; LAME buffers samples internally
+/// until a whole frame can be encoded, so the number of samples passed doesn't change the
+/// output.
+int LameOutputModule::EncodeBuffer(void* samples, int numSamples)
 {
    if (m_mp3OutputBuffer.empty())
       return -1;
 
+   if (numSamples <= 0)
+      return 0;
+
+   // worst case size of the encoded data, as documented for lame_encode_buffer()
+   size_t maxEncodedSize = static_cast<size_t>(numSamples) + numSamples / 4 + 7200;
+   if (m_mp3OutputBuffer.size() < maxEncodedSize)
+      m_mp3OutputBuffer.resize(maxEncodedSize);
+
    // encode buffer
    int ret;
    if (m_channels == 1)
    {
       ret = nlame_encode_buffer_mono(m_instance, m_bufferType,
-         m_inputBuffer.data(), m_inputBufferFill, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
+         samples, numSamples, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
    }
    else
    {
       ret = nlame_encode_buffer_interleaved(m_instance, m_bufferType,
-         m_inputBuffer.data(), m_inputBufferFill, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
+         samples, numSamples, m_mp3OutputBuffer.data(), m_mp3OutputBuffer.size());
    }
 
-   m_numSamplesEncoded += m_inputBufferFill;
-   m_inputBufferFill = 0;
+   m_numSamplesEncoded += numSamples;
 
    // error?
    if (ret < 0)
@@ -283,41 +300,19 @@ int LameOutputModule::EncodeFrame()
    return ret;
 }
 
+bool LameOutputModule::PrefersFloatSamples() const
+{
+   return nlame_get_api_version() >= 7 &&
+      nlame_var_get_int(nullptr, nle_var_is_avail_encode_buffer_ieee_float) == 1;
+}
+
 int LameOutputModule::EncodeSamples(SampleContainer& samples)
 {
    // get samples
    int numSamples = 0;
-   unsigned char* sampleBuffer = (unsigned char*)samples.GetSamplesInterleaved(numSamples);
-
-   unsigned int sampleBufferCount = 0;
-
-   int ret = 0;
-   int sampleSizeInBytes = samples.GetOutputModuleBitsPerSample() >> 3;
-   do
-   {
-      unsigned int fillsize = std::min(m_inputBufferSize - m_inputBufferFill, static_cast<unsigned int>(numSamples));
-
-      // copy samples into inbuffer; note: m_inputBufferFill is counted in "samples"
-      memcpy(
-         m_inputBuffer.data() + m_inputBufferFill * m_channels * sampleSizeInBytes,
-         sampleBuffer + sampleBufferCount * m_channels * sampleSizeInBytes,
-         fillsize * m_channels * sampleSizeInBytes);
-
-      m_inputBufferFill += fillsize;
-      numSamples -= fillsize;
-      sampleBufferCount += fillsize;
-
-      if (m_inputBufferFill == m_inputBufferSize)
-      {
-         // encode one frame
-         ret = EncodeFrame();
-         if (ret < 0)
-            break;
-      }
-
-   } while (numSamples > 0);
+   void* sampleBuffer = samples.GetSamplesInterleaved(numSamples);
 
-   return ret;
+   return EncodeBuffer(sampleBuffer, numSamples);
 }
 
 void LameOutputModule::FlushOutputBuffer()
@@ -343,11 +338,8 @@ void LameOutputModule::FlushOutputBuffer()
    }
 }
 
-void LameOutputModule::FinishEncoding()
+int LameOutputModule::FinishEncoding()
 {
-   // encode remaining samples, if any
-   EncodeFrame();
-
    FlushOutputBuffer();
 
    // write ID3v1 tag when available
@@ -380,7 +372,17 @@ void LameOutputModule::FinishEncoding()
    //       file, the wave header might get overwritten, so we don't write a
    //       info tag when writing a wave header
    if (m_writeInfoTag && !m_writeWaveHeader)
+   {
       WriteVBRInfoTag(m_instance, m_mp3Filename);
+
+      // without the gapless context in the info tag, the neighbour tracks' samples would be
+      // played back, so the file is unusable
+      if ((m_numPrerollSamples > 0 || m_numPostrollSamples > 0) &&
+         !AddGaplessContextToInfoTag())
+         return -1;
+   }
+
+   return 0;
 }
 
 void LameOutputModule::FreeLameInstance()
@@ -400,20 +402,28 @@ void LameOutputModule::FreeLameInstance()
    }
    else
    {
-      // free nlame instance
+      // free nlame instance; an instance that was flushed with nlame_encode_flush() can't be
+      // reused for the next file, even with the same parameters: nlame_reinit_bitstream() only
+      // resets the bitstream, but LAME keeps the padding samples still buffered, and doesn't
+      // account for the encoder delay again, so the next file would start with a different
+      // delay and would lose samples at the end. Only nogap encoding reuses instances, since
+      // the files are continued with nlame_encode_flush_nogap().
       nlame_delete(m_instance);
    }
 }
 
-void LameOutputModule::DoneOutput()
+int LameOutputModule::DoneOutput()
 {
+   int ret = 0;
    if (m_outputFile.is_open())
-      FinishEncoding();
+      ret = FinishEncoding();
 
    if (m_instance != nullptr)
       FreeLameInstance();
 
    m_instance = nullptr;
+
+   return ret;
 }
 
 int LameOutputModule::SetEncodingParameters(SettingsManager& mgr)
@@ -526,7 +536,7 @@ void LameOutputModule::GenerateDescription(SettingsManager& mgr)
       value == nle_mode_joint_stereo ? _T("Joint Stereo") : _T("Mono"));
 
    // nogap option
-   if (m_nogapEncoding)
+   if (mgr.QueryValueInt(LameOptNoGap) == 1)
       text += _T(", gapless encoding");
 
    m_description = text;
@@ -659,3 +669,29 @@ void LameOutputModule::WriteVBRInfoTag(nlame_instance_t* instance, LPCTSTR mp3Fi
       fclose(fp);
    }
 }
+
+bool LameOutputModule::AddGaplessContextToInfoTag()
+{
+   // the info tag stores delay and padding in output samples
+   int outputSamplerate = nlame_var_get_int(m_instance, nle_var_out_samplerate);
+   if (outputSamplerate <= 0 || m_samplerate <= 0)
+   {
+      m_lastError = _T("couldn't determine samplerate to trim gapless encoding context");
+      return false;
+   }
+
+   unsigned int additionalDelay = static_cast<unsigned int>(
+      (static_cast<ULONGLONG>(m_numPrerollSamples) * outputSamplerate + m_samplerate / 2) / m_samplerate);
+
+   unsigned int additionalPadding = static_cast<unsigned int>(
+      (static_cast<ULONGLONG>(m_numPostrollSamples) * outputSamplerate + m_samplerate / 2) / m_samplerate);
+
+   if (!LameInfoTag::AddDelayAndPadding(m_mp3Filename, additionalDelay, additionalPadding))
+   {
+      m_lastError.Format(_T("couldn't add gapless delay %u and padding %u to info tag of file %s"),
+         additionalDelay, additionalPadding, m_mp3Filename.GetString());
+      return false;
+   }
+
+   return true;
+}
@@ -64,11 +64,28 @@ namespace Encoder
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
 
+      /// returns if the output module prefers float samples; LAME encodes float samples
+      /// without conversion, when the library supports it
+      virtual bool PrefersFloatSamples() const override;
+
       /// encodes samples from the sample container
       virtual int EncodeSamples(SampleContainer& samples) override;
 
       /// cleans up the output module
-      virtual void DoneOutput() override;
+      virtual int DoneOutput() override;
+
+      /// returns if samples of neighbour tracks can be trimmed using the VBR info tag
+      bool CanTrimGaplessContext() const { return m_writeInfoTag && !m_writeWaveHeader; }
+
+      /// \brief sets number of samples of neighbour tracks that were encoded before and after
+      /// the track, when encoding gapless tracks in parallel
+      /// \details the samples are added to the encoder delay and padding values of the LAME
+      /// info tag, so that decoders trim them again; must be called before DoneOutput()
+      void SetGaplessContextSamples(unsigned int numPrerollSamples, unsigned int numPostrollSamples)
+      {
+         m_numPrerollSamples = numPrerollSamples;
+         m_numPostrollSamples = numPostrollSamples;
+      }
 
    private:
       /// sets all encoding parameters from settings
@@ -77,14 +94,15 @@ namespace Encoder
       /// generatse a description text
       void GenerateDescription(SettingsManager& mgr);
 
-      /// encodes one frame
-      int EncodeFrame();
+      /// encodes interleaved samples, directly from the given buffer, and writes out the
+      /// encoded data
+      int EncodeBuffer(void* samples, int numSamples);
 
       /// flushes LAME output buffer without encoding more samples
       void FlushOutputBuffer();
 
       /// finishes encoding by flushing buffer and writing out last frames
-      void FinishEncoding();
+      int FinishEncoding();
 
       /// frees LAME instance (or stores it for next NoGap encoding)
       void FreeLameInstance();
@@ -101,10 +119,16 @@ namespace Encoder
       /// Writes VBR Info tag
       static void WriteVBRInfoTag(nlame_instance_t* inst, LPCTSTR mp3filename);
 
+      /// adds encoded samples of neighbour tracks to the delay and padding in the VBR info tag
+      bool AddGaplessContextToInfoTag();
+
    private:
       /// nlame instance
       nlame_instance_t* m_instance;
 
+      /// buffer of the output file stream; declared before the stream, so that it outlives it
+      std::vector<char> m_outputFileBuffer;
+
       /// output file stream
       std::ofstream m_outputFile;
 
@@ -117,16 +141,7 @@ namespace Encoder
       /// encode buffer type
       nlame_encode_buffer_type m_bufferType;
 
-      /// current input buffer size for LAME
-      unsigned int m_inputBufferSize;
-
-      /// LAME input buffer
-      std::vector<unsigned char> m_inputBuffer;
-
-      /// inbuffer filled indicator
-      unsigned int m_inputBufferFill;
-
-      /// mp3 output buffer
+      /// mp3 output buffer; grows with the number of samples encoded at once
       std::vector<unsigned char> m_mp3OutputBuffer;
 
       /// last error occured
@@ -153,6 +168,12 @@ namespace Encoder
       /// nogap instance ID
       int m_nogapInstanceId;
 
+      /// number of samples of the previous track encoded before the track, in input samples
+      unsigned int m_numPrerollSamples;
+
+      /// number of samples of the next track encoded after the track, in input samples
+      unsigned int m_numPostrollSamples;
+
       /// indicates if we should write a wave header
       bool m_writeWaveHeader;
 
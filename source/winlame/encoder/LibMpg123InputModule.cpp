@@ -36,7 +36,8 @@ static std::once_flag s_libmpg123init;
 
 LibMpg123InputModule::LibMpg123InputModule()
 :m_isAtEndOfFile(false),
-m_fileSize(0L)
+m_fileSize(0L),
+m_numTotalSamples(0)
 {
    std::call_once(s_libmpg123init, []() { mpg123_init(); });
 
@@ -128,6 +129,24 @@ CString LibMpg123InputModule::GetFilterString() const
    return filterString;
 }
 
+static ssize_t ReadFromFile(void* handle, void* buffer, size_t size)
+{
+   return fread(buffer, 1, size, (FILE*)handle);
+}
+
+static off_t SeekInFile(void* handle, off_t offset, int direction)
+{
+   if (fseek((FILE*)handle, offset, direction) != 0)
+      return (off_t)-1;
+   return ftell((FILE*)handle);
+}
+
+static void CleanupFile(void* handle)
+{
+   // don't fclose the handle here, since the shared_ptr owning the file will do that for us
+   UNUSED(handle);
+}
+
 int LibMpg123InputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    TrackInfo& trackInfo, SampleContainer& samples)
 {
@@ -161,12 +180,14 @@ int LibMpg123InputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
    if (!OpenStream())
       return -1;
 
-   if (!SetupDecoder())
+   if (!SetupDecoder(samples.OutputModulePrefersFloat()))
       return -1;
 
    if (!SetFormat(samples))
       return -1;
 
+   ScanStream();
+
    return 0;
 }
 
@@ -184,17 +205,76 @@ void LibMpg123InputModule::GetInfo(int& numChannels, int& bitrateInBps, int& len
    samplerateInHz = frameInfo.rate;
    numChannels = frameInfo.mode == MPG123_M_MONO ? 1 : 2;
 
-   off_t numTotalSamples = mpg123_length(m_decoder.get());
+   off_t numTotalSamples = m_numTotalSamples != 0 ? m_numTotalSamples : mpg123_length(m_decoder.get());
 
    lengthInSeconds = numTotalSamples / samplerateInHz;
 }
 
+bool LibMpg123InputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   // uses its own file and decoder handles, so that probing doesn't affect a decoder that
+   // was initialized with InitInput()
+   FILE* fd = nullptr;
+   errno_t err = _tfopen_s(&fd, filename, _T("rb"));
+
+   if (err != 0 || fd == nullptr)
+      return false;
+
+   std::shared_ptr<FILE> inputFile(fd, fclose);
+
+   int errorCode = 0;
+   mpg123_handle* handle = mpg123_new(nullptr, &errorCode);
+   if (handle == nullptr || errorCode != MPG123_OK)
+      return false;
+
+   std::shared_ptr<mpg123_handle> decoder(handle, mpg123_delete);
+
+   mpg123_replace_reader_handle(decoder.get(), ReadFromFile, SeekInFile, CleanupFile);
+
+   // only parses the first frame header and the Xing/Info tag, if present; doesn't read
+   // any tags and doesn't scan the whole file
+   long sampleRate = 0;
+   int numChannels = 0;
+   int encoding = 0;
+   mpg123_frameinfo frameInfo;
+
+   bool ret = mpg123_open_handle(decoder.get(), inputFile.get()) == MPG123_OK &&
+      mpg123_getformat(decoder.get(), &sampleRate, &numChannels, &encoding) == MPG123_OK &&
+      mpg123_info(decoder.get(), &frameInfo) == MPG123_OK &&
+      sampleRate != 0;
+
+   if (ret)
+   {
+      off_t numTotalSamples = mpg123_length(decoder.get());
+
+      info.m_numChannels = numChannels;
+      info.m_samplerateInHz = sampleRate;
+      info.m_numSamples = numTotalSamples > 0 ? numTotalSamples : 0;
+      info.m_bitrateInBps = frameInfo.bitrate * 1000;
+      info.m_lengthInSeconds = static_cast<int>(info.m_numSamples / sampleRate);
+   }
+
+   mpg123_close(decoder.get());
+
+   return ret;
+}
+
 int LibMpg123InputModule::DecodeSamples(SampleContainer& samples)
 {
-   unsigned char sampleBuffer[32768];
+   // decode the next frame; the samples are stored in the decoder's own buffer
+   off_t frameNumber = 0;
+   unsigned char* frameSamples = nullptr;
+   size_t bytesDecoded = 0;
+
+   int ret = MPG123_OK;
+   do
+   {
+      ret = mpg123_decode_frame(m_decoder.get(), &frameNumber, &frameSamples, &bytesDecoded);
+
+      // frames may not produce samples, e.g. at the start of gapless streams
+   } while (ret == MPG123_NEW_FORMAT ||
+      (ret == MPG123_OK && bytesDecoded == 0));
 
-   size_t bytesWritten = 0;
-   int ret = mpg123_read(m_decoder.get(), sampleBuffer, sizeof(sampleBuffer), &bytesWritten);
    if (ret != MPG123_OK &&
       ret != MPG123_DONE)
    {
@@ -203,20 +283,35 @@ int LibMpg123InputModule::DecodeSamples(SampleContainer& samples)
       return -1;
    }
 
-   m_isAtEndOfFile = bytesWritten == 0 ||
+   m_isAtEndOfFile = bytesDecoded == 0 ||
       ret == MPG123_DONE;
 
-   if (bytesWritten == 0)
+   if (bytesDecoded == 0)
       return 0;
 
    int sampleSize = samples.GetInputModuleBitsPerSample();
-   int numSamplesPerChannel = bytesWritten / m_channels / (sampleSize / 8);
+   int numSamplesPerChannel = bytesDecoded / m_channels / (sampleSize / 8);
 
-   samples.PutSamplesInterleaved(sampleBuffer, numSamplesPerChannel);
+   samples.PutSamplesInterleaved(frameSamples, numSamplesPerChannel);
 
    return numSamplesPerChannel;
 }
 
+bool LibMpg123InputModule::SeekToEnd(unsigned int numSamples)
+{
+   // the exact length is only known after scanning the stream
+   if (m_numTotalSamples == 0)
+      return false;
+
+   off_t startSample = m_numTotalSamples > off_t(numSamples) ? m_numTotalSamples - numSamples : 0;
+
+   if (mpg123_seek(m_decoder.get(), startSample, SEEK_SET) < 0)
+      return false;
+
+   m_isAtEndOfFile = false;
+   return true;
+}
+
 float LibMpg123InputModule::PercentDone() const
 {
    if (m_decoder == nullptr ||
@@ -228,6 +323,9 @@ float LibMpg123InputModule::PercentDone() const
       m_isAtEndOfFile)
       return 100.0f;
 
+   if (m_numTotalSamples != 0)
+      return float(mpg123_tell(m_decoder.get())) * 100.0f / m_numTotalSamples;
+
    long pos = ftell(m_inputFile.get());
 
    return float(pos) * 100.0f / m_fileSize;
@@ -266,24 +364,6 @@ bool LibMpg123InputModule::GetFileSize()
    return true;
 }
 
-static ssize_t ReadFromFile(void* handle, void* buffer, size_t size)
-{
-   return fread(buffer, 1, size, (FILE*)handle);
-}
-
-static off_t SeekInFile(void* handle, off_t offset, int direction)
-{
-   if (fseek((FILE*)handle, offset, direction) != 0)
-      return (off_t)-1;
-   return ftell((FILE*)handle);
-}
-
-static void CleanupFile(void* handle)
-{
-   // don't fclose the handle here, since m_inputFile will do that for us
-   UNUSED(handle);
-}
-
 bool LibMpg123InputModule::OpenStream()
 {
    mpg123_replace_reader_handle(m_decoder.get(), ReadFromFile, SeekInFile, CleanupFile);
@@ -332,12 +412,26 @@ bool LibMpg123InputModule::GetTrackInfo(const CString& filename, TrackInfo& trac
 
 bool LibMpg123InputModule::GetId3v2TagInfos(const CString& filename, TrackInfo& trackInfo)
 {
-   AudioFileTag tag(trackInfo);
+   AudioFileTag tag(trackInfo, m_spTrackInfoCache);
    return tag.ReadFromFile(filename);
 }
 
-bool LibMpg123InputModule::SetupDecoder()
+/// checks if libmpg123 can decode to given encoding
+static bool IsEncodingSupported(int encoding)
+{
+   const int* encodingsList = nullptr;
+   size_t encodingsListSize = 0;
+   mpg123_encodings(&encodingsList, &encodingsListSize);
+
+   return std::find(encodingsList, encodingsList + encodingsListSize, encoding) != encodingsList + encodingsListSize;
+}
+
+bool LibMpg123InputModule::SetupDecoder(bool floatSamples)
 {
+   int encoding = floatSamples && IsEncodingSupported(MPG123_ENC_FLOAT_32)
+      ? MPG123_ENC_FLOAT_32
+      : MPG123_ENC_SIGNED_32;
+
    mpg123_format_none(m_decoder.get());
 
    const long* ratesList = nullptr;
@@ -347,7 +441,7 @@ bool LibMpg123InputModule::SetupDecoder()
    for (long rate : std::vector<long>(ratesList, ratesList + ratesListSize))
    {
       // only request 32-bit samples
-      int ret = mpg123_format(m_decoder.get(), rate, MPG123_STEREO | MPG123_MONO, MPG123_ENC_SIGNED_32);
+      int ret = mpg123_format(m_decoder.get(), rate, MPG123_STEREO | MPG123_MONO, encoding);
 
       if (ret != MPG123_OK)
       {
@@ -360,6 +454,20 @@ bool LibMpg123InputModule::SetupDecoder()
    return true;
 }
 
+void LibMpg123InputModule::ScanStream()
+{
+   // scanning only reads the frame headers, and returns to the current position afterwards;
+   // without scanning, the length is estimated from the file size or the Xing/Info tag
+   m_numTotalSamples = 0;
+
+   if (mpg123_scan(m_decoder.get()) != MPG123_OK)
+      return;
+
+   off_t numTotalSamples = mpg123_length(m_decoder.get());
+   if (numTotalSamples > 0)
+      m_numTotalSamples = numTotalSamples;
+}
+
 bool LibMpg123InputModule::SetFormat(SampleContainer& samples)
 {
    long sampleRate = 0;
@@ -376,7 +484,10 @@ bool LibMpg123InputModule::SetFormat(SampleContainer& samples)
    m_channels = numChannels;
    m_samplerate = sampleRate;
 
-   samples.SetInputModuleTraits(encoding == MPG123_ENC_SIGNED_32 ? 32 : 16, SamplesInterleaved, m_samplerate, numChannels);
+   bool isFloat = encoding == MPG123_ENC_FLOAT_32;
+
+   samples.SetInputModuleTraits(encoding == MPG123_ENC_SIGNED_32 || isFloat ? 32 : 16, SamplesInterleaved,
+      m_samplerate, numChannels, isFloat);
 
    return true;
 }
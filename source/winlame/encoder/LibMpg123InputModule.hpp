@@ -63,9 +63,15 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
+      /// seeks to the last samples of the track
+      virtual bool SeekToEnd(unsigned int numSamples) override;
+
       /// returns the number of percent done
       virtual float PercentDone() const override;
 
@@ -85,8 +91,12 @@ namespace Encoder
       /// reads ID3v2 tag infos, if available
       bool GetId3v2TagInfos(const CString& filename, TrackInfo& trackInfo);
 
-      /// sets up decoder
-      bool SetupDecoder();
+      /// sets up decoder; decodes to float samples when requested and supported, or to
+      /// 32-bit integer samples
+      bool SetupDecoder(bool floatSamples);
+
+      /// scans the whole stream, for exact length and seeking
+      void ScanStream();
 
       /// sets sample container format
       bool SetFormat(SampleContainer& samples);
@@ -104,6 +114,10 @@ namespace Encoder
       /// handle to the mpg123 decoder
       std::shared_ptr<mpg123_handle> m_decoder;
 
+      /// number of samples in the stream, per channel, determined by scanning the stream;
+      /// 0 when not scanned
+      off_t m_numTotalSamples;
+
       /// indicates if the decoder is at the end of the file
       bool m_isAtEndOfFile;
    };
@@ -0,0 +1,326 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LibraryMirrorManifest.cpp
+/// \brief Library mirror manifest class
+//
+#include "stdafx.h"
+#include "LibraryMirrorManifest.hpp"
+#include "SettingsManager.hpp"
+
+using Encoder::LibraryMirrorManifest;
+
+/// manifest filename, stored in the output root folder
+LPCTSTR c_manifestFilename = _T("winLAME-mirror-manifest.txt");
+
+/// first line of the manifest file, including format version
+LPCTSTR c_manifestHeader = _T("winLAME mirror manifest\t1");
+
+/// number of tab separated fields in a manifest line
+const int c_numManifestLineFields = 6;
+
+/// FNV-1a 64-bit offset basis
+const ULONGLONG c_fnvOffsetBasis = 14695981039346656037ULL;
+
+/// FNV-1a 64-bit prime
+const ULONGLONG c_fnvPrime = 1099511628211ULL;
+
+/// adds bytes to FNV-1a hash value
+static void HashBytes(ULONGLONG& hash, const BYTE* data, size_t length)
+{
+   for (size_t index = 0; index < length; index++)
+   {
+      hash ^= data[index];
+      hash *= c_fnvPrime;
+   }
+}
+
+LibraryMirrorManifest::LibraryMirrorManifest(const CString& outputRootFolder)
+   :m_outputRootFolder(outputRootFolder)
+{
+   Path::AddEndingBackslash(m_outputRootFolder);
+}
+
+CString LibraryMirrorManifest::ManifestFilename() const
+{
+   return Path::Combine(m_outputRootFolder, c_manifestFilename);
+}
+
+bool LibraryMirrorManifest::Load()
+{
+   m_mapEntries.clear();
+
+   FILE* fd = _tfopen(ManifestFilename(), _T("rt, ccs=UTF-8"));
+   if (fd == nullptr)
+      return false;
+
+   std::shared_ptr<FILE> spFd(fd, fclose);
+
+   std::vector<TCHAR> buffer(4096, 0);
+   if (_fgetts(buffer.data(), static_cast<int>(buffer.size()), fd) == nullptr)
+      return false;
+
+   CString header(buffer.data());
+   header.TrimRight(_T("\r\n"));
+   if (header != c_manifestHeader)
+      return false; // unknown format; all files are encoded again
+
+   while (_fgetts(buffer.data(), static_cast<int>(buffer.size()), fd) != nullptr)
+   {
+      CString line(buffer.data());
+      line.TrimRight(_T("\r\n"));
+
+      Entry entry;
+      if (ParseLine(line, entry))
+         m_mapEntries[KeyFromFilename(entry.m_inputFilename)] = entry;
+   }
+
+   return true;
+}
+
+bool LibraryMirrorManifest::Save() const
+{
+   // write to a temporary file first, so that an interrupted write keeps the old manifest
+   CString manifestFilename = ManifestFilename();
+   CString tempFilename = manifestFilename + _T(".temp");
+
+   FILE* fd = _tfopen(tempFilename, _T("wt, ccs=UTF-8"));
+   if (fd == nullptr)
+      return false;
+
+   _ftprintf(fd, _T("%s\n"), c_manifestHeader);
+
+   for (const auto& iter : m_mapEntries)
+   {
+      const Entry& entry = iter.second;
+
+      // output files are stored relative to the output root, so that the mirror can be moved
+      CString outputFilename = entry.m_outputFilename;
+      if (outputFilename.Left(m_outputRootFolder.GetLength()).CompareNoCase(m_outputRootFolder) == 0)
+         outputFilename = outputFilename.Mid(m_outputRootFolder.GetLength());
+
+      _ftprintf(fd, _T("%s\t%I64u\t%I64u\t%016I64x\t%016I64x\t%s\n"),
+         entry.m_inputFilename.GetString(),
+         entry.m_fileSize,
+         entry.m_lastWriteTime,
+         entry.m_contentHash,
+         entry.m_settingsHash,
+         outputFilename.GetString());
+   }
+
+   bool writeError = ferror(fd) != 0;
+   fclose(fd);
+
+   if (writeError)
+   {
+      DeleteFile(tempFilename);
+      return false;
+   }
+
+   return FALSE != MoveFileEx(tempFilename, manifestFilename, MOVEFILE_REPLACE_EXISTING);
+}
+
+const LibraryMirrorManifest::Entry* LibraryMirrorManifest::Find(const CString& inputFilename) const
+{
+   auto iter = m_mapEntries.find(KeyFromFilename(inputFilename));
+   return iter == m_mapEntries.end() ? nullptr : &iter->second;
+}
+
+void LibraryMirrorManifest::Update(const Entry& entry)
+{
+   m_mapEntries[KeyFromFilename(entry.m_inputFilename)] = entry;
+}
+
+bool LibraryMirrorManifest::IsUpToDate(Entry& currentEntry, const CString& outputFolder, bool useContentHash)
+{
+   auto iter = m_mapEntries.find(KeyFromFilename(currentEntry.m_inputFilename));
+   if (iter == m_mapEntries.end())
+      return false; // new file
+
+   Entry& storedEntry = iter->second;
+
+   if (storedEntry.m_settingsHash != currentEntry.m_settingsHash ||
+      storedEntry.m_fileSize != currentEntry.m_fileSize)
+      return false;
+
+   // the mirror folder structure may have changed, e.g. when another input root folder is used
+   CString storedOutputFolder = Path::FolderName(storedEntry.m_outputFilename);
+   CString currentOutputFolder = outputFolder;
+   storedOutputFolder.TrimRight(_T('\\'));
+   currentOutputFolder.TrimRight(_T('\\'));
+
+   if (storedOutputFolder.CompareNoCase(currentOutputFolder) != 0)
+      return false;
+
+   if (!Path::FileExists(storedEntry.m_outputFilename))
+      return false;
+
+   if (storedEntry.m_lastWriteTime == currentEntry.m_lastWriteTime)
+   {
+      currentEntry.m_contentHash = storedEntry.m_contentHash;
+      currentEntry.m_outputFilename = storedEntry.m_outputFilename;
+      return true;
+   }
+
+   // file was touched, e.g. by a tagging tool; only hashing tells if the audio data changed
+   if (!useContentHash || storedEntry.m_contentHash == 0)
+      return false;
+
+   currentEntry.m_contentHash = CalcContentHash(currentEntry.m_inputFilename);
+   if (currentEntry.m_contentHash == 0 ||
+      currentEntry.m_contentHash != storedEntry.m_contentHash)
+      return false;
+
+   // same content; remember new last write time, so that the file isn't hashed again
+   storedEntry.m_lastWriteTime = currentEntry.m_lastWriteTime;
+   currentEntry.m_outputFilename = storedEntry.m_outputFilename;
+
+   return true;
+}
+
+size_t LibraryMirrorManifest::PruneRemovedInputFiles(const CString& inputRootFolder)
+{
+   CString rootFolder = inputRootFolder;
+   Path::AddEndingBackslash(rootFolder);
+
+   // only prune below an existing root folder, e.g. not when a network drive is unavailable
+   if (!Path::FolderExists(rootFolder))
+      return 0;
+
+   size_t numRemoved = 0;
+   for (auto iter = m_mapEntries.begin(); iter != m_mapEntries.end();)
+   {
+      const Entry& entry = iter->second;
+
+      if (entry.m_inputFilename.Left(rootFolder.GetLength()).CompareNoCase(rootFolder) == 0 &&
+         !Path::FileExists(entry.m_inputFilename))
+      {
+         ATLTRACE(_T("pruning mirrored file: %s\n"), entry.m_outputFilename.GetString());
+
+         DeleteFile(entry.m_outputFilename);
+
+         iter = m_mapEntries.erase(iter);
+         numRemoved++;
+      }
+      else
+         ++iter;
+   }
+
+   return numRemoved;
+}
+
+bool LibraryMirrorManifest::GetFileInfo(const CString& filename, ULONGLONG& fileSize, ULONGLONG& lastWriteTime)
+{
+   WIN32_FILE_ATTRIBUTE_DATA data = {};
+   if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &data) ||
+      (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+      return false;
+
+   fileSize = (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+   lastWriteTime = (static_cast<ULONGLONG>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+      data.ftLastWriteTime.dwLowDateTime;
+
+   return true;
+}
+
+ULONGLONG LibraryMirrorManifest::CalcContentHash(const CString& filename)
+{
+   FILE* fd = _tfopen(filename, _T("rb"));
+   if (fd == nullptr)
+      return 0;
+
+   std::shared_ptr<FILE> spFd(fd, fclose);
+
+   ULONGLONG hash = c_fnvOffsetBasis;
+
+   std::vector<BYTE> buffer(64 * 1024);
+   size_t numRead = 0;
+   while ((numRead = fread(buffer.data(), 1, buffer.size(), fd)) > 0)
+      HashBytes(hash, buffer.data(), numRead);
+
+   if (ferror(fd) != 0)
+      return 0;
+
+   return hash == 0 ? 1 : hash; // 0 means "not calculated"
+}
+
+ULONGLONG LibraryMirrorManifest::CalcSettingsHash(int outputModuleID, const SettingsManager& settingsManager)
+{
+   ULONGLONG hash = c_fnvOffsetBasis;
+
+   HashBytes(hash, reinterpret_cast<const BYTE*>(&outputModuleID), sizeof(outputModuleID));
+
+   VarMgrVariables varMgr;
+
+   for (const auto& setting : settingsManager.GetSettingsList())
+   {
+      // settings that e.g. differ for each run or only control threading are marked in the
+      // varmap; they don't change the encoded output
+      if (varMgr.lookupOutputNeutral(setting.first))
+         continue;
+
+      HashBytes(hash, reinterpret_cast<const BYTE*>(&setting.first), sizeof(setting.first));
+      HashBytes(hash, reinterpret_cast<const BYTE*>(&setting.second), sizeof(setting.second));
+   }
+
+   return hash;
+}
+
+CString LibraryMirrorManifest::KeyFromFilename(const CString& inputFilename)
+{
+   CString key = inputFilename;
+   key.MakeLower();
+   return key;
+}
+
+bool LibraryMirrorManifest::ParseLine(const CString& line, Entry& entry) const
+{
+   std::vector<CString> fields;
+
+   int start = 0;
+   for (int fieldIndex = 0; fieldIndex < c_numManifestLineFields - 1; fieldIndex++)
+   {
+      int pos = line.Find(_T('\t'), start);
+      if (pos == -1)
+         return false;
+
+      fields.push_back(line.Mid(start, pos - start));
+      start = pos + 1;
+   }
+
+   // last field is the output filename, which may not contain tabs anyway
+   fields.push_back(line.Mid(start));
+
+   entry.m_inputFilename = fields[0];
+   entry.m_fileSize = _tcstoui64(fields[1], nullptr, 10);
+   entry.m_lastWriteTime = _tcstoui64(fields[2], nullptr, 10);
+   entry.m_contentHash = _tcstoui64(fields[3], nullptr, 16);
+   entry.m_settingsHash = _tcstoui64(fields[4], nullptr, 16);
+   entry.m_outputFilename = fields[5];
+
+   if (entry.m_inputFilename.IsEmpty() ||
+      entry.m_outputFilename.IsEmpty())
+      return false;
+
+   // relative output filenames are stored relative to the output root folder
+   if (entry.m_outputFilename.Find(_T(':')) == -1 &&
+      entry.m_outputFilename.Left(2) != _T("\\\\"))
+      entry.m_outputFilename = Path::Combine(m_outputRootFolder, entry.m_outputFilename);
+
+   return true;
+}
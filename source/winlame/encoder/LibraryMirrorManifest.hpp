@@ -0,0 +1,128 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file LibraryMirrorManifest.hpp
+/// \brief Library mirror manifest class
+//
+#pragma once
+
+#include <map>
+#include <vector>
+
+class SettingsManager;
+
+namespace Encoder
+{
+   /// \brief manifest of a mirrored library
+   /// \details When encoding a folder structure into a mirror folder, the manifest stores
+   /// which input file was encoded to which output file, together with the input file's size,
+   /// last write time, optional content hash and the hash of the encoding settings used. On
+   /// the next run, input files that didn't change since then can be skipped. The manifest is
+   /// stored as text file in the root folder of the output tree. The class is not thread-safe.
+   class LibraryMirrorManifest
+   {
+   public:
+      /// single manifest entry
+      struct Entry
+      {
+         /// ctor
+         Entry()
+            :m_fileSize(0),
+            m_lastWriteTime(0),
+            m_contentHash(0),
+            m_settingsHash(0)
+         {
+         }
+
+         /// input filename, with full path
+         CString m_inputFilename;
+
+         /// input file size, in bytes
+         ULONGLONG m_fileSize;
+
+         /// input file last write time, as FILETIME value
+         ULONGLONG m_lastWriteTime;
+
+         /// input file content hash; 0 when not calculated
+         ULONGLONG m_contentHash;
+
+         /// hash of output module and settings used for encoding
+         ULONGLONG m_settingsHash;
+
+         /// output filename, with full path
+         CString m_outputFilename;
+      };
+
+      /// ctor; takes root folder of the output tree
+      explicit LibraryMirrorManifest(const CString& outputRootFolder);
+
+      /// returns manifest filename
+      CString ManifestFilename() const;
+
+      /// loads manifest from the output root folder; returns false when there's no manifest yet
+      bool Load();
+
+      /// saves manifest to the output root folder
+      bool Save() const;
+
+      /// returns number of entries in the manifest
+      size_t Count() const { return m_mapEntries.size(); }
+
+      /// finds entry for given input filename; returns nullptr when not found
+      const Entry* Find(const CString& inputFilename) const;
+
+      /// adds or updates entry
+      void Update(const Entry& entry);
+
+      /// \brief checks if given input file is up-to-date
+      /// \details The current entry must have input filename, file size, last write time and
+      /// settings hash set. The file is up-to-date when the manifest contains an entry with
+      /// the same values, stored in the given output folder, and the output file still
+      /// exists. When the content hash is used, files with only a changed last write time are
+      /// hashed and are up-to-date when the content hash matches; the entry is updated then.
+      bool IsUpToDate(Entry& currentEntry, const CString& outputFolder, bool useContentHash);
+
+      /// \brief removes all entries whose input files below the given root folder were
+      /// deleted, and deletes their output files; returns number of removed entries
+      size_t PruneRemovedInputFiles(const CString& inputRootFolder);
+
+      /// retrieves size and last write time of input file; returns false when file doesn't exist
+      static bool GetFileInfo(const CString& filename, ULONGLONG& fileSize, ULONGLONG& lastWriteTime);
+
+      /// calculates 64-bit FNV-1a hash over the file content; returns 0 on errors
+      static ULONGLONG CalcContentHash(const CString& filename);
+
+      /// calculates hash of output module and encoding settings; per-run settings are ignored
+      static ULONGLONG CalcSettingsHash(int outputModuleID, const SettingsManager& settingsManager);
+
+   private:
+      /// returns map key for given input filename
+      static CString KeyFromFilename(const CString& inputFilename);
+
+      /// parses single manifest line and returns false when line is invalid
+      bool ParseLine(const CString& line, Entry& entry) const;
+
+   private:
+      /// root folder of output tree, with ending backslash
+      CString m_outputRootFolder;
+
+      /// map with all entries, keyed by lowercase input filename
+      std::map<CString, Entry> m_mapEntries;
+   };
+
+} // namespace Encoder
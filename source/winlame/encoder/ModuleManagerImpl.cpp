@@ -164,34 +164,116 @@ void ModuleManagerImpl::GetFilterString(CString& filterstring) const
    filterstring.AppendFormat(_T("|%s|%s"), allFilter.GetString(), filter.GetString());
 }
 
+std::set<CString> ModuleManagerImpl::GetInputFileExtensions() const
+{
+   std::set<CString> extensionsSet;
+
+   for (const auto& iter : m_mapExtensionToInputModuleIndex)
+      extensionsSet.insert(CString(iter.first.c_str()));
+
+   return extensionsSet;
+}
+
 bool ModuleManagerImpl::GetAudioFileInfo(LPCTSTR filename,
    int& lengthInSeconds, int& bitrateInBps, int& samplerateInHz, CString& errorMessage)
 {
-   // get appropriate input module
-   InputModule* inputModule = ChooseInputModule(filename);
+   ProbeInfo probeInfo;
+   bool ret = m_spAudioFileInfoCache != nullptr &&
+      m_spAudioFileInfoCache->LookupAudioFileInfo(filename, probeInfo);
+
+   if (!ret)
+   {
+      // get appropriate input module
+      std::unique_ptr<InputModule> inputModule(ChooseInputModule(filename));
+      if (inputModule == nullptr)
+      {
+         errorMessage.LoadString(IDS_ENCODER_MISSING_INPUT_MOD);
+         return false;
+      }
+
+      // try reading infos from the file's headers first
+      ret = inputModule->Probe(filename, probeInfo);
+
+      if (ret)
+      {
+         if (m_spAudioFileInfoCache != nullptr)
+            m_spAudioFileInfoCache->StoreAudioFileInfo(filename, probeInfo);
+      }
+      else
+      {
+         // get infos by fully opening the file
+         TrackInfo trackInfo;
+         ret = OpenInputFile(*inputModule, filename, probeInfo, trackInfo, errorMessage);
+      }
+   }
+
+   if (ret)
+   {
+      lengthInSeconds = probeInfo.m_lengthInSeconds;
+      bitrateInBps = probeInfo.m_bitrateInBps;
+      samplerateInHz = probeInfo.m_samplerateInHz;
+   }
+
+   return ret;
+}
+
+bool ModuleManagerImpl::GetTrackInfo(LPCTSTR filename, TrackInfo& trackInfo, CString& errorMessage)
+{
+   if (m_spAudioFileInfoCache != nullptr &&
+      m_spAudioFileInfoCache->LookupTrackInfo(filename, trackInfo))
+      return true;
+
+   std::unique_ptr<InputModule> inputModule(ChooseInputModule(filename));
    if (inputModule == nullptr)
    {
       errorMessage.LoadString(IDS_ENCODER_MISSING_INPUT_MOD);
       return false;
    }
 
-   // get infos
-   Encoder::TrackInfo trackInfo;
+   ProbeInfo probeInfo;
+   return OpenInputFile(*inputModule, filename, probeInfo, trackInfo, errorMessage);
+}
+
+bool ModuleManagerImpl::OpenInputFile(InputModule& inputModule, LPCTSTR filename,
+   ProbeInfo& probeInfo, TrackInfo& trackInfo, CString& errorMessage)
+{
    SampleContainer samples;
    SettingsManager dummy;
-   int ret = inputModule->InitInput(filename, dummy, trackInfo, samples);
+   int ret = inputModule.InitInput(filename, dummy, trackInfo, samples);
 
    if (ret >= 0)
    {
-      int dummy2;
-      inputModule->GetInfo(dummy2, bitrateInBps, lengthInSeconds, samplerateInHz);
+      inputModule.GetInfo(probeInfo.m_numChannels, probeInfo.m_bitrateInBps,
+         probeInfo.m_lengthInSeconds, probeInfo.m_samplerateInHz);
+
+      // both infos are known now
+      if (m_spAudioFileInfoCache != nullptr)
+      {
+         m_spAudioFileInfoCache->StoreAudioFileInfo(filename, probeInfo);
+         m_spAudioFileInfoCache->StoreTrackInfo(filename, trackInfo);
+      }
    }
    else
-      errorMessage = inputModule->GetLastError();
+      errorMessage = inputModule.GetLastError();
 
-   inputModule->DoneInput();
+   inputModule.DoneInput();
 
-   delete inputModule;
+   if (ret < 0)
+   {
+      // the file may have a wrong extension; retry with the module matching the file's content
+      std::unique_ptr<InputModule> contentInputModule(
+         ChooseInputModuleByContent(filename, inputModule.GetModuleID()));
+
+      if (contentInputModule != nullptr)
+      {
+         CString contentErrorMessage;
+         if (OpenInputFile(*contentInputModule, filename, probeInfo, trackInfo, contentErrorMessage))
+         {
+            errorMessage.Empty();
+            return true;
+         }
+      }
+   }
 
    return ret >= 0;
 }
@@ -229,6 +311,8 @@ ModuleManagerImpl::ModuleManagerImpl()
             delete inputModule;
       }
    }
+
+   BuildInputModuleExtensionTable();
 }
 
 ModuleManagerImpl::~ModuleManagerImpl()
@@ -246,53 +330,184 @@ ModuleManagerImpl::~ModuleManagerImpl()
 
 InputModule* ModuleManagerImpl::ChooseInputModule(LPCTSTR filename)
 {
-   InputModule* inputModule = nullptr;
+   int moduleIndex = FindInputModuleIndexByExtension(filename);
+   if (moduleIndex != -1)
+      return CloneInputModule(*m_inputModules[moduleIndex]);
 
-   // get file extension
-   std::tstring extension(filename);
-   std::tstring::size_type pos = extension.find_last_of('.');
-   if (pos == std::tstring::npos)
-      return nullptr; // no extension
-   extension.erase(0, pos);
+   // no or unknown extension
+   return ChooseInputModuleByContent(filename);
+}
+
+int ModuleManagerImpl::ChooseInputModuleID(LPCTSTR filename)
+{
+   int moduleIndex = FindInputModuleIndexByExtension(filename);
+   if (moduleIndex != -1)
+      return m_inputModules[moduleIndex]->GetModuleID();
+
+   int moduleId = SniffInputModuleID(filename);
+
+   // the module for the detected format may not be available
+   bool isAvailable = std::any_of(m_inputModules.begin(), m_inputModules.end(),
+      [moduleId](InputModule* inputModule) { return inputModule->GetModuleID() == moduleId; });
+
+   return isAvailable ? moduleId : -1;
+}
 
-   CString lowerExtension(extension.c_str());
+int ModuleManagerImpl::FindInputModuleIndexByExtension(LPCTSTR filename) const
+{
+   LPCTSTR extension = _tcsrchr(filename, _T('.'));
+   LPCTSTR lastSeparator = _tcsrchr(filename, _T('\\'));
+
+   if (extension == nullptr || (lastSeparator != nullptr && extension < lastSeparator))
+      return -1;
+
+   CString lowerExtension(extension + 1);
    lowerExtension.MakeLower();
-   extension = lowerExtension.GetString();
 
-   // search all filter strings for file extension
-   int max = GetInputModuleCount();
-   for (int i = 0; i < max && inputModule == nullptr; i++)
+   auto iter = m_mapExtensionToInputModuleIndex.find(std::tstring(lowerExtension.GetString()));
+
+   return iter != m_mapExtensionToInputModuleIndex.end() ? static_cast<int>(iter->second) : -1;
+}
+
+InputModule* ModuleManagerImpl::ChooseInputModuleByContent(LPCTSTR filename, int excludeModuleId)
+{
+   int moduleId = SniffInputModuleID(filename);
+
+   if (moduleId == -1 || moduleId == excludeModuleId)
+      return nullptr;
+
+   return CloneInputModuleByID(moduleId);
+}
+
+void ModuleManagerImpl::BuildInputModuleExtensionTable()
+{
+   for (size_t moduleIndex = 0, maxModuleIndex = m_inputModules.size(); moduleIndex < maxModuleIndex; moduleIndex++)
    {
-      CString lowerFilter = GetInputModuleFilterString(i);
-      lowerFilter.MakeLower();
-      std::tstring filter = lowerFilter.GetString();
+      CString filterString = m_inputModules[moduleIndex]->GetFilterString();
+      filterString.MakeLower();
 
-      do
+      // every second part of the filter string contains the wildcards, e.g. "*.mp3;*.mp2"
+      int start = 0;
+      for (int partIndex = 0; start >= 0; partIndex++)
       {
-         // search for second string delimited by a | char
-         pos = filter.find_first_of('|');
-         if (pos != std::tstring::npos)
+         CString part = filterString.Tokenize(_T("|"), start);
+         if (start < 0 || (partIndex % 2) == 0)
+            continue;
+
+         int wildcardStart = 0;
+         CString wildcard = part.Tokenize(_T(";"), wildcardStart);
+
+         while (wildcardStart >= 0)
          {
-            filter.erase(0, pos + 1);
-            pos = filter.find_first_of('|');
-            if (pos == std::tstring::npos)
-               break;
+            wildcard.Trim();
 
-            // check if the extension is in the filter wildcard pattern
-            std::tstring temp(filter.c_str(), pos);
-            std::tstring::size_type pos2 = temp.find(extension.c_str());
+            int pos = wildcard.ReverseFind(_T('.'));
+            CString extension = pos == -1 ? CString() : wildcard.Mid(pos + 1);
 
-            if (pos2 != std::tstring::npos)
-            {
-               // clone input module
-               inputModule = m_inputModules[i]->CloneModule();
-               break;
-            }
+            // when more than one module supports an extension, the first module is used
+            if (!extension.IsEmpty() && extension != _T("*"))
+               m_mapExtensionToInputModuleIndex.emplace(std::tstring(extension.GetString()), moduleIndex);
+
+            wildcard = part.Tokenize(_T(";"), wildcardStart);
          }
-      } while (pos != std::tstring::npos);
+      }
    }
+}
 
-   return inputModule;
+int ModuleManagerImpl::SniffInputModuleID(LPCTSTR filename)
+{
+   FILE* fd = _tfopen(filename, _T("rb"));
+   if (fd == nullptr)
+      return -1;
+
+   unsigned char header[64] = {};
+   size_t headerSize = fread(header, 1, sizeof(header), fd);
+
+   // skip ID3v2 tag, which may be in front of MP3, FLAC and Monkey's Audio files
+   bool hasId3v2Tag = headerSize >= 10 && memcmp(header, "ID3", 3) == 0;
+   if (hasId3v2Tag)
+   {
+      long tagSize = 10 +
+         (((header[6] & 0x7F) << 21) |
+         ((header[7] & 0x7F) << 14) |
+         ((header[8] & 0x7F) << 7) |
+         (header[9] & 0x7F));
+
+      if ((header[5] & 0x10) != 0)
+         tagSize += 10; // footer
+
+      memset(header, 0, sizeof(header));
+      headerSize = fseek(fd, tagSize, SEEK_SET) == 0 ? fread(header, 1, sizeof(header), fd) : 0;
+   }
+
+   fclose(fd);
+
+   if (headerSize < 12)
+      return hasId3v2Tag ? ID_IM_LIBMPG123 : -1;
+
+   if (memcmp(header, "fLaC", 4) == 0)
+      return ID_IM_FLAC;
+
+   if (memcmp(header, "MAC ", 4) == 0)
+      return ID_IM_MONKEYSAUDIO;
+
+   if (memcmp(header, "OggS", 4) == 0)
+   {
+      // the codec is identified by the header packet in the first page, after the 27 bytes of
+      // the page header and the segment table
+      size_t packetOffset = 27 + header[26];
+      const unsigned char* packet = header + packetOffset;
+      size_t packetSize = packetOffset < headerSize ? headerSize - packetOffset : 0;
+
+      if (packetSize >= 7 && memcmp(packet, "\x01vorbis", 7) == 0)
+         return ID_IM_OGGV;
+
+      if (packetSize >= 8 && memcmp(packet, "OpusHead", 8) == 0)
+         return ID_IM_OPUS;
+
+      if (packetSize >= 8 && memcmp(packet, "Speex   ", 8) == 0)
+         return ID_IM_SPEEX;
+
+      return -1;
+   }
+
+   if ((memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0) ||
+      (memcmp(header, "RF64", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0) ||
+      (memcmp(header, "FORM", 4) == 0 && (memcmp(header + 8, "AIFF", 4) == 0 || memcmp(header + 8, "AIFC", 4) == 0)) ||
+      memcmp(header, "riff\x2e\x91\xcf\x11", 8) == 0) // Sony Wave64 GUID
+      return ID_IM_SNDFILE;
+
+   if (memcmp(header + 4, "ftyp", 4) == 0)
+      return ID_IM_AAC; // MP4 container
+
+   if (header[0] == 0xFF && (header[1] & 0xF6) == 0xF0)
+      return ID_IM_AAC; // ADTS frame sync, with layer bits 00
+
+   if (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0 && (header[1] & 0x06) != 0)
+      return ID_IM_LIBMPG123; // MPEG audio frame sync, with layer I, II or III
+
+   return hasId3v2Tag ? ID_IM_LIBMPG123 : -1;
+}
+
+InputModule* ModuleManagerImpl::CloneInputModuleByID(int moduleId) const
+{
+   for (InputModule* inputModule : m_inputModules)
+   {
+      if (inputModule->GetModuleID() == moduleId)
+         return CloneInputModule(*inputModule);
+   }
+
+   return nullptr;
+}
+
+InputModule* ModuleManagerImpl::CloneInputModule(InputModule& inputModule) const
+{
+   InputModule* clonedInputModule = inputModule.CloneModule();
+
+   // the tags are only read when they're not in the cache
+   clonedInputModule->SetTrackInfoCache(m_spAudioFileInfoCache);
+
+   return clonedInputModule;
 }
 
 OutputModule *ModuleManagerImpl::GetOutputModule(int m_moduleId)
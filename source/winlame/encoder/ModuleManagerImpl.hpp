@@ -22,8 +22,10 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include "ModuleManager.hpp"
 #include "ModuleInterface.hpp"
+#include "AudioFileInfoCache.hpp"
 
 namespace Encoder
 {
@@ -41,10 +43,28 @@ namespace Encoder
       /// returns currently available filter string for open file dialog
       virtual void GetFilterString(CString& filterstring) const override;
 
+      /// returns lowercase file extensions, without dot, of all files supported by input modules
+      virtual std::set<CString> GetInputFileExtensions() const override;
+
       /// returns infos about audio file; returns false when not supported
       virtual bool GetAudioFileInfo(LPCTSTR filename,
          int& lengthInSeconds, int& bitrateInBps, int& samplerateInHz, CString& errorMessage) override;
 
+      /// returns track infos stored in audio file; returns false when not supported
+      virtual bool GetTrackInfo(LPCTSTR filename, TrackInfo& trackInfo, CString& errorMessage) override;
+
+      /// returns cache for audio file infos and track infos; may be nullptr
+      virtual std::shared_ptr<AudioFileInfoCache> GetAudioFileInfoCache() override
+      {
+         return m_spAudioFileInfoCache;
+      }
+
+      /// sets cache for audio file infos and track infos
+      void SetAudioFileInfoCache(std::shared_ptr<AudioFileInfoCache> spAudioFileInfoCache)
+      {
+         m_spAudioFileInfoCache = spAudioFileInfoCache;
+      }
+
       // input module
 
       /// returns the number of available input modules
@@ -77,10 +97,21 @@ namespace Encoder
          return m_inputModules[index];
       }
 
-      /// chooses an input module suitable for opening file with given filename;
+      /// \brief chooses an input module suitable for opening file with given filename;
       /// pointer has to be deleted!
+      /// \details The module is chosen by file extension; when the file has no or an unknown
+      /// extension, the module is chosen by the file's content.
       InputModule* ChooseInputModule(LPCTSTR filename);
 
+      /// \brief chooses an input module by the file's content only, e.g. when the input module
+      /// chosen by extension can't open the file; returns nullptr when the file's format isn't
+      /// known or is the same as the one of the given module ID; pointer has to be deleted!
+      InputModule* ChooseInputModuleByContent(LPCTSTR filename, int excludeModuleId = -1);
+
+      /// returns ID of the input module that ChooseInputModule() would choose, without creating
+      /// an input module instance; returns -1 when no input module is suitable
+      int ChooseInputModuleID(LPCTSTR filename);
+
       // output module
 
       /// returns the number of available output modules
@@ -107,6 +138,27 @@ namespace Encoder
       /// returns output module with given module id; pointer has to be deleted!
       OutputModule* GetOutputModule(int moduleId);
 
+   private:
+      /// builds file extension to input module table
+      void BuildInputModuleExtensionTable();
+
+      /// returns index of input module by the filename's extension; -1 when no or unknown extension
+      int FindInputModuleIndexByExtension(LPCTSTR filename) const;
+
+      /// returns input module ID for the format detected from the file's magic bytes; -1 when unknown
+      static int SniffInputModuleID(LPCTSTR filename);
+
+      /// returns input module instance by module ID; nullptr when not available
+      InputModule* CloneInputModuleByID(int moduleId) const;
+
+      /// clones input module and sets the track info cache
+      InputModule* CloneInputModule(InputModule& inputModule) const;
+
+      /// \brief opens input file with input module and retrieves audio file and track infos;
+      /// also stores them in the cache
+      bool OpenInputFile(InputModule& inputModule, LPCTSTR filename,
+         ProbeInfo& probeInfo, TrackInfo& trackInfo, CString& errorMessage);
+
    private:
       /// all available output modules
       std::vector<OutputModule*> m_outputModules;
@@ -114,8 +166,14 @@ namespace Encoder
       /// all available input modules
       std::vector<InputModule*> m_inputModules;
 
+      /// lowercase file extension, without dot, to input module index mapping
+      std::unordered_map<std::tstring, size_t> m_mapExtensionToInputModuleIndex;
+
       /// output module ID to index mapping
       std::map<int, int> m_mapOutputModuleIdToModuleIndex;
+
+      /// audio file info cache; may be nullptr
+      std::shared_ptr<AudioFileInfoCache> m_spAudioFileInfoCache;
    };
 
 } //namespace Encoder
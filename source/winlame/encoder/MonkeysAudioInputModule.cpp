@@ -27,6 +27,10 @@
 #include "resource.h"
 #include <cstdio>
 #include <cassert>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "AudioFileTag.hpp"
 
 // Monkey's Audio header files have some incompatibilities; working around that
@@ -125,8 +129,186 @@ namespace MonkeysAudio
       proc_APEDecompress_GetInfo       GetInfo;
    };
 
-   /// buffer size for MonkeysAudio's audio module
-   const int c_macBufferSize = 8192;
+   /// max. number of threads used to decode a file
+   const unsigned int c_maxDecoderThreads = 4;
+
+   /// \brief decodes the frames of an APE file in worker threads
+   /// \details APE frames can be decoded independently of each other, so each worker thread
+   /// uses its own decompressor and decodes every n-th frame, after seeking to the frame's
+   /// first block. Each worker decodes one frame ahead, and the frames are returned in order.
+   class FrameDecoder
+   {
+   public:
+      /// ctor; takes ownership of the decompressors and starts one worker thread for each
+      FrameDecoder(MonkeysAudioDll& dll, const std::vector<APE_DECOMPRESS_HANDLE>& handlesList,
+         int64_t totalBlocks, int64_t blocksPerFrame, int blockAlign)
+         :m_dll(dll),
+         m_handlesList(handlesList),
+         m_totalBlocks(totalBlocks),
+         m_blocksPerFrame(blocksPerFrame),
+         m_blockAlign(blockAlign),
+         m_numFrames((totalBlocks + blocksPerFrame - 1) / blocksPerFrame),
+         m_nextFrame(0),
+         m_stop(false),
+         m_slotsList(handlesList.size())
+      {
+         for (size_t workerIndex = 0; workerIndex < m_handlesList.size(); workerIndex++)
+            m_workersList.emplace_back(&FrameDecoder::DecodeFrames, this, workerIndex);
+      }
+
+      /// dtor; stops worker threads
+      ~FrameDecoder()
+      {
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+         }
+
+         m_condition.notify_all();
+
+         for (std::thread& worker : m_workersList)
+            worker.join();
+
+         for (APE_DECOMPRESS_HANDLE handle : m_handlesList)
+            m_dll.Destroy(handle);
+      }
+
+      /// \brief returns samples of the next frame; waits until the frame is decoded
+      /// \details the buffer is swapped with the frame's buffer; returns 0 or the error code
+      /// of the decompressor
+      int GetNextFrame(std::vector<unsigned char>& buffer, APE::int64& numBlocks)
+      {
+         numBlocks = 0;
+         if (m_nextFrame >= m_numFrames)
+            return 0;
+
+         FrameSlot& slot = m_slotsList[static_cast<size_t>(m_nextFrame % m_slotsList.size())];
+
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_condition.wait(lock, [&]() { return slot.m_isReady; });
+
+         buffer.swap(slot.m_data);
+         numBlocks = slot.m_numBlocks;
+         int errorCode = slot.m_errorCode;
+
+         slot.m_isReady = false;
+         m_nextFrame++;
+
+         lock.unlock();
+         m_condition.notify_all();
+
+         return errorCode;
+      }
+
+   private:
+      /// a decoded frame, passed from a worker thread to the caller
+      struct FrameSlot
+      {
+         /// ctor
+         FrameSlot()
+            :m_numBlocks(0),
+            m_errorCode(0),
+            m_isReady(false)
+         {
+         }
+
+         /// samples of the frame
+         std::vector<unsigned char> m_data;
+
+         /// number of blocks in the frame
+         int64_t m_numBlocks;
+
+         /// error code of the decompressor
+         int m_errorCode;
+
+         /// indicates if the frame was decoded and not yet returned
+         bool m_isReady;
+      };
+
+      /// worker thread function; decodes every n-th frame, starting with given worker index
+      void DecodeFrames(size_t workerIndex)
+      {
+         APE_DECOMPRESS_HANDLE handle = m_handlesList[workerIndex];
+         FrameSlot& slot = m_slotsList[workerIndex];
+
+         std::vector<unsigned char> frameData;
+         int64_t nextBlock = 0;
+
+         int64_t numWorkers = static_cast<int64_t>(m_handlesList.size());
+
+         for (int64_t frameIndex = workerIndex; frameIndex < m_numFrames; frameIndex += numWorkers)
+         {
+            int64_t firstBlock = frameIndex * m_blocksPerFrame;
+            int64_t numBlocks = std::min(m_blocksPerFrame, m_totalBlocks - firstBlock);
+
+            frameData.resize(static_cast<size_t>(numBlocks * m_blockAlign));
+
+            int errorCode = 0;
+            if (firstBlock != nextBlock)
+               errorCode = m_dll.Seek(handle, firstBlock);
+
+            APE::int64 numBlocksRetrieved = 0;
+            if (errorCode == 0)
+               errorCode = m_dll.GetData(handle, reinterpret_cast<char*>(frameData.data()), numBlocks, &numBlocksRetrieved);
+
+            nextBlock = firstBlock + numBlocksRetrieved;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&]() { return !slot.m_isReady || m_stop; });
+
+            if (m_stop)
+               return;
+
+            slot.m_data.swap(frameData);
+            slot.m_numBlocks = numBlocksRetrieved;
+            slot.m_errorCode = errorCode;
+            slot.m_isReady = true;
+
+            lock.unlock();
+            m_condition.notify_all();
+
+            if (errorCode != 0)
+               return;
+         }
+      }
+
+   private:
+      /// library functions
+      MonkeysAudioDll& m_dll;
+
+      /// decompressors, one for each worker thread
+      std::vector<APE_DECOMPRESS_HANDLE> m_handlesList;
+
+      /// total number of blocks in the file
+      int64_t m_totalBlocks;
+
+      /// number of blocks in a frame
+      int64_t m_blocksPerFrame;
+
+      /// number of bytes of one block
+      int m_blockAlign;
+
+      /// number of frames in the file
+      int64_t m_numFrames;
+
+      /// index of the frame returned next; only accessed by the caller
+      int64_t m_nextFrame;
+
+      /// mutex to protect slots and the stop flag
+      std::mutex m_mutex;
+
+      /// condition signaled when a slot was filled or emptied, or when stopping
+      std::condition_variable m_condition;
+
+      /// indicates that the worker threads should stop
+      bool m_stop;
+
+      /// slots for decoded frames, one for each worker thread
+      std::vector<FrameSlot> m_slotsList;
+
+      /// worker threads
+      std::vector<std::thread> m_workersList;
+   };
 
    /// encodes an error string based on macdll error code
    CString EncodeMonkeyErrorString(int errorCode)
@@ -218,6 +400,9 @@ MonkeysAudio::MonkeysAudioDll MonkeysAudioInputModule::s_dll;
 
 MonkeysAudioInputModule::MonkeysAudioInputModule()
    :m_handle(0),
+   m_blocksPerFrame(0),
+   m_blockAlign(0),
+   m_bitsPerSample(0),
    m_numCurrentSamples(0),
    m_numTotalSamples(0)
 {
@@ -226,6 +411,7 @@ MonkeysAudioInputModule::MonkeysAudioInputModule()
 
 MonkeysAudioInputModule::~MonkeysAudioInputModule()
 {
+   DoneInput();
 }
 
 Encoder::InputModule* MonkeysAudioInputModule::CloneModule()
@@ -310,11 +496,7 @@ int MonkeysAudioInputModule::InitInput(LPCTSTR infilename,
    ATLASSERT(s_dll.IsAvail());
 
    // close old file if still open
-   if (m_handle)
-   {
-      s_dll.Destroy(m_handle);
-      m_handle = nullptr;
-   }
+   DoneInput();
 
    // internal retval used by macdll
    int retval = 0;
@@ -336,14 +518,28 @@ int MonkeysAudioInputModule::InitInput(LPCTSTR infilename,
    // get some fileinfo
    APE::int64 samplerateInHz = s_dll.GetInfo(m_handle, APE::APE_INFO_SAMPLE_RATE, 0, 0);
    APE::int64 numChannels = s_dll.GetInfo(m_handle, APE::APE_INFO_CHANNELS, 0, 0);
-   APE::int64 bitrateInBps = s_dll.GetInfo(m_handle, APE::APE_INFO_BITS_PER_SAMPLE, 0, 0);
+   m_bitsPerSample = static_cast<int>(s_dll.GetInfo(m_handle, APE::APE_INFO_BITS_PER_SAMPLE, 0, 0));
+   m_blockAlign = static_cast<int>(s_dll.GetInfo(m_handle, APE::APE_INFO_BLOCK_ALIGN, 0, 0));
+   m_blocksPerFrame = s_dll.GetInfo(m_handle, APE::APE_INFO_BLOCKS_PER_FRAME, 0, 0);
 
    // set total samples in file (for stats update)
    m_numTotalSamples = s_dll.GetInfo(m_handle, APE::APE_DECOMPRESS_TOTAL_BLOCKS, 0, 0);
 
+   if (m_blockAlign <= 0 || m_blocksPerFrame <= 0)
+   {
+      m_lastError = MonkeysAudio::EncodeMonkeyErrorString(ERROR_INVALID_INPUT_FILE);
+      return -1;
+   }
+
+   // decode whole frames at once; when using worker threads, the buffers are allocated by
+   // the frame decoder
+   unsigned int numThreads = GetNumDecoderThreads(mgr);
+   if (numThreads <= 1 || !StartFrameDecoder(infilename, numThreads))
+      m_buffer.resize(static_cast<size_t>(m_blocksPerFrame * m_blockAlign));
+
    // set up input traits
    samples.SetInputModuleTraits(
-      static_cast<int>(bitrateInBps),
+      m_bitsPerSample,
       SamplesInterleaved,
       static_cast<int>(samplerateInHz),
       static_cast<int>(numChannels));
@@ -369,16 +565,75 @@ void MonkeysAudioInputModule::GetInfo(int& numChannels, int& bitrateInBps, int&
    bitrateInBps = samplerateInHz * bitsPerSample;
 }
 
+bool MonkeysAudioInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   FILE* fd = nullptr;
+   errno_t err = _tfopen_s(&fd, filename, _T("rb"));
+
+   if (err != 0 || fd == nullptr)
+      return false;
+
+   std::shared_ptr<FILE> inputFile(fd, fclose);
+
+   // skip ID3v2 tag, if present
+   long headerOffset = 0;
+
+   unsigned char id3v2Header[10] = {};
+   if (fread(id3v2Header, 1, sizeof(id3v2Header), fd) == sizeof(id3v2Header) &&
+      memcmp(id3v2Header, "ID3", 3) == 0)
+   {
+      headerOffset = sizeof(id3v2Header) +
+         (((id3v2Header[6] & 0x7F) << 21) |
+         ((id3v2Header[7] & 0x7F) << 14) |
+         ((id3v2Header[8] & 0x7F) << 7) |
+         (id3v2Header[9] & 0x7F));
+
+      if ((id3v2Header[5] & 0x10) != 0)
+         headerOffset += sizeof(id3v2Header);
+   }
+
+   // read APE_DESCRIPTOR and APE_HEADER; only files of version 3.98 and later store
+   // these, older files are opened using the decompressor
+   APE::APE_DESCRIPTOR descriptor = {};
+   APE::APE_HEADER header = {};
+
+   if (fseek(fd, headerOffset, SEEK_SET) != 0 ||
+      fread(&descriptor, sizeof(descriptor), 1, fd) != 1 ||
+      memcmp(descriptor.cID, "MAC ", 4) != 0 ||
+      descriptor.nVersion < 3980)
+      return false;
+
+   if (fseek(fd, headerOffset + descriptor.nDescriptorBytes, SEEK_SET) != 0 ||
+      fread(&header, sizeof(header), 1, fd) != 1 ||
+      header.nSampleRate == 0 ||
+      header.nTotalFrames == 0)
+      return false;
+
+   unsigned long long numTotalSamples =
+      static_cast<unsigned long long>(header.nTotalFrames - 1) * header.nBlocksPerFrame +
+      header.nFinalFrameBlocks;
+
+   info.m_numChannels = header.nChannels;
+   info.m_samplerateInHz = header.nSampleRate;
+   info.m_numSamples = numTotalSamples;
+   info.m_bitrateInBps = header.nSampleRate * header.nBitsPerSample;
+   info.m_lengthInSeconds = static_cast<int>(numTotalSamples / header.nSampleRate);
+
+   return true;
+}
+
 int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
 {
    ATLASSERT(s_dll.IsAvail() && m_handle != nullptr);
 
-   unsigned char buffer[MonkeysAudio::c_macBufferSize];
    APE::int64 numBlocksRetrieved = 0;
 
-   // get data from file
-   APE::int64 blockalign = s_dll.GetInfo(m_handle, APE::APE_INFO_BLOCK_ALIGN, 0, 0);
-   int retval = s_dll.GetData(m_handle, reinterpret_cast<char*>(buffer), MonkeysAudio::c_macBufferSize / blockalign, &numBlocksRetrieved);
+   // get one frame from file
+   int retval = 0;
+   if (m_frameDecoder != nullptr)
+      retval = m_frameDecoder->GetNextFrame(m_buffer, numBlocksRetrieved);
+   else
+      retval = s_dll.GetData(m_handle, reinterpret_cast<char*>(m_buffer.data()), m_blocksPerFrame, &numBlocksRetrieved);
 
    // success?
    if (retval != 0)
@@ -389,12 +644,12 @@ int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
 
    // if we are dealing with 8-bit samples, we have to convert them to signed samples
    // (8-bit samples from MonkeysAudio's audio are unsigned)
-   APE::int64 bitsPerSample = s_dll.GetInfo(m_handle, APE::APE_INFO_BITS_PER_SAMPLE, 0, 0);
-   if (8 == bitsPerSample)
+   if (8 == m_bitsPerSample)
    {
-      for (int i = 0; i < MonkeysAudio::c_macBufferSize; ++i)
+      size_t numBytes = static_cast<size_t>(numBlocksRetrieved * m_blockAlign);
+      for (size_t i = 0; i < numBytes; ++i)
       {
-         buffer[i] = ((buffer[i] & 0x80) ^ 0x80) | (buffer[i] & 0x7f);   // invert most significant bit
+         m_buffer[i] ^= 0x80;   // invert most significant bit
       }
    }
 
@@ -402,14 +657,29 @@ int MonkeysAudioInputModule::DecodeSamples(SampleContainer& samples)
    m_numCurrentSamples += numBlocksRetrieved;
 
    // put samples in container
-   samples.PutSamplesInterleaved(buffer, static_cast<int>(numBlocksRetrieved));
+   samples.PutSamplesInterleaved(m_buffer.data(), static_cast<int>(numBlocksRetrieved));
 
    // return samples retrieved
    return static_cast<int>(numBlocksRetrieved);
 }
 
+void MonkeysAudioInputModule::EstimateDecodingMemoryUsage(size_t& bufferMemoryUsage, size_t& maxNumDecodedSamples) const
+{
+   // frames of files compressed with the "insane" level have 16 times the default number of
+   // 73728 blocks per frame; blocks are assumed to be stereo with up to 32 bit per sample
+   const size_t maxBlocksPerFrame = 73728 * 16;
+   const size_t maxBlockAlign = 2 * sizeof(int);
+
+   // each decoder thread decodes into its own buffer while its slot holds the previously
+   // decoded frame; the module's buffer holds the frame passed to the sample container
+   bufferMemoryUsage = (2 * MonkeysAudio::c_maxDecoderThreads + 1) * maxBlocksPerFrame * maxBlockAlign;
+   maxNumDecodedSamples = maxBlocksPerFrame;
+}
+
 void MonkeysAudioInputModule::DoneInput()
 {
+   m_frameDecoder.reset();
+
    if (m_handle)
    {
       s_dll.Destroy(m_handle);
@@ -419,6 +689,52 @@ void MonkeysAudioInputModule::DoneInput()
 
 bool MonkeysAudioInputModule::GetTrackInfo(LPCTSTR filename, TrackInfo& trackInfo)
 {
-   AudioFileTag tag(trackInfo);
+   AudioFileTag tag(trackInfo, m_spTrackInfoCache);
    return tag.ReadFromFile(filename);
 }
+
+unsigned int MonkeysAudioInputModule::GetNumDecoderThreads(SettingsManager& mgr) const
+{
+   // APL files (image links) only decode a range of the APE file
+   if (s_dll.GetInfo(m_handle, APE::APE_INFO_APL, 0, 0) != 0)
+      return 1;
+
+   // 0 means to use half of the logical processors, since other files may be encoded in
+   // parallel
+   int numThreads = mgr.QueryValueInt(MonkeysAudioDecoderThreads);
+   if (numThreads <= 0)
+      numThreads = static_cast<int>(std::thread::hardware_concurrency() / 2);
+
+   int64_t numFrames = (m_numTotalSamples + m_blocksPerFrame - 1) / m_blocksPerFrame;
+
+   return static_cast<unsigned int>(std::max<int64_t>(1,
+      std::min<int64_t>({ numThreads, MonkeysAudio::c_maxDecoderThreads, numFrames })));
+}
+
+bool MonkeysAudioInputModule::StartFrameDecoder(LPCTSTR infilename, unsigned int numThreads)
+{
+   std::vector<MonkeysAudio::APE_DECOMPRESS_HANDLE> handlesList;
+
+   for (unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+   {
+      int retval = 0;
+      MonkeysAudio::APE_DECOMPRESS_HANDLE handle = s_dll.Create(CStringA(GetAnsiCompatFilename(infilename)), &retval);
+      if (handle == nullptr)
+      {
+         ATLTRACE(_T("Monkey's Audio: couldn't create decompressor for worker thread: %s\n"),
+            MonkeysAudio::EncodeMonkeyErrorString(retval).GetString());
+
+         for (MonkeysAudio::APE_DECOMPRESS_HANDLE createdHandle : handlesList)
+            s_dll.Destroy(createdHandle);
+
+         return false;
+      }
+
+      handlesList.push_back(handle);
+   }
+
+   m_frameDecoder.reset(new MonkeysAudio::FrameDecoder(s_dll, handlesList,
+      m_numTotalSamples, m_blocksPerFrame, m_blockAlign));
+
+   return true;
+}
@@ -29,6 +29,7 @@
 namespace MonkeysAudio
 {
    struct MonkeysAudioDll;
+   class FrameDecoder;
    typedef void* APE_DECOMPRESS_HANDLE;
 }
 
@@ -71,9 +72,15 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
+      /// estimates the memory used by the frame buffers of the decoder threads
+      virtual void EstimateDecodingMemoryUsage(size_t& bufferMemoryUsage, size_t& maxNumDecodedSamples) const override;
+
       /// returns the number of percent done
       virtual float PercentDone() const override
       {
@@ -87,6 +94,13 @@ namespace Encoder
       /// gets the track info in ape files
       bool GetTrackInfo(LPCTSTR filename, TrackInfo& trackInfo);
 
+      /// returns number of threads to use for decoding the opened file
+      unsigned int GetNumDecoderThreads(SettingsManager& mgr) const;
+
+      /// starts decoding frames in worker threads; returns false when the additional
+      /// decompressors can't be created
+      bool StartFrameDecoder(LPCTSTR infilename, unsigned int numThreads);
+
    private:
       /// pointers to functions
       static MonkeysAudio::MonkeysAudioDll s_dll;
@@ -94,6 +108,22 @@ namespace Encoder
       /// handle to APE decompress data
       void* m_handle;
 
+      /// decoder for frames decoded in worker threads; nullptr when decoding on the
+      /// calling thread
+      std::unique_ptr<MonkeysAudio::FrameDecoder> m_frameDecoder;
+
+      /// sample buffer, holding one frame
+      std::vector<unsigned char> m_buffer;
+
+      /// number of blocks in a frame
+      int64_t m_blocksPerFrame;
+
+      /// number of bytes of one block, containing a sample of each channel
+      int m_blockAlign;
+
+      /// number of bits per sample
+      int m_bitsPerSample;
+
       /// counts the samples already decoded
       int64_t m_numCurrentSamples;
 
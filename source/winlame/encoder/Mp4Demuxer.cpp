@@ -0,0 +1,532 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Mp4Demuxer.cpp
+/// \brief MP4 demuxer for AAC audio tracks
+//
+#include "stdafx.h"
+#include "Mp4Demuxer.hpp"
+#include <numeric>
+
+using Encoder::Mp4Demuxer;
+
+// All values in MP4 files are stored in big-endian byte order. Each box starts with a 32-bit
+// size and a 4-character type; a size of 1 means a 64-bit size follows the type, and a size
+// of 0 means the box extends to the end of the file. "Full boxes" additionally start with
+// a version byte and 3 bytes of flags.
+
+/// object type indication for MPEG-4 audio, in the decoder config descriptor
+const unsigned char c_objectTypeMpeg4Audio = 0x40;
+
+/// object type indication for MPEG-2 AAC LC audio, in the decoder config descriptor
+const unsigned char c_objectTypeMpeg2AacLc = 0x67;
+
+/// reads 16-bit big-endian value
+static unsigned int ReadUInt16(const unsigned char* data)
+{
+   return (static_cast<unsigned int>(data[0]) << 8) | data[1];
+}
+
+/// reads 32-bit big-endian value
+static unsigned int ReadUInt32(const unsigned char* data)
+{
+   return (static_cast<unsigned int>(data[0]) << 24) | (static_cast<unsigned int>(data[1]) << 16) |
+      (static_cast<unsigned int>(data[2]) << 8) | data[3];
+}
+
+/// reads 64-bit big-endian value
+static unsigned long long ReadUInt64(const unsigned char* data)
+{
+   return (static_cast<unsigned long long>(ReadUInt32(data)) << 32) | ReadUInt32(data + 4);
+}
+
+/// reads next box header at pos and advances pos to the box after it; returns false when
+/// there are no more boxes or the box is invalid
+static bool NextBox(const unsigned char*& pos, const unsigned char* end,
+   const unsigned char*& type, const unsigned char*& boxData, size_t& boxSize)
+{
+   size_t available = end - pos;
+   if (available < 8)
+      return false;
+
+   unsigned long long size = ReadUInt32(pos);
+   size_t headerSize = 8;
+   type = pos + 4;
+
+   if (size == 1)
+   {
+      if (available < 16)
+         return false;
+
+      size = ReadUInt64(pos + 8);
+      headerSize = 16;
+   }
+   else if (size == 0)
+      size = available;
+
+   if (size < headerSize || size > available)
+      return false;
+
+   boxData = pos + headerSize;
+   boxSize = static_cast<size_t>(size) - headerSize;
+   pos += static_cast<size_t>(size);
+
+   return true;
+}
+
+/// finds first box of given type in the box data
+static bool FindBox(const unsigned char* data, size_t size, const char* boxType,
+   const unsigned char*& boxData, size_t& boxSize)
+{
+   const unsigned char* pos = data;
+   const unsigned char* type = nullptr;
+
+   while (NextBox(pos, data + size, type, boxData, boxSize))
+   {
+      if (memcmp(type, boxType, 4) == 0)
+         return true;
+   }
+
+   return false;
+}
+
+/// reads descriptor header in the elementary stream descriptor; advances pos to the
+/// descriptor's data
+static bool ReadDescriptor(const unsigned char*& pos, const unsigned char* end,
+   unsigned char& tag, size_t& length)
+{
+   if (pos >= end)
+      return false;
+
+   tag = *pos++;
+
+   // length is stored in up to 4 bytes, 7 bits each
+   length = 0;
+   for (int index = 0; index < 4; index++)
+   {
+      if (pos >= end)
+         return false;
+
+      unsigned char value = *pos++;
+      length = (length << 7) | (value & 0x7F);
+
+      if ((value & 0x80) == 0)
+         break;
+   }
+
+   return length <= size_t(end - pos);
+}
+
+Mp4Demuxer::Mp4Demuxer()
+   :m_fileHandle(INVALID_HANDLE_VALUE),
+   m_mappingHandle(nullptr),
+   m_mappedData(nullptr),
+   m_mappedSize(0),
+   m_numChannels(0),
+   m_sampleRate(0),
+   m_averageBitrate(0),
+   m_timescale(0),
+   m_duration(0),
+   m_currentAccessUnit(0)
+{
+}
+
+Mp4Demuxer::~Mp4Demuxer()
+{
+   Close();
+}
+
+bool Mp4Demuxer::Open(const CString& filename)
+{
+   Close();
+
+   m_fileHandle = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+   if (m_fileHandle == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER fileSize = {};
+   if (!GetFileSizeEx(m_fileHandle, &fileSize) ||
+      fileSize.QuadPart < 8 ||
+      static_cast<ULONGLONG>(fileSize.QuadPart) > SIZE_MAX)
+   {
+      Close();
+      return false;
+   }
+
+   m_mappingHandle = CreateFileMapping(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (m_mappingHandle != nullptr)
+      m_mappedData = reinterpret_cast<const unsigned char*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+   if (m_mappedData == nullptr)
+   {
+      Close();
+      return false;
+   }
+
+   m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+   // MP4 files start with a ftyp box; only the moov box is read, skipping all others
+   const unsigned char* boxData = nullptr;
+   size_t boxSize = 0;
+
+   if (memcmp(m_mappedData + 4, "ftyp", 4) != 0 ||
+      !FindBox(m_mappedData, m_mappedSize, "moov", boxData, boxSize) ||
+      !ReadMovieBox(boxData, boxSize))
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void Mp4Demuxer::Close()
+{
+   if (m_mappedData != nullptr)
+      UnmapViewOfFile(m_mappedData);
+
+   if (m_mappingHandle != nullptr)
+      CloseHandle(m_mappingHandle);
+
+   if (m_fileHandle != INVALID_HANDLE_VALUE)
+      CloseHandle(m_fileHandle);
+
+   m_mappedData = nullptr;
+   m_mappingHandle = nullptr;
+   m_fileHandle = INVALID_HANDLE_VALUE;
+   m_mappedSize = 0;
+
+   m_decoderConfig.clear();
+   m_accessUnitOffsets.clear();
+   m_accessUnitSizes.clear();
+   m_timeToSample.clear();
+   m_currentAccessUnit = 0;
+}
+
+unsigned long long Mp4Demuxer::GetMediaDataSize() const
+{
+   return std::accumulate(m_accessUnitSizes.begin(), m_accessUnitSizes.end(), 0ULL);
+}
+
+bool Mp4Demuxer::ReadAccessUnit(const unsigned char*& data, size_t& size)
+{
+   if (m_currentAccessUnit >= m_accessUnitSizes.size())
+      return false;
+
+   data = m_mappedData + m_accessUnitOffsets[m_currentAccessUnit];
+   size = m_accessUnitSizes[m_currentAccessUnit];
+
+   m_currentAccessUnit++;
+
+   return true;
+}
+
+bool Mp4Demuxer::Seek(unsigned long long timestamp)
+{
+   size_t accessUnitIndex = 0;
+   unsigned long long startTime = 0;
+
+   for (const auto& entry : m_timeToSample)
+   {
+      unsigned long long entryDuration = static_cast<unsigned long long>(entry.first) * entry.second;
+
+      if (timestamp < startTime + entryDuration)
+      {
+         m_currentAccessUnit = accessUnitIndex + static_cast<size_t>((timestamp - startTime) / entry.second);
+         return true;
+      }
+
+      accessUnitIndex += entry.first;
+      startTime += entryDuration;
+   }
+
+   return false;
+}
+
+bool Mp4Demuxer::ReadMovieBox(const unsigned char* data, size_t size)
+{
+   const unsigned char* pos = data;
+   const unsigned char* type = nullptr;
+   const unsigned char* boxData = nullptr;
+   size_t boxSize = 0;
+
+   while (NextBox(pos, data + size, type, boxData, boxSize))
+   {
+      if (memcmp(type, "trak", 4) == 0 &&
+         ReadTrackBox(boxData, boxSize))
+         return true;
+   }
+
+   return false;
+}
+
+bool Mp4Demuxer::ReadTrackBox(const unsigned char* data, size_t size)
+{
+   const unsigned char* mediaData = nullptr;
+   size_t mediaSize = 0;
+   if (!FindBox(data, size, "mdia", mediaData, mediaSize))
+      return false;
+
+   // only sound tracks
+   const unsigned char* boxData = nullptr;
+   size_t boxSize = 0;
+   if (!FindBox(mediaData, mediaSize, "hdlr", boxData, boxSize) ||
+      boxSize < 12 ||
+      memcmp(boxData + 8, "soun", 4) != 0)
+      return false;
+
+   // media header, containing the timescale
+   if (!FindBox(mediaData, mediaSize, "mdhd", boxData, boxSize) ||
+      boxSize < 24)
+      return false;
+
+   size_t timescaleOffset = boxData[0] == 1 ? 20 : 12;
+   if (boxSize < timescaleOffset + 4)
+      return false;
+
+   m_timescale = ReadUInt32(boxData + timescaleOffset);
+   if (m_timescale == 0)
+      return false;
+
+   const unsigned char* sampleTableData = nullptr;
+   size_t sampleTableSize = 0;
+
+   return FindBox(mediaData, mediaSize, "minf", boxData, boxSize) &&
+      FindBox(boxData, boxSize, "stbl", sampleTableData, sampleTableSize) &&
+      FindBox(sampleTableData, sampleTableSize, "stsd", boxData, boxSize) &&
+      ReadSampleDescription(boxData, boxSize) &&
+      ReadSampleTables(sampleTableData, sampleTableSize);
+}
+
+bool Mp4Demuxer::ReadSampleDescription(const unsigned char* data, size_t size)
+{
+   // skip version, flags and entry count; only the first entry is used
+   if (size < 8)
+      return false;
+
+   const unsigned char* entryData = nullptr;
+   size_t entrySize = 0;
+   if (!FindBox(data + 8, size - 8, "mp4a", entryData, entrySize))
+      return false;
+
+   // audio sample entry: 6 bytes reserved, data reference index, version, revision level,
+   // vendor, channel count, sample size, compression id, packet size, 16.16 sample rate
+   const size_t c_audioSampleEntrySize = 28;
+   if (entrySize < c_audioSampleEntrySize)
+      return false;
+
+   unsigned int version = ReadUInt16(entryData + 8);
+
+   m_numChannels = ReadUInt16(entryData + 16);
+   m_sampleRate = ReadUInt32(entryData + 24) >> 16;
+
+   // QuickTime sound description versions 1 and 2 have additional fields
+   size_t childBoxesOffset = c_audioSampleEntrySize +
+      (version == 1 ? 16 : version == 2 ? 36 : 0);
+
+   if (entrySize < childBoxesOffset)
+      return false;
+
+   const unsigned char* boxData = nullptr;
+   size_t boxSize = 0;
+
+   return FindBox(entryData + childBoxesOffset, entrySize - childBoxesOffset, "esds", boxData, boxSize) &&
+      ReadElementaryStreamDescriptor(boxData, boxSize);
+}
+
+bool Mp4Demuxer::ReadElementaryStreamDescriptor(const unsigned char* data, size_t size)
+{
+   // skip version and flags
+   if (size < 4)
+      return false;
+
+   const unsigned char* pos = data + 4;
+   const unsigned char* end = data + size;
+
+   unsigned char tag = 0;
+   size_t length = 0;
+
+   // ES descriptor: ES ID, flags, and optional fields depending on the flags
+   if (!ReadDescriptor(pos, end, tag, length) ||
+      tag != 0x03 ||
+      length < 3)
+      return false;
+
+   unsigned char flags = pos[2];
+   pos += 3;
+
+   if ((flags & 0x80) != 0)
+      pos += 2; // depends on ES ID
+
+   if ((flags & 0x40) != 0 && pos < end)
+      pos += 1 + *pos; // URL
+
+   if ((flags & 0x20) != 0)
+      pos += 2; // OCR ES ID
+
+   // decoder config descriptor: object type, stream type, buffer size, max. and avg. bitrate
+   if (pos > end ||
+      !ReadDescriptor(pos, end, tag, length) ||
+      tag != 0x04 ||
+      length < 13)
+      return false;
+
+   unsigned char objectType = pos[0];
+   if (objectType != c_objectTypeMpeg4Audio &&
+      objectType != c_objectTypeMpeg2AacLc)
+      return false;
+
+   m_averageBitrate = ReadUInt32(pos + 9);
+   pos += 13;
+
+   // decoder specific info, containing the AudioSpecificConfig
+   if (!ReadDescriptor(pos, end, tag, length) ||
+      tag != 0x05 ||
+      length == 0)
+      return false;
+
+   m_decoderConfig.assign(pos, pos + length);
+
+   return true;
+}
+
+bool Mp4Demuxer::ReadSampleTables(const unsigned char* data, size_t size)
+{
+   const unsigned char* sampleSizeData = nullptr;
+   size_t sampleSizeSize = 0;
+
+   const unsigned char* sampleToChunkData = nullptr;
+   size_t sampleToChunkSize = 0;
+
+   const unsigned char* timeToSampleData = nullptr;
+   size_t timeToSampleSize = 0;
+
+   const unsigned char* chunkOffsetData = nullptr;
+   size_t chunkOffsetSize = 0;
+
+   bool largeChunkOffsets = FindBox(data, size, "co64", chunkOffsetData, chunkOffsetSize);
+
+   if (!FindBox(data, size, "stsz", sampleSizeData, sampleSizeSize) ||
+      !FindBox(data, size, "stsc", sampleToChunkData, sampleToChunkSize) ||
+      !FindBox(data, size, "stts", timeToSampleData, timeToSampleSize) ||
+      (!largeChunkOffsets && !FindBox(data, size, "stco", chunkOffsetData, chunkOffsetSize)))
+      return false;
+
+   // sample sizes; either one size for all samples, or a table
+   if (sampleSizeSize < 12)
+      return false;
+
+   unsigned int commonSampleSize = ReadUInt32(sampleSizeData + 4);
+   size_t numAccessUnits = ReadUInt32(sampleSizeData + 8);
+
+   if (commonSampleSize == 0 &&
+      (sampleSizeSize - 12) / 4 < numAccessUnits)
+      return false;
+
+   m_accessUnitSizes.resize(numAccessUnits, commonSampleSize);
+
+   if (commonSampleSize == 0)
+   {
+      for (size_t index = 0; index < numAccessUnits; index++)
+         m_accessUnitSizes[index] = ReadUInt32(sampleSizeData + 12 + index * 4);
+   }
+
+   // chunk offsets
+   if (chunkOffsetSize < 8)
+      return false;
+
+   size_t numChunks = ReadUInt32(chunkOffsetData + 4);
+   size_t chunkOffsetEntrySize = largeChunkOffsets ? 8 : 4;
+
+   if ((chunkOffsetSize - 8) / chunkOffsetEntrySize < numChunks)
+      return false;
+
+   // sample to chunk table; each entry is valid up to the first chunk of the next entry
+   if (sampleToChunkSize < 8)
+      return false;
+
+   size_t numSampleToChunkEntries = ReadUInt32(sampleToChunkData + 4);
+   if ((sampleToChunkSize - 8) / 12 < numSampleToChunkEntries)
+      return false;
+
+   m_accessUnitOffsets.resize(numAccessUnits);
+
+   size_t accessUnitIndex = 0;
+   for (size_t entryIndex = 0; entryIndex < numSampleToChunkEntries && accessUnitIndex < numAccessUnits; entryIndex++)
+   {
+      const unsigned char* entry = sampleToChunkData + 8 + entryIndex * 12;
+
+      size_t firstChunk = ReadUInt32(entry);
+      size_t numSamplesPerChunk = ReadUInt32(entry + 4);
+
+      size_t lastChunk = entryIndex + 1 < numSampleToChunkEntries
+         ? ReadUInt32(entry + 12)
+         : numChunks + 1;
+
+      if (firstChunk == 0 || lastChunk > numChunks + 1)
+         return false;
+
+      for (size_t chunk = firstChunk; chunk < lastChunk && accessUnitIndex < numAccessUnits; chunk++)
+      {
+         const unsigned char* chunkOffsetEntry = chunkOffsetData + 8 + (chunk - 1) * chunkOffsetEntrySize;
+         unsigned long long offset = largeChunkOffsets ? ReadUInt64(chunkOffsetEntry) : ReadUInt32(chunkOffsetEntry);
+
+         for (size_t sampleIndex = 0; sampleIndex < numSamplesPerChunk && accessUnitIndex < numAccessUnits; sampleIndex++)
+         {
+            if (offset + m_accessUnitSizes[accessUnitIndex] > m_mappedSize)
+               return false;
+
+            m_accessUnitOffsets[accessUnitIndex] = offset;
+            offset += m_accessUnitSizes[accessUnitIndex];
+            accessUnitIndex++;
+         }
+      }
+   }
+
+   if (accessUnitIndex != numAccessUnits)
+      return false;
+
+   // time to sample table, for the exact duration and for seeking
+   if (timeToSampleSize < 8)
+      return false;
+
+   size_t numTimeToSampleEntries = ReadUInt32(timeToSampleData + 4);
+   if ((timeToSampleSize - 8) / 8 < numTimeToSampleEntries)
+      return false;
+
+   m_duration = 0;
+   for (size_t entryIndex = 0; entryIndex < numTimeToSampleEntries; entryIndex++)
+   {
+      const unsigned char* entry = timeToSampleData + 8 + entryIndex * 8;
+
+      unsigned int numSamples = ReadUInt32(entry);
+      unsigned int sampleDuration = ReadUInt32(entry + 4);
+
+      if (numSamples == 0 || sampleDuration == 0)
+         continue;
+
+      m_timeToSample.push_back(std::make_pair(numSamples, sampleDuration));
+      m_duration += static_cast<unsigned long long>(numSamples) * sampleDuration;
+   }
+
+   m_currentAccessUnit = 0;
+
+   return true;
+}
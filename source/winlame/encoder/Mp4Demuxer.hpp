@@ -0,0 +1,148 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Mp4Demuxer.hpp
+/// \brief MP4 demuxer for AAC audio tracks
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief demuxer for the AAC audio track of MP4/M4A files
+   /// \details The file is memory-mapped, and only the boxes leading to the sample tables
+   /// (stsz, stsc, stco/co64 and stts) of the first AAC audio track are read, so the size of
+   /// the moov box and of the media data doesn't matter. Access units are returned as pointers
+   /// into the mapped file and can be passed to the decoder without copying.
+   class Mp4Demuxer
+   {
+   public:
+      /// ctor
+      Mp4Demuxer();
+
+      /// dtor
+      ~Mp4Demuxer();
+
+      /// opens file and reads the sample tables; returns false when the file isn't an MP4
+      /// file containing an AAC audio track
+      bool Open(const CString& filename);
+
+      /// closes file
+      void Close();
+
+      /// returns if a file is opened
+      bool IsOpen() const { return m_mappedData != nullptr; }
+
+      /// returns decoder config of the track, the AudioSpecificConfig
+      const std::vector<unsigned char>& GetDecoderConfig() const { return m_decoderConfig; }
+
+      /// returns number of channels, as stored in the sample entry
+      unsigned int GetNumChannels() const { return m_numChannels; }
+
+      /// returns sample rate, as stored in the sample entry; may be the rate of the AAC core
+      /// for HE-AAC files
+      unsigned int GetSampleRate() const { return m_sampleRate; }
+
+      /// returns average bitrate, in bits per second; 0 when not stored
+      unsigned int GetAverageBitrate() const { return m_averageBitrate; }
+
+      /// returns media timescale, in units per second
+      unsigned int GetTimescale() const { return m_timescale; }
+
+      /// returns track duration, in timescale units; calculated from the sample durations
+      unsigned long long GetDuration() const { return m_duration; }
+
+      /// returns number of access units in the track
+      size_t GetNumAccessUnits() const { return m_accessUnitSizes.size(); }
+
+      /// returns size of all access units, in bytes
+      unsigned long long GetMediaDataSize() const;
+
+      /// returns index of the access unit read next
+      size_t GetCurrentAccessUnit() const { return m_currentAccessUnit; }
+
+      /// \brief returns next access unit; returns false at the end of the track
+      /// \details the data stays valid until the file is closed
+      bool ReadAccessUnit(const unsigned char*& data, size_t& size);
+
+      /// seeks to the access unit containing the given time, in timescale units; returns
+      /// false when the time is after the end of the track
+      bool Seek(unsigned long long timestamp);
+
+   private:
+      /// reads moov box and the first AAC audio track in it
+      bool ReadMovieBox(const unsigned char* data, size_t size);
+
+      /// reads track box; returns false when it's not an AAC audio track
+      bool ReadTrackBox(const unsigned char* data, size_t size);
+
+      /// reads sample description box, containing the mp4a sample entry
+      bool ReadSampleDescription(const unsigned char* data, size_t size);
+
+      /// reads elementary stream descriptor box, containing the decoder config
+      bool ReadElementaryStreamDescriptor(const unsigned char* data, size_t size);
+
+      /// reads sample table boxes and calculates access unit offsets
+      bool ReadSampleTables(const unsigned char* data, size_t size);
+
+   private:
+      /// handle of the mapped file
+      HANDLE m_fileHandle;
+
+      /// handle of the file mapping
+      HANDLE m_mappingHandle;
+
+      /// start of the mapped file; nullptr when not mapped
+      const unsigned char* m_mappedData;
+
+      /// size of the mapped file
+      size_t m_mappedSize;
+
+      /// decoder config
+      std::vector<unsigned char> m_decoderConfig;
+
+      /// number of channels
+      unsigned int m_numChannels;
+
+      /// sample rate, in Hz
+      unsigned int m_sampleRate;
+
+      /// average bitrate, in bits per second
+      unsigned int m_averageBitrate;
+
+      /// media timescale
+      unsigned int m_timescale;
+
+      /// track duration, in timescale units
+      unsigned long long m_duration;
+
+      /// file offsets of all access units
+      std::vector<unsigned long long> m_accessUnitOffsets;
+
+      /// sizes of all access units
+      std::vector<unsigned int> m_accessUnitSizes;
+
+      /// time to sample table; pairs of number of access units and their duration
+      std::vector<std::pair<unsigned int, unsigned int>> m_timeToSample;
+
+      /// index of the access unit read next
+      size_t m_currentAccessUnit;
+   };
+
+} // namespace Encoder
@@ -0,0 +1,132 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file OggStreamProbe.cpp
+/// \brief Ogg stream probe
+//
+#include "stdafx.h"
+#include "OggStreamProbe.hpp"
+
+using Encoder::OggStreamProbe;
+
+/// length of the fixed part of an Ogg page header
+const size_t c_pageHeaderLength = 27;
+
+/// maximum length of an Ogg page, including header and segment table
+const size_t c_maxPageLength = c_pageHeaderLength + 255 + 255 * 255;
+
+/// header type flag of the first page of a logical stream
+const unsigned char c_headerTypeBeginOfStream = 0x02;
+
+/// reads little-endian 32-bit value
+static unsigned int ReadUInt32(const unsigned char* data)
+{
+   return data[0] |
+      (static_cast<unsigned int>(data[1]) << 8) |
+      (static_cast<unsigned int>(data[2]) << 16) |
+      (static_cast<unsigned int>(data[3]) << 24);
+}
+
+/// reads little-endian 64-bit value
+static long long ReadInt64(const unsigned char* data)
+{
+   return static_cast<long long>(ReadUInt32(data)) |
+      (static_cast<long long>(ReadUInt32(data + 4)) << 32);
+}
+
+/// checks if an Ogg page header starts at given position
+static bool IsPageHeader(const unsigned char* data, size_t length)
+{
+   return length >= c_pageHeaderLength &&
+      memcmp(data, "OggS", 4) == 0 &&
+      data[4] == 0; // stream structure version
+}
+
+bool OggStreamProbe::ReadFirstPacket(std::vector<unsigned char>& packet)
+{
+   if (_fseeki64(m_fd, 0, SEEK_END) != 0)
+      return false;
+
+   m_fileSize = _ftelli64(m_fd);
+
+   unsigned char header[c_pageHeaderLength + 255] = {};
+
+   if (_fseeki64(m_fd, 0, SEEK_SET) != 0 ||
+      fread(header, 1, c_pageHeaderLength, m_fd) != c_pageHeaderLength ||
+      !IsPageHeader(header, c_pageHeaderLength) ||
+      (header[5] & c_headerTypeBeginOfStream) == 0)
+      return false;
+
+   m_serialNumber = ReadUInt32(header + 14);
+
+   unsigned char numSegments = header[26];
+   unsigned char* segmentTable = header + c_pageHeaderLength;
+
+   if (fread(segmentTable, 1, numSegments, m_fd) != numSegments)
+      return false;
+
+   // the packet ends with the first segment shorter than 255 bytes
+   size_t packetLength = 0;
+   bool packetComplete = false;
+   for (unsigned char segment = 0; segment < numSegments && !packetComplete; segment++)
+   {
+      packetLength += segmentTable[segment];
+      packetComplete = segmentTable[segment] < 255;
+   }
+
+   if (!packetComplete)
+      return false;
+
+   packet.resize(packetLength);
+
+   return packetLength == 0 ||
+      fread(packet.data(), 1, packetLength, m_fd) == packetLength;
+}
+
+long long OggStreamProbe::ReadLastGranulePosition()
+{
+   // the last page of the stream starts within the last maximum page length of the file
+   long long offset = m_fileSize > static_cast<long long>(c_maxPageLength) ?
+      m_fileSize - c_maxPageLength : 0;
+
+   std::vector<unsigned char> buffer(static_cast<size_t>(m_fileSize - offset));
+
+   if (buffer.empty() ||
+      _fseeki64(m_fd, offset, SEEK_SET) != 0 ||
+      fread(buffer.data(), 1, buffer.size(), m_fd) != buffer.size())
+      return -1;
+
+   // search backwards for the last page of the stream that has a granule position
+   for (size_t pos = buffer.size(); pos-- > 0;)
+   {
+      const unsigned char* page = buffer.data() + pos;
+      size_t remainingLength = buffer.size() - pos;
+
+      if (!IsPageHeader(page, remainingLength) ||
+         ReadUInt32(page + 14) != m_serialNumber)
+         continue;
+
+      long long granulePosition = ReadInt64(page + 6);
+
+      // pages on which no packet ends have no granule position
+      if (granulePosition != -1)
+         return granulePosition;
+   }
+
+   return -1;
+}
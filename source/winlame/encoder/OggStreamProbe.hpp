@@ -0,0 +1,65 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file OggStreamProbe.hpp
+/// \brief Ogg stream probe
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief reads stream infos from the pages of an Ogg file, without decoding it
+   /// \details only the first page and the last pages of the file are read; the page CRCs
+   /// aren't checked
+   class OggStreamProbe
+   {
+   public:
+      /// ctor; the file isn't closed by the probe
+      explicit OggStreamProbe(FILE* fd)
+         :m_fd(fd),
+         m_serialNumber(0),
+         m_fileSize(0)
+      {
+      }
+
+      /// \brief reads the first page of the file and returns the first packet of the stream
+      /// \details the first packet is the codec's identification header, which must be the
+      /// only packet on the first page
+      bool ReadFirstPacket(std::vector<unsigned char>& packet);
+
+      /// \brief returns the granule position of the last page of the stream
+      /// \details must be called after ReadFirstPacket(); returns -1 when not found
+      long long ReadLastGranulePosition();
+
+      /// returns file size, in bytes; valid after ReadFirstPacket()
+      long long FileSize() const { return m_fileSize; }
+
+   private:
+      /// file to read from
+      FILE* m_fd;
+
+      /// serial number of the logical stream in the first page
+      unsigned int m_serialNumber;
+
+      /// file size, in bytes
+      long long m_fileSize;
+   };
+
+} // namespace Encoder
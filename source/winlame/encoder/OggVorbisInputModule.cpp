@@ -24,10 +24,12 @@
 #include "OggVorbisInputModule.hpp"
 #include "resource.h"
 #include <fstream>
+#include <algorithm>
 #include "vorbis/vorbisfile.h"
 #include <ulib/UTF8.hpp>
 #include <opus/opusfile.h>
 #include "ChannelRemapper.hpp"
+#include "OggStreamProbe.hpp"
 
 using Encoder::OggVorbisInputModule;
 using Encoder::TrackInfo;
@@ -35,8 +37,8 @@ using Encoder::SampleContainer;
 
 extern CString GetOggVorbisVersionString();
 
-/// ogg vorbis input buffer size
-const int c_oggInputBufferSize = 512 * 6; // must be a multiple of max channels
+/// max. number of samples per channel to decode at once
+const int c_oggMaxDecodeSamples = 4096;
 
 static size_t ReadDataSource(void* buffer, size_t size, size_t count, void* dataSource)
 {
@@ -169,8 +171,10 @@ int OggVorbisInputModule::InitInput(LPCTSTR m_inputFilename,
    m_channels = vi->channels;
    m_samplerate = vi->rate;
 
-   // set up input traits
-   samplecont.SetInputModuleTraits(sizeof(short) * 8, SamplesInterleaved, m_samplerate, m_channels);
+   m_remappedChannels.resize(m_channels);
+
+   // set up input traits; the decoder produces float samples in separate channel buffers
+   samplecont.SetInputModuleTraits(sizeof(float) * 8, SamplesChannelArray, m_samplerate, m_channels, true);
 
    GetTrackInfo(trackInfo);
 
@@ -187,23 +191,59 @@ void OggVorbisInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& len
    samplerateInHz = vi->rate;
 }
 
+bool OggVorbisInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   if (!IsAvailable())
+      return false;
+
+   FILE* fd = _wfopen(filename, _T("rb"));
+   if (fd == nullptr)
+      return false;
+
+   std::shared_ptr<FILE> inputFile(fd, fclose);
+
+   // only reads the identification header on the first page and the last page's granule
+   // position; the comment and setup headers are only needed for decoding
+   OggStreamProbe probe(fd);
+
+   std::vector<unsigned char> packet;
+   if (!probe.ReadFirstPacket(packet) ||
+      packet.size() < 30 ||
+      memcmp(packet.data(), "\x01vorbis", 7) != 0)
+      return false;
+
+   int numChannels = packet[11];
+   int samplerateInHz = static_cast<int>(
+      packet[12] | (packet[13] << 8) | (packet[14] << 16) | (static_cast<unsigned int>(packet[15]) << 24));
+   int bitrateNominal = static_cast<int>(
+      packet[20] | (packet[21] << 8) | (packet[22] << 16) | (static_cast<unsigned int>(packet[23]) << 24));
+
+   if (numChannels == 0 || samplerateInHz <= 0)
+      return false;
+
+   // the granule position of Vorbis pages is the sample count
+   long long numTotalSamples = probe.ReadLastGranulePosition();
+
+   info.m_numChannels = numChannels;
+   info.m_samplerateInHz = samplerateInHz;
+   info.m_numSamples = numTotalSamples > 0 ? numTotalSamples : 0;
+   info.m_lengthInSeconds = int(info.m_numSamples / samplerateInHz);
+
+   if (bitrateNominal > 0)
+      info.m_bitrateInBps = bitrateNominal;
+   else if (info.m_numSamples > 0)
+      info.m_bitrateInBps = static_cast<int>(probe.FileSize() * 8 * samplerateInHz / info.m_numSamples);
+
+   return true;
+}
+
 int OggVorbisInputModule::DecodeSamples(SampleContainer& samples)
 {
-   short buffer[c_oggInputBufferSize];
+   // read in samples; the channel buffers belong to the decoder
+   float** pcm = nullptr;
    int bitstream;
 
-   // temporary sample buffer
-   short* outputBuffer;
-   short tempBuffer[c_oggInputBufferSize];
-
-   // read in samples
-   int ret = ov_read(&m_vf,
-      reinterpret_cast<char*>(buffer),
-      c_oggInputBufferSize * sizeof(short),
-      0,
-      sizeof(short),
-      1,
-      &bitstream);
+   long ret = ov_read_float(&m_vf, &pcm, c_oggMaxDecodeSamples, &bitstream);
 
    if (ret < 0)
    {
@@ -211,26 +251,40 @@ int OggVorbisInputModule::DecodeSamples(SampleContainer& samples)
       return ret;
    }
 
-   ret /= m_channels * sizeof(short);
-
-   // channel remap
-   if (m_channels > 2 && ret > 0)
+   if (ret > 0)
    {
-      outputBuffer = tempBuffer;
-      ChannelRemapper::RemapInterleaved(T_enChannelMapType::oggVorbisInputChannelMap,
-         buffer, ret, m_channels, outputBuffer);
-   }
-   else
-      outputBuffer = buffer;
+      // channel remap
+      float** channels = pcm;
+      if (m_channels > 2)
+      {
+         ChannelRemapper::RemapArrayPointers(T_enChannelMapType::oggVorbisInputChannelMap,
+            pcm, m_channels, m_remappedChannels.data());
 
-   if (ret > 0)
-      samples.PutSamplesInterleaved(outputBuffer, ret);
+         channels = m_remappedChannels.data();
+      }
+
+      samples.PutSamplesArray(reinterpret_cast<void**>(channels), ret);
+   }
 
    m_numCurrentSamples += ret;
 
    return ret;
 }
 
+bool OggVorbisInputModule::SeekToEnd(unsigned int numSamples)
+{
+   if (!ov_seekable(&m_vf) || m_numMaxSamples <= 0)
+      return false;
+
+   __int64 startSample = std::max<__int64>(0, m_numMaxSamples - numSamples);
+
+   if (ov_pcm_seek(&m_vf, startSample) != 0)
+      return false;
+
+   m_numCurrentSamples = startSample;
+   return true;
+}
+
 void OggVorbisInputModule::DoneInput()
 {
    ov_clear(&m_vf);
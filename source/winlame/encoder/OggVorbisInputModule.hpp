@@ -64,9 +64,15 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
+      /// seeks to the last samples of the track
+      virtual bool SeekToEnd(unsigned int numSamples) override;
+
       /// returns the number of percent done
       virtual float PercentDone() const override
       {
@@ -93,6 +99,9 @@ namespace Encoder
       /// input file
       FILE* m_inputFile;
 
+      /// channel pointers of the decoded samples, in remapped channel order
+      std::vector<float*> m_remappedChannels;
+
       /// decoding file struct
       mutable OggVorbis_File m_vf;
    };
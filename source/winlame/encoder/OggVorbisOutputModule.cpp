@@ -41,10 +41,16 @@ extern bool GetRandomNumber(int& randomNumber);
 #pragma comment(lib, "libvorbis.lib")
 #pragma comment(lib, "libvorbisfile.lib")
 
+/// size of the page buffer at which the pages are written out
+const size_t c_pageBufferFlushSize = 256 * 1024;
+
 OggVorbisOutputModule::OggVorbisOutputModule()
    :m_bitrateMode(0),
    m_baseQuality(0.0),
-   m_endOfStream(false)
+   m_endOfStream(false),
+   m_bufferPages(true),
+   m_isChunkPending(false),
+   m_stopEncoderThread(false)
 {
    m_moduleId = ID_OM_OGGV;
 
@@ -59,6 +65,7 @@ OggVorbisOutputModule::OggVorbisOutputModule()
 
 OggVorbisOutputModule::~OggVorbisOutputModule()
 {
+   StopEncoderThread();
 }
 
 bool OggVorbisOutputModule::IsAvailable() const
@@ -181,9 +188,24 @@ int OggVorbisOutputModule::InitOutput(LPCTSTR outfilename,
 
    InitEncoder();
 
+   m_bufferPages = mgr.QueryValueInt(OggPageBuffering) == 1;
+
+   m_pageBuffer.clear();
+   if (m_bufferPages)
+      m_pageBuffer.reserve(c_pageBufferFlushSize * 2);
+
+   m_channelRemapPlan = ChannelRemapPlan(T_enChannelMapType::oggVorbisOutputChannelMap, m_channels);
+
    WriteHeader();
 
-   samples.SetOutputModuleTraits(16, SamplesChannelArray, m_samplerate, m_channels);
+   samples.SetOutputModuleTraits(32, SamplesChannelArray, m_samplerate, m_channels, true);
+
+   if (mgr.QueryValueInt(OggEncoderThread) == 1)
+   {
+      m_isChunkPending = false;
+      m_stopEncoderThread = false;
+      m_encoderThread = std::thread(&OggVorbisOutputModule::RunEncoderThread, this);
+   }
 
    return 0;
 }
@@ -402,33 +424,52 @@ void OggVorbisOutputModule::WriteHeader()
       if (result == 0)
          break;
 
-      m_outputStream.write(reinterpret_cast<char*>(m_og.header), m_og.header_len);
-      m_outputStream.write(reinterpret_cast<char*>(m_og.body), m_og.body_len);
+      WritePage(m_og);
    }
 }
 
+size_t OggVorbisOutputModule::EstimatedBufferMemoryUsage(size_t blockSize) const
+{
+   // the page buffer is written out when it's full, and is reserved with twice the size;
+   // the fill and the pending chunk each store one block as float samples
+   return c_pageBufferFlushSize * 2 + 2 * blockSize;
+}
+
 int OggVorbisOutputModule::EncodeSamples(SampleContainer& samples)
 {
+   // get samples
+   int numSamples = 0;
+   float** buffer = (float**)samples.GetSamplesArray(numSamples);
+
+   if (m_encoderThread.joinable())
+   {
+      PassSamplesToEncoderThread(buffer, numSamples);
+      return numSamples;
+   }
+
    if (m_endOfStream)
       return 0;
 
-   // get samples
-   int numSamples = 0;
-   short** buffer = (short**)samples.GetSamplesArray(numSamples);
+   EncodeChannelArray(buffer, numSamples, m_channels > 2);
+
+   return numSamples;
+}
 
+void OggVorbisOutputModule::EncodeChannelArray(float** buffer, int numSamples, bool remapChannels)
+{
    if (numSamples != 0)
    {
       float** sampleBuffer = vorbis_analysis_buffer(&m_vd, numSamples);
 
       // copy samples to analysis buffer
-      if (m_channels > 2)
+      if (remapChannels)
       {
-         ChannelRemapper::RemapArrayToFloat(T_enChannelMapType::oggVorbisOutputChannelMap,
-            buffer, numSamples, m_channels, sampleBuffer);
+         m_channelRemapPlan.RemapArray(buffer, numSamples, sampleBuffer);
       }
       else
       {
-         ChannelRemapper::ConvertSamplesToFloat(buffer, numSamples, m_channels, sampleBuffer);
+         for (int channelIndex = 0; channelIndex < m_channels; channelIndex++)
+            std::copy_n(buffer[channelIndex], numSamples, sampleBuffer[channelIndex]);
       }
    }
 
@@ -436,8 +477,6 @@ int OggVorbisOutputModule::EncodeSamples(SampleContainer& samples)
    vorbis_analysis_wrote(&m_vd, numSamples);
 
    WriteBlocks();
-
-   return numSamples;
 }
 
 void OggVorbisOutputModule::WriteBlocks()
@@ -463,8 +502,7 @@ void OggVorbisOutputModule::WriteBlocks()
             if (result == 0)
                break;
 
-            m_outputStream.write(reinterpret_cast<char*>(m_og.header), m_og.header_len);
-            m_outputStream.write(reinterpret_cast<char*>(m_og.body), m_og.body_len);
+            WritePage(m_og);
 
             // this could be set above, but for illustrative purposes, I do
             // it here (to show that vorbis does know where the stream ends)
@@ -475,16 +513,124 @@ void OggVorbisOutputModule::WriteBlocks()
    }
 }
 
-void OggVorbisOutputModule::DoneOutput()
+void OggVorbisOutputModule::WritePage(const ogg_page& page)
 {
-   if (!m_lastError.IsEmpty())
+   if (!m_bufferPages)
+   {
+      m_outputStream.write(reinterpret_cast<char*>(page.header), page.header_len);
+      m_outputStream.write(reinterpret_cast<char*>(page.body), page.body_len);
+      return;
+   }
+
+   m_pageBuffer.insert(m_pageBuffer.end(), page.header, page.header + page.header_len);
+   m_pageBuffer.insert(m_pageBuffer.end(), page.body, page.body + page.body_len);
+
+   if (m_pageBuffer.size() >= c_pageBufferFlushSize)
+      FlushPageBuffer();
+}
+
+void OggVorbisOutputModule::FlushPageBuffer()
+{
+   if (m_pageBuffer.empty())
+      return;
+
+   m_outputStream.write(m_pageBuffer.data(), m_pageBuffer.size());
+   m_pageBuffer.clear();
+}
+
+void OggVorbisOutputModule::PassSamplesToEncoderThread(float** buffer, int numSamples)
+{
+   // remap channels while the encoder thread is still busy with the previous chunk
+   m_fillChunk.m_numSamples = numSamples;
+   m_fillChunk.m_samples.resize(static_cast<size_t>(m_channels) * numSamples);
+
+   std::vector<float*> channelsList(m_channels);
+   for (int channelIndex = 0; channelIndex < m_channels; channelIndex++)
+      channelsList[channelIndex] = m_fillChunk.m_samples.data() + static_cast<size_t>(channelIndex) * numSamples;
+
+   if (numSamples != 0)
+   {
+      if (m_channels > 2)
+      {
+         m_channelRemapPlan.RemapArray(buffer, numSamples, channelsList.data());
+      }
+      else
+      {
+         for (int channelIndex = 0; channelIndex < m_channels; channelIndex++)
+            std::copy_n(buffer[channelIndex], numSamples, channelsList[channelIndex]);
+      }
+   }
+
+   std::unique_lock<std::mutex> lock(m_chunkMutex);
+   m_chunkCondition.wait(lock, [&]() { return !m_isChunkPending; });
+
+   std::swap(m_fillChunk, m_pendingChunk);
+   m_isChunkPending = true;
+
+   lock.unlock();
+   m_chunkCondition.notify_all();
+}
+
+void OggVorbisOutputModule::RunEncoderThread()
+{
+   SampleChunk chunk;
+   std::vector<float*> channelsList(m_channels);
+
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(m_chunkMutex);
+         m_chunkCondition.wait(lock, [&]() { return m_isChunkPending || m_stopEncoderThread; });
+
+         if (!m_isChunkPending)
+            return;
+
+         std::swap(chunk, m_pendingChunk);
+         m_isChunkPending = false;
+      }
+
+      m_chunkCondition.notify_all();
+
+      if (m_endOfStream)
+         continue;
+
+      for (int channelIndex = 0; channelIndex < m_channels; channelIndex++)
+         channelsList[channelIndex] = chunk.m_samples.data() + static_cast<size_t>(channelIndex) * chunk.m_numSamples;
+
+      EncodeChannelArray(channelsList.data(), chunk.m_numSamples, false);
+   }
+}
+
+void OggVorbisOutputModule::StopEncoderThread()
+{
+   if (!m_encoderThread.joinable())
       return;
 
+   {
+      std::unique_lock<std::mutex> lock(m_chunkMutex);
+      m_stopEncoderThread = true;
+   }
+
+   m_chunkCondition.notify_all();
+
+   m_encoderThread.join();
+}
+
+int OggVorbisOutputModule::DoneOutput()
+{
+   // the encoder thread encodes the last chunk before stopping
+   StopEncoderThread();
+
+   if (!m_lastError.IsEmpty())
+      return -1;
+
    vorbis_analysis_wrote(&m_vd, 0);
 
    // put out the last ogg blocks
    WriteBlocks();
 
+   FlushPageBuffer();
+
    // clean up and exit.  vorbis_info_clear() must be called last
    ogg_stream_clear(&m_os);
    vorbis_block_clear(&m_vb);
@@ -496,4 +642,6 @@ void OggVorbisOutputModule::DoneOutput()
    // libvorbis.  They're never freed or manipulated directly
 
    m_outputStream.close();
+
+   return 0;
 }
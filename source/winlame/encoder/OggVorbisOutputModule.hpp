@@ -22,7 +22,12 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "ChannelRemapper.hpp"
 #include <iosfwd>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "vorbis/codec.h"
 
 namespace Encoder
@@ -54,6 +59,12 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return _T("ogg"); }
 
+      /// the encoder takes float samples
+      virtual bool PrefersFloatSamples() const override { return true; }
+
+      /// returns the max. memory used by the page buffer and the encoder thread's sample chunks
+      virtual size_t EstimatedBufferMemoryUsage(size_t blockSize) const override;
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
@@ -62,7 +73,7 @@ namespace Encoder
       virtual int EncodeSamples(SampleContainer& samples) override;
 
       /// cleans up the output module
-      virtual void DoneOutput() override;
+      virtual int DoneOutput() override;
 
    private:
       /// initializes vorbis info struct
@@ -77,9 +88,47 @@ namespace Encoder
       /// writes Ogg Vorbis header
       void WriteHeader();
 
+      /// passes samples to the encoder and writes all ready blocks; the channels are remapped
+      /// to the Vorbis channel order when requested
+      void EncodeChannelArray(float** buffer, int numSamples, bool remapChannels);
+
       /// write all ready blocks
       void WriteBlocks();
 
+      /// appends page to the page buffer; writes out the buffer when it's full
+      void WritePage(const ogg_page& page);
+
+      /// writes out all pages in the page buffer
+      void FlushPageBuffer();
+
+      /// \brief passes samples to the encoder thread
+      /// \details the samples are remapped into a chunk, and the chunk is handed over as soon as
+      /// the encoder thread has taken the previous chunk
+      void PassSamplesToEncoderThread(float** buffer, int numSamples);
+
+      /// encoder thread function; encodes chunks until stopped
+      void RunEncoderThread();
+
+      /// stops encoder thread, after it encoded the last chunk
+      void StopEncoderThread();
+
+   private:
+      /// samples passed to the encoder thread
+      struct SampleChunk
+      {
+         /// ctor
+         SampleChunk()
+            :m_numSamples(0)
+         {
+         }
+
+         /// samples, one channel after another
+         std::vector<float> m_samples;
+
+         /// number of samples per channel
+         int m_numSamples;
+      };
+
    private:
       /// output file stream
       std::ofstream m_outputStream;
@@ -96,6 +145,40 @@ namespace Encoder
       /// end of stream marker
       bool m_endOfStream;
 
+      /// remap plan from the input channel order to the Vorbis channel order
+      ChannelRemapPlan m_channelRemapPlan;
+
+      /// indicates if completed pages are collected in the page buffer; when not set, each
+      /// page is written to the output stream right away
+      bool m_bufferPages;
+
+      /// buffer with completed pages, written out in large blocks
+      std::vector<char> m_pageBuffer;
+
+      /// chunk that is filled by EncodeSamples()
+      SampleChunk m_fillChunk;
+
+      /// chunk handed over to the encoder thread
+      SampleChunk m_pendingChunk;
+
+      /// indicates that m_pendingChunk contains samples not yet taken by the encoder thread
+      bool m_isChunkPending;
+
+      /// indicates that the encoder thread should stop after encoding the pending chunk
+      bool m_stopEncoderThread;
+
+      /// mutex to protect pending chunk and flags
+      std::mutex m_chunkMutex;
+
+      /// condition signaled when a chunk was handed over or taken, or when stopping
+      std::condition_variable m_chunkCondition;
+
+      /// \brief encoder thread; only running when enabled in the settings
+      /// \details while running, the encoder thread is the only one using the encoder state,
+      /// so that analysis, bitrate management and page output of the samples run in parallel
+      /// to decoding the next samples
+      std::thread m_encoderThread;
+
       /// take physical pages, weld into a logical stream of packets
       ogg_stream_state m_os;
 
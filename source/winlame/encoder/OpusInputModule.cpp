@@ -22,6 +22,8 @@
 #include "stdafx.h"
 #include "OpusInputModule.hpp"
 #include "resource.h"
+#include "ChannelRemapper.hpp"
+#include "OggStreamProbe.hpp"
 #include <ulib/UTF8.hpp>
 
 using Encoder::OpusInputModule;
@@ -31,6 +33,9 @@ using Encoder::SampleContainer;
 #pragma comment(lib, "opusfile.lib")
 #pragma comment(lib, "opus.lib")
 
+/// max. number of samples per channel in a single Opus packet; 120 ms at 48 kHz
+const int c_maxPacketSamples = 5760;
+
 OpusInputModule::OpusInputModule()
    :m_numTotalSamples(0)
 {
@@ -107,9 +112,12 @@ int OpusInputModule::InitInput(LPCTSTR infilename, SettingsManager& mgr,
 
    const OpusHead* header = op_head(m_inputFile.get(), 0);
 
-   // set up input traits
-   samples.SetInputModuleTraits(16, SamplesInterleaved,
-      48000, header->channel_count);
+   m_sampleBuffer.resize(c_maxPacketSamples * header->channel_count);
+   SetupChannelRemapping(header->channel_count, header->mapping_family);
+
+   // set up input traits; the decoder produces interleaved float samples
+   samples.SetInputModuleTraits(32, SamplesInterleaved,
+      48000, header->channel_count, true);
 
    m_numTotalSamples = op_pcm_total(m_inputFile.get(), -1);
 
@@ -134,23 +142,78 @@ void OpusInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengthIn
    numChannels = header->channel_count;
 }
 
+bool OpusInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   FILE* fd = nullptr;
+   errno_t err = _tfopen_s(&fd, filename, _T("rb"));
+
+   if (err != 0 || fd == nullptr)
+      return false;
+
+   std::shared_ptr<FILE> inputFile(fd, fclose);
+
+   // only reads the OpusHead packet on the first page and the last page's granule position;
+   // the OpusTags packet is only needed for the track infos
+   OggStreamProbe probe(fd);
+
+   std::vector<unsigned char> packet;
+   if (!probe.ReadFirstPacket(packet) ||
+      packet.size() < 19 ||
+      memcmp(packet.data(), "OpusHead", 8) != 0)
+      return false;
+
+   int numChannels = packet[9];
+   unsigned int preSkip = packet[10] | (packet[11] << 8);
+
+   if (numChannels == 0)
+      return false;
+
+   // the granule position of Opus pages counts 48 kHz samples, including the pre-skip
+   long long lastGranulePosition = probe.ReadLastGranulePosition();
+   long long numTotalSamples = lastGranulePosition - preSkip;
+
+   info.m_numChannels = numChannels;
+   info.m_samplerateInHz = 48000;
+   info.m_numSamples = numTotalSamples > 0 ? numTotalSamples : 0;
+   info.m_lengthInSeconds = static_cast<int>(info.m_numSamples / 48000);
+
+   if (info.m_numSamples > 0)
+      info.m_bitrateInBps = static_cast<int>(probe.FileSize() * 8 * 48000 / info.m_numSamples);
+
+   return true;
+}
+
 int OpusInputModule::DecodeSamples(SampleContainer& samples)
 {
    const OpusHead* header = op_head(m_inputFile.get(), 0);
    if (header == nullptr)
       return -1;
 
-   short sampleBuffer[48000];
-
    int currentLink = 0;
-   int numSamplesPerChannel = op_read(m_inputFile.get(), sampleBuffer, sizeof(sampleBuffer) / sizeof(*sampleBuffer), &currentLink);
+   int numSamplesPerChannel = op_read_float(m_inputFile.get(),
+      m_sampleBuffer.data(), static_cast<int>(m_sampleBuffer.size()), &currentLink);
+
+   if (numSamplesPerChannel < 0)
+   {
+      m_lastError.LoadString(IDS_ENCODER_INTERNAL_DECODE_ERROR);
+      m_lastError.AppendFormat(_T(" (%s)"), ErrorTextFromCode(numSamplesPerChannel));
+      return numSamplesPerChannel;
+   }
 
    if (numSamplesPerChannel == 0)
       return 0;
 
-   samples.PutSamplesInterleaved(sampleBuffer, numSamplesPerChannel);
+   int numChannels = header->channel_count;
+
+   if (!m_remappedChannels.empty())
+   {
+      samples.PutSamplesArray(reinterpret_cast<void**>(m_remappedChannels.data()), numSamplesPerChannel,
+         numChannels * sizeof(float));
+   }
+   else
+      samples.PutSamplesInterleaved(m_sampleBuffer.data(), numSamplesPerChannel);
 
-   return numSamplesPerChannel * header->channel_count;
+   return numSamplesPerChannel * numChannels;
 }
 
 float OpusInputModule::PercentDone() const
@@ -169,6 +232,26 @@ void OpusInputModule::DoneInput()
    m_inputFile.reset();
 }
 
+void OpusInputModule::SetupChannelRemapping(int numChannels, int mappingFamily)
+{
+   m_remappedChannels.clear();
+
+   // channel mapping family 1 uses the Vorbis channel order
+   if (numChannels <= 2 ||
+      mappingFamily != 1)
+      return;
+
+   // remap by pointing to the channels in the interleaved buffer, in remapped order
+   std::vector<float*> channels(numChannels);
+   for (int channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      channels[channelIndex] = m_sampleBuffer.data() + channelIndex;
+
+   m_remappedChannels.resize(numChannels);
+
+   ChannelRemapper::RemapArrayPointers(T_enChannelMapType::oggVorbisInputChannelMap,
+      channels.data(), numChannels, m_remappedChannels.data());
+}
+
 void OpusInputModule::GetTrackInfo(TrackInfo& trackInfo)
 {
    const OpusTags* tags = op_tags(m_inputFile.get(), 0);
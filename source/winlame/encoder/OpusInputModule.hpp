@@ -63,6 +63,9 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
@@ -76,6 +79,9 @@ namespace Encoder
       /// reads track info from Opus tags
       void GetTrackInfo(TrackInfo& trackInfo);
 
+      /// sets up channel pointers into the sample buffer, when channels have to be remapped
+      void SetupChannelRemapping(int numChannels, int mappingFamily);
+
       /// formats error text from error code
       static LPCTSTR ErrorTextFromCode(int errorCode);
 
@@ -103,6 +109,13 @@ namespace Encoder
 
       /// total number of samples in the file
       ogg_int64_t m_numTotalSamples;
+
+      /// buffer for decoded interleaved float samples; holds the samples of the largest Opus packet
+      std::vector<float> m_sampleBuffer;
+
+      /// channel pointers into the sample buffer, in remapped channel order; empty when the
+      /// channels don't need to be remapped
+      std::vector<float*> m_remappedChannels;
    };
 
 } // namespace Encoder
@@ -22,6 +22,7 @@
 #include "stdafx.h"
 #include "resource.h"
 #include "OpusOutputModule.hpp"
+#include "ChannelRemapper.hpp"
 #include <ulib/UTF8.hpp>
 #include "App.hpp"
 #include <wincrypt.h>
@@ -172,11 +173,11 @@ OpusOutputModule::OpusOutputModule()
    m_opusBitrateMode(0),
    m_inputSampleRate(48000),
    m_inputSampleSize(16),
+   m_isInputFloat(true),
    m_codingRate(48000),
    m_downmix(0),
    m_frameSize(960),
    m_numSamplesPerFrame(0),
-   m_32bitMode(false),
    m_outputStreamAtEnd(false)
 {
    m_moduleId = ID_OM_OPUS;
@@ -210,7 +211,7 @@ CString OpusOutputModule::GetDescription() const
    desc.Format(IDS_FORMAT_INFO_OPUS_OUTPUT,
       m_channels,
       m_inputSampleRate,
-      m_32bitMode ? 32 : 16,
+      m_inputSampleSize,
       bitrateMode,
       m_bitrateInBps / 1000,
       m_complexity);
@@ -234,8 +235,6 @@ int OpusOutputModule::InitOutput(LPCTSTR outfilename,
    m_channels = samples.GetInputModuleChannels();
    m_inputSampleSize = samples.GetInputModuleBitsPerSample();
 
-   m_32bitMode = samples.GetInputModuleBitsPerSample() == 32;
-
    // set options from UI
    m_bitrateInBps = mgr.QueryValueInt(OpusTargetBitrate) * 1000;
    m_complexity = mgr.QueryValueInt(OpusComplexity);
@@ -255,8 +254,13 @@ int OpusOutputModule::InitOutput(LPCTSTR outfilename,
 
    m_samplerate = m_codingRate;
 
+   // the encoder expects the Vorbis channel order; the channels are remapped when filling the
+   // input buffer, and integer samples are converted to float in the same pass
+   m_channelRemapPlan = ChannelRemapPlan(T_enChannelMapType::oggVorbisOutputChannelMap, m_channels);
+   m_isInputFloat = samples.IsInputModuleFloat();
+
    // set up output traits
-   samples.SetOutputModuleTraits(m_32bitMode ? 32 : 16, SamplesInterleaved, m_samplerate, m_channels);
+   samples.SetOutputModuleTraits(32, SamplesInterleaved, m_samplerate, m_channels, m_isInputFloat);
 
    return 0;
 }
@@ -271,11 +275,13 @@ int OpusOutputModule::EncodeSamples(SampleContainer& samples)
    return numSamples;
 }
 
-void OpusOutputModule::DoneOutput()
+int OpusOutputModule::DoneOutput()
 {
    EncodeRemainingInputBuffer();
 
    m_encoder.Close();
+
+   return 0;
 }
 
 bool OpusOutputModule::StoreTrackInfos(const TrackInfo& trackinfo)
@@ -543,40 +549,14 @@ bool OpusOutputModule::OpenOutputFile(LPCTSTR outputFilename)
    return false;
 }
 
-long OpusOutputModule::ReadFloatSamples16(float* buffer, int samples)
+long OpusOutputModule::ReadFloatSamples(float* buffer, int samples)
 {
-   int numSamples = std::min(m_inputInt16Buffer.size(), size_t(samples * m_channels));
+   int numSamples = std::min(m_inputSampleBuffer.size(), size_t(samples * m_channels));
 
-   //ATLTRACE(_T("ReadFloatSamples16: Requesting %i samples, returning %i samples\n"), samples, numSamples / m_channels);
-
-   const int16_t scaleFactor = std::numeric_limits<int16_t>::max();
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      buffer[i] = float(m_inputInt16Buffer[i]) / scaleFactor;
-   }
+   std::copy_n(m_inputSampleBuffer.begin(), numSamples, buffer);
 
    // remove samples from input buffer
-   m_inputInt16Buffer.erase(m_inputInt16Buffer.begin(), m_inputInt16Buffer.begin() + numSamples);
-
-   return numSamples / m_channels;
-}
-
-long OpusOutputModule::ReadFloatSamples32(float* buffer, int samples)
-{
-   int numSamples = std::min(m_inputInt32Buffer.size(), size_t(samples * m_channels));
-
-   //ATLTRACE(_T("ReadFloatSamples32: Requesting %i samples, returning %i samples\n"), samples, numSamples / m_channels);
-
-   const int32_t scaleFactor = std::numeric_limits<int32_t>::max();
-
-   for (int i = 0; i < numSamples; i++)
-   {
-      buffer[i] = float(m_inputInt32Buffer[i]) / scaleFactor;
-   }
-
-   // remove samples from input buffer
-   m_inputInt32Buffer.erase(m_inputInt32Buffer.begin(), m_inputInt32Buffer.begin() + numSamples);
+   m_inputSampleBuffer.erase(m_inputSampleBuffer.begin(), m_inputSampleBuffer.begin() + numSamples);
 
    return numSamples / m_channels;
 }
@@ -586,31 +566,18 @@ int OpusOutputModule::RefillInputSampleBuffer(SampleContainer& samples)
    // get samples
    int numSamples = 0;
 
-   if (m_32bitMode)
-   {
-      static_assert(sizeof(int) == sizeof(opus_int32), "short and opus_int16 must have the same size");
+   // numSamples is in "samples per channel", so input buffer contains numSamples*m_channels samples
+   void* inputBuffer = samples.GetSamplesInterleaved(numSamples);
 
-      // numSamples is in "samples per channel", so input buffer contains numSamples*m_channels samples
-      opus_int32* inputBuffer = (opus_int32*)samples.GetSamplesInterleaved(numSamples);
+   size_t startIndex = m_inputSampleBuffer.size();
 
-      size_t startIndex = m_inputInt32Buffer.size();
+   m_inputSampleBuffer.resize(startIndex + numSamples * m_channels);
 
-      m_inputInt32Buffer.resize(startIndex + numSamples * m_channels);
-
-      std::copy_n(inputBuffer, numSamples * m_channels, m_inputInt32Buffer.begin() + startIndex);
-   }
+   float* outputBuffer = m_inputSampleBuffer.data() + startIndex;
+   if (m_isInputFloat)
+      m_channelRemapPlan.RemapInterleaved(static_cast<const float*>(inputBuffer), numSamples, outputBuffer);
    else
-   {
-      static_assert(sizeof(short) == sizeof(opus_int16), "short and opus_int16 must have the same size");
-
-      opus_int16* inputBuffer = (opus_int16*)samples.GetSamplesInterleaved(numSamples);
-
-      size_t startIndex = m_inputInt16Buffer.size();
-
-      m_inputInt16Buffer.resize(startIndex + numSamples * m_channels);
-
-      std::copy_n(inputBuffer, numSamples * m_channels, m_inputInt16Buffer.begin() + startIndex);
-   }
+      m_channelRemapPlan.RemapInterleavedToFloat(static_cast<const int*>(inputBuffer), numSamples, outputBuffer);
 
    return numSamples;
 }
@@ -619,7 +586,7 @@ bool OpusOutputModule::EncodeInputBufferUntilEmpty()
 {
    // as long as the input buffer has samples for one frame, encode it
    bool inputBufferSufficientSamples =
-      (m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size()) >= size_t(m_numSamplesPerFrame);
+      m_inputSampleBuffer.size() >= size_t(m_numSamplesPerFrame);
 
    while (inputBufferSufficientSamples)
    {
@@ -627,7 +594,7 @@ bool OpusOutputModule::EncodeInputBufferUntilEmpty()
          return false; // error occured
 
       inputBufferSufficientSamples =
-         (m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size()) >= size_t(m_numSamplesPerFrame);
+         m_inputSampleBuffer.size() >= size_t(m_numSamplesPerFrame);
    }
 
    return true;
@@ -635,13 +602,13 @@ bool OpusOutputModule::EncodeInputBufferUntilEmpty()
 
 void OpusOutputModule::EncodeRemainingInputBuffer()
 {
-   size_t inputBufferSize = m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size();
+   size_t inputBufferSize = m_inputSampleBuffer.size();
 
    if (inputBufferSize > 0)
    {
       EncodeInputBufferUntilEmpty();
 
-      inputBufferSize = m_32bitMode ? m_inputInt32Buffer.size() : m_inputInt16Buffer.size();
+      inputBufferSize = m_inputSampleBuffer.size();
 
       if (inputBufferSize > 0)
       {
@@ -667,17 +634,14 @@ bool OpusOutputModule::EncodeInputBufferFrame()
    // read samples
    opus_int32 nb_samples = -1; // number of samples, per channel
 
-   if (m_32bitMode)
-      nb_samples = ReadFloatSamples32(m_inputFloatBuffer.data(), m_frameSize);
-   else
-      nb_samples = ReadFloatSamples16(m_inputFloatBuffer.data(), m_frameSize);
+   nb_samples = ReadFloatSamples(m_inputFloatBuffer.data(), m_frameSize);
 
    if (nb_samples < m_frameSize)
    {
       m_outputStreamAtEnd = true;
    }
 
-   if (!m_downmixMatrix.empty())
+   if (m_downmixer.IsActive())
       DownmixSamples(nb_samples);
 
    int ret = ope_encoder_write_float(m_encoder.enc, m_inputFloatBuffer.data(), nb_samples);
@@ -716,49 +680,6 @@ std::string OpusOutputModule::GetMetadataBlockPicture(const std::vector<unsigned
    return base64image;
 }
 
-// Note: The stupid_matrix table and the code in SetupDownmix() and
-// DownmixSamples() is taken from opus-tools' audio-in.c file:
-// https://github.com/xiph/opus-tools/blob/master/src/audio-in.c
-// The following copyright header appears in the file
-//
-/* Copyright 2000-2002, Michael Smith <msmith@xiph.org>
-             2010, Monty <monty@xiph.org>
-   AIFF/AIFC support from OggSquish, (c) 1994-1996 Monty <xiphmont@xiph.org>
-   (From GPL code in oggenc relicensed by permission from Monty and Msmith)
-   File: audio-in.c
-   Redistribution and use in source and binary forms, with or without
-   modification, are permitted provided that the following conditions
-   are met:
-   - Redistributions of source code must retain the above copyright
-   notice, this list of conditions and the following disclaimer.
-   - Redistributions in binary form must reproduce the above copyright
-   notice, this list of conditions and the following disclaimer in the
-   documentation and/or other materials provided with the distribution.
-   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
-   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
-   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
-   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-/// \brief matrix for downsampling from N channels to 2 channels
-static const float stupid_matrix[7][8][2] =
-{
-   /*2*/  {{1,0}, {0,1}},
-   /*3*/  {{1,0}, {0.7071f,0.7071f}, {0,1}},
-   /*4*/  {{1,0}, {0,1},{0.866f,0.5f}, {0.5f,0.866f}},
-   /*5*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}},
-   /*6*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.7071f,0.7071f}},
-   /*7*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.6123f,0.6123f}, {0.7071f,0.7071f}},
-   /*8*/  {{1,0}, {0.7071f,0.7071f}, {0,1}, {0.866f,0.5f}, {0.5f,0.866f}, {0.866f,0.5f}, {0.5f,0.866f}, {0.7071f,0.7071f}},
-};
-
 bool OpusOutputModule::SetupDownmix(size_t inputNumChannels, size_t outputNumChannels)
 {
    if (inputNumChannels <= outputNumChannels || outputNumChannels > 2 || inputNumChannels <= 0 || outputNumChannels <= 0)
@@ -773,58 +694,15 @@ bool OpusOutputModule::SetupDownmix(size_t inputNumChannels, size_t outputNumCha
       return false;
    }
 
-   m_downmixMatrix.resize(inputNumChannels * outputNumChannels);
-
-   if (outputNumChannels == 1 && inputNumChannels > 8)
-   {
-      for (size_t i = 0; i < inputNumChannels; i++)
-         m_downmixMatrix[i] = 1.0f / inputNumChannels;
-   }
-   else if (outputNumChannels == 2)
-   {
-      for (size_t j = 0; j < outputNumChannels; j++)
-         for (size_t i = 0; i < inputNumChannels; i++)
-            m_downmixMatrix[inputNumChannels * j + i] = stupid_matrix[inputNumChannels - 2][i][j];
-   }
-   else
-   {
-      for (size_t i = 0; i < inputNumChannels; i++)
-         m_downmixMatrix[i] = stupid_matrix[inputNumChannels - 2][i][0] + stupid_matrix[inputNumChannels - 2][i][1];
-   }
-
-   float sum = 0.f;
-   for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
-      sum += m_downmixMatrix[i];
-
-   sum = (float)outputNumChannels / sum;
-   for (size_t i = 0; i < inputNumChannels * outputNumChannels; i++)
-      m_downmixMatrix[i] *= sum;
-
-   return true;
+   // the input buffer contains the samples in Vorbis channel order
+   return m_downmixer.Init(inputNumChannels, outputNumChannels, true);
 }
 
-void OpusOutputModule::DownmixSamples(opus_int32& numSamplesPerChannel)
+void OpusOutputModule::DownmixSamples(opus_int32 numSamplesPerChannel)
 {
    ATLASSERT(m_downmix == 1 || m_downmix == 2); // downmix value must be 1 or 2
 
-   size_t inputNumChannels = m_channels;
-   size_t outputNumChannels = m_downmix;
-
-   for (opus_int32 i = 0; i < numSamplesPerChannel; i++)
-   {
-      for (size_t j = 0; j < outputNumChannels; j++)
-      {
-         float* sample = &m_downmixFloatBuffer[i * outputNumChannels + j];
-         *sample = 0.f;
-
-         for (size_t k = 0; k < inputNumChannels; k++)
-         {
-            *sample += m_inputFloatBuffer[i * inputNumChannels + k] * m_downmixMatrix[inputNumChannels * j + k];
-         }
-      }
-   }
-
-   numSamplesPerChannel = numSamplesPerChannel * m_downmix / m_channels;
+   m_downmixer.Mix(m_inputFloatBuffer.data(), numSamplesPerChannel, m_downmixFloatBuffer.data());
 
    std::swap(m_downmixFloatBuffer, m_inputFloatBuffer);
 }
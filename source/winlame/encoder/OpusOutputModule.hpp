@@ -22,6 +22,8 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "ChannelRemapper.hpp"
+#include "Downmixer.hpp"
 #include <opus/opusenc.h>
 
 
@@ -91,6 +93,9 @@ namespace Encoder
       /// returns the extension the output module produces
       virtual CString GetOutputExtension() const override { return _T("opus"); }
 
+      /// the encoder takes float samples
+      virtual bool PrefersFloatSamples() const override { return true; }
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackInfo, SampleContainer& samples) override;
@@ -99,7 +104,7 @@ namespace Encoder
       virtual int EncodeSamples(SampleContainer& samples) override;
 
       /// cleans up the output module
-      virtual void DoneOutput() override;
+      virtual int DoneOutput() override;
 
       /// generates text for a picture metadata block from an image
       static std::string GetMetadataBlockPicture(const std::vector<unsigned char>& imageData);
@@ -120,14 +125,11 @@ namespace Encoder
       /// opens output file
       bool OpenOutputFile(LPCTSTR outputFilename);
 
-      /// reads float samples from 16-bit buffer
-      long ReadFloatSamples16(float* buffer, int samples);
-
-      /// reads float samples from 32-bit buffer
-      long ReadFloatSamples32(float* buffer, int samples);
+      /// reads float samples from input sample buffer
+      long ReadFloatSamples(float* buffer, int samples);
 
       /// downmix samples in input float sample buffer
-      void DownmixSamples(opus_int32& numSamplesPerChannel);
+      void DownmixSamples(opus_int32 numSamplesPerChannel);
 
       /// refills input sample buffer from sample container
       int RefillInputSampleBuffer(SampleContainer& samples);
@@ -176,24 +178,25 @@ namespace Encoder
       /// number of samples per frame we should feed the encoder with, for all channels
       opus_int32 m_numSamplesPerFrame;
 
-      /// input buffer for 16-bit samples
-      std::vector<opus_int16> m_inputInt16Buffer;
+      /// remap plan from the input channel order to the Vorbis channel order
+      ChannelRemapPlan m_channelRemapPlan;
 
-      /// input buffer for 32-bit samples
-      std::vector<opus_int32> m_inputInt32Buffer;
+      /// indicates if the sample container delivers float samples; else it delivers 32-bit
+      /// samples that are converted while remapping
+      bool m_isInputFloat;
+
+      /// input buffer for float samples from the sample container, in Vorbis channel order
+      std::vector<float> m_inputSampleBuffer;
 
       /// input buffer for float samples; contains at most one frame
       std::vector<float> m_inputFloatBuffer;
 
-      /// matrix for factors for downmixing channels
-      std::vector<float> m_downmixMatrix;
+      /// downmixer for the input channels, when downmixing
+      Downmixer m_downmixer;
 
       /// buffer for downmixed float samples
       std::vector<float> m_downmixFloatBuffer;
 
-      /// indicates if the input module supports 32-bit samples
-      bool m_32bitMode;
-
       /// indicates if the output stream is at the end
       bool m_outputStreamAtEnd;
    };
@@ -43,6 +43,17 @@ namespace Encoder
       /// lets the output module fetch some settings, right after module creation
       virtual void PrepareOutput(SettingsManager& mgr) { UNUSED(mgr); }
 
+      /// returns if the output module prefers float samples over integer samples
+      virtual bool PrefersFloatSamples() const { return false; }
+
+      /// \brief returns the max. memory used by the module's buffers, in bytes, without the encoder state
+      /// \details blockSize is the max. size of the sample blocks passed to EncodeSamples(), in bytes
+      virtual size_t EstimatedBufferMemoryUsage(size_t blockSize) const
+      {
+         UNUSED(blockSize);
+         return 0;
+      }
+
       /// initializes the output module
       virtual int InitOutput(LPCTSTR outfilename, SettingsManager& mgr,
          const TrackInfo& trackinfo, SampleContainer& samplecont) = 0;
@@ -52,8 +63,9 @@ namespace Encoder
       /// returns 0 if all was ok, or a negative value on error
       virtual int EncodeSamples(SampleContainer& samples) = 0;
 
-      /// cleans up the output module
-      virtual void DoneOutput() = 0;
+      /// \brief cleans up the output module
+      /// \details returns 0 if all was ok, or a negative value on error
+      virtual int DoneOutput() = 0;
    };
 
 } // namespace Encoder
@@ -0,0 +1,481 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file PcmFileReader.cpp
+/// \brief reader for uncompressed PCM audio files
+//
+#include "stdafx.h"
+#include "PcmFileReader.hpp"
+#include <algorithm>
+
+using Encoder::PcmFileReader;
+
+// RIFF and RF64 wave files consist of chunks with a 4-character id and a 32-bit little-endian
+// size, padded to even sizes; RF64 files store the 64-bit size of the data chunk in a ds64
+// chunk. Wave64 chunks have a GUID as id and a 64-bit size that includes the chunk header,
+// and are padded to multiples of 8 bytes. AIFF chunks are like RIFF chunks, but all values
+// are stored in big-endian byte order.
+
+/// wave format tag for integer PCM samples
+const unsigned int c_waveFormatPcm = 0x0001;
+
+/// wave format tag for float samples
+const unsigned int c_waveFormatIeeeFloat = 0x0003;
+
+/// wave format tag for WAVE_FORMAT_EXTENSIBLE; the format tag is stored in the sub format GUID
+const unsigned int c_waveFormatExtensible = 0xFFFE;
+
+/// bytes 2 to 15 of the sub format GUIDs of WAVE_FORMAT_EXTENSIBLE; the first two bytes contain
+/// the format tag
+const unsigned char c_waveSubFormatGuidSuffix[14] =
+{
+   0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+/// GUID of the Wave64 riff header
+const unsigned char c_wave64RiffGuid[16] =
+{
+   0x72, 0x69, 0x66, 0x66, 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00
+};
+
+/// bytes 4 to 15 of the Wave64 GUIDs for the wave header and for the fmt and data chunks; the
+/// first four bytes contain the chunk id
+const unsigned char c_wave64GuidSuffix[12] =
+{
+   0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A
+};
+
+/// size of an ID3v1 tag
+const size_t c_id3v1TagSize = 128;
+
+/// reads 16-bit little-endian value
+static unsigned int ReadUInt16LE(const unsigned char* data)
+{
+   return data[0] | (static_cast<unsigned int>(data[1]) << 8);
+}
+
+/// reads 32-bit little-endian value
+static unsigned int ReadUInt32LE(const unsigned char* data)
+{
+   return ReadUInt16LE(data) | (ReadUInt16LE(data + 2) << 16);
+}
+
+/// reads 64-bit little-endian value
+static unsigned long long ReadUInt64LE(const unsigned char* data)
+{
+   return ReadUInt32LE(data) | (static_cast<unsigned long long>(ReadUInt32LE(data + 4)) << 32);
+}
+
+/// reads 16-bit big-endian value
+static unsigned int ReadUInt16BE(const unsigned char* data)
+{
+   return (static_cast<unsigned int>(data[0]) << 8) | data[1];
+}
+
+/// reads 32-bit big-endian value
+static unsigned int ReadUInt32BE(const unsigned char* data)
+{
+   return (ReadUInt16BE(data) << 16) | ReadUInt16BE(data + 2);
+}
+
+/// reads 80-bit extended precision value, as used for the AIFF sample rate; returns 0 when the
+/// value is negative or doesn't fit into 32 bits
+static unsigned int ReadExtendedFloat(const unsigned char* data)
+{
+   int exponent = ((data[0] & 0x7F) << 8) | data[1];
+   unsigned long long mantissa =
+      (static_cast<unsigned long long>(ReadUInt32BE(data + 2)) << 32) | ReadUInt32BE(data + 6);
+
+   int shift = 16383 + 63 - exponent;
+   if ((data[0] & 0x80) != 0 || shift < 32 || shift > 63)
+      return 0;
+
+   return static_cast<unsigned int>(mantissa >> shift);
+}
+
+PcmFileReader::PcmFileReader()
+   :m_fileHandle(INVALID_HANDLE_VALUE),
+   m_mappingHandle(nullptr),
+   m_mappedData(nullptr),
+   m_mappedSize(0),
+   m_numChannels(0),
+   m_sampleRate(0),
+   m_bitsPerSample(0),
+   m_isFloat(false),
+   m_isBigEndian(false),
+   m_sampleData(nullptr),
+   m_numFrames(0),
+   m_currentFrame(0),
+   m_id3ChunkData(nullptr)
+{
+}
+
+PcmFileReader::~PcmFileReader()
+{
+   Close();
+}
+
+bool PcmFileReader::Open(const CString& filename)
+{
+   Close();
+
+   m_fileHandle = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+   if (m_fileHandle == INVALID_HANDLE_VALUE)
+      return false;
+
+   LARGE_INTEGER fileSize = {};
+   if (!GetFileSizeEx(m_fileHandle, &fileSize) ||
+      fileSize.QuadPart < 12 ||
+      static_cast<ULONGLONG>(fileSize.QuadPart) > SIZE_MAX)
+   {
+      Close();
+      return false;
+   }
+
+   m_mappingHandle = CreateFileMapping(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (m_mappingHandle != nullptr)
+      m_mappedData = reinterpret_cast<const unsigned char*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+   if (m_mappedData == nullptr)
+   {
+      Close();
+      return false;
+   }
+
+   m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+   bool ret = false;
+   if (memcmp(m_mappedData, "RIFF", 4) == 0 || memcmp(m_mappedData, "RF64", 4) == 0)
+      ret = ParseRiffWave();
+   else if (memcmp(m_mappedData, c_wave64RiffGuid, sizeof(c_wave64RiffGuid)) == 0)
+      ret = ParseWave64();
+   else if (memcmp(m_mappedData, "FORM", 4) == 0)
+      ret = ParseAiff();
+
+   if (!ret)
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void PcmFileReader::Close()
+{
+   if (m_mappedData != nullptr)
+      UnmapViewOfFile(m_mappedData);
+
+   if (m_mappingHandle != nullptr)
+      CloseHandle(m_mappingHandle);
+
+   if (m_fileHandle != INVALID_HANDLE_VALUE)
+      CloseHandle(m_fileHandle);
+
+   m_mappedData = nullptr;
+   m_mappingHandle = nullptr;
+   m_fileHandle = INVALID_HANDLE_VALUE;
+   m_mappedSize = 0;
+
+   m_numChannels = 0;
+   m_sampleRate = 0;
+   m_bitsPerSample = 0;
+   m_isFloat = false;
+   m_isBigEndian = false;
+   m_sampleData = nullptr;
+   m_numFrames = 0;
+   m_currentFrame = 0;
+   m_id3ChunkData = nullptr;
+   m_blockBuffer.clear();
+}
+
+const unsigned char* PcmFileReader::GetId3v1Tag() const
+{
+   if (m_id3ChunkData != nullptr)
+      return m_id3ChunkData;
+
+   if (m_mappedSize >= c_id3v1TagSize &&
+      memcmp(m_mappedData + m_mappedSize - c_id3v1TagSize, "TAG", 3) == 0)
+      return m_mappedData + m_mappedSize - c_id3v1TagSize;
+
+   return nullptr;
+}
+
+void PcmFileReader::SeekToFrame(unsigned long long frame)
+{
+   m_currentFrame = std::min<unsigned long long>(frame, m_numFrames);
+}
+
+size_t PcmFileReader::ReadFrames(size_t maxFrames, const unsigned char*& data)
+{
+   size_t numFrames = static_cast<size_t>(
+      std::min<unsigned long long>(maxFrames, m_numFrames - m_currentFrame));
+
+   if (numFrames == 0)
+      return 0;
+
+   size_t bytesPerSample = m_bitsPerSample / 8;
+   size_t numBytes = numFrames * m_numChannels * bytesPerSample;
+
+   data = m_sampleData + m_currentFrame * m_numChannels * bytesPerSample;
+   m_currentFrame += numFrames;
+
+   if (m_isBigEndian)
+   {
+      m_blockBuffer.resize(numBytes + 3);
+
+      unsigned char* dest = m_blockBuffer.data();
+      for (size_t offset = 0; offset < numBytes; offset += bytesPerSample)
+      {
+         for (size_t byteIndex = 0; byteIndex < bytesPerSample; byteIndex++)
+            dest[offset + byteIndex] = data[offset + bytesPerSample - 1 - byteIndex];
+      }
+
+      data = m_blockBuffer.data();
+   }
+   else if (static_cast<size_t>(m_mappedData + m_mappedSize - (data + numBytes)) < 4 - bytesPerSample)
+   {
+      // the last sample would be read past the end of the mapped file
+      m_blockBuffer.assign(data, data + numBytes);
+      m_blockBuffer.resize(numBytes + 3);
+
+      data = m_blockBuffer.data();
+   }
+
+   return numFrames;
+}
+
+bool PcmFileReader::ParseRiffWave()
+{
+   if (memcmp(m_mappedData + 8, "WAVE", 4) != 0)
+      return false;
+
+   bool formatFound = false;
+   const unsigned char* dataChunk = nullptr;
+   unsigned long long dataChunkSize = 0;
+   unsigned long long dataChunkSize64 = 0;
+
+   const unsigned char* pos = m_mappedData + 12;
+   const unsigned char* end = m_mappedData + m_mappedSize;
+
+   while (end - pos >= 8)
+   {
+      const unsigned char* chunkData = pos + 8;
+      unsigned long long chunkSize = ReadUInt32LE(pos + 4);
+      size_t maxChunkSize = static_cast<size_t>(end - chunkData);
+
+      if (memcmp(pos, "ds64", 4) == 0 && chunkSize >= 24 && chunkSize <= maxChunkSize)
+      {
+         dataChunkSize64 = ReadUInt64LE(chunkData + 8);
+      }
+      else if (memcmp(pos, "fmt ", 4) == 0)
+      {
+         if (chunkSize > maxChunkSize ||
+            !ParseWaveFormat(chunkData, static_cast<size_t>(chunkSize)))
+            return false;
+
+         formatFound = true;
+      }
+      else if (memcmp(pos, "data", 4) == 0)
+      {
+         // RF64 files store the size in the ds64 chunk
+         if (chunkSize == 0xFFFFFFFF && dataChunkSize64 != 0)
+            chunkSize = dataChunkSize64;
+
+         dataChunk = chunkData;
+         dataChunkSize = chunkSize;
+      }
+      else if (memcmp(pos, "id3 ", 4) == 0 && chunkSize == c_id3v1TagSize && chunkSize <= maxChunkSize)
+      {
+         m_id3ChunkData = chunkData;
+      }
+
+      // the data chunk of an unfinished recording may extend past the end of the file
+      if (chunkSize > maxChunkSize)
+         break;
+
+      pos = chunkData + chunkSize + (chunkSize & 1);
+   }
+
+   return formatFound && dataChunk != nullptr &&
+      SetDataChunk(dataChunk, dataChunkSize);
+}
+
+bool PcmFileReader::ParseWave64()
+{
+   if (m_mappedSize < 40 ||
+      memcmp(m_mappedData + 24, "wave", 4) != 0 ||
+      memcmp(m_mappedData + 28, c_wave64GuidSuffix, sizeof(c_wave64GuidSuffix)) != 0)
+      return false;
+
+   bool formatFound = false;
+
+   const unsigned char* pos = m_mappedData + 40;
+   const unsigned char* end = m_mappedData + m_mappedSize;
+
+   while (end - pos >= 24)
+   {
+      const unsigned char* chunkData = pos + 24;
+      unsigned long long chunkSize = ReadUInt64LE(pos + 16);
+      if (chunkSize < 24)
+         return false;
+
+      chunkSize -= 24;
+      size_t maxChunkSize = static_cast<size_t>(end - chunkData);
+
+      bool isWaveChunk = memcmp(pos + 4, c_wave64GuidSuffix, sizeof(c_wave64GuidSuffix)) == 0;
+
+      if (isWaveChunk && memcmp(pos, "fmt ", 4) == 0)
+      {
+         if (chunkSize > maxChunkSize ||
+            !ParseWaveFormat(chunkData, static_cast<size_t>(chunkSize)))
+            return false;
+
+         formatFound = true;
+      }
+      else if (isWaveChunk && memcmp(pos, "data", 4) == 0)
+      {
+         return formatFound &&
+            SetDataChunk(chunkData, chunkSize);
+      }
+
+      if (chunkSize > maxChunkSize)
+         break;
+
+      pos = chunkData + ((chunkSize + 7) & ~7ULL);
+   }
+
+   return false;
+}
+
+bool PcmFileReader::ParseAiff()
+{
+   bool isAiffC = memcmp(m_mappedData + 8, "AIFC", 4) == 0;
+   if (!isAiffC && memcmp(m_mappedData + 8, "AIFF", 4) != 0)
+      return false;
+
+   bool formatFound = false;
+
+   const unsigned char* pos = m_mappedData + 12;
+   const unsigned char* end = m_mappedData + m_mappedSize;
+
+   while (end - pos >= 8)
+   {
+      const unsigned char* chunkData = pos + 8;
+      unsigned long long chunkSize = ReadUInt32BE(pos + 4);
+      size_t maxChunkSize = static_cast<size_t>(end - chunkData);
+
+      if (memcmp(pos, "COMM", 4) == 0)
+      {
+         if (chunkSize > maxChunkSize || chunkSize < (isAiffC ? 22U : 18U))
+            return false;
+
+         // samples are stored left-justified, so e.g. 20-bit samples can be read as 24-bit
+         m_numChannels = ReadUInt16BE(chunkData);
+         m_bitsPerSample = ((ReadUInt16BE(chunkData + 6) + 7) / 8) * 8;
+         m_sampleRate = ReadExtendedFloat(chunkData + 8);
+         m_isBigEndian = true;
+
+         if (isAiffC)
+         {
+            const unsigned char* compressionType = chunkData + 18;
+
+            if (memcmp(compressionType, "sowt", 4) == 0)
+               m_isBigEndian = false;
+            else if (memcmp(compressionType, "fl32", 4) == 0 || memcmp(compressionType, "FL32", 4) == 0)
+               m_isFloat = true;
+            else if (memcmp(compressionType, "NONE", 4) != 0 && memcmp(compressionType, "twos", 4) != 0)
+               return false;
+         }
+
+         formatFound = true;
+      }
+      else if (memcmp(pos, "SSND", 4) == 0)
+      {
+         if (!formatFound || chunkSize < 8 || maxChunkSize < 8)
+            return false;
+
+         unsigned int offset = ReadUInt32BE(chunkData);
+         if (offset > chunkSize - 8 || offset > maxChunkSize - 8)
+            return false;
+
+         return SetDataChunk(chunkData + 8 + offset, chunkSize - 8 - offset);
+      }
+
+      if (chunkSize > maxChunkSize)
+         break;
+
+      pos = chunkData + chunkSize + (chunkSize & 1);
+   }
+
+   return false;
+}
+
+bool PcmFileReader::ParseWaveFormat(const unsigned char* data, size_t size)
+{
+   if (size < 16)
+      return false;
+
+   unsigned int formatTag = ReadUInt16LE(data);
+   m_numChannels = ReadUInt16LE(data + 2);
+   m_sampleRate = ReadUInt32LE(data + 4);
+
+   unsigned int blockAlign = ReadUInt16LE(data + 12);
+   unsigned int validBitsPerSample = ReadUInt16LE(data + 14);
+
+   if (formatTag == c_waveFormatExtensible)
+   {
+      if (size < 40 ||
+         memcmp(data + 26, c_waveSubFormatGuidSuffix, sizeof(c_waveSubFormatGuidSuffix)) != 0)
+         return false;
+
+      formatTag = ReadUInt16LE(data + 24);
+   }
+
+   if (formatTag != c_waveFormatPcm && formatTag != c_waveFormatIeeeFloat)
+      return false;
+
+   m_isFloat = formatTag == c_waveFormatIeeeFloat;
+
+   // samples are stored left-justified in the container size given by the block alignment
+   if (m_numChannels == 0 || blockAlign % m_numChannels != 0)
+      return false;
+
+   m_bitsPerSample = (blockAlign / m_numChannels) * 8;
+
+   return validBitsPerSample <= m_bitsPerSample;
+}
+
+bool PcmFileReader::SetDataChunk(const unsigned char* data, unsigned long long size)
+{
+   if (m_numChannels == 0 || m_sampleRate == 0 ||
+      (m_bitsPerSample != 16 && m_bitsPerSample != 24 && m_bitsPerSample != 32) ||
+      (m_isFloat && m_bitsPerSample != 32))
+      return false;
+
+   // truncated files contain less samples than stated in the header
+   unsigned long long maxSize = static_cast<unsigned long long>(m_mappedData + m_mappedSize - data);
+
+   m_sampleData = data;
+   m_numFrames = std::min(size, maxSize) / (m_numChannels * (m_bitsPerSample / 8));
+   m_currentFrame = 0;
+
+   return true;
+}
@@ -0,0 +1,147 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file PcmFileReader.hpp
+/// \brief reader for uncompressed PCM audio files
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// \brief reader for uncompressed PCM samples in WAV, RF64, Wave64 and AIFF files
+   /// \details The file is memory-mapped and only the chunk headers are parsed, to find the
+   /// format and the data chunk. Sample blocks of little-endian files are returned as pointers
+   /// into the mapped file, so they can be passed to the SampleContainer without copying; the
+   /// samples of big-endian AIFF files are byte-swapped into a buffer. Only 16, 24 and 32 bit
+   /// integer samples and 32 bit float samples are supported; Open() returns false for all
+   /// other files, which then have to be read by libsndfile.
+   class PcmFileReader
+   {
+   public:
+      /// ctor
+      PcmFileReader();
+
+      /// dtor
+      ~PcmFileReader();
+
+      /// opens file and parses the chunk headers; returns false when the file isn't a
+      /// supported PCM file
+      bool Open(const CString& filename);
+
+      /// closes file
+      void Close();
+
+      /// returns if a file is opened
+      bool IsOpen() const { return m_mappedData != nullptr; }
+
+      /// returns number of channels
+      unsigned int GetNumChannels() const { return m_numChannels; }
+
+      /// returns sample rate, in Hz
+      unsigned int GetSampleRate() const { return m_sampleRate; }
+
+      /// returns number of bits per sample, as stored in the file; 16, 24 or 32
+      unsigned int GetBitsPerSample() const { return m_bitsPerSample; }
+
+      /// returns if the samples are 32-bit float values
+      bool IsFloat() const { return m_isFloat; }
+
+      /// returns number of sample frames in the file
+      unsigned long long GetNumFrames() const { return m_numFrames; }
+
+      /// returns number of sample frames already read
+      unsigned long long GetCurrentFrame() const { return m_currentFrame; }
+
+      /// \brief returns ID3v1 tag data, 128 bytes long, or nullptr when there's no tag
+      /// \details the tag is either stored in an "id3 " chunk of a RIFF wave file, or appended
+      /// at the end of the file
+      const unsigned char* GetId3v1Tag() const;
+
+      /// \brief returns next block of interleaved little-endian samples, with at most maxFrames
+      /// sample frames; returns the number of frames, or 0 at the end of the file
+      /// \details The data stays valid until the next call or until the file is closed. Since
+      /// the SampleContainer reads all samples as 32-bit values, the data can be read up to 3
+      /// bytes past the last sample.
+      size_t ReadFrames(size_t maxFrames, const unsigned char*& data);
+
+      /// sets the sample frame that is read next; positions past the end are clamped
+      void SeekToFrame(unsigned long long frame);
+
+   private:
+      /// parses RIFF or RF64 wave file
+      bool ParseRiffWave();
+
+      /// parses Sony Wave64 file
+      bool ParseWave64();
+
+      /// parses AIFF or AIFF-C file
+      bool ParseAiff();
+
+      /// parses wave format data, as stored in the fmt chunks of wave files
+      bool ParseWaveFormat(const unsigned char* data, size_t size);
+
+      /// checks the format values and calculates the number of sample frames in the data chunk
+      bool SetDataChunk(const unsigned char* data, unsigned long long size);
+
+   private:
+      /// handle of the mapped file
+      HANDLE m_fileHandle;
+
+      /// handle of the file mapping
+      HANDLE m_mappingHandle;
+
+      /// start of the mapped file; nullptr when not mapped
+      const unsigned char* m_mappedData;
+
+      /// size of the mapped file
+      size_t m_mappedSize;
+
+      /// number of channels
+      unsigned int m_numChannels;
+
+      /// sample rate, in Hz
+      unsigned int m_sampleRate;
+
+      /// number of bits per sample
+      unsigned int m_bitsPerSample;
+
+      /// indicates if the samples are float values
+      bool m_isFloat;
+
+      /// indicates if the samples are stored in big-endian byte order
+      bool m_isBigEndian;
+
+      /// start of the sample data
+      const unsigned char* m_sampleData;
+
+      /// number of sample frames
+      unsigned long long m_numFrames;
+
+      /// number of sample frames already read
+      unsigned long long m_currentFrame;
+
+      /// ID3v1 tag stored in an "id3 " chunk; nullptr when not present
+      const unsigned char* m_id3ChunkData;
+
+      /// buffer for samples that are byte-swapped or that are at the end of the mapped file
+      std::vector<unsigned char> m_blockBuffer;
+   };
+
+} // namespace Encoder
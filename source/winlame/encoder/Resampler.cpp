@@ -0,0 +1,320 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Resampler.cpp
+/// \brief Resampler class
+//
+#include "stdafx.h"
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using Encoder::Resampler;
+
+/// pi
+const double c_pi = 3.14159265358979323846;
+
+/// max. number of phases in the filter bank; when the sample rates need more phases, the
+/// nearest phase is used, with a timing error of at most 1/2048 of an input sample
+const size_t c_maxNumPhases = 1024;
+
+/// max. number of filter taps per phase; limits the downsampling ratio
+const size_t c_maxNumTaps = 1024;
+
+/// resampler quality preset
+struct ResamplerQualityPreset
+{
+   /// number of filter taps per phase, when upsampling
+   size_t m_numTaps;
+
+   /// filter cutoff, relative to the lower of the two Nyquist frequencies
+   double m_rolloff;
+
+   /// beta parameter of the Kaiser window; determines the stopband attenuation
+   double m_kaiserBeta;
+};
+
+/// quality presets, indexed by T_enResamplerQuality
+static const ResamplerQualityPreset c_qualityPresets[] =
+{
+   { 16, 0.85, 6.0 },
+   { 32, 0.91, 8.0 },
+   { 64, 0.95, 10.0 },
+};
+
+/// calculates greatest common divisor
+static unsigned long long GreatestCommonDivisor(unsigned long long a, unsigned long long b)
+{
+   while (b != 0)
+   {
+      unsigned long long remainder = a % b;
+      a = b;
+      b = remainder;
+   }
+
+   return a;
+}
+
+/// calculates the zeroth order modified Bessel function of the first kind, used by the
+/// Kaiser window
+static double BesselI0(double x)
+{
+   double sum = 1.0;
+   double term = 1.0;
+   double halfX = x / 2.0;
+
+   for (int k = 1; k < 100; k++)
+   {
+      term *= (halfX / k) * (halfX / k);
+      sum += term;
+
+      if (term < sum * 1e-12)
+         break;
+   }
+
+   return sum;
+}
+
+/// \brief calculates dot product of samples and filter coefficients
+/// \details uses four independent sums, so that the compiler can interleave or vectorize the
+/// multiply-adds; the number of taps must be a multiple of 4
+static float DotProduct(const float* samples, const float* filter, size_t numTaps)
+{
+   float sum0 = 0.f, sum1 = 0.f, sum2 = 0.f, sum3 = 0.f;
+
+   for (size_t tapIndex = 0; tapIndex < numTaps; tapIndex += 4)
+   {
+      sum0 += samples[tapIndex + 0] * filter[tapIndex + 0];
+      sum1 += samples[tapIndex + 1] * filter[tapIndex + 1];
+      sum2 += samples[tapIndex + 2] * filter[tapIndex + 2];
+      sum3 += samples[tapIndex + 3] * filter[tapIndex + 3];
+   }
+
+   return (sum0 + sum1) + (sum2 + sum3);
+}
+
+Resampler::Resampler()
+   :m_numChannels(0),
+   m_outputSampleRate(0),
+   m_inputStep(1),
+   m_outputStep(1),
+   m_numTaps(0),
+   m_numPhases(0),
+   m_historyStart(0),
+   m_numInputSamples(0),
+   m_numOutputSamples(0)
+{
+}
+
+bool Resampler::Init(size_t numChannels, int inputSampleRate, int outputSampleRate, T_enResamplerQuality quality)
+{
+   m_filterBank.clear();
+   m_history.clear();
+
+   if (numChannels == 0 || inputSampleRate <= 0 || outputSampleRate <= 0 ||
+      quality < resamplerQualityFast || quality > resamplerQualityBest)
+      return false;
+
+   const ResamplerQualityPreset& preset = c_qualityPresets[quality];
+
+   // when downsampling, the filter must be longer by the ratio, since the cutoff is lower
+   double ratio = std::min(1.0, double(outputSampleRate) / inputSampleRate);
+
+   size_t numTaps = static_cast<size_t>(std::ceil(preset.m_numTaps / ratio));
+   numTaps = (numTaps + 3) & ~size_t(3);
+
+   if (numTaps > c_maxNumTaps)
+      return false;
+
+   unsigned long long divisor = GreatestCommonDivisor(inputSampleRate, outputSampleRate);
+
+   m_numChannels = numChannels;
+   m_outputSampleRate = outputSampleRate;
+   m_inputStep = inputSampleRate / divisor;
+   m_outputStep = outputSampleRate / divisor;
+   m_numTaps = numTaps;
+   m_numPhases = static_cast<size_t>(std::min<unsigned long long>(m_outputStep, c_maxNumPhases));
+
+   CalcFilterBank(ratio * preset.m_rolloff, preset.m_kaiserBeta);
+
+   // the first output sample needs input samples before the start of the input
+   size_t numLeadingSamples = m_numTaps / 2 - 1;
+
+   m_history.resize(m_numChannels);
+   for (std::vector<float>& channelHistory : m_history)
+      channelHistory.assign(numLeadingSamples, 0.f);
+
+   m_historyStart = -static_cast<long long>(numLeadingSamples);
+   m_numInputSamples = 0;
+   m_numOutputSamples = 0;
+
+   return true;
+}
+
+size_t Resampler::Process(const float* sampleBuffer, size_t numSamples, std::vector<float>& outputBuffer)
+{
+   ATLASSERT(IsActive()); // must have been set up
+
+   for (size_t channelIndex = 0; channelIndex < m_numChannels; channelIndex++)
+   {
+      std::vector<float>& channelHistory = m_history[channelIndex];
+
+      size_t offset = channelHistory.size();
+      channelHistory.resize(offset + numSamples);
+
+      const float* sample = sampleBuffer + channelIndex;
+      for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++, sample += m_numChannels)
+         channelHistory[offset + sampleIndex] = *sample;
+   }
+
+   m_numInputSamples += numSamples;
+
+   size_t numOutputSamples = ProduceSamples(std::numeric_limits<unsigned long long>::max(), outputBuffer);
+
+   DiscardHistory();
+
+   return numOutputSamples;
+}
+
+size_t Resampler::Flush(std::vector<float>& outputBuffer)
+{
+   ATLASSERT(IsActive()); // must have been set up
+
+   // the last output samples need input samples after the end of the input
+   size_t numTrailingSamples = m_numTaps / 2 + 1;
+
+   for (std::vector<float>& channelHistory : m_history)
+      channelHistory.resize(channelHistory.size() + numTrailingSamples, 0.f);
+
+   unsigned long long totalNumOutputSamples =
+      (m_numInputSamples * m_outputStep + m_inputStep - 1) / m_inputStep;
+
+   size_t numOutputSamples = ProduceSamples(totalNumOutputSamples, outputBuffer);
+
+   DiscardHistory();
+
+   return numOutputSamples;
+}
+
+void Resampler::CalcFilterBank(double cutoff, double kaiserBeta)
+{
+   m_filterBank.resize(m_numPhases * m_numTaps);
+
+   double halfNumTaps = double(m_numTaps / 2);
+   double windowScale = 1.0 / BesselI0(kaiserBeta);
+
+   for (size_t phaseIndex = 0; phaseIndex < m_numPhases; phaseIndex++)
+   {
+      double fraction = double(phaseIndex) / m_numPhases;
+      float* filter = m_filterBank.data() + phaseIndex * m_numTaps;
+
+      double sum = 0.0;
+      std::vector<double> coefficients(m_numTaps);
+
+      for (size_t tapIndex = 0; tapIndex < m_numTaps; tapIndex++)
+      {
+         // distance of the tap's input sample to the output sample position
+         double distance = double(tapIndex) - (halfNumTaps - 1.0) - fraction;
+
+         double windowPos = distance / halfNumTaps;
+         double window = std::abs(windowPos) <= 1.0
+            ? BesselI0(kaiserBeta * std::sqrt(1.0 - windowPos * windowPos)) * windowScale
+            : 0.0;
+
+         double x = c_pi * cutoff * distance;
+         double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(x) / x;
+
+         coefficients[tapIndex] = cutoff * sinc * window;
+         sum += coefficients[tapIndex];
+      }
+
+      // normalize, so that each phase passes DC unchanged
+      for (size_t tapIndex = 0; tapIndex < m_numTaps; tapIndex++)
+         filter[tapIndex] = static_cast<float>(coefficients[tapIndex] / sum);
+   }
+}
+
+size_t Resampler::ProduceSamples(unsigned long long maxNumOutputSamples, std::vector<float>& outputBuffer)
+{
+   bool isPhaseRounded = m_numPhases < m_outputStep;
+   long long halfNumTaps = static_cast<long long>(m_numTaps / 2);
+
+   // the last input sample that can be the base of an output sample; the filter needs the
+   // input samples up to halfNumTaps after it, and rounding the phase may move it by one
+   long long historyEnd = m_historyStart + static_cast<long long>(m_history[0].size());
+   long long maxInputIndex = historyEnd - 1 - halfNumTaps - (isPhaseRounded ? 1 : 0);
+
+   unsigned long long numAvailable = maxInputIndex < 0
+      ? 0
+      : ((maxInputIndex + 1) * m_outputStep + m_inputStep - 1) / m_inputStep;
+
+   numAvailable = std::min(numAvailable, maxNumOutputSamples);
+
+   size_t numOutputSamples = numAvailable > m_numOutputSamples
+      ? static_cast<size_t>(numAvailable - m_numOutputSamples)
+      : 0;
+
+   outputBuffer.resize(numOutputSamples * m_numChannels);
+
+   float* output = outputBuffer.data();
+   for (size_t outputIndex = 0; outputIndex < numOutputSamples; outputIndex++)
+   {
+      unsigned long long position = (m_numOutputSamples + outputIndex) * m_inputStep;
+      long long inputIndex = static_cast<long long>(position / m_outputStep);
+      size_t phaseIndex = static_cast<size_t>(position % m_outputStep);
+
+      if (isPhaseRounded)
+      {
+         phaseIndex = static_cast<size_t>((phaseIndex * m_numPhases + m_outputStep / 2) / m_outputStep);
+         if (phaseIndex == m_numPhases)
+         {
+            phaseIndex = 0;
+            inputIndex++;
+         }
+      }
+
+      size_t historyIndex = static_cast<size_t>(inputIndex - (halfNumTaps - 1) - m_historyStart);
+      const float* filter = m_filterBank.data() + phaseIndex * m_numTaps;
+
+      for (size_t channelIndex = 0; channelIndex < m_numChannels; channelIndex++)
+         *output++ = DotProduct(m_history[channelIndex].data() + historyIndex, filter, m_numTaps);
+   }
+
+   m_numOutputSamples += numOutputSamples;
+
+   return numOutputSamples;
+}
+
+void Resampler::DiscardHistory()
+{
+   long long nextInputIndex = static_cast<long long>((m_numOutputSamples * m_inputStep) / m_outputStep);
+   long long firstNeededIndex = nextInputIndex - static_cast<long long>(m_numTaps / 2 - 1);
+
+   if (firstNeededIndex <= m_historyStart)
+      return;
+
+   size_t numDiscard = std::min(
+      static_cast<size_t>(firstNeededIndex - m_historyStart),
+      m_history[0].size());
+
+   for (std::vector<float>& channelHistory : m_history)
+      channelHistory.erase(channelHistory.begin(), channelHistory.begin() + numDiscard);
+
+   m_historyStart += numDiscard;
+}
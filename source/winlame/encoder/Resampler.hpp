@@ -0,0 +1,120 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file Resampler.hpp
+/// \brief Resampler class
+//
+#pragma once
+
+#include <vector>
+
+namespace Encoder
+{
+   /// resampler quality presets
+   enum T_enResamplerQuality
+   {
+      resamplerQualityFast = 0,     ///< short filter, wider transition band
+      resamplerQualityNormal = 1,   ///< default quality
+      resamplerQualityBest = 2,     ///< long filter, narrow transition band
+   };
+
+   /// \brief converts the sample rate of interleaved float samples
+   /// \details Uses a polyphase filter bank with Kaiser windowed sinc filters; for each output
+   /// sample, the filter phase matching the fractional input position is applied to the input
+   /// samples around it. The filter is centered on the output sample, so the resampler doesn't
+   /// add delay, and the number of output samples only depends on the number of input samples.
+   /// Input samples are buffered per channel, so that the filter runs over contiguous samples.
+   class Resampler
+   {
+   public:
+      /// ctor
+      Resampler();
+
+      /// sets up the resampler; returns false when the sample rates aren't supported
+      bool Init(size_t numChannels, int inputSampleRate, int outputSampleRate, T_enResamplerQuality quality);
+
+      /// returns if the resampler was set up
+      bool IsActive() const { return !m_filterBank.empty(); }
+
+      /// returns number of channels
+      size_t GetNumChannels() const { return m_numChannels; }
+
+      /// returns output sample rate
+      int GetOutputSampleRate() const { return m_outputSampleRate; }
+
+      /// \brief resamples samples
+      /// \param sampleBuffer interleaved input samples
+      /// \param numSamples number of input samples, per channel
+      /// \param outputBuffer buffer for the interleaved output samples; is resized as needed
+      /// \return number of output samples, per channel
+      size_t Process(const float* sampleBuffer, size_t numSamples, std::vector<float>& outputBuffer);
+
+      /// \brief resamples the samples still buffered, at the end of the input
+      /// \param outputBuffer buffer for the interleaved output samples; is resized as needed
+      /// \return number of output samples, per channel
+      size_t Flush(std::vector<float>& outputBuffer);
+
+   private:
+      /// calculates the filter bank
+      void CalcFilterBank(double cutoff, double kaiserBeta);
+
+      /// produces output samples until the given number of output samples or the end of the
+      /// buffered input is reached
+      size_t ProduceSamples(unsigned long long maxNumOutputSamples, std::vector<float>& outputBuffer);
+
+      /// removes the input samples that aren't needed anymore from the history
+      void DiscardHistory();
+
+   private:
+      /// number of channels
+      size_t m_numChannels;
+
+      /// output sample rate
+      int m_outputSampleRate;
+
+      /// input sample rate, divided by the greatest common divisor of both rates
+      unsigned long long m_inputStep;
+
+      /// output sample rate, divided by the greatest common divisor of both rates; this is the
+      /// number of distinct input positions between two input samples
+      unsigned long long m_outputStep;
+
+      /// number of filter taps per phase; a multiple of 4
+      size_t m_numTaps;
+
+      /// number of phases in the filter bank
+      size_t m_numPhases;
+
+      /// filter bank; contains m_numTaps filter coefficients for each phase
+      std::vector<float> m_filterBank;
+
+      /// buffered input samples, per channel
+      std::vector<std::vector<float>> m_history;
+
+      /// input sample index of the first sample in the history; negative at the start, where
+      /// the history starts with silence
+      long long m_historyStart;
+
+      /// number of input samples passed to the resampler, per channel
+      unsigned long long m_numInputSamples;
+
+      /// number of output samples produced, per channel
+      unsigned long long m_numOutputSamples;
+   };
+
+} // namespace Encoder
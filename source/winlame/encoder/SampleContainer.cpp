@@ -30,7 +30,8 @@ SampleContainer::SampleContainer()
    :m_channelArray(nullptr),
    m_interleaved(nullptr),
    m_numBytesAvail(0),
-   m_numSamplesAvail(0)
+   m_numSamplesAvail(0),
+   m_outputModulePrefersFloat(false)
 {
    source.format = SamplesUnknown;
    target.format = SamplesUnknown;
@@ -42,18 +43,23 @@ SampleContainer::~SampleContainer()
 }
 
 void SampleContainer::SetInputModuleTraits(int bitsPerSample,
-   SampleFormatType format, int samplerateInHz, int numChannels)
+   SampleFormatType format, int samplerateInHz, int numChannels, bool isFloat)
 {
+   ATLASSERT(!isFloat || bitsPerSample == 32);
+
    // set up traits struct
    source.bitsPerSample = bitsPerSample;
    source.format = format;
    source.samplerateInHz = samplerateInHz;
    source.numChannels = numChannels;
+   source.isFloat = isFloat;
 }
 
 void SampleContainer::SetOutputModuleTraits(int bitsPerSample,
-   SampleFormatType format, int samplerateInHz, int numChannels)
+   SampleFormatType format, int samplerateInHz, int numChannels, bool isFloat)
 {
+   ATLASSERT(!isFloat || bitsPerSample == 32);
+
    if (samplerateInHz == -1)
       samplerateInHz = source.samplerateInHz;
    if (numChannels == -1)
@@ -64,6 +70,7 @@ void SampleContainer::SetOutputModuleTraits(int bitsPerSample,
    target.format = format;
    target.samplerateInHz = samplerateInHz;
    target.numChannels = numChannels;
+   target.isFloat = isFloat;
 
    // initial value
    m_numBytesAvail = 512;
@@ -128,12 +135,15 @@ void SampleContainer::PutSamplesInterleaved(void* samples, int numSamples)
    m_numSamplesAvail = numSamples;
 }
 
-void SampleContainer::PutSamplesArray(void** samples, int numSamples)
+void SampleContainer::PutSamplesArray(void** samples, int numSamples, int sourceStep)
 {
    // check if there is enough space in the buffer
    if (numSamples > m_numBytesAvail)
       ReallocMemory(numSamples);
 
+   if (sourceStep == 0)
+      sourceStep = source.bitsPerSample >> 3;
+
    // conversion from channel array to ...
 
    switch (target.format)
@@ -143,7 +153,7 @@ void SampleContainer::PutSamplesArray(void** samples, int numSamples)
       for (int i = 0; i < source.numChannels; i++)
       {
          DeinterleaveChannel((unsigned char*)(samples[i]), numSamples,
-            i, source.bitsPerSample >> 3);
+            i, sourceStep);
       }
    }
    break;
@@ -153,7 +163,7 @@ void SampleContainer::PutSamplesArray(void** samples, int numSamples)
       for (int i = 0; i < source.numChannels; i++)
       {
          InterleaveChannel((unsigned char*)(samples[i]), numSamples,
-            i, source.bitsPerSample >> 3);
+            i, sourceStep);
       }
    }
    break;
@@ -229,100 +239,106 @@ void SampleContainer::DeallocMemory()
 
 void SampleContainer::InterleaveChannel(unsigned char* samples, int numSamples, int channel, int sourceStep)
 {
-   int sourceShift = 32 - source.bitsPerSample;
    int dbps = target.bitsPerSample >> 3;
-   int destShift = 32 - target.bitsPerSample;
-   int destStep = target.numChannels * (target.bitsPerSample >> 3);
-
-   int roundbit = destShift > 0 ? (1 << (destShift - 1)) : 0;
-   int destHigh = std::numeric_limits<int>::max() - roundbit + 1;
 
    unsigned char *destbuf =
       ((unsigned char*)m_interleaved) + dbps * channel;
 
-   for (int i = 0; i < numSamples; i++)
-   {
-      signed int sample;
+   ConvertChannel(samples, numSamples, sourceStep, destbuf, target.numChannels * dbps);
+}
 
-      sample = *((unsigned int*)samples);
+void SampleContainer::DeinterleaveChannel(unsigned char*samples, int numSamples, int channel, int sourceStep)
+{
+   unsigned char *destbuf = (unsigned char*)m_channelArray[channel];
 
-      // normalize
+   ConvertChannel(samples, numSamples, sourceStep, destbuf, target.bitsPerSample >> 3);
+}
 
-      // shift up
-      sample <<= sourceShift;
+/// converts float sample to 32-bit integer sample, clipping values outside of -1.0 to 1.0
+static signed int FloatToSample(float value)
+{
+   double sample = double(value) * 2147483648.0;
 
-      // do sth with the sample
+   if (sample >= 2147483647.0)
+      return std::numeric_limits<int>::max();
 
-      // add rounding value
-      if (sample < destHigh)
-         sample += roundbit;
+   if (sample <= -2147483648.0)
+      return std::numeric_limits<int>::min();
 
-      // shift to target bps
-      sample >>= destShift;
+   return static_cast<signed int>(sample);
+}
 
-      // store sample in destbuf
-      _asm
+void SampleContainer::ConvertChannel(unsigned char* samples, int numSamples, int sourceStep,
+   unsigned char* destbuf, int destStep)
+{
+   if (source.isFloat && target.isFloat)
+   {
+      // no conversion needed
+      for (int i = 0; i < numSamples; i++)
       {
-         mov   edi, destbuf
-         mov   eax, sample
-         mov   ecx, dbps
-         label1 :
-         stosb
-            shr   eax, 8
-            loop  label1
+         *((float*)destbuf) = *((float*)samples);
+
+         destbuf += destStep;
+         samples += sourceStep;
       }
 
-      destbuf += destStep;
-      samples += sourceStep;
+      return;
    }
-}
 
-void SampleContainer::DeinterleaveChannel(unsigned char*samples, int numSamples, int channel, int sourceStep)
-{
    int sourceShift = 32 - source.bitsPerSample;
    int dbps = target.bitsPerSample >> 3;
    int destShift = 32 - target.bitsPerSample;
-   int destStep = dbps;
 
    int roundbit = destShift > 0 ? (1 << (destShift - 1)) : 0;
    int destHigh = std::numeric_limits<int>::max() - roundbit + 1;
 
-   unsigned char *destbuf = (unsigned char*)m_channelArray[channel];
-
    for (int i = 0; i < numSamples; i++)
    {
       signed int sample;
 
-      sample = *((unsigned int*)samples);
+      if (source.isFloat)
+      {
+         sample = FloatToSample(*((float*)samples));
+      }
+      else
+      {
+         sample = *((unsigned int*)samples);
 
-      // normalize
+         // normalize
 
-      // shift up
-      sample <<= sourceShift;
+         // shift up
+         sample <<= sourceShift;
+      }
 
       // do sth with the sample
 
-      // add rounding value
-      if (sample < destHigh)
-         sample += roundbit;
-
-      // shift to target bps
-      sample >>= destShift;
-
-      // store sample in destbuf
-      _asm
+      if (target.isFloat)
+      {
+         *((float*)destbuf) = float(sample) / 2147483648.0f;
+      }
+      else
       {
-         mov   edi, destbuf
-         mov   eax, sample
-         mov   ecx, dbps
-         label1 :
-         stosb
-            shr   eax, 8
-            loop  label1
+         // add rounding value
+         if (sample < destHigh)
+            sample += roundbit;
+
+         // shift to target bps
+         sample >>= destShift;
+
+         // store sample in destbuf
+         _asm
+         {
+            mov   edi, destbuf
+            mov   eax, sample
+            mov   ecx, dbps
+            label1 :
+            stosb
+               shr   eax, 8
+               loop  label1
+         }
       }
 
       destbuf += destStep;
       samples += sourceStep;
    }
-
 }
@@ -48,12 +48,16 @@ namespace Encoder
       /// number of channels
       int numChannels;
 
+      /// indicates if samples are 32-bit float values, in the range -1.0 to 1.0
+      bool isFloat;
+
       /// ctor
       ModuleTraits()
          :bitsPerSample(0),
          format(SamplesInterleaved),
          samplerateInHz(0),
-         numChannels(0)
+         numChannels(0),
+         isFloat(false)
       {
       }
    };
@@ -70,9 +74,9 @@ namespace Encoder
 
       // input module functions
 
-      /// sets traits of the input module
+      /// sets traits of the input module; float samples must have 32 bits per sample
       void SetInputModuleTraits(int bitsPerSample, SampleFormatType format,
-         int samplerateInHz, int numChannels);
+         int samplerateInHz, int numChannels, bool isFloat = false);
 
       /// returns the input module sample rate
       int GetInputModuleSampleRate() { return source.samplerateInHz; }
@@ -83,11 +87,22 @@ namespace Encoder
       /// returns the input module bits per sample
       int GetInputModuleBitsPerSample() { return source.bitsPerSample; }
 
+      /// returns if the input module stores float samples
+      bool IsInputModuleFloat() const { return source.isFloat; }
+
       // output module functions
 
-      /// sets traits of the output module
+      /// \brief sets if the output module prefers float samples
+      /// \details must be set before initializing the input module; input modules that can
+      /// decode to both integer and float samples then choose the format
+      void SetOutputModulePrefersFloat(bool prefersFloat) { m_outputModulePrefersFloat = prefersFloat; }
+
+      /// returns if the output module prefers float samples
+      bool OutputModulePrefersFloat() const { return m_outputModulePrefersFloat; }
+
+      /// sets traits of the output module; float samples must have 32 bits per sample
       void SetOutputModuleTraits(int bitsPerSample, SampleFormatType format,
-         int samplerateInHz = -1, int numChannels = -1);
+         int samplerateInHz = -1, int numChannels = -1, bool isFloat = false);
 
       /// returns the input module sample rate
       int GetOutputModuleSampleRate() { return target.samplerateInHz; }
@@ -98,13 +113,20 @@ namespace Encoder
       /// returns the input module bits per sample
       int GetOutputModuleBitsPerSample() { return target.bitsPerSample; }
 
+      /// returns if the output module gets float samples
+      bool IsOutputModuleFloat() const { return target.isFloat; }
+
       // functions to put samples in or get samples out
 
       /// stores samples in interleaved format in the sample container
       void PutSamplesInterleaved(void* samples, int numSamples);
 
-      /// stores samples in interleaved format in the sample container
-      void PutSamplesArray(void **samples, int numSamples);
+      /// \brief stores samples in channel array format in the sample container
+      /// \details sourceStep is the distance in bytes between two samples in the channel buffers,
+      /// e.g. 4 for 32-bit integers holding samples with fewer bits per sample, or the size of
+      /// all channels of one sample, when the channel pointers point into an interleaved buffer;
+      /// when 0, the samples are packed with the input module's bits per sample
+      void PutSamplesArray(void **samples, int numSamples, int sourceStep = 0);
 
       /// retrieves samples in interleaved format
       void* GetSamplesInterleaved(int& numSamples);
@@ -125,6 +147,10 @@ namespace Encoder
       /// converts samples to channel array target buffer
       void DeinterleaveChannel(unsigned char* samples, int numSamples, int numChannels, int sourceStep);
 
+      /// converts samples of one channel from source to target format
+      void ConvertChannel(unsigned char* samples, int numSamples, int sourceStep,
+         unsigned char* destbuf, int destStep);
+
    private:
       /// source traits
       ModuleTraits source;
@@ -143,6 +169,9 @@ namespace Encoder
 
       /// number of available samples
       int m_numSamplesAvail;
+
+      /// indicates if the output module prefers float samples
+      bool m_outputModulePrefersFloat;
    };
 
 } // namespace Encoder
@@ -44,6 +44,9 @@ public:
    /// sets new variable value
    void setValue(unsigned short name, int val);
 
+   /// returns all variables that were explicitly set
+   const SettingsList& GetSettingsList() const { return settings; }
+
 private:
    /// map with settings
    SettingsList settings;
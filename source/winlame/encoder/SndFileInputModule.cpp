@@ -27,6 +27,7 @@
 #include "SndFileFormats.hpp"
 #include <ulib/DynamicLibrary.hpp>
 #include <ulib/UTF8.hpp>
+#include <algorithm>
 
 using Encoder::SndFileInputModule;
 using Encoder::TrackInfo;
@@ -35,6 +36,10 @@ using Encoder::SampleContainer;
 /// sndfile input buffer size
 const int c_sndfileInputBufferSize = 512;
 
+/// number of sample frames passed to the sample container at once, when reading the samples
+/// from the mapped file
+const size_t c_mappedFileBlockSize = 16384;
+
 SndFileInputModule::SndFileInputModule()
    :m_sndfile(nullptr),
    m_sampleCount(0),
@@ -146,14 +151,28 @@ int SndFileInputModule::InitInput(LPCTSTR infilename,
       return -1;
    }
 
+   OpenMappedFile(infilename);
+
    // when RIFF wave format, check for id3 tag info chunk
    if ((m_sfinfo.format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV)
    {
-      WaveGetID3Tag(infilename, trackInfo);
+      if (m_pcmFileReader.IsOpen())
+         MappedFileGetID3Tag(trackInfo);
+      else
+         WaveGetID3Tag(infilename, trackInfo);
    }
 
    GetTrackInfos(trackInfo);
 
+   if (m_pcmFileReader.IsOpen())
+   {
+      // samples are passed from the mapped file without conversion
+      samples.SetInputModuleTraits(m_pcmFileReader.GetBitsPerSample(), SamplesInterleaved,
+         m_sfinfo.samplerate, m_sfinfo.channels, m_pcmFileReader.IsFloat());
+
+      return 0;
+   }
+
    switch (m_sfinfo.format & SF_FORMAT_SUBMASK)
    {
    case SF_FORMAT_PCM_S8:
@@ -264,8 +283,43 @@ void SndFileInputModule::GetInfo(int& numChannels, int& bitrateInBps, int& lengt
    samplerateInHz = m_sfinfo.samplerate;
 }
 
+bool SndFileInputModule::Probe(LPCTSTR filename, ProbeInfo& info)
+{
+   // opening the file only parses the container header
+   memset(&m_sfinfo, 0, sizeof(m_sfinfo));
+#ifdef UNICODE
+   m_sndfile = sf_wchar_open(filename, SFM_READ, &m_sfinfo);
+#else
+   m_sndfile = sf_open(CStringA(GetAnsiCompatFilename(filename)), SFM_READ, &m_sfinfo);
+#endif
+
+   if (m_sndfile == nullptr)
+      return false;
+
+   GetInfo(info.m_numChannels, info.m_bitrateInBps, info.m_lengthInSeconds, info.m_samplerateInHz);
+   info.m_numSamples = m_sfinfo.frames > 0 ? m_sfinfo.frames : 0;
+
+   sf_close(m_sndfile);
+   m_sndfile = nullptr;
+
+   return true;
+}
+
 int SndFileInputModule::DecodeSamples(SampleContainer& samples)
 {
+   if (m_pcmFileReader.IsOpen())
+   {
+      const unsigned char* data = nullptr;
+      int numFrames = static_cast<int>(m_pcmFileReader.ReadFrames(c_mappedFileBlockSize, data));
+
+      if (numFrames > 0)
+         samples.PutSamplesInterleaved(const_cast<unsigned char*>(data), numFrames);
+
+      m_sampleCount += numFrames;
+
+      return numFrames;
+   }
+
    // read samples
    sf_count_t ret;
 
@@ -297,6 +351,25 @@ int SndFileInputModule::DecodeSamples(SampleContainer& samples)
    return iret;
 }
 
+bool SndFileInputModule::SeekToEnd(unsigned int numSamples)
+{
+   sf_count_t startFrame = std::max<sf_count_t>(0, m_sfinfo.frames - numSamples);
+
+   if (m_pcmFileReader.IsOpen())
+   {
+      m_pcmFileReader.SeekToFrame(startFrame);
+      m_sampleCount = static_cast<int>(startFrame);
+      return true;
+   }
+
+   if (!m_sfinfo.seekable ||
+      sf_seek(m_sndfile, startFrame, SEEK_SET) < 0)
+      return false;
+
+   m_sampleCount = static_cast<int>(startFrame);
+   return true;
+}
+
 float SndFileInputModule::PercentDone() const
 {
    return m_sfinfo.frames != 0 ? float(m_sampleCount)*100.f / float(m_sfinfo.frames) : 0.f;
@@ -304,9 +377,67 @@ float SndFileInputModule::PercentDone() const
 
 void SndFileInputModule::DoneInput()
 {
+   m_pcmFileReader.Close();
    sf_close(m_sndfile);
 }
 
+bool SndFileInputModule::OpenMappedFile(LPCTSTR infilename)
+{
+   switch (m_sfinfo.format & SF_FORMAT_TYPEMASK)
+   {
+   case SF_FORMAT_WAV:
+   case SF_FORMAT_WAVEX:
+   case SF_FORMAT_RF64:
+   case SF_FORMAT_W64:
+   case SF_FORMAT_AIFF:
+      break;
+   default:
+      return false;
+   }
+
+   switch (m_sfinfo.format & SF_FORMAT_SUBMASK)
+   {
+   case SF_FORMAT_PCM_16:
+   case SF_FORMAT_PCM_24:
+   case SF_FORMAT_PCM_32:
+   case SF_FORMAT_FLOAT:
+      break;
+   default:
+      return false;
+   }
+
+   if (!m_pcmFileReader.Open(infilename))
+      return false;
+
+   // only use the reader when it agrees with libsndfile on the format
+   if (m_pcmFileReader.GetNumChannels() != static_cast<unsigned int>(m_sfinfo.channels) ||
+      m_pcmFileReader.GetSampleRate() != static_cast<unsigned int>(m_sfinfo.samplerate) ||
+      m_pcmFileReader.GetNumFrames() != static_cast<unsigned long long>(m_sfinfo.frames))
+   {
+      ATLTRACE(_T("PcmFileReader: format differs from libsndfile's; using libsndfile\n"));
+      m_pcmFileReader.Close();
+      return false;
+   }
+
+   return true;
+}
+
+bool SndFileInputModule::MappedFileGetID3Tag(TrackInfo& trackInfo)
+{
+   const unsigned char* tagData = m_pcmFileReader.GetId3v1Tag();
+   if (tagData == nullptr)
+      return false;
+
+   Id3v1Tag id3tag;
+   memcpy(id3tag.GetData(), tagData, 128);
+
+   if (!id3tag.IsValidTag())
+      return false;
+
+   id3tag.ToTrackInfo(trackInfo);
+   return true;
+}
+
 bool SndFileInputModule::WaveGetID3Tag(LPCTSTR wavfile, TrackInfo& trackInfo)
 {
    FILE* wav = _tfopen(wavfile, _T("rb"));
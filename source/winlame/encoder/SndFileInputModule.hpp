@@ -23,6 +23,7 @@
 #pragma once
 
 #include "ModuleInterface.hpp"
+#include "PcmFileReader.hpp"
 #define ENABLE_SNDFILE_WINDOWS_PROTOTYPES 1
 #include <sndfile.h>
 
@@ -65,9 +66,15 @@ namespace Encoder
       /// returns info about the input file
       virtual void GetInfo(int& numChannels, int& bitrateInBps, int& lengthInSeconds, int& samplerateInHz) const override;
 
+      /// reads audio file infos from the file's headers
+      virtual bool Probe(LPCTSTR filename, ProbeInfo& info) override;
+
       /// decodes samples and stores them in the sample container
       virtual int DecodeSamples(SampleContainer& samples) override;
 
+      /// seeks to the last samples of the track
+      virtual bool SeekToEnd(unsigned int numSamples) override;
+
       /// returns the number of percent done
       virtual float PercentDone() const override;
 
@@ -75,6 +82,13 @@ namespace Encoder
       virtual void DoneInput() override;
 
    private:
+      /// opens file for reading the samples directly from the mapped file, when it contains
+      /// uncompressed samples that the PcmFileReader can read
+      bool OpenMappedFile(LPCTSTR infilename);
+
+      /// reads id3 tag stored in the mapped file
+      bool MappedFileGetID3Tag(TrackInfo& trackInfo);
+
       /// searches for id3 tag chunk in the wave file
       bool WaveGetID3Tag(LPCTSTR wavfile, TrackInfo &trackinfo);
 
@@ -97,6 +111,9 @@ namespace Encoder
       /// sample buffer
       std::vector<unsigned char> m_buffer;
 
+      /// reader for uncompressed samples; when opened, samples aren't read using libsndfile
+      PcmFileReader m_pcmFileReader;
+
       /// number of output bits
       int m_numOutputBits;
 
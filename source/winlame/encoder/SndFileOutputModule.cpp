@@ -192,9 +192,11 @@ int SndFileOutputModule::EncodeSamples(SampleContainer& samples)
    return int(ret);
 }
 
-void SndFileOutputModule::DoneOutput()
+int SndFileOutputModule::DoneOutput()
 {
    sf_close(m_sndfile);
+
+   return 0;
 }
 
 void SndFileOutputModule::SetTrackInfo(const TrackInfo& trackInfo)
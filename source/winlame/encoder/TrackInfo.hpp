@@ -24,6 +24,7 @@
 
 #include <string>
 #include <map>
+#include <memory>
 
 namespace Encoder
 {
@@ -53,6 +54,10 @@ namespace Encoder
       TrackInfoFrontCover = 0,   ///< front cover art, in JPEG format
    };
 
+   /// shared binary info data; binary infos like cover art are shared between copies of track
+   /// infos, since they may be copied for every encoding task
+   typedef std::shared_ptr<const std::vector<unsigned char>> SharedBinaryInfo;
+
    /// track info class
    class TrackInfo
    {
@@ -101,7 +106,14 @@ namespace Encoder
       /// sets a binary info value
       void SetBinaryInfo(TrackInfoBinaryType type, const std::vector<unsigned char>& value)
       {
-         m_mapBinaryInfos[type] = value;
+         m_mapBinaryInfos[type] = std::make_shared<const std::vector<unsigned char>>(value);
+      }
+
+      /// sets a binary info value, sharing the data with the caller
+      void SetBinaryInfo(TrackInfoBinaryType type, SharedBinaryInfo value)
+      {
+         if (value != nullptr)
+            m_mapBinaryInfos[type] = value;
       }
 
       /// retrieves a binary info value
@@ -111,11 +123,21 @@ namespace Encoder
          bool avail = iter != m_mapBinaryInfos.end();
 
          if (avail)
-            binaryInfo.assign(iter->second.begin(), iter->second.end());
+            binaryInfo.assign(iter->second->begin(), iter->second->end());
 
          return avail;
       }
 
+      /// returns size of all binary infos, in bytes
+      size_t BinaryInfosSize() const
+      {
+         size_t size = 0;
+         for (const auto& iter : m_mapBinaryInfos)
+            size += iter.second->size();
+
+         return size;
+      }
+
       /// returns if track info is empty
       bool IsEmpty() const
       {
@@ -141,7 +163,7 @@ namespace Encoder
       std::map<TrackInfoNumberType, int> m_mapNumberInfos;
 
       /// binary infos map
-      std::map<TrackInfoBinaryType, std::vector<unsigned char>> m_mapBinaryInfos;
+      std::map<TrackInfoBinaryType, SharedBinaryInfo> m_mapBinaryInfos;
    };
 
 } // namespace Encoder
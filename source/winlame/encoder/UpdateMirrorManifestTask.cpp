@@ -0,0 +1,96 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file UpdateMirrorManifestTask.cpp
+/// \brief Update mirror manifest task class
+//
+#include "stdafx.h"
+#include "UpdateMirrorManifestTask.hpp"
+#include <ulib/Path.hpp>
+
+using Encoder::UpdateMirrorManifestTask;
+
+/// tolerance for comparing file times, in 100ns units; FAT file systems store 2s steps
+const ULONGLONG c_fileTimeTolerance = 2ULL * 10 * 1000 * 1000;
+
+UpdateMirrorManifestTask::UpdateMirrorManifestTask(const std::vector<unsigned int>& encoderTaskIds,
+   std::shared_ptr<LibraryMirrorManifest> spManifest,
+   const std::vector<LibraryMirrorManifest::Entry>& encodedEntriesList,
+   bool useContentHash,
+   ULONGLONG encodingStartTime)
+   :Task(0),
+   m_spManifest(spManifest),
+   m_encodedEntriesList(encodedEntriesList),
+   m_useContentHash(useContentHash),
+   m_encodingStartTime(encodingStartTime),
+   m_finished(false)
+{
+   DependentTaskIds(encoderTaskIds);
+}
+
+TaskInfo UpdateMirrorManifestTask::GetTaskInfo()
+{
+   TaskInfo info(Id(), TaskInfo::taskWritePlaylist);
+
+   CString manifestFilename = m_spManifest->ManifestFilename();
+
+   CString name;
+   name.Format(IDS_MIRROR_TASK_NAME_S, Path::FilenameAndExt(manifestFilename).GetString());
+   info.Name(name);
+
+   CString description;
+   description.Format(IDS_MIRROR_TASK_DESCRIPTION_SU, manifestFilename.GetString(), m_encodedEntriesList.size());
+   info.Description(description);
+
+   info.Progress(m_finished ? 100 : 0);
+   info.Status(m_finished ? TaskInfo::statusCompleted : TaskInfo::statusWaiting);
+
+   return info;
+}
+
+void UpdateMirrorManifestTask::Run()
+{
+   // even when stopped, all files encoded so far are stored, so they're not encoded again
+   m_finished = false;
+
+   for (LibraryMirrorManifest::Entry entry : m_encodedEntriesList)
+   {
+      ULONGLONG outputFileSize = 0, outputLastWriteTime = 0;
+      if (!LibraryMirrorManifest::GetFileInfo(entry.m_outputFilename, outputFileSize, outputLastWriteTime))
+         continue; // not encoded
+
+      // an older output file was kept, e.g. because encoding failed or the task was stopped
+      if (outputLastWriteTime + c_fileTimeTolerance < m_encodingStartTime)
+         continue;
+
+      if (m_useContentHash && entry.m_contentHash == 0)
+         entry.m_contentHash = LibraryMirrorManifest::CalcContentHash(entry.m_inputFilename);
+
+      m_spManifest->Update(entry);
+   }
+
+   if (!m_spManifest->Save())
+      SetTaskError(IDS_MIRROR_TASK_ERROR_CREATE_FILE);
+
+   m_finished = true;
+}
+
+void UpdateMirrorManifestTask::Stop()
+{
+   // nothing to do; the task only runs briefly, and should store the files encoded so far
+}
@@ -0,0 +1,71 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file UpdateMirrorManifestTask.hpp
+/// \brief Update mirror manifest task class
+//
+#pragma once
+
+#include "Task.hpp"
+#include "LibraryMirrorManifest.hpp"
+#include <atomic>
+
+namespace Encoder
+{
+   /// \brief Task to update the library mirror manifest after all encoding tasks finished
+   /// \details Only entries whose output file was written by this run are stored in the
+   /// manifest; files that couldn't be encoded are encoded again on the next run.
+   class UpdateMirrorManifestTask : public Task
+   {
+   public:
+      /// ctor
+      UpdateMirrorManifestTask(const std::vector<unsigned int>& encoderTaskIds,
+         std::shared_ptr<LibraryMirrorManifest> spManifest,
+         const std::vector<LibraryMirrorManifest::Entry>& encodedEntriesList,
+         bool useContentHash,
+         ULONGLONG encodingStartTime);
+      /// dtor
+      virtual ~UpdateMirrorManifestTask() {}
+
+      /// returns current task info; must return immediately
+      virtual TaskInfo GetTaskInfo();
+
+      /// runs task; may take longer
+      virtual void Run();
+
+      /// task should be aborted, e.g. when program is closed
+      virtual void Stop();
+
+   private:
+      /// manifest to update
+      std::shared_ptr<LibraryMirrorManifest> m_spManifest;
+
+      /// entries for all files that are encoded
+      std::vector<LibraryMirrorManifest::Entry> m_encodedEntriesList;
+
+      /// indicates if content hashes are stored in the manifest
+      bool m_useContentHash;
+
+      /// time when encoding tasks were added, as FILETIME value; output files are newer
+      ULONGLONG m_encodingStartTime;
+
+      /// indicates if task is already finished
+      std::atomic<bool> m_finished;
+   };
+
+} // namespace Encoder
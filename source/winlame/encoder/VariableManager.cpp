@@ -33,6 +33,7 @@ struct SettingsVarMap
    LPCTSTR name;        ///< name
    LPCTSTR desc;        ///< description
    int defvalue;        ///< default value
+   bool outputNeutral;  ///< indicates if the variable doesn't change the encoded output
 };
 
 
@@ -106,17 +107,36 @@ int VariableManager::lookupDefaultValue(int varID)
    return defval;
 }
 
+bool VariableManager::lookupOutputNeutral(int varID)
+{
+   const SettingsVarMap *varmap = m_varmap;
+
+   bool outputNeutral = false;
+   while (varmap->name != NULL)
+   {
+      if (varID == varmap->id)
+      {
+         outputNeutral = varmap->outputNeutral;
+         break;
+      }
+      varmap++;
+   }
+   return outputNeutral;
+}
+
 
 // macros for building a varmap
 
 /// defines settings var map
 #define WL_VARMAP_START(x)       const SettingsVarMap x[] = {
 /// defines settings variable entry
-#define WL_VARMAP_ENTRY1(x,y,z)  { x, y, z, 0 },
+#define WL_VARMAP_ENTRY1(x,y,z)  { x, y, z, 0, false },
 /// defines settings variable entry with default value
-#define WL_VARMAP_ENTRY(x,y,z,w) { x, y, z, w },
+#define WL_VARMAP_ENTRY(x,y,z,w) { x, y, z, w, false },
+/// defines settings variable entry with default value, that doesn't change the encoded output
+#define WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(x,y,z,w) { x, y, z, w, true },
 /// ends settings var map
-#define WL_VARMAP_END()          { 0, NULL, NULL } };
+#define WL_VARMAP_END()          { 0, NULL, NULL, 0, false } };
 
 
 // facility varmap
@@ -148,6 +168,8 @@ WL_VARMAP_END()
 WL_VARMAP_START(varMapVariables)
 // persistent encoder variables
 WL_VARMAP_ENTRY(LameOptNoGap, _T("lameNoGap"), _T("nogap Encoding"), 0)
+WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(LameNoGapInstanceId, _T("lameNoGapInstanceId"), _T("nogap instance id"), -1)
+WL_VARMAP_ENTRY(LameOptNoGapParallel, _T("lameNoGapParallel"), _T("parallel nogap Encoding"), 0)
 WL_VARMAP_ENTRY(LameWriteWaveHeader, _T("lameWriteWaveHeader"), _T("write Wave Header"), 0)
 
 WL_VARMAP_ENTRY(LameSimpleEncodeQuality, _T("lameEncodeQuality"), _T("LAME encode quality"), 1)
@@ -163,6 +185,8 @@ WL_VARMAP_ENTRY(OggBaseQuality, _T("vorbisBaseQuality"), _T("Base Quality"), 400
 WL_VARMAP_ENTRY(OggVarMinBitrate, _T("vorbisVarMinBitrate"), _T("min. Bitrate"), 64)
 WL_VARMAP_ENTRY(OggVarMaxBitrate, _T("vorbisVarMaxBitrate"), _T("max. Bitrate"), 256)
 WL_VARMAP_ENTRY(OggVarNominalBitrate, _T("vorbisVarNominal"), _T("nominal Bitrate"), 128)
+WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(OggEncoderThread, _T("vorbisEncoderThread"), _T("encode on separate thread"), 0)
+WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(OggPageBuffering, _T("vorbisPageBuffering"), _T("write pages in large blocks"), 1)
 
 WL_VARMAP_ENTRY(AacBitrate, _T("aacBitrate"), _T("Bitrate"), 128)
 WL_VARMAP_ENTRY(AacBandwidth, _T("aacBandwidth"), _T("Bandwidth"), 16000)
@@ -186,7 +210,12 @@ WL_VARMAP_ENTRY(OpusTargetBitrate, _T("opusTargetBitrate"), _T("Opus Target Bitr
 WL_VARMAP_ENTRY(OpusComplexity, _T("opusComplexity"), _T("Opus Complexity"), 10)
 WL_VARMAP_ENTRY(OpusBitrateMode, _T("opusBitrateMode"), _T("Opus Bitrate Mode"), 0)
 
-WL_VARMAP_ENTRY(GeneralIsLastFile, _T("isLastFile"), _T("is last file"), 0)
+WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(GeneralIsLastFile, _T("isLastFile"), _T("is last file"), 0)
+WL_VARMAP_ENTRY(GeneralDownmixChannels, _T("downmixChannels"), _T("downmix to number of channels"), 0)
+WL_VARMAP_ENTRY(GeneralResampleRate, _T("resampleRate"), _T("resample to sample rate"), 0)
+WL_VARMAP_ENTRY(GeneralResampleQuality, _T("resampleQuality"), _T("resampler quality"), 1)
+
+WL_VARMAP_ENTRY_OUTPUT_NEUTRAL(MonkeysAudioDecoderThreads, _T("monkeysAudioDecoderThreads"), _T("Monkey's Audio decoder threads"), 0)
 WL_VARMAP_END()
 
 
@@ -48,6 +48,10 @@ public:
    /// looks up default variable value per ID
    int lookupDefaultValue(int varID);
 
+   /// looks up if variable doesn't change the encoded output, e.g. when it only controls
+   /// threading or differs for each run
+   bool lookupOutputNeutral(int varID);
+
 protected:
    /// variable map
    const SettingsVarMap* m_varmap;
@@ -114,6 +118,17 @@ enum
    OpusComplexity,
    OpusBitrateMode,
 
+   LameOptNoGapParallel,
+
+   MonkeysAudioDecoderThreads,
+
+   OggEncoderThread,
+   OggPageBuffering,
+
+   GeneralDownmixChannels,
+   GeneralResampleRate,
+   GeneralResampleQuality,
+
    VarLast
 };
 
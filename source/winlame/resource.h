@@ -69,6 +69,7 @@
 #define IDC_OUT_BEVEL1                  3210
 #define IDC_OUT_BEVEL2                  3211
 #define IDC_OUT_BEVEL3                  3212
+#define IDC_OUT_MIRROR_LIBRARY          3213
 #define IDC_LAME_EDIT_QUALITY           3400
 #define IDC_LAME_SPIN_QUALITY           3401
 #define IDC_LAME_RADIO_TYPE2            3402
@@ -85,6 +86,7 @@
 #define IDC_LAME_BEVEL1                 3413
 #define IDC_LAME_BEVEL2                 3414
 #define IDC_LAME_BEVEL3                 3415
+#define IDC_LAME_CHECK_NOGAP_PARALLEL   3416
 #define IDC_OGGV_RADIO_BRMODE1          3500
 #define IDC_OGGV_RADIO_BRMODE2          3501
 #define IDC_OGGV_RADIO_BRMODE3          3502
@@ -225,6 +227,7 @@
 #define IDS_INPUT_FILTER_ALLFILES       40412
 #define IDS_INPUT_ERRORS_OCCURED_ADDING 40414
 #define IDS_INPUT_TIME_UU               40415
+#define IDS_INPUT_STILL_SEARCHING_FOLDERS 40416
 #define IDS_OUT_OUTDIR_EMPTY            40600
 #define IDS_OUT_CREATE                  40601
 #define IDS_OUT_ACTION_EXIT             40602
@@ -292,6 +295,11 @@
 #define IDS_ENCODER_ERROR_ERRORINFO_SSI 41611
 #define IDS_PLAYLIST_TASK_ERROR_CREATE_FILE 41612
 #define IDS_PLAYLIST_TASK_DESCRIPTION_SU 41613
+#define IDS_MIRROR_TASK_ERROR_CREATE_FILE 41614
+#define IDS_MIRROR_TASK_DESCRIPTION_SU  41615
+#define IDS_MIRROR_TASK_NAME_S          41616
+#define IDS_ENCODER_ERROR_INIT_RESAMPLER 41617
+#define IDS_ENCODER_ERROR_GAPLESS_CONTEXT_SKIPPED 41618
 #define IDS_FILTER_AAC_INPUT            41700
 #define IDS_FILTER_BASS_INPUT           41701
 #define IDS_FILTER_BASS_WMA_INPUT       41702
@@ -716,6 +716,10 @@ void InputCDPage::UpdateCDReadJobList(unsigned int driveIndex)
 
    unsigned int maxTrack = tracksList.size();
 
+   // all jobs share the same cover art data
+   Encoder::SharedBinaryInfo spCoverArtImageData =
+      std::make_shared<const std::vector<unsigned char>>(m_covertArtImageData);
+
    for (unsigned int n = 0; n < maxTrack; n++)
    {
       unsigned int numTrack = tracksList[n];
@@ -728,7 +732,8 @@ void InputCDPage::UpdateCDReadJobList(unsigned int driveIndex)
       CDRipTrackInfo trackInfo = ReadTrackInfo(driveIndex, numTrack, discInfo);
 
       Encoder::CDReadJob cdReadJob(discInfo, trackInfo);
-      cdReadJob.FrontCoverArtImage(m_covertArtImageData);
+      if (!m_covertArtImageData.empty())
+         cdReadJob.FrontCoverArtImage(spCoverArtImageData);
 
       m_uiSettings.cdreadjoblist.push_back(cdReadJob);
    }
@@ -60,6 +60,9 @@ LRESULT InputFilesPage::OnInitDialog(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*
 
    SetupListCtrl();
 
+   m_audioFileInfoManager.SetCallback(
+      std::bind(&InputFilesPage::OnRetrievedAudioFileInfos, this, std::placeholders::_1));
+
    AddFiles(m_inputFilesList);
    m_inputFilesList.clear();
 
@@ -73,6 +76,13 @@ LRESULT InputFilesPage::OnInitDialog(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*
 
 LRESULT InputFilesPage::OnButtonOK(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& bHandled)
 {
+   // when dropped folders are still searched, refuse to leave the page, since files would be missing
+   if (m_upDirectoryWalker != nullptr && m_upDirectoryWalker->IsWalking())
+   {
+      AtlMessageBox(m_hWnd, IDS_INPUT_STILL_SEARCHING_FOLDERS, IDS_APP_CAPTION, MB_OK | MB_ICONEXCLAMATION);
+      return 1; // prevent leaving dialog
+   }
+
    m_audioFileInfoManager.Stop();
 
    int max = m_listViewInputFiles.GetItemCount();
@@ -125,7 +135,7 @@ LRESULT InputFilesPage::OnKeyDown(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL&
       int pos = m_listViewInputFiles.GetNextItem(-1, LVIS_SELECTED);
 
       // delete all files
-      m_listViewInputFiles.DeleteSelectedListItems();
+      DeleteSelectedFiles();
 
       // set selection on next item
       m_listViewInputFiles.SetItemState(pos,
@@ -166,17 +176,32 @@ LRESULT InputFilesPage::OnSize(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bH
 
 LRESULT InputFilesPage::OnUpdateAudioInfo(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled)
 {
-   AudioFileEntry* entry = reinterpret_cast<AudioFileEntry*>(lParam);
+   std::vector<AudioFileEntry>* entriesList = reinterpret_cast<std::vector<AudioFileEntry>*>(lParam);
 
-   m_listViewInputFiles.UpdateAudioFileInfo(*entry);
+   m_listViewInputFiles.UpdateAudioFileInfos(*entriesList);
 
-   delete entry;
+   delete entriesList;
 
    UpdateTimeCount();
 
    return 0;
 }
 
+LRESULT InputFilesPage::OnAddFoundFiles(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled)
+{
+   std::vector<CString>* filenamesList = reinterpret_cast<std::vector<CString>*>(lParam);
+
+   // also imports playlists and cue sheets found in the folders
+   InputFilesParser parser;
+   parser.ParseFiles(*filenamesList);
+
+   delete filenamesList;
+
+   AddParsedFiles(parser);
+
+   return 0;
+}
+
 LRESULT InputFilesPage::OnListItemChanged(int idCtrl, LPNMHDR pnmh, BOOL& bHandled)
 {
    // called when the selected item in the list changes
@@ -190,6 +215,13 @@ LRESULT InputFilesPage::OnListItemChanged(int idCtrl, LPNMHDR pnmh, BOOL& bHandl
    return 0;
 }
 
+LRESULT InputFilesPage::OnListEndScroll(int idCtrl, LPNMHDR pnmh, BOOL& bHandled)
+{
+   PrioritizeVisibleFiles();
+
+   return 0;
+}
+
 LRESULT InputFilesPage::OnDoubleClickedList(int idCtrl, LPNMHDR pnmh, BOOL& bHandled)
 {
    // double-clicked on an item
@@ -232,7 +264,7 @@ LRESULT InputFilesPage::OnButtonInputFileSel(WORD /*wNotifyCode*/, WORD /*wID*/,
 LRESULT InputFilesPage::OnButtonDeleteAll(WORD wNotifyCode, WORD wID, HWND hWndCtl, BOOL& bHandled)
 {
    // delete all list items
-   m_listViewInputFiles.DeleteSelectedListItems();
+   DeleteSelectedFiles();
 
    UpdateTimeCount();
 
@@ -285,8 +317,16 @@ void InputFilesPage::AddFiles(const std::vector<CString>& inputFilesList)
    InputFilesParser parser;
    parser.Parse(inputFilesList);
 
+   AddParsedFiles(parser);
+}
+
+void InputFilesPage::AddParsedFiles(InputFilesParser& parser)
+{
    InsertFilenames(parser.FileList());
 
+   for (const CString& folderName : parser.FolderList())
+      WalkFolder(folderName);
+
    if (!parser.PlaylistName().IsEmpty())
    {
       CString name = Path::FilenameOnly(parser.PlaylistName());
@@ -294,12 +334,36 @@ void InputFilesPage::AddFiles(const std::vector<CString>& inputFilesList)
    }
 }
 
+void InputFilesPage::WalkFolder(const CString& folderName)
+{
+   if (m_upDirectoryWalker == nullptr)
+   {
+      Encoder::ModuleManager& moduleManager = IoCContainer::Current().Resolve<Encoder::ModuleManager>();
+
+      std::set<CString> extensionsSet = moduleManager.GetInputFileExtensions();
+
+      // playlists and cue sheets are imported when the found files are parsed
+      extensionsSet.insert(_T("m3u"));
+      extensionsSet.insert(_T("pls"));
+      extensionsSet.insert(_T("cue"));
+
+      m_upDirectoryWalker.reset(new DirectoryWalker(extensionsSet));
+
+      m_upDirectoryWalker->SetCallback(
+         std::bind(&InputFilesPage::OnFoundFiles, this, std::placeholders::_1));
+   }
+
+   m_upDirectoryWalker->Walk(folderName);
+}
+
 void InputFilesPage::InsertFilenames(const std::vector<CString>& inputFilesList)
 {
    RedrawLock lock(m_listViewInputFiles);
 
    for (size_t i = 0, iMax = inputFilesList.size(); i < iMax; i++)
       InsertFilenameWithIcon(inputFilesList[i]);
+
+   PrioritizeVisibleFiles();
 }
 
 void InputFilesPage::InsertFilenameWithIcon(const CString& filename)
@@ -319,29 +383,56 @@ void InputFilesPage::InsertFilenameWithIcon(const CString& filename)
 
    m_listViewInputFiles.InsertFile(filename, sfi.iIcon, -1, -1, -1);
 
-   m_audioFileInfoManager.AsyncGetAudioFileInfo(filename,
-      std::bind(&InputFilesPage::OnRetrievedAudioFileInfo, this,
-         filename,
-         std::placeholders::_1,
-         std::placeholders::_2,
-         std::placeholders::_3,
-         std::placeholders::_4,
-         std::placeholders::_5));
+   m_audioFileInfoManager.AsyncGetAudioFileInfo(filename);
+}
+
+void InputFilesPage::DeleteSelectedFiles()
+{
+   std::vector<CString> deletedFilenamesList = m_listViewInputFiles.DeleteSelectedListItems();
+
+   m_audioFileInfoManager.CancelFiles(deletedFilenamesList);
+
+   PrioritizeVisibleFiles();
 }
 
-void InputFilesPage::OnRetrievedAudioFileInfo(const CString& filename, bool error, const CString& errorMessage,
-   int lengthInSeconds, int bitrateInBps, int sampleFrequencyInHz)
+void InputFilesPage::PrioritizeVisibleFiles()
 {
-   if (error)
+   m_audioFileInfoManager.PrioritizeFiles(m_listViewInputFiles.GetVisibleFileNames());
+}
+
+void InputFilesPage::OnRetrievedAudioFileInfos(const std::vector<AudioFileInfoManager::AudioFileInfo>& audioFileInfoList)
+{
+   std::vector<AudioFileEntry>* entriesList = new std::vector<AudioFileEntry>;
+   entriesList->reserve(audioFileInfoList.size());
+
+   for (const AudioFileInfoManager::AudioFileInfo& info : audioFileInfoList)
+   {
+      if (info.m_error)
+         continue;
+
+      AudioFileEntry entry;
+      entry.filename = info.m_filename;
+      entry.length = info.m_lengthInSeconds;
+      entry.bitrate = info.m_bitrateInBps;
+      entry.samplerate = info.m_sampleFrequencyInHz;
+
+      entriesList->push_back(entry);
+   }
+
+   if (entriesList->empty())
+   {
+      delete entriesList;
       return;
+   }
 
-   AudioFileEntry* entry = new AudioFileEntry;
-   entry->filename = filename;
-   entry->length = lengthInSeconds;
-   entry->bitrate = bitrateInBps;
-   entry->samplerate = sampleFrequencyInHz;
+   // all entries of the batch are updated with a single message
+   PostMessage(WM_UPDATE_AUDIO_INFO, 0, reinterpret_cast<LPARAM>(entriesList));
+}
 
-   PostMessage(WM_UPDATE_AUDIO_INFO, 0, reinterpret_cast<LPARAM>(entry));
+void InputFilesPage::OnFoundFiles(const std::vector<CString>& filenamesList)
+{
+   // the files are inserted in the UI thread
+   PostMessage(WM_ADD_FOUND_FILES, 0, reinterpret_cast<LPARAM>(new std::vector<CString>(filenamesList)));
 }
 
 void InputFilesPage::PlayFile(LPCTSTR filename)
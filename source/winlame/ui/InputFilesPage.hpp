@@ -24,12 +24,17 @@
 #include "WizardPage.hpp"
 #include "InputListCtrl.hpp"
 #include "AudioFileInfoManager.hpp"
+#include "DirectoryWalker.hpp"
 #include "resource.h"
 
-/// window message used to update audio info for a file
+/// window message used to update audio infos for a batch of files
 #define WM_UPDATE_AUDIO_INFO (WM_APP + 4)
 
+/// window message used to add a batch of files found while walking folders
+#define WM_ADD_FOUND_FILES (WM_APP + 5)
+
 struct UISettings;
+class InputFilesParser;
 
 namespace UI
 {
@@ -73,8 +78,10 @@ namespace UI
          MESSAGE_HANDLER(WM_KEYDOWN, OnKeyDown)
          MESSAGE_HANDLER(WM_SIZE, OnSize)
          MESSAGE_HANDLER(WM_UPDATE_AUDIO_INFO, OnUpdateAudioInfo)
+         MESSAGE_HANDLER(WM_ADD_FOUND_FILES, OnAddFoundFiles)
          NOTIFY_HANDLER(IDC_INPUT_LIST_INPUTFILES, LVN_ITEMCHANGED, OnListItemChanged)
          NOTIFY_HANDLER(IDC_INPUT_LIST_INPUTFILES, NM_DBLCLK, OnDoubleClickedList)
+         NOTIFY_HANDLER(IDC_INPUT_LIST_INPUTFILES, LVN_ENDSCROLL, OnListEndScroll)
          COMMAND_HANDLER(IDC_INPUT_BUTTON_PLAY, BN_CLICKED, OnButtonPlay)
          COMMAND_HANDLER(IDC_INPUT_BUTTON_INFILESEL, BN_CLICKED, OnButtonInputFileSel)
          COMMAND_HANDLER(IDC_INPUT_BUTTON_DELETE, BN_CLICKED, OnButtonDeleteAll)
@@ -106,21 +113,29 @@ namespace UI
       /// called when resizing the dialog
       LRESULT OnSize(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
 
-      /// called when audio info for a file was updated
+      /// called when audio infos for a batch of files were updated
       LRESULT OnUpdateAudioInfo(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
 
+      /// called when a batch of files was found while walking folders
+      LRESULT OnAddFoundFiles(UINT uMsg, WPARAM wParam, LPARAM lParam, BOOL& bHandled);
+
       /// called when the selected item in the list ctrl changes
       LRESULT OnListItemChanged(int idCtrl, LPNMHDR pnmh, BOOL& bHandled);
 
+      /// called when the user finished scrolling the list
+      LRESULT OnListEndScroll(int idCtrl, LPNMHDR pnmh, BOOL& bHandled);
+
       /// called when user double-clicks on an item in list
       LRESULT OnDoubleClickedList(int idCtrl, LPNMHDR pnmh, BOOL& bHandled);
 
       /// called when user presses the play button
       LRESULT OnButtonPlay(WORD wNotifyCode, WORD wID, HWND hWndCtl, BOOL& bHandled);
 
-      /// called when audio file info was retrieved asynchronously
-      void OnRetrievedAudioFileInfo(const CString& filename, bool error, const CString& errorMessage,
-         int lengthInSeconds, int bitrateInBps, int sampleFrequencyInHz);
+      /// called when a batch of audio file infos was retrieved asynchronously
+      void OnRetrievedAudioFileInfos(const std::vector<AudioFileInfoManager::AudioFileInfo>& audioFileInfoList);
+
+      /// called when a batch of files was found by the directory walker
+      void OnFoundFiles(const std::vector<CString>& filenamesList);
 
    private:
       /// sets up tracks list control
@@ -132,12 +147,24 @@ namespace UI
       /// adds files to list
       void AddFiles(const std::vector<CString>& inputFilesList);
 
+      /// adds files of parser to list, and starts walking its folders
+      void AddParsedFiles(InputFilesParser& parser);
+
+      /// starts walking folder, to add all supported audio files in it
+      void WalkFolder(const CString& folderName);
+
       /// insert new file names into list
       void InsertFilenames(const std::vector<CString>& inputFilesList);
 
       /// inserts single filename with icon into list
       void InsertFilenameWithIcon(const CString& filename);
 
+      /// deletes all selected files and cancels getting their audio file infos
+      void DeleteSelectedFiles();
+
+      /// lets the audio file info manager process the visible files first
+      void PrioritizeVisibleFiles();
+
       /// plays file using assigned application
       void PlayFile(LPCTSTR filename);
 
@@ -173,6 +200,9 @@ namespace UI
       /// manager for audio file infos
       AudioFileInfoManager m_audioFileInfoManager;
 
+      /// directory walker; created when the first folder is added
+      std::unique_ptr<DirectoryWalker> m_upDirectoryWalker;
+
       /// filter string
       static CString m_filterString;
    };
@@ -21,6 +21,7 @@
 //
 #include "stdafx.h"
 #include "InputListCtrl.hpp"
+#include <map>
 
 /// darker color for alternate lines list control
 COLORREF g_clrAlternateListColor = RGB(232, 232, 232);
@@ -45,10 +46,11 @@ InputListCtrl::~InputListCtrl()
    allentries.clear();
 }
 
-void InputListCtrl::DeleteSelectedListItems()
+std::vector<CString> InputListCtrl::DeleteSelectedListItems()
 {
    // deletes items from the list ctrl in reverse order
    std::vector<int> vItems;
+   std::vector<CString> deletedFilenamesList;
 
    // first, collect all item indices
    int pos = GetNextItem(-1, LVIS_SELECTED);
@@ -56,12 +58,15 @@ void InputListCtrl::DeleteSelectedListItems()
    while (pos != -1)
    {
       vItems.push_back(pos);
+      deletedFilenamesList.push_back(GetFileName(pos));
       pos = GetNextItem(pos, LVIS_SELECTED);
    }
 
    // then delete them in the reverse order
    for (int i = vItems.size() - 1; i >= 0; i--)
       DeleteItem(vItems[i]);
+
+   return deletedFilenamesList;
 }
 
 void InputListCtrl::InsertFile(LPCTSTR filename, int icon, int samplerate,
@@ -128,6 +133,19 @@ CString InputListCtrl::GetFileName(int index)
    return entry == nullptr ? CString() : entry->filename;
 }
 
+std::vector<CString> InputListCtrl::GetVisibleFileNames()
+{
+   std::vector<CString> filenamesList;
+
+   int topIndex = GetTopIndex();
+   int maxIndex = std::min(GetItemCount(), topIndex + GetCountPerPage() + 1);
+
+   for (int index = std::max(topIndex, 0); index < maxIndex; index++)
+      filenamesList.push_back(GetFileName(index));
+
+   return filenamesList;
+}
+
 unsigned int InputListCtrl::GetTotalLength()
 {
    unsigned int nLength = 0;
@@ -137,32 +155,34 @@ unsigned int InputListCtrl::GetTotalLength()
    return nLength;
 }
 
-void InputListCtrl::UpdateAudioFileInfo(const AudioFileEntry& updatedEntry)
+void InputListCtrl::UpdateAudioFileInfos(const std::vector<AudioFileEntry>& updatedEntriesList)
 {
-   for (unsigned int index = 0, maxIndex = allentries.size(); index < maxIndex; index++)
+   std::map<CString, const AudioFileEntry*> updatedEntriesMap;
+   for (const AudioFileEntry& updatedEntry : updatedEntriesList)
    {
-      AudioFileEntry* entry = allentries[index];
-      if (entry->filename.CompareNoCase(updatedEntry.filename) == 0)
-      {
-         entry->length = updatedEntry.length;
-         entry->bitrate = updatedEntry.bitrate;
-         entry->samplerate = updatedEntry.samplerate;
+      CString key = updatedEntry.filename;
+      updatedEntriesMap[key.MakeLower()] = &updatedEntry;
+   }
 
-         // now search item in list and update it also
-         for (int itemIndex = 0, maxItemIndex = GetItemCount(); itemIndex < maxItemIndex; itemIndex++)
-         {
-            AudioFileEntry* entryFromList =
-               reinterpret_cast<AudioFileEntry*>(GetItemData(itemIndex));
+   // only iterates once over the list items, regardless of the number of updated entries
+   for (int itemIndex = 0, maxItemIndex = GetItemCount(); itemIndex < maxItemIndex; itemIndex++)
+   {
+      AudioFileEntry* entry =
+         reinterpret_cast<AudioFileEntry*>(GetItemData(itemIndex));
 
-            if (entryFromList == entry)
-            {
-               SetItemAudioInfos(itemIndex, entry->length, entry->bitrate, entry->samplerate);
-               break;
-            }
-         }
+      if (entry == nullptr)
+         continue;
 
-         break;
-      }
+      CString key = entry->filename;
+      auto iter = updatedEntriesMap.find(key.MakeLower());
+      if (iter == updatedEntriesMap.end())
+         continue;
+
+      entry->length = iter->second->length;
+      entry->bitrate = iter->second->bitrate;
+      entry->samplerate = iter->second->samplerate;
+
+      SetItemAudioInfos(itemIndex, entry->length, entry->bitrate, entry->samplerate);
    }
 }
 
@@ -50,8 +50,8 @@ namespace UI
       /// dtor
       ~InputListCtrl();
 
-      /// deletes all selected list items
-      void DeleteSelectedListItems();
+      /// deletes all selected list items; returns the file names of the deleted items
+      std::vector<CString> DeleteSelectedListItems();
 
       /// inserts a file
       void InsertFile(LPCTSTR filename, int icon, int samplerate,
@@ -60,11 +60,14 @@ namespace UI
       /// returns file name
       CString GetFileName(int index);
 
+      /// returns file names of all items currently visible in the list
+      std::vector<CString> GetVisibleFileNames();
+
       /// returns total length of files in list
       unsigned int GetTotalLength();
 
-      /// updates audio file infos about one file
-      void UpdateAudioFileInfo(const AudioFileEntry& entry);
+      /// updates audio file infos of multiple files at once
+      void UpdateAudioFileInfos(const std::vector<AudioFileEntry>& updatedEntriesList);
 
    private:
       // message map
@@ -131,6 +131,13 @@ LRESULT LAMESettingsPage::OnRadioEncodeType(WORD wNotifyCode, WORD wID, HWND hWn
    return 0;
 }
 
+LRESULT LAMESettingsPage::OnCheckNogap(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/)
+{
+   m_checkNogapParallel.EnableWindow(m_checkNogap.GetCheck() == BST_CHECKED);
+
+   return 0;
+}
+
 void LAMESettingsPage::LoadData()
 {
    SettingsManager& mgr = m_uiSettings.settings_manager;
@@ -166,6 +173,10 @@ void LAMESettingsPage::LoadData()
    // "nogap" check
    m_checkNogap.SetCheck(mgr.queryValueInt(LameOptNoGap) == 0 ? BST_UNCHECKED : BST_CHECKED);
 
+   // "nogap parallel encoding" check
+   m_checkNogapParallel.SetCheck(mgr.queryValueInt(LameOptNoGapParallel) == 0 ? BST_UNCHECKED : BST_CHECKED);
+   OnCheckNogap(0, IDC_LAME_CHECK_NOGAP, NULL, dummy);
+
    // "prepend RIFF WAVE Header" check
    m_checkWaveMp3.SetCheck(mgr.queryValueInt(LameWriteWaveHeader) == 0 ? BST_UNCHECKED : BST_CHECKED);
 }
@@ -205,6 +216,10 @@ void LAMESettingsPage::SaveData()
    value = m_checkNogap.GetCheck() == BST_CHECKED ? 1 : 0;
    mgr.setValue(LameOptNoGap, value);
 
+   // "nogap parallel encoding" check
+   value = m_checkNogapParallel.GetCheck() == BST_CHECKED ? 1 : 0;
+   mgr.setValue(LameOptNoGapParallel, value);
+
    // "prepend RIFF WAVE Header" check
    value = m_checkWaveMp3.GetCheck() == BST_CHECKED ? 1 : 0;
    mgr.setValue(LameWriteWaveHeader, value);
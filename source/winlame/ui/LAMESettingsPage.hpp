@@ -59,6 +59,7 @@ namespace UI
          DDX_CONTROL_HANDLE(IDC_LAME_CHECK_MONO, m_checkMono)
          DDX_CONTROL_HANDLE(IDC_LAME_CHECK_CBR, m_checkCBR)
          DDX_CONTROL_HANDLE(IDC_LAME_CHECK_NOGAP, m_checkNogap)
+         DDX_CONTROL_HANDLE(IDC_LAME_CHECK_NOGAP_PARALLEL, m_checkNogapParallel)
          DDX_CONTROL_HANDLE(IDC_LAME_CHECK_WRITE_WAVEMP3, m_checkWaveMp3)
          DDX_RADIO(IDC_LAME_RADIO_TYPE1, m_radioType);
       END_DDX_MAP()
@@ -79,6 +80,7 @@ namespace UI
          COMMAND_HANDLER(ID_WIZBACK, BN_CLICKED, OnButtonBack)
          COMMAND_HANDLER(IDC_LAME_RADIO_TYPE1, BN_CLICKED, OnRadioEncodeType)
          COMMAND_HANDLER(IDC_LAME_RADIO_TYPE2, BN_CLICKED, OnRadioEncodeType)
+         COMMAND_HANDLER(IDC_LAME_CHECK_NOGAP, BN_CLICKED, OnCheckNogap)
          CHAIN_MSG_MAP(CDialogResize<LAMESettingsPage>)
          REFLECT_NOTIFICATIONS()
       END_MSG_MAP()
@@ -103,6 +105,9 @@ namespace UI
       /// called when radio button for encode type changes
       LRESULT OnRadioEncodeType(WORD wNotifyCode, WORD wID, HWND hWndCtl, BOOL& bHandled);
 
+      /// called when nogap checkbox is clicked
+      LRESULT OnCheckNogap(WORD wNotifyCode, WORD wID, HWND hWndCtl, BOOL& bHandled);
+
       /// loads settings data into controls
       void LoadData();
 
@@ -133,6 +138,9 @@ namespace UI
       /// Nogap checkbox
       CButton m_checkNogap;
 
+      /// Nogap parallel encoding checkbox
+      CButton m_checkNogapParallel;
+
       /// Wave MP3 checkbox
       CButton m_checkWaveMp3;
 
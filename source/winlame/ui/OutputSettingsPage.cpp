@@ -129,6 +129,9 @@ void OutputSettingsPage::LoadData()
       m_checkDeleteAfter.EnableWindow(FALSE);
    }
 
+   // "mirror library" check
+   m_checkMirrorLibrary.SetCheck(m_uiSettings.m_mirrorLibrary && m_uiSettings.m_bFromInputFilesPage ? BST_CHECKED : BST_UNCHECKED);
+
    // update edit field state
    BOOL dummy;
    OnCheckUseInputFolder(0, 0, 0, dummy);
@@ -160,6 +163,10 @@ bool OutputSettingsPage::SaveData(bool bSilent)
    m_uiSettings.out_location_use_input_dir =
       BST_CHECKED == m_checkUseInputDir.GetCheck();
 
+   // "mirror library" check; not changed when encoding CD tracks
+   if (m_uiSettings.m_bFromInputFilesPage)
+      m_uiSettings.m_mirrorLibrary = BST_CHECKED == m_checkMirrorLibrary.GetCheck();
+
    // "overwrite existing" check
    m_uiSettings.m_defaultSettings.overwrite_existing =
       BST_CHECKED == m_checkOverwrite.GetCheck();
@@ -299,6 +306,9 @@ LRESULT OutputSettingsPage::OnCheckUseInputFolder(WORD /*wNotifyCode*/, WORD /*w
    m_comboOutputPath.EnableWindow(check);
    m_buttonSelectPath.EnableWindow(check);
 
+   // mirroring needs an output folder to mirror to, and input folders to mirror
+   m_checkMirrorLibrary.EnableWindow(check && m_uiSettings.m_bFromInputFilesPage ? TRUE : FALSE);
+
    return 0;
 }
 
@@ -55,6 +55,7 @@ namespace UI
          DDX_CONTROL(IDC_OUT_BEVEL3, m_bevel3)
          DDX_CONTROL_HANDLE(IDC_OUT_COMBO_OUTMODULE, m_comboOutputModule)
          DDX_CONTROL_HANDLE(IDC_OUT_USE_INDIR, m_checkUseInputDir)
+         DDX_CONTROL_HANDLE(IDC_OUT_MIRROR_LIBRARY, m_checkMirrorLibrary)
          DDX_CONTROL_HANDLE(IDC_OUT_OUTPATH, m_comboOutputPath)
          DDX_CONTROL_HANDLE(IDC_OUT_DELAFTER, m_checkDeleteAfter)
          DDX_CONTROL_HANDLE(IDC_OUT_CHECK_OVERWRITE, m_checkOverwrite)
@@ -142,6 +143,7 @@ namespace UI
 
       CComboBox m_comboOutputPath;  ///< output path combobox
       CButton m_checkUseInputDir;   ///< "use input dir" checkbox
+      CButton m_checkMirrorLibrary; ///< "mirror library" checkbox
       CButton m_checkDeleteAfter;   ///< "delete after encoding" checkbox
       CButton m_checkOverwrite;     ///< "overwrite" checkbox
       CButton m_checkCreatePlaylist;///< "create playlist" checkbox
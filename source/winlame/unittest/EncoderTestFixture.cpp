@@ -105,12 +105,10 @@ Encoder::TrackInfo EncoderTestFixture::GetTrackInfo(LPCTSTR filename)
    if (inputModule == nullptr)
       throw std::runtime_error("couldn't find input module for filename");
 
+   // reads the track info like the app does, using the track info cache when it's set
    Encoder::TrackInfo trackInfo;
-   Encoder::SampleContainer samples;
-   SettingsManager dummy;
-   inputModule->InitInput(filename, dummy, trackInfo, samples);
-
-   inputModule->DoneInput();
+   CString errorMessage;
+   moduleManager.GetTrackInfo(filename, trackInfo, errorMessage);
 
    return trackInfo;
 }
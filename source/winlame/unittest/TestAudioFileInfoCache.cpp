@@ -0,0 +1,210 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestAudioFileInfoCache.cpp
+/// \brief Unit tests for the AudioFileInfoCache class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "AudioFileInfoCache.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for AudioFileInfoCache class
+   TEST_CLASS(TestAudioFileInfoCache)
+   {
+   public:
+      /// writes file with given content
+      static void WriteFile(const CString& filename, const char* content)
+      {
+         FILE* fd = _tfopen(filename, _T("wb"));
+         Assert::IsNotNull(fd, _T("file must be able to be created"));
+
+         fwrite(content, 1, strlen(content), fd);
+         fclose(fd);
+      }
+
+      /// tests storing, saving and loading infos
+      TEST_METHOD(TestSaveLoad)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString audioFilename = Path::Combine(folder.FolderName(), _T("track.flac"));
+         CString cacheFilename = Path::Combine(folder.FolderName(), _T("cache.bin"));
+         WriteFile(audioFilename, "audio");
+
+         Encoder::ProbeInfo info;
+         info.m_numChannels = 2;
+         info.m_samplerateInHz = 44100;
+         info.m_numSamples = 441000;
+         info.m_bitrateInBps = 900000;
+         info.m_lengthInSeconds = 10;
+
+         std::vector<unsigned char> coverArt(1000, 0x42);
+
+         Encoder::TrackInfo trackInfo;
+         trackInfo.SetTextInfo(Encoder::TrackInfoTitle, _T("Title"));
+         trackInfo.SetNumberInfo(Encoder::TrackInfoYear, 2020);
+         trackInfo.SetBinaryInfo(Encoder::TrackInfoFrontCover, coverArt);
+
+         // run
+         {
+            Encoder::AudioFileInfoCache cache(cacheFilename);
+            Assert::IsFalse(cache.Load(), _T("there must be no cache file yet"));
+
+            cache.StoreAudioFileInfo(audioFilename, info);
+            cache.StoreTrackInfo(audioFilename, trackInfo);
+            Assert::AreEqual<size_t>(1, cache.NumUnsavedEntries(), _T("there must be one new entry"));
+
+            Assert::IsTrue(cache.Save(), _T("saving cache must succeed"));
+            Assert::AreEqual<size_t>(0, cache.NumUnsavedEntries(), _T("there must be no new entry anymore"));
+         }
+
+         Encoder::AudioFileInfoCache cache(cacheFilename);
+         Assert::IsTrue(cache.Load(), _T("loading cache must succeed"));
+
+         // check
+         Encoder::ProbeInfo info2;
+         Assert::IsTrue(cache.LookupAudioFileInfo(CString(audioFilename).MakeUpper(), info2),
+            _T("audio file info must be found, regardless of filename case"));
+
+         Assert::AreEqual(2, info2.m_numChannels, _T("number of channels must match"));
+         Assert::AreEqual(44100, info2.m_samplerateInHz, _T("sample rate must match"));
+         Assert::AreEqual(441000ULL, info2.m_numSamples, _T("number of samples must match"));
+         Assert::AreEqual(900000, info2.m_bitrateInBps, _T("bitrate must match"));
+         Assert::AreEqual(10, info2.m_lengthInSeconds, _T("length must match"));
+
+         Encoder::TrackInfo trackInfo2;
+         Assert::IsTrue(cache.LookupTrackInfo(audioFilename, trackInfo2), _T("track info must be found"));
+
+         bool avail = false;
+         Assert::AreEqual(_T("Title"), trackInfo2.GetTextInfo(Encoder::TrackInfoTitle, avail).GetString(),
+            _T("title must match"));
+         Assert::IsTrue(avail, _T("title must be available"));
+
+         Assert::AreEqual(2020, trackInfo2.GetNumberInfo(Encoder::TrackInfoYear, avail), _T("year must match"));
+         Assert::IsTrue(avail, _T("year must be available"));
+
+         std::vector<unsigned char> coverArt2;
+         Assert::IsTrue(trackInfo2.GetBinaryInfo(Encoder::TrackInfoFrontCover, coverArt2),
+            _T("cover art must be available"));
+         Assert::IsTrue(coverArt == coverArt2, _T("cover art must match"));
+      }
+
+      /// tests that infos of modified files aren't returned
+      TEST_METHOD(TestModifiedFile)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString audioFilename = Path::Combine(folder.FolderName(), _T("track.flac"));
+         CString cacheFilename = Path::Combine(folder.FolderName(), _T("cache.bin"));
+         WriteFile(audioFilename, "audio");
+
+         Encoder::ProbeInfo info;
+         info.m_numChannels = 2;
+
+         {
+            Encoder::AudioFileInfoCache cache(cacheFilename);
+            cache.StoreAudioFileInfo(audioFilename, info);
+            Assert::IsTrue(cache.Save(), _T("saving cache must succeed"));
+         }
+
+         // run
+         WriteFile(audioFilename, "modified audio");
+
+         Encoder::AudioFileInfoCache cache(cacheFilename);
+         Assert::IsTrue(cache.Load(), _T("loading cache must succeed"));
+
+         // check
+         Encoder::ProbeInfo info2;
+         Assert::IsFalse(cache.LookupAudioFileInfo(audioFilename, info2),
+            _T("audio file info of modified file must not be found"));
+
+         Encoder::TrackInfo trackInfo2;
+         Assert::IsFalse(cache.LookupTrackInfo(audioFilename, trackInfo2),
+            _T("track info must not be found when it was never stored"));
+      }
+
+      /// tests that entries of deleted files are evicted when looked up, but not those in
+      /// missing folders
+      TEST_METHOD(TestLookupEvictsMissingFiles)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString keptFilename = Path::Combine(folder.FolderName(), _T("kept.flac"));
+         CString deletedFilename = Path::Combine(folder.FolderName(), _T("deleted.flac"));
+         CString cacheFilename = Path::Combine(folder.FolderName(), _T("cache.bin"));
+         WriteFile(keptFilename, "audio");
+         WriteFile(deletedFilename, "audio");
+
+         CString subfolderName = Path::Combine(folder.FolderName(), _T("subfolder"));
+         CreateDirectory(subfolderName, nullptr);
+         CString unavailableFilename = Path::Combine(subfolderName, _T("unavailable.flac"));
+         WriteFile(unavailableFilename, "audio");
+
+         Encoder::ProbeInfo info;
+         info.m_numChannels = 2;
+
+         {
+            Encoder::AudioFileInfoCache cache(cacheFilename);
+            cache.StoreAudioFileInfo(keptFilename, info);
+            cache.StoreAudioFileInfo(deletedFilename, info);
+            cache.StoreAudioFileInfo(unavailableFilename, info);
+            Assert::IsTrue(cache.Save(), _T("saving cache must succeed"));
+         }
+
+         DeleteFile(deletedFilename);
+         DeleteFile(unavailableFilename);
+         RemoveDirectory(subfolderName);
+
+         // run
+         {
+            Encoder::AudioFileInfoCache cache(cacheFilename);
+            Assert::IsTrue(cache.Load(), _T("loading cache must succeed"));
+
+            Encoder::ProbeInfo info2;
+            Assert::IsFalse(cache.LookupAudioFileInfo(deletedFilename, info2),
+               _T("audio file info of deleted file must not be found"));
+            Assert::IsFalse(cache.LookupAudioFileInfo(unavailableFilename, info2),
+               _T("audio file info of file in missing folder must not be found"));
+
+            Assert::AreEqual<size_t>(1, cache.NumEvictedEntries(), _T("only the deleted file must be evicted"));
+            Assert::IsTrue(cache.Save(), _T("saving cache must succeed"));
+         }
+
+         // check
+         Encoder::AudioFileInfoCache cache(cacheFilename);
+         Assert::IsTrue(cache.Load(), _T("loading cache must succeed"));
+
+         Encoder::ProbeInfo info2;
+         Assert::IsFalse(cache.LookupAudioFileInfo(deletedFilename, info2),
+            _T("audio file info of deleted file must not be found"));
+         Assert::AreEqual<size_t>(0, cache.NumEvictedEntries(), _T("deleted file's entry must have been removed"));
+
+         Assert::IsTrue(cache.LookupAudioFileInfo(keptFilename, info2),
+            _T("audio file info of existing file must still be found"));
+      }
+   };
+} // namespace unittest
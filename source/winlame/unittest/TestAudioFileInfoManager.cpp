@@ -0,0 +1,201 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestAudioFileInfoManager.cpp
+/// \brief Unit tests for the AudioFileInfoManager class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "AudioFileInfoManager.hpp"
+#include <set>
+#include <condition_variable>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for AudioFileInfoManager class
+   TEST_CLASS(TestAudioFileInfoManager)
+   {
+   public:
+      /// max. number of results passed to the callback at once, as used by the manager
+      static const size_t c_maxNumResultsPerBatch = 64;
+
+      /// collects the batches of results passed to the callback
+      struct ResultsCollector
+      {
+         /// mutex protecting all members
+         std::mutex m_mutex;
+
+         /// sizes of all batches passed to the callback
+         std::vector<size_t> m_batchSizesList;
+
+         /// all filenames of received results
+         std::vector<CString> m_filenamesList;
+
+         /// callback function for the manager
+         void OnResults(const std::vector<AudioFileInfoManager::AudioFileInfo>& audioFileInfoList)
+         {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_batchSizesList.push_back(audioFileInfoList.size());
+
+            for (const AudioFileInfoManager::AudioFileInfo& info : audioFileInfoList)
+               m_filenamesList.push_back(info.m_filename);
+         }
+
+         /// waits until at least the given number of results were received; returns false on timeout
+         bool WaitForResults(size_t numResults)
+         {
+            for (unsigned int retry = 0; retry < 500; retry++)
+            {
+               {
+                  std::lock_guard<std::mutex> lock(m_mutex);
+                  if (m_filenamesList.size() >= numResults)
+                     return true;
+               }
+
+               Sleep(10);
+            }
+
+            return false;
+         }
+      };
+
+      /// returns fixed audio file infos, without accessing any file
+      static bool GetFixedAudioFileInfo(LPCTSTR filename,
+         int& lengthInSeconds, int& bitrateInBps, int& sampleFrequencyInHz, CString& errorMessage)
+      {
+         UNUSED(filename);
+         UNUSED(errorMessage);
+
+         lengthInSeconds = 60;
+         bitrateInBps = 128000;
+         sampleFrequencyInHz = 44100;
+
+         return true;
+      }
+
+      /// tests that results of many requests are passed to the callback in batches
+      TEST_METHOD(TestResultsAreBatched)
+      {
+         // set up
+         ResultsCollector collector;
+
+         AudioFileInfoManager manager(&TestAudioFileInfoManager::GetFixedAudioFileInfo);
+         manager.SetCallback(
+            std::bind(&ResultsCollector::OnResults, &collector, std::placeholders::_1));
+
+         const size_t numFiles = 1000;
+
+         // run
+         for (size_t fileIndex = 0; fileIndex < numFiles; fileIndex++)
+         {
+            CString filename;
+            filename.Format(_T("C:\\Music\\track%03u.mp3"), static_cast<unsigned int>(fileIndex));
+
+            manager.AsyncGetAudioFileInfo(filename);
+         }
+
+         bool allReceived = collector.WaitForResults(numFiles);
+
+         // check
+         Assert::IsTrue(allReceived, _T("all results must be received"));
+
+         std::lock_guard<std::mutex> lock(collector.m_mutex);
+
+         std::set<CString> filenamesSet(collector.m_filenamesList.begin(), collector.m_filenamesList.end());
+         Assert::AreEqual(numFiles, collector.m_filenamesList.size(), _T("each result must be received once"));
+         Assert::AreEqual(numFiles, filenamesSet.size(), _T("results of all files must be received"));
+
+         for (size_t batchSize : collector.m_batchSizesList)
+            Assert::IsTrue(batchSize <= c_maxNumResultsPerBatch, _T("batch must not exceed max. size"));
+
+         Assert::IsTrue(collector.m_batchSizesList.size() < numFiles / 2,
+            _T("results must be passed in batches, not one by one"));
+      }
+
+      /// tests that results waiting for more results are passed on when all remaining
+      /// requests are cancelled
+      TEST_METHOD(TestCancelPassesOnWaitingResults)
+      {
+         // set up
+         std::mutex gateMutex;
+         std::condition_variable gateCondition;
+         bool isGateOpen = false;
+
+         // requests of "blocked" files only return when the gate is opened
+         auto fnGetAudioFileInfo = [&](LPCTSTR filename,
+            int& lengthInSeconds, int& bitrateInBps, int& sampleFrequencyInHz, CString& errorMessage)
+         {
+            if (CString(filename).Find(_T("blocked")) != -1)
+            {
+               std::unique_lock<std::mutex> lock(gateMutex);
+               gateCondition.wait(lock, [&]() { return isGateOpen; });
+            }
+
+            return GetFixedAudioFileInfo(filename, lengthInSeconds, bitrateInBps, sampleFrequencyInHz, errorMessage);
+         };
+
+         ResultsCollector collector;
+
+         AudioFileInfoManager manager(fnGetAudioFileInfo);
+         manager.SetCallback(
+            std::bind(&ResultsCollector::OnResults, &collector, std::placeholders::_1));
+
+         // more blocked files than worker threads, so that some requests stay pending
+         std::vector<CString> blockedFilenamesList;
+         for (unsigned int fileIndex = 0; fileIndex < 16; fileIndex++)
+         {
+            CString filename;
+            filename.Format(_T("C:\\Music\\blocked%02u.mp3"), fileIndex);
+            blockedFilenamesList.push_back(filename);
+         }
+
+         manager.AsyncGetAudioFileInfo(_T("C:\\Music\\track.mp3"));
+
+         for (const CString& filename : blockedFilenamesList)
+            manager.AsyncGetAudioFileInfo(filename);
+
+         // wait a bit, so that the result of the unblocked file is stored in the current batch
+         Sleep(100);
+
+         // run
+         manager.CancelFiles(blockedFilenamesList);
+
+         bool receivedBeforeGateOpened = collector.WaitForResults(1);
+
+         {
+            std::lock_guard<std::mutex> lock(gateMutex);
+            isGateOpen = true;
+         }
+
+         gateCondition.notify_all();
+
+         manager.Stop();
+
+         // check
+         Assert::IsTrue(receivedBeforeGateOpened,
+            _T("result must be received before the remaining running requests are finished"));
+
+         std::lock_guard<std::mutex> lock(collector.m_mutex);
+         Assert::IsTrue(collector.m_filenamesList[0] == _T("C:\\Music\\track.mp3"),
+            _T("result of unblocked file must be received"));
+      }
+   };
+} // namespace unittest
@@ -27,6 +27,7 @@
 #include <ulib/win32/ResourceData.hpp>
 #include "TrackInfo.hpp"
 #include "AudioFileTag.hpp"
+#include "AudioFileInfoCache.hpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -134,5 +135,46 @@ namespace unittest
          Assert::IsTrue(tag.ReadFromFile(filename), _T("reading from file must succeed"));
          Assert::IsTrue(tag.WriteToFile(filename), _T("writing to file must succeed"));;
       }
+
+      /// tests that ReadFromFile() stores track infos in the cache and reads them from there
+      TEST_METHOD(TestReadTrackInfoUsesCache)
+      {
+         // set up
+         HINSTANCE hInstance = g_hDllInstance;
+         Win32::ResourceData data(MAKEINTRESOURCE(IDR_SAMPLE_MP3), _T("\"RT_RCDATA\""), hInstance);
+
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         data.AsFile(filename);
+
+         auto spCache = std::make_shared<Encoder::AudioFileInfoCache>(
+            Path::Combine(folder.FolderName(), _T("cache.bin")));
+
+         // run
+         Encoder::TrackInfo trackInfo;
+         Encoder::AudioFileTag tag(trackInfo, spCache);
+
+         bool readFirst = tag.ReadFromFile(filename);
+         size_t numEntries = spCache->NumUnsavedEntries();
+
+         Encoder::TrackInfo cachedTrackInfo;
+         cachedTrackInfo.SetTextInfo(Encoder::TrackInfoTitle, _T("Cached Title"));
+         spCache->StoreTrackInfo(filename, cachedTrackInfo);
+
+         Encoder::TrackInfo trackInfo2;
+         Encoder::AudioFileTag tag2(trackInfo2, spCache);
+         bool readSecond = tag2.ReadFromFile(filename);
+
+         // check
+         Assert::IsTrue(readFirst, _T("reading from file must succeed"));
+         Assert::AreEqual<size_t>(1, numEntries, _T("track info must have been stored in the cache"));
+
+         Assert::IsTrue(readSecond, _T("reading from cache must succeed"));
+
+         bool isAvail = false;
+         Assert::AreEqual(_T("Cached Title"), trackInfo2.GetTextInfo(Encoder::TrackInfoTitle, isAvail).GetString(),
+            _T("title must have been read from the cache"));
+      }
    };
 }
@@ -0,0 +1,539 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestBenchmarks.cpp
+/// \brief Benchmarks for encoding throughput
+/// \details The benchmarks are in the test category "Benchmark" and log their results; run
+/// them with a Release build, e.g. with: vstest.console.exe unittest.dll /TestCaseFilter:"TestCategory=Benchmark"
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "EncoderTestFixture.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include "resource_unittest.h"
+#include "EncoderImpl.hpp"
+#include "CpuTopology.hpp"
+#include "LameNogapInstanceManager.hpp"
+#include "ModuleManagerImpl.hpp"
+#include "EncoderBatchPlan.hpp"
+#include "MonkeysAudioInputModule.hpp"
+#include <ulib/IoCContainer.hpp>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// encoder that encodes on the calling thread, like EncoderTask does
+   class BenchmarkEncoder : public Encoder::EncoderImpl
+   {
+   public:
+      /// encodes file; returns when finished
+      void EncodeOnCurrentThread()
+      {
+         m_encoderState.m_running = true;
+         Encode();
+      }
+   };
+
+   /// benchmarks for encoding throughput
+   TEST_CLASS(TestBenchmarks), public EncoderTestFixture
+   {
+   public:
+      /// sets up test; called before each test
+      TEST_CLASS_INITIALIZE(SetUp)
+      {
+         EncoderTestFixture::SetUp();
+      }
+
+      /// \brief encodes input file in parallel worker threads, and returns throughput
+      /// \param inputFilename input file to encode
+      /// \param outputFolder folder to store output files in
+      /// \param outputModuleID output module to use
+      /// \param settingsManager settings to use for encoding
+      /// \param numWorkers number of worker threads
+      /// \param numFilesPerWorker number of times each worker encodes the file
+      /// \param workerCores cores to pin worker threads to; when empty, threads are not pinned
+      /// \return number of encoded seconds per second, summed over all workers
+      static double RunParallelEncodes(const CString& inputFilename, const CString& outputFolder,
+         int outputModuleID, const SettingsManager& settingsManager,
+         unsigned int numWorkers, unsigned int numFilesPerWorker,
+         const std::vector<Encoder::CpuTopology::CoreInfo>& workerCores)
+      {
+         int numChannels = 0, bitrateInBps = 0, lengthInSeconds = 0, samplerateInHz = 0;
+         EncoderTestFixture fixture;
+         fixture.GetAudioFileInfos(inputFilename, numChannels, bitrateInBps, lengthInSeconds, samplerateInHz);
+
+         auto startTime = std::chrono::steady_clock::now();
+
+         std::vector<std::thread> workersList;
+         for (unsigned int workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+         {
+            workersList.emplace_back([&, workerIndex]()
+            {
+               if (!workerCores.empty())
+               {
+                  const Encoder::CpuTopology::CoreInfo& core = workerCores[workerIndex % workerCores.size()];
+                  Encoder::CpuTopology::SetThreadAffinity(GetCurrentThread(), core.m_group, core.m_affinityMask);
+               }
+
+               SettingsManager workerSettingsManager = settingsManager;
+
+               for (unsigned int fileIndex = 0; fileIndex < numFilesPerWorker; fileIndex++)
+               {
+                  CString outputFilename;
+                  outputFilename.Format(_T("output-%u-%u.out"), workerIndex, fileIndex);
+
+                  Encoder::EncoderSettings encoderSettings;
+                  encoderSettings.m_inputFilename = inputFilename;
+                  encoderSettings.m_outputFilename = Path::Combine(outputFolder, outputFilename);
+                  encoderSettings.m_outputModuleID = outputModuleID;
+                  encoderSettings.m_overwriteExisting = true;
+
+                  BenchmarkEncoder encoder;
+                  encoder.SetEncoderSettings(encoderSettings);
+                  encoder.SetSettingsManager(&workerSettingsManager);
+
+                  encoder.EncodeOnCurrentThread();
+               }
+            });
+         }
+
+         for (std::thread& worker : workersList)
+            worker.join();
+
+         double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+         return elapsedSeconds <= 0.0 ? 0.0 :
+            double(lengthInSeconds) * numWorkers * numFilesPerWorker / elapsedSeconds;
+      }
+
+      /// logs benchmark result
+      static void LogResult(LPCTSTR benchmarkName, LPCTSTR variantName, unsigned int numWorkers, double realtimeFactor)
+      {
+         CString text;
+         text.Format(_T("%s: %s, %u workers: %.1f x realtime\n"),
+            benchmarkName, variantName, numWorkers, realtimeFactor);
+
+         Logger::WriteMessage(text);
+      }
+
+      BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkWorkerPlacement)
+         TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+      END_TEST_METHOD_ATTRIBUTE()
+
+      /// compares LAME encoding throughput of unpinned workers on all logical processors with
+      /// one worker per physical core, unpinned and pinned to the cores
+      TEST_METHOD(BenchmarkWorkerPlacement)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString inputFilename = Path::Combine(folder.FolderName(), _T("sample.wav"));
+         ExtractFromResource(IDR_SAMPLE_WAV, inputFilename);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 0);
+         settingsManager.setValue(LameSimpleEncodeQuality, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+
+         Encoder::CpuTopology topology;
+         std::vector<Encoder::CpuTopology::CoreInfo> workerCores = topology.WorkerCores(0);
+
+         unsigned int numLogical = topology.NumLogicalProcessors();
+         unsigned int numPhysical = workerCores.size();
+         const unsigned int numFilesPerWorker = 4;
+
+         double unpinnedLogical = RunParallelEncodes(inputFilename, folder.FolderName(), ID_OM_LAME,
+            settingsManager, numLogical, numFilesPerWorker, std::vector<Encoder::CpuTopology::CoreInfo>());
+
+         double unpinnedPhysical = RunParallelEncodes(inputFilename, folder.FolderName(), ID_OM_LAME,
+            settingsManager, numPhysical, numFilesPerWorker, std::vector<Encoder::CpuTopology::CoreInfo>());
+
+         double pinnedPhysical = RunParallelEncodes(inputFilename, folder.FolderName(), ID_OM_LAME,
+            settingsManager, numPhysical, numFilesPerWorker, workerCores);
+
+         LogResult(_T("WorkerPlacement"), _T("unpinned, per logical processor"), numLogical, unpinnedLogical);
+         LogResult(_T("WorkerPlacement"), _T("unpinned, per physical core"), numPhysical, unpinnedPhysical);
+         LogResult(_T("WorkerPlacement"), _T("pinned, per physical core"), numPhysical, pinnedPhysical);
+
+         Assert::IsTrue(unpinnedLogical > 0.0 && unpinnedPhysical > 0.0 && pinnedPhysical > 0.0,
+            _T("all variants must encode successfully"));
+      }
+
+      /// \brief encodes list of gapless tracks and returns throughput
+      /// \param inputFilenamesList input files, in album order
+      /// \param outputFolder folder to store output files in
+      /// \param settingsManager settings to use for encoding
+      /// \param parallel when true, all tracks are encoded in parallel, using the neighbour
+      /// tracks' samples; when false, the tracks are encoded one after another, passing the
+      /// LAME instance from track to track
+      /// \return number of encoded seconds per second
+      static double RunGaplessEncodes(const std::vector<CString>& inputFilenamesList, const CString& outputFolder,
+         const SettingsManager& settingsManager, bool parallel)
+      {
+         int numChannels = 0, bitrateInBps = 0, lengthInSeconds = 0, samplerateInHz = 0;
+         int totalLengthInSeconds = 0;
+
+         EncoderTestFixture fixture;
+         for (const CString& inputFilename : inputFilenamesList)
+         {
+            fixture.GetAudioFileInfos(inputFilename, numChannels, bitrateInBps, lengthInSeconds, samplerateInHz);
+            totalLengthInSeconds += lengthInSeconds;
+         }
+
+         SettingsManager gaplessSettingsManager = settingsManager;
+         gaplessSettingsManager.setValue(LameOptNoGap, 1);
+         gaplessSettingsManager.setValue(LameOptNoGapParallel, parallel ? 1 : 0);
+         gaplessSettingsManager.setValue(LameNoGapInstanceId,
+            IoCContainer::Current().Resolve<Encoder::LameNogapInstanceManager>().NextNogapInstanceId());
+
+         std::vector<SettingsManager> trackSettingsManagerList(inputFilenamesList.size(), gaplessSettingsManager);
+         trackSettingsManagerList.back().setValue(GeneralIsLastFile, 1);
+
+         auto encodeTrack = [&](size_t trackIndex)
+         {
+            CString outputFilename;
+            outputFilename.Format(_T("track-%u.mp3"), static_cast<unsigned int>(trackIndex));
+
+            Encoder::EncoderSettings encoderSettings;
+            encoderSettings.m_inputFilename = inputFilenamesList[trackIndex];
+            encoderSettings.m_outputFilename = Path::Combine(outputFolder, outputFilename);
+            encoderSettings.m_outputModuleID = ID_OM_LAME;
+            encoderSettings.m_overwriteExisting = true;
+
+            if (parallel && trackIndex > 0)
+               encoderSettings.m_gaplessPreviousInputFilename = inputFilenamesList[trackIndex - 1];
+
+            if (parallel && trackIndex + 1 < inputFilenamesList.size())
+               encoderSettings.m_gaplessNextInputFilename = inputFilenamesList[trackIndex + 1];
+
+            BenchmarkEncoder encoder;
+            encoder.SetEncoderSettings(encoderSettings);
+            encoder.SetSettingsManager(&trackSettingsManagerList[trackIndex]);
+
+            encoder.EncodeOnCurrentThread();
+         };
+
+         auto startTime = std::chrono::steady_clock::now();
+
+         if (parallel)
+         {
+            std::vector<std::thread> workersList;
+            for (size_t trackIndex = 0; trackIndex < inputFilenamesList.size(); trackIndex++)
+               workersList.emplace_back(encodeTrack, trackIndex);
+
+            for (std::thread& worker : workersList)
+               worker.join();
+         }
+         else
+         {
+            for (size_t trackIndex = 0; trackIndex < inputFilenamesList.size(); trackIndex++)
+               encodeTrack(trackIndex);
+         }
+
+         double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+         return elapsedSeconds <= 0.0 ? 0.0 : double(totalLengthInSeconds) / elapsedSeconds;
+      }
+
+      BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkGaplessEncoding)
+         TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+      END_TEST_METHOD_ATTRIBUTE()
+
+      /// compares gapless LAME encoding of an album, passing the LAME instance from track to
+      /// track, with encoding all tracks in parallel
+      TEST_METHOD(BenchmarkGaplessEncoding)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         Encoder::CpuTopology topology;
+         unsigned int numTracks = topology.NumLogicalProcessors();
+
+         std::vector<CString> inputFilenamesList;
+         for (unsigned int trackIndex = 0; trackIndex < numTracks; trackIndex++)
+         {
+            CString inputFilename;
+            inputFilename.Format(_T("sample-%u.wav"), trackIndex);
+            inputFilename = Path::Combine(folder.FolderName(), inputFilename);
+
+            ExtractFromResource(IDR_SAMPLE_WAV, inputFilename);
+            inputFilenamesList.push_back(inputFilename);
+         }
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+
+         double chained = RunGaplessEncodes(inputFilenamesList, folder.FolderName(), settingsManager, false);
+         double parallel = RunGaplessEncodes(inputFilenamesList, folder.FolderName(), settingsManager, true);
+
+         LogResult(_T("GaplessEncoding"), _T("chained LAME instance"), 1, chained);
+         LogResult(_T("GaplessEncoding"), _T("parallel with neighbour samples"), numTracks, parallel);
+
+         Assert::IsTrue(chained > 0.0 && parallel > 0.0, _T("all variants must encode successfully"));
+      }
+
+      BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkBatchPlanning)
+         TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+      END_TEST_METHOD_ATTRIBUTE()
+
+      /// compares the checks and output filename generation when starting a batch of 50k files,
+      /// creating modules for every job, with planning the batch in a single pass
+      TEST_METHOD(BenchmarkBatchPlanning)
+      {
+         const unsigned int numJobs = 50000;
+
+         std::vector<CString> inputFilenamesList;
+         for (unsigned int jobIndex = 0; jobIndex < numJobs; jobIndex++)
+         {
+            CString inputFilename;
+            inputFilename.Format(_T("C:\\Music\\Artist %u\\Album\\track-%05u.flac"), jobIndex / 100, jobIndex);
+            inputFilenamesList.push_back(inputFilename);
+         }
+
+         Encoder::ModuleManagerImpl moduleManager;
+         SettingsManager settingsManager;
+         CString outputFolder = _T("C:\\Output");
+
+         // per job modules, as done before
+         auto start = std::chrono::steady_clock::now();
+
+         bool isLossyInput = false;
+         std::vector<CString> outputFilenamesList;
+         for (const CString& inputFilename : inputFilenamesList)
+         {
+            std::unique_ptr<Encoder::InputModule> inputModule(moduleManager.ChooseInputModule(inputFilename));
+            if (inputModule != nullptr)
+               isLossyInput |= Encoder::EncoderImpl::IsLossyInputModule(inputModule->GetModuleID());
+
+            // once for the overwrite check, once for the task's output filename
+            for (int pass = 0; pass < 2; pass++)
+            {
+               std::unique_ptr<Encoder::OutputModule> outputModule(moduleManager.GetOutputModule(ID_OM_LAME));
+               outputModule->PrepareOutput(settingsManager);
+
+               CString outputFilename = Encoder::EncoderImpl::GetOutputFilenameByInputTitle(
+                  outputFolder, Path::FilenameOnly(inputFilename), *outputModule);
+
+               if (pass == 1)
+                  outputFilenamesList.push_back(outputFilename);
+            }
+         }
+
+         double perJobSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         // single pass batch plan
+         start = std::chrono::steady_clock::now();
+
+         Encoder::EncoderBatchPlan plan(moduleManager, ID_OM_LAME, settingsManager);
+         for (const CString& inputFilename : inputFilenamesList)
+            plan.AddJob(inputFilename, outputFolder);
+
+         double batchPlanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         CString text;
+         text.Format(_T("BatchPlanning: %u jobs, modules per job: %.3f s, batch plan: %.3f s\n"),
+            numJobs, perJobSeconds, batchPlanSeconds);
+         Logger::WriteMessage(text);
+
+         Assert::AreEqual<size_t>(numJobs, plan.NumJobs(), _T("all jobs must be planned"));
+         Assert::IsFalse(plan.IsLossyTranscoding(), _T("FLAC input must not be lossy"));
+         Assert::IsFalse(isLossyInput, _T("FLAC input must not be lossy"));
+
+         for (unsigned int jobIndex = 0; jobIndex < numJobs; jobIndex += 997)
+            Assert::AreEqual(outputFilenamesList[jobIndex].GetString(), plan.OutputFilename(jobIndex).GetString(),
+               _T("output filenames must match"));
+      }
+
+      /// \brief decodes Monkey's Audio file multiple times and returns throughput
+      /// \param inputFilename input file to decode
+      /// \param numDecoderThreads number of decoder threads to use
+      /// \param numRuns number of times the file is decoded
+      /// \param decodedSamples samples decoded in the last run
+      /// \return number of decoded seconds per second
+      static double RunMonkeysAudioDecodes(const CString& inputFilename, unsigned int numDecoderThreads,
+         unsigned int numRuns, std::vector<BYTE>& decodedSamples)
+      {
+         SettingsManager settingsManager;
+         settingsManager.setValue(MonkeysAudioDecoderThreads, static_cast<int>(numDecoderThreads));
+
+         double decodedSeconds = 0.0;
+
+         auto startTime = std::chrono::steady_clock::now();
+
+         for (unsigned int runIndex = 0; runIndex < numRuns; runIndex++)
+         {
+            Encoder::MonkeysAudioInputModule inputModule;
+            Encoder::TrackInfo trackInfo;
+            Encoder::SampleContainer samples;
+
+            Assert::IsTrue(inputModule.IsAvailable(), _T("Monkey's Audio library must be available"));
+            Assert::AreEqual(0, inputModule.InitInput(inputFilename, settingsManager, trackInfo, samples),
+               _T("input module must be initialized"));
+
+            samples.SetOutputModuleTraits(samples.GetInputModuleBitsPerSample(), Encoder::SamplesInterleaved);
+
+            size_t bytesPerBlock = samples.GetInputModuleChannels() * (samples.GetInputModuleBitsPerSample() / 8);
+            decodedSamples.clear();
+
+            int numSamples = 0;
+            while ((numSamples = inputModule.DecodeSamples(samples)) > 0)
+            {
+               BYTE* data = static_cast<BYTE*>(samples.GetSamplesInterleaved(numSamples));
+               decodedSamples.insert(decodedSamples.end(), data, data + numSamples * bytesPerBlock);
+            }
+
+            Assert::AreEqual(0, numSamples, _T("decoding must end without error"));
+
+            decodedSeconds += double(decodedSamples.size() / bytesPerBlock) / samples.GetInputModuleSampleRate();
+
+            inputModule.DoneInput();
+         }
+
+         double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+         return elapsedSeconds <= 0.0 ? 0.0 : decodedSeconds / elapsedSeconds;
+      }
+
+      BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkMonkeysAudioDecoding)
+         TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+      END_TEST_METHOD_ATTRIBUTE()
+
+      /// compares decoding a Monkey's Audio file on the calling thread with decoding the
+      /// frames in worker threads
+      TEST_METHOD(BenchmarkMonkeysAudioDecoding)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString inputFilename = Path::Combine(folder.FolderName(), _T("sample.ape"));
+         ExtractFromResource(IDR_SAMPLE_MONKEYS_AUDIO, inputFilename);
+
+         Encoder::CpuTopology topology;
+         unsigned int numThreads = std::min(4U, topology.NumLogicalProcessors());
+         const unsigned int numRuns = 20;
+
+         std::vector<BYTE> singleThreadSamples, workerThreadSamples;
+         double singleThread = RunMonkeysAudioDecodes(inputFilename, 1, numRuns, singleThreadSamples);
+         double workerThreads = RunMonkeysAudioDecodes(inputFilename, numThreads, numRuns, workerThreadSamples);
+
+         LogResult(_T("MonkeysAudioDecoding"), _T("calling thread"), 1, singleThread);
+         LogResult(_T("MonkeysAudioDecoding"), _T("worker threads"), numThreads, workerThreads);
+
+         Assert::IsTrue(singleThread > 0.0 && workerThreads > 0.0, _T("all variants must decode successfully"));
+         Assert::IsTrue(singleThreadSamples == workerThreadSamples, _T("decoded samples must be identical"));
+      }
+
+      /// \brief reads Ogg file and clears the stream serial number and checksum of all pages
+      /// \details the serial number is chosen randomly for each encoded file, and the checksum
+      /// covers it; all other bytes of two encodes of the same input must be identical. Returns
+      /// an empty buffer when the file can't be read or isn't a sequence of Ogg pages.
+      static std::vector<char> ReadOggPagesWithoutSerialNumber(const CString& filename)
+      {
+         std::ifstream file(filename, std::ios::in | std::ios::binary);
+         std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+         const size_t c_pageHeaderSize = 27;
+
+         size_t pos = 0;
+         while (pos < data.size())
+         {
+            if (data.size() - pos < c_pageHeaderSize ||
+               memcmp(&data[pos], "OggS", 4) != 0)
+               return std::vector<char>();
+
+            size_t numSegments = static_cast<unsigned char>(data[pos + 26]);
+            if (data.size() - pos < c_pageHeaderSize + numSegments)
+               return std::vector<char>();
+
+            size_t bodySize = 0;
+            for (size_t segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+               bodySize += static_cast<unsigned char>(data[pos + c_pageHeaderSize + segmentIndex]);
+
+            std::fill_n(data.begin() + pos + 14, 4, 0); // stream serial number
+            std::fill_n(data.begin() + pos + 22, 4, 0); // page checksum
+
+            pos += c_pageHeaderSize + numSegments + bodySize;
+         }
+
+         return pos == data.size() ? data : std::vector<char>();
+      }
+
+      /// encodes Ogg Vorbis files with given page buffering and encoder thread settings; returns
+      /// throughput and the pages of the last encoded file
+      static double RunOggVorbisEncodes(const CString& inputFilename, const CString& outputFolder,
+         SettingsManager& settingsManager, bool bufferPages, bool encoderThread, std::vector<char>& pages)
+      {
+         settingsManager.setValue(OggPageBuffering, bufferPages ? 1 : 0);
+         settingsManager.setValue(OggEncoderThread, encoderThread ? 1 : 0);
+
+         const unsigned int numFilesPerWorker = 10;
+         double realtimeFactor = RunParallelEncodes(inputFilename, outputFolder, ID_OM_OGGV,
+            settingsManager, 1, numFilesPerWorker, std::vector<Encoder::CpuTopology::CoreInfo>());
+
+         pages = ReadOggPagesWithoutSerialNumber(Path::Combine(outputFolder, _T("output-0-0.out")));
+
+         return realtimeFactor;
+      }
+
+      BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkOggVorbisMultichannelEncoding)
+         TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+      END_TEST_METHOD_ATTRIBUTE()
+
+      /// compares Ogg Vorbis encoding of a 5.1 file at quality 6 writing every page on its own,
+      /// with page buffering, and with page buffering and a separate encoder thread
+      TEST_METHOD(BenchmarkOggVorbisMultichannelEncoding)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString inputFilename = Path::Combine(folder.FolderName(), _T("sample.opus"));
+         ExtractFromResource(IDR_SAMPLE_OPUS_MULTICHANNEL, inputFilename);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(OggBitrateMode, 0); // base quality mode
+         settingsManager.setValue(OggBaseQuality, 600);
+
+         std::vector<char> unbufferedPages, bufferedPages, encoderThreadPages;
+
+         double unbuffered = RunOggVorbisEncodes(inputFilename, folder.FolderName(),
+            settingsManager, false, false, unbufferedPages);
+
+         double buffered = RunOggVorbisEncodes(inputFilename, folder.FolderName(),
+            settingsManager, true, false, bufferedPages);
+
+         double encoderThread = RunOggVorbisEncodes(inputFilename, folder.FolderName(),
+            settingsManager, true, true, encoderThreadPages);
+
+         LogResult(_T("OggVorbisMultichannelEncoding"), _T("unbuffered pages"), 1, unbuffered);
+         LogResult(_T("OggVorbisMultichannelEncoding"), _T("buffered pages"), 1, buffered);
+         LogResult(_T("OggVorbisMultichannelEncoding"), _T("buffered pages, encoder thread"), 1, encoderThread);
+
+         Assert::IsTrue(unbuffered > 0.0 && buffered > 0.0 && encoderThread > 0.0,
+            _T("all variants must encode successfully"));
+
+         // the files may only differ in the stream serial number and the page checksums
+         Assert::IsFalse(unbufferedPages.empty(), _T("output file must contain Ogg pages"));
+         Assert::IsTrue(unbufferedPages == bufferedPages, _T("page buffering must not change the output"));
+         Assert::IsTrue(unbufferedPages == encoderThreadPages, _T("encoder thread must not change the output"));
+      }
+   };
+}
@@ -0,0 +1,116 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestChannelRemapper.cpp
+/// \brief Unit tests for the ChannelRemapper and ChannelRemapPlan classes
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "ChannelRemapper.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for ChannelRemapper and ChannelRemapPlan classes
+   TEST_CLASS(TestChannelRemapper)
+   {
+   public:
+      /// tests remapping 5.1 and 7.1 samples to the Vorbis channel order
+      TEST_METHOD(TestRemapInterleavedToVorbisOrder)
+      {
+         // l, r, c, lfe, bl, br -> l, c, r, bl, br, lfe
+         Encoder::ChannelRemapPlan plan51(Encoder::oggVorbisOutputChannelMap, 6);
+
+         const short samples51[12] = { 0, 1, 2, 3, 4, 5, 10, 11, 12, 13, 14, 15 };
+         const short expected51[12] = { 0, 2, 1, 4, 5, 3, 10, 12, 11, 14, 15, 13 };
+
+         short output51[12] = {};
+         plan51.RemapInterleaved(samples51, 2, output51);
+
+         for (size_t index = 0; index < 12; index++)
+            Assert::AreEqual(expected51[index], output51[index], _T("5.1 samples must be remapped"));
+
+         // l, r, c, lfe, bl, br, sl, sr -> l, c, r, sl, sr, bl, br, lfe
+         Encoder::ChannelRemapPlan plan71(Encoder::oggVorbisOutputChannelMap, 8);
+
+         const int samples71[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+         const int expected71[8] = { 0, 2, 1, 6, 7, 4, 5, 3 };
+
+         int output71[8] = {};
+         plan71.RemapInterleaved(samples71, 1, output71);
+
+         for (size_t index = 0; index < 8; index++)
+            Assert::AreEqual(expected71[index], output71[index], _T("7.1 samples must be remapped"));
+      }
+
+      /// tests that the input and output channel maps reverse each other
+      TEST_METHOD(TestInputAndOutputMapsMatch)
+      {
+         for (size_t numChannels = 1; numChannels <= Encoder::ChannelRemapper::GetMaxMappedChannel(); numChannels++)
+         {
+            Encoder::ChannelRemapPlan inputPlan(Encoder::oggVorbisInputChannelMap, numChannels);
+            Encoder::ChannelRemapPlan outputPlan(Encoder::oggVorbisOutputChannelMap, numChannels);
+
+            for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+               Assert::AreEqual(channelIndex, inputPlan.GetSourceChannel(outputPlan.GetSourceChannel(channelIndex)),
+                  _T("mapping to Vorbis order and back must keep the channel"));
+         }
+      }
+
+      /// tests remapping and converting samples to float in one pass
+      TEST_METHOD(TestRemapInterleavedToFloat)
+      {
+         Encoder::ChannelRemapPlan plan(Encoder::oggVorbisOutputChannelMap, 3);
+
+         const short samples[3] = { -32768, 16384, 0 };
+         float output[3] = {};
+         plan.RemapInterleavedToFloat(samples, 1, output);
+
+         Assert::AreEqual(-1.0f, output[0], _T("left channel must be converted"));
+         Assert::AreEqual(0.0f, output[1], _T("center channel must be moved to second position"));
+         Assert::AreEqual(0.5f, output[2], _T("right channel must be moved to third position"));
+
+         const int intSamples[3] = { 1 << 30, 0, -(1 << 30) };
+         plan.RemapInterleavedToFloat(intSamples, 1, output);
+
+         Assert::AreEqual(0.5f, output[0], _T("left channel must be converted"));
+         Assert::AreEqual(-0.5f, output[1], _T("center channel must be converted"));
+         Assert::AreEqual(0.0f, output[2], _T("right channel must be converted"));
+      }
+
+      /// tests that channel counts without channel map are passed unchanged
+      TEST_METHOD(TestUnmappedChannelCounts)
+      {
+         Encoder::ChannelRemapPlan plan(Encoder::oggVorbisOutputChannelMap, 10);
+         Assert::IsTrue(plan.IsIdentity(), _T("10 channels must not be remapped"));
+
+         const float samples[10] = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f };
+         float output[10] = {};
+         plan.RemapInterleaved(samples, 1, output);
+
+         for (size_t index = 0; index < 10; index++)
+            Assert::AreEqual(samples[index], output[index], _T("samples must not be remapped"));
+
+         Assert::AreEqual<size_t>(5, Encoder::ChannelRemapper::GetMappedChannel(Encoder::aacOutputChannelMap, 10, 5),
+            _T("unmapped channel must keep its position"));
+         Assert::AreEqual<size_t>(3, Encoder::ChannelRemapper::GetMappedChannel(Encoder::aacOutputChannelMap, 6, 5),
+            _T("5.1 channel map must be used"));
+      }
+   };
+} // namespace unittest
@@ -0,0 +1,136 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestDecodeFlac.cpp
+/// \brief Tests decoding .flac file using libFLAC
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "EncoderTestFixture.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+#include "resource_unittest.h"
+#include "FlacInputModule.hpp"
+#include "FLAC/metadata.h"
+#include <wincrypt.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for decoding flac files
+   TEST_CLASS(TestDecodeFlac), public EncoderTestFixture
+   {
+   public:
+      /// sets up test; called before each test
+      TEST_CLASS_INITIALIZE(SetUp)
+      {
+         EncoderTestFixture::SetUp();
+      }
+
+      /// \brief decodes file with FLAC input module, and returns MD5 hash of the decoded samples
+      /// \details the hash is calculated the same way as the MD5 signature in the file's
+      /// STREAMINFO block, which is also used by "flac -d" to verify decoding
+      static std::vector<BYTE> DecodeAndHash(const CString& filename, Encoder::SampleFormatType targetFormat,
+         int bitsPerSample, int numChannels)
+      {
+         Encoder::FlacInputModule inputModule;
+         Encoder::TrackInfo trackInfo;
+         Encoder::SampleContainer samples;
+         SettingsManager settingsManager;
+
+         Assert::AreEqual(0, inputModule.InitInput(filename, settingsManager, trackInfo, samples),
+            _T("input module must be initialized"));
+
+         samples.SetOutputModuleTraits(bitsPerSample, targetFormat);
+
+         HCRYPTPROV cryptProvider = 0;
+         HCRYPTHASH cryptHash = 0;
+         Assert::IsTrue(FALSE != CryptAcquireContext(&cryptProvider, nullptr, nullptr, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT),
+            _T("crypt provider must be available"));
+         Assert::IsTrue(FALSE != CryptCreateHash(cryptProvider, CALG_MD5, 0, 0, &cryptHash),
+            _T("MD5 hash must be available"));
+
+         int bytesPerSample = bitsPerSample / 8;
+         std::vector<BYTE> interleavedSamples;
+
+         while (inputModule.DecodeSamples(samples) > 0)
+         {
+            int numSamples = 0;
+
+            if (targetFormat == Encoder::SamplesInterleaved)
+            {
+               BYTE* data = static_cast<BYTE*>(samples.GetSamplesInterleaved(numSamples));
+               interleavedSamples.assign(data, data + numSamples * numChannels * bytesPerSample);
+            }
+            else
+            {
+               // interleave channel arrays, to hash the samples in the same order
+               void** channelArray = samples.GetSamplesArray(numSamples);
+               interleavedSamples.resize(numSamples * numChannels * bytesPerSample);
+
+               for (int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+                  for (int channel = 0; channel < numChannels; channel++)
+                     memcpy(interleavedSamples.data() + (sampleIndex * numChannels + channel) * bytesPerSample,
+                        static_cast<BYTE*>(channelArray[channel]) + sampleIndex * bytesPerSample,
+                        bytesPerSample);
+            }
+
+            CryptHashData(cryptHash, interleavedSamples.data(), static_cast<DWORD>(interleavedSamples.size()), 0);
+         }
+
+         inputModule.DoneInput();
+
+         std::vector<BYTE> hash(16, 0);
+         DWORD hashSize = static_cast<DWORD>(hash.size());
+         CryptGetHashParam(cryptHash, HP_HASHVAL, hash.data(), &hashSize, 0);
+
+         CryptDestroyHash(cryptHash);
+         CryptReleaseContext(cryptProvider, 0);
+
+         return hash;
+      }
+
+      /// tests that decoding is bit-exact, both to interleaved and to channel array format
+      TEST_METHOD(TestDecodeBitExact)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.flac"));
+         ExtractFromResource(IDR_SAMPLE_FLAC, filename);
+
+         FLAC__StreamMetadata streamInfo;
+         Assert::IsTrue(FALSE != FLAC__metadata_get_streaminfo(CStringA(filename), &streamInfo),
+            _T("stream info must be available"));
+
+         const FLAC__StreamMetadata_StreamInfo& info = streamInfo.data.stream_info;
+
+         std::vector<BYTE> expectedHash(info.md5sum, info.md5sum + sizeof(info.md5sum));
+         Assert::IsTrue(expectedHash != std::vector<BYTE>(16, 0), _T("file must contain MD5 signature"));
+
+         std::vector<BYTE> interleavedHash = DecodeAndHash(filename, Encoder::SamplesInterleaved,
+            info.bits_per_sample, info.channels);
+
+         std::vector<BYTE> channelArrayHash = DecodeAndHash(filename, Encoder::SamplesChannelArray,
+            info.bits_per_sample, info.channels);
+
+         Assert::IsTrue(expectedHash == interleavedHash, _T("interleaved samples must match MD5 signature"));
+         Assert::IsTrue(expectedHash == channelArrayHash, _T("channel array samples must match MD5 signature"));
+      }
+   };
+}
@@ -28,6 +28,7 @@
 #include "EncoderImpl.hpp"
 #include "ModuleManager.hpp"
 #include "ModuleManagerImpl.hpp"
+#include "LibMpg123InputModule.hpp"
 #include <sndfile.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -73,5 +74,59 @@ namespace unittest
          // output file must exist
          Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
       }
+
+      /// decodes file with libmpg123 input module to 16-bit samples, with float or integer decoder output
+      static std::vector<short> DecodeToShortSamples(const CString& filename, bool floatSamples)
+      {
+         Encoder::LibMpg123InputModule inputModule;
+         Encoder::TrackInfo trackInfo;
+         Encoder::SampleContainer samples;
+         SettingsManager settingsManager;
+
+         samples.SetOutputModulePrefersFloat(floatSamples);
+
+         Assert::AreEqual(0, inputModule.InitInput(filename, settingsManager, trackInfo, samples),
+            _T("input module must be initialized"));
+
+         Assert::AreEqual(floatSamples, samples.IsInputModuleFloat(), _T("decoder must use preferred format"));
+
+         samples.SetOutputModuleTraits(16, Encoder::SamplesInterleaved);
+
+         std::vector<short> decodedSamples;
+         int ret = 0;
+         while ((ret = inputModule.DecodeSamples(samples)) > 0)
+         {
+            int numSamples = 0;
+            short* data = static_cast<short*>(samples.GetSamplesInterleaved(numSamples));
+
+            decodedSamples.insert(decodedSamples.end(), data, data + numSamples * samples.GetInputModuleChannels());
+         }
+
+         Assert::AreEqual(0, ret, _T("decoding must end without error"));
+         Assert::AreEqual(100.0f, inputModule.PercentDone(), _T("decoding must be at 100%"));
+
+         inputModule.DoneInput();
+
+         return decodedSamples;
+      }
+
+      /// tests that decoding to float and to integer samples results in the same samples
+      TEST_METHOD(TestDecodeFloatAndInteger)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         std::vector<short> integerSamples = DecodeToShortSamples(filename, false);
+         std::vector<short> floatSamples = DecodeToShortSamples(filename, true);
+
+         Assert::IsFalse(integerSamples.empty(), _T("samples must have been decoded"));
+         Assert::AreEqual(integerSamples.size(), floatSamples.size(), _T("number of samples must match"));
+
+         // the samples may only differ by rounding
+         for (size_t index = 0; index < integerSamples.size(); index++)
+            Assert::IsTrue(abs(integerSamples[index] - floatSamples[index]) <= 1, _T("samples must match"));
+      }
    };
 }
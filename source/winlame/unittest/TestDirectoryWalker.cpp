@@ -0,0 +1,182 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestDirectoryWalker.cpp
+/// \brief Unit tests for the DirectoryWalker class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "DirectoryWalker.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for DirectoryWalker class
+   TEST_CLASS(TestDirectoryWalker)
+   {
+   public:
+      /// collects the files passed to the callback
+      struct ResultsCollector
+      {
+         /// mutex protecting all members
+         std::mutex m_mutex;
+
+         /// all found filenames, in the order they were passed
+         std::vector<CString> m_filenamesList;
+
+         /// callback function for the walker
+         void OnFoundFiles(const std::vector<CString>& filenamesList)
+         {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_filenamesList.insert(m_filenamesList.end(), filenamesList.begin(), filenamesList.end());
+         }
+      };
+
+      /// creates an empty file
+      static void CreateEmptyFile(const CString& filename)
+      {
+         FILE* fd = _tfopen(filename, _T("wb"));
+         Assert::IsNotNull(fd, _T("file must be able to be created"));
+
+         fclose(fd);
+      }
+
+      /// creates a folder
+      static CString CreateFolder(const CString& basePath, LPCTSTR folderName)
+      {
+         CString folderPath = Path::Combine(basePath, folderName);
+         Assert::IsTrue(FALSE != ::CreateDirectory(folderPath, nullptr), _T("folder must be able to be created"));
+
+         return folderPath;
+      }
+
+      /// waits until the walker is finished; returns false on timeout
+      static bool WaitForWalker(const DirectoryWalker& walker)
+      {
+         for (int count = 0; count < 1000 && walker.IsWalking(); count++)
+            Sleep(10);
+
+         return !walker.IsWalking();
+      }
+
+      /// tests that files are found recursively, in a deterministic order, and filtered by extension
+      TEST_METHOD(TestWalkFolders)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString firstFolder = CreateFolder(folder.FolderName(), _T("first"));
+         CString subfolder = CreateFolder(firstFolder, _T("sub"));
+         CString subfolder2 = CreateFolder(firstFolder, _T("Sub2"));
+         CString nestedFolder = CreateFolder(subfolder, _T("nested"));
+         CString secondFolder = CreateFolder(folder.FolderName(), _T("second"));
+
+         CreateEmptyFile(Path::Combine(firstFolder, _T("b.mp3")));
+         CreateEmptyFile(Path::Combine(firstFolder, _T("A.MP3")));
+         CreateEmptyFile(Path::Combine(firstFolder, _T("notes.txt")));
+         CreateEmptyFile(Path::Combine(firstFolder, _T("z.flac")));
+         CreateEmptyFile(Path::Combine(subfolder, _T("c.mp3")));
+         CreateEmptyFile(Path::Combine(nestedFolder, _T("d.flac")));
+         CreateEmptyFile(Path::Combine(subfolder2, _T("e.mp3")));
+         CreateEmptyFile(Path::Combine(secondFolder, _T("f.mp3")));
+
+         std::set<CString> extensionsSet;
+         extensionsSet.insert(_T("mp3"));
+         extensionsSet.insert(_T("flac"));
+
+         ResultsCollector collector;
+
+         // run
+         {
+            DirectoryWalker walker(extensionsSet);
+            walker.SetCallback(
+               std::bind(&ResultsCollector::OnFoundFiles, &collector, std::placeholders::_1));
+
+            walker.Walk(firstFolder + _T("\\"));
+            walker.Walk(secondFolder);
+
+            Assert::IsTrue(WaitForWalker(walker), _T("walking must finish"));
+         }
+
+         // check
+         std::vector<CString> expectedList;
+         expectedList.push_back(Path::Combine(firstFolder, _T("A.MP3")));
+         expectedList.push_back(Path::Combine(firstFolder, _T("b.mp3")));
+         expectedList.push_back(Path::Combine(subfolder, _T("c.mp3")));
+         expectedList.push_back(Path::Combine(nestedFolder, _T("d.flac")));
+         expectedList.push_back(Path::Combine(subfolder2, _T("e.mp3")));
+         expectedList.push_back(Path::Combine(firstFolder, _T("z.flac")));
+         expectedList.push_back(Path::Combine(secondFolder, _T("f.mp3")));
+
+         Assert::AreEqual(expectedList.size(), collector.m_filenamesList.size(),
+            _T("all files with matching extension must have been found"));
+
+         for (size_t index = 0; index < expectedList.size(); index++)
+         {
+            Assert::AreEqual(expectedList[index].GetString(), collector.m_filenamesList[index].GetString(),
+               _T("files must be found in walked folder order, depth-first and sorted by name"));
+         }
+      }
+
+      /// tests that no files are passed on after cancelling
+      TEST_METHOD(TestCancel)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString subfolder = folder.FolderName();
+         for (int depth = 0; depth < 20; depth++)
+         {
+            subfolder = CreateFolder(subfolder, _T("sub"));
+            CreateEmptyFile(Path::Combine(subfolder, _T("track.mp3")));
+         }
+
+         std::set<CString> extensionsSet;
+         extensionsSet.insert(_T("mp3"));
+
+         ResultsCollector collector;
+
+         DirectoryWalker walker(extensionsSet);
+         walker.SetCallback(
+            std::bind(&ResultsCollector::OnFoundFiles, &collector, std::placeholders::_1));
+
+         // run
+         walker.Walk(folder.FolderName());
+         walker.Cancel();
+
+         size_t numFilesAfterCancel = 0;
+         {
+            std::lock_guard<std::mutex> lock(collector.m_mutex);
+            numFilesAfterCancel = collector.m_filenamesList.size();
+         }
+
+         Sleep(100);
+
+         // check
+         Assert::IsFalse(walker.IsWalking(), _T("walker must not be walking after cancelling"));
+
+         std::lock_guard<std::mutex> lock(collector.m_mutex);
+         Assert::AreEqual(numFilesAfterCancel, collector.m_filenamesList.size(),
+            _T("no files must be passed on after cancelling"));
+      }
+   };
+} // namespace unittest
@@ -0,0 +1,98 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestDownmixer.cpp
+/// \brief Unit tests for the Downmixer class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Downmixer.hpp"
+#include "ChannelRemapper.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for Downmixer class
+   TEST_CLASS(TestDownmixer)
+   {
+   public:
+      /// tests supported channel combinations
+      TEST_METHOD(TestIsSupported)
+      {
+         Assert::IsTrue(Encoder::Downmixer::IsSupported(6, 2), _T("5.1 to stereo must be supported"));
+         Assert::IsTrue(Encoder::Downmixer::IsSupported(2, 1), _T("stereo to mono must be supported"));
+         Assert::IsTrue(Encoder::Downmixer::IsSupported(12, 1), _T("12 channels to mono must be supported"));
+
+         Assert::IsFalse(Encoder::Downmixer::IsSupported(2, 2), _T("downmixer must actually downmix"));
+         Assert::IsFalse(Encoder::Downmixer::IsSupported(6, 3), _T("only mono and stereo output is supported"));
+         Assert::IsFalse(Encoder::Downmixer::IsSupported(12, 2), _T("12 channels can only be mixed to mono"));
+
+         Encoder::Downmixer downmixer;
+         Assert::IsFalse(downmixer.Init(2, 2, false), _T("init must fail"));
+         Assert::IsFalse(downmixer.IsActive(), _T("downmixer must not be active"));
+      }
+
+      /// tests downmixing stereo to mono
+      TEST_METHOD(TestMixStereoToMono)
+      {
+         Encoder::Downmixer downmixer;
+         Assert::IsTrue(downmixer.Init(2, 1, false), _T("init must succeed"));
+         Assert::IsTrue(downmixer.IsActive(), _T("downmixer must be active"));
+
+         const float samples[4] = { 1.0f, 0.0f, 0.5f, 0.5f };
+         float output[2] = {};
+         downmixer.Mix(samples, 2, output);
+
+         Assert::AreEqual(0.5f, output[0], _T("channels must be mixed with the same weight"));
+         Assert::AreEqual(0.5f, output[1], _T("channels must be mixed with the same weight"));
+      }
+
+      /// tests that the channel order of the input samples is considered
+      TEST_METHOD(TestMixWaveAndVorbisChannelOrder)
+      {
+         Encoder::Downmixer waveDownmixer;
+         Encoder::Downmixer vorbisDownmixer;
+         Assert::IsTrue(waveDownmixer.Init(6, 2, false), _T("init must succeed"));
+         Assert::IsTrue(vorbisDownmixer.Init(6, 2, true), _T("init must succeed"));
+
+         // l, r, c, lfe, bl, br
+         const float waveSamples[12] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, -0.6f, -0.5f, -0.4f, -0.3f, -0.2f, -0.1f };
+
+         float vorbisSamples[12] = {};
+         Encoder::ChannelRemapPlan plan(Encoder::oggVorbisOutputChannelMap, 6);
+         plan.RemapInterleaved(waveSamples, 2, vorbisSamples);
+
+         float waveOutput[4] = {};
+         float vorbisOutput[4] = {};
+         waveDownmixer.Mix(waveSamples, 2, waveOutput);
+         vorbisDownmixer.Mix(vorbisSamples, 2, vorbisOutput);
+
+         for (size_t index = 0; index < 4; index++)
+            Assert::AreEqual(vorbisOutput[index], waveOutput[index], 1e-6f, _T("downmixed samples must match"));
+
+         // left channel only goes to the left output
+         const float leftOnly[6] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+         float leftOutput[2] = {};
+         waveDownmixer.Mix(leftOnly, 1, leftOutput);
+
+         Assert::IsTrue(leftOutput[0] > 0.0f, _T("left channel must be mixed to left output"));
+         Assert::AreEqual(0.0f, leftOutput[1], _T("left channel must not be mixed to right output"));
+      }
+   };
+} // namespace unittest
@@ -28,6 +28,7 @@
 #include "EncoderImpl.hpp"
 #include "ModuleManager.hpp"
 #include "ModuleManagerImpl.hpp"
+#include "LameInfoTag.hpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -73,5 +74,90 @@ namespace unittest
          // output file must exist
          Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
       }
+
+      /// tests that encoding a gapless track with neighbour tracks in parallel adds the
+      /// neighbour tracks' samples to delay and padding in the LAME info tag
+      TEST_METHOD(TestEncodeGaplessParallel)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+         settingsManager.setValue(LameOptNoGap, 1);
+         settingsManager.setValue(LameOptNoGapParallel, 1);
+
+         // encode file alone, and with the same file as previous and next track
+         Encoder::EncoderSettings encoderSettings;
+         encoderSettings.m_inputFilename = filename;
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output-alone.mp3"));
+         encoderSettings.m_outputModuleID = ID_OM_LAME;
+
+         Encoder::EncoderImpl encoder1;
+         encoder1.SetEncoderSettings(encoderSettings);
+         encoder1.SetSettingsManager(&settingsManager);
+         StartEncodeAndWaitForFinish(encoder1);
+
+         CString outputAloneFilename = encoderSettings.m_outputFilename;
+
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output-context.mp3"));
+         encoderSettings.m_gaplessPreviousInputFilename = filename;
+         encoderSettings.m_gaplessNextInputFilename = filename;
+
+         Encoder::EncoderImpl encoder2;
+         encoder2.SetEncoderSettings(encoderSettings);
+         encoder2.SetSettingsManager(&settingsManager);
+         StartEncodeAndWaitForFinish(encoder2);
+
+         // check
+         unsigned int encoderDelayAlone = 0, paddingAlone = 0;
+         Assert::IsTrue(Encoder::LameInfoTag::GetDelayAndPadding(outputAloneFilename, encoderDelayAlone, paddingAlone),
+            _T("LAME tag must be found"));
+
+         unsigned int encoderDelayContext = 0, paddingContext = 0;
+         Assert::IsTrue(Encoder::LameInfoTag::GetDelayAndPadding(encoderSettings.m_outputFilename, encoderDelayContext, paddingContext),
+            _T("LAME tag must be found"));
+
+         Assert::AreEqual(encoderDelayAlone + 1152, encoderDelayContext, _T("previous track's samples must be added to delay"));
+         Assert::AreEqual(paddingAlone + 1152, paddingContext, _T("next track's samples must be added to padding"));
+      }
+
+      /// tests that encoding a gapless track with neighbour tracks in parallel reports that
+      /// the neighbour tracks were left out when resampling
+      TEST_METHOD(TestEncodeGaplessParallelResampled)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         ExtractFromResource(IDR_SAMPLE_MP3, filename);
+
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQualityOrBitrate, 1);
+         settingsManager.setValue(LameSimpleQuality, 4);
+         settingsManager.setValue(LameOptNoGap, 1);
+         settingsManager.setValue(LameOptNoGapParallel, 1);
+         settingsManager.setValue(GeneralResampleRate, 22050);
+
+         Encoder::EncoderSettings encoderSettings;
+         encoderSettings.m_inputFilename = filename;
+         encoderSettings.m_outputFilename = Path::Combine(folder.FolderName(), _T("output.mp3"));
+         encoderSettings.m_outputModuleID = ID_OM_LAME;
+         encoderSettings.m_gaplessPreviousInputFilename = filename;
+         encoderSettings.m_gaplessNextInputFilename = filename;
+
+         // run
+         Encoder::EncoderImpl encoder;
+         encoder.SetEncoderSettings(encoderSettings);
+         encoder.SetSettingsManager(&settingsManager);
+         StartEncodeAndWaitForFinish(encoder);
+
+         // check
+         Assert::IsTrue(Path::FileExists(encoderSettings.m_outputFilename), _T("output file must exist"));
+         Assert::AreEqual<size_t>(1, encoder.GetAllErrorInfos().size(), _T("left out neighbour tracks must be reported"));
+      }
    };
 }
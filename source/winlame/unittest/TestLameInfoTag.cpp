@@ -0,0 +1,127 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestLameInfoTag.cpp
+/// \brief Unit tests for the LameInfoTag class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "LameInfoTag.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for LameInfoTag class
+   TEST_CLASS(TestLameInfoTag)
+   {
+   public:
+      /// \brief creates info tag frame of an MPEG-1 layer III stereo file
+      /// \details the info tag starts after frame header and side info, at offset 36; the
+      /// LAME extension starts after the info tag fields, at offset 156
+      static std::vector<unsigned char> CreateInfoTagFrame(unsigned int encoderDelay, unsigned int padding)
+      {
+         std::vector<unsigned char> frameData(417, 0);
+
+         // MPEG-1 layer III, no CRC, 128 kbps, 44.1 kHz, stereo
+         frameData[0] = 0xFF;
+         frameData[1] = 0xFB;
+         frameData[2] = 0x90;
+         frameData[3] = 0x00;
+
+         memcpy(frameData.data() + 36, "Info", 4);
+         frameData[43] = 0x0F; // frames, bytes, TOC and quality fields present
+
+         memcpy(frameData.data() + 156, "LAME3.100", 9);
+
+         frameData[177] = static_cast<unsigned char>(encoderDelay >> 4);
+         frameData[178] = static_cast<unsigned char>(((encoderDelay & 0x0F) << 4) | (padding >> 8));
+         frameData[179] = static_cast<unsigned char>(padding & 0xFF);
+
+         return frameData;
+      }
+
+      /// tests reading delay and padding
+      TEST_METHOD(TestGetDelayAndPadding)
+      {
+         std::vector<unsigned char> frameData = CreateInfoTagFrame(576, 1000);
+
+         unsigned int encoderDelay = 0, padding = 0;
+         Assert::IsTrue(Encoder::LameInfoTag::GetDelayAndPadding(frameData, encoderDelay, padding),
+            _T("LAME tag must be found"));
+
+         Assert::AreEqual(576U, encoderDelay, _T("encoder delay must match"));
+         Assert::AreEqual(1000U, padding, _T("padding must match"));
+      }
+
+      /// tests adding delay and padding
+      TEST_METHOD(TestAddDelayAndPadding)
+      {
+         std::vector<unsigned char> frameData = CreateInfoTagFrame(576, 1000);
+
+         Assert::IsTrue(Encoder::LameInfoTag::AddDelayAndPadding(frameData, 1152, 1152),
+            _T("adding delay and padding must succeed"));
+
+         unsigned int encoderDelay = 0, padding = 0;
+         Encoder::LameInfoTag::GetDelayAndPadding(frameData, encoderDelay, padding);
+
+         Assert::AreEqual(576U + 1152U, encoderDelay, _T("encoder delay must have been increased"));
+         Assert::AreEqual(1000U + 1152U, padding, _T("padding must have been increased"));
+
+         // a different delay value must result in a different CRC
+         std::vector<unsigned char> otherFrameData = CreateInfoTagFrame(576, 1000);
+         Encoder::LameInfoTag::AddDelayAndPadding(otherFrameData, 1151, 1152);
+
+         Assert::IsTrue(frameData[190] != otherFrameData[190] || frameData[191] != otherFrameData[191],
+            _T("tag CRC must have been updated"));
+
+         // adding nothing keeps the tag, including the CRC
+         std::vector<unsigned char> frameData2 = frameData;
+         Encoder::LameInfoTag::AddDelayAndPadding(frameData2, 0, 0);
+
+         Assert::IsTrue(frameData == frameData2, _T("frame must not change"));
+      }
+
+      /// tests that values that don't fit into the tag are rejected
+      TEST_METHOD(TestAddDelayAndPaddingOutOfRange)
+      {
+         std::vector<unsigned char> frameData = CreateInfoTagFrame(576, 3000);
+         std::vector<unsigned char> frameData2 = frameData;
+
+         Assert::IsFalse(Encoder::LameInfoTag::AddDelayAndPadding(frameData, 1152, 1152),
+            _T("padding larger than 4095 must be rejected"));
+
+         Assert::IsTrue(frameData == frameData2, _T("frame must not change"));
+      }
+
+      /// tests frames without LAME tag
+      TEST_METHOD(TestNoLameTag)
+      {
+         std::vector<unsigned char> frameData = CreateInfoTagFrame(576, 1000);
+         memcpy(frameData.data() + 156, "Lavf", 4);
+
+         unsigned int encoderDelay = 0, padding = 0;
+         Assert::IsFalse(Encoder::LameInfoTag::GetDelayAndPadding(frameData, encoderDelay, padding),
+            _T("tag of other encoders must not be found"));
+
+         std::vector<unsigned char> noFrameData(417, 0);
+         Assert::IsFalse(Encoder::LameInfoTag::AddDelayAndPadding(noFrameData, 1152, 1152),
+            _T("data without frame sync must be rejected"));
+      }
+   };
+} // namespace unittest
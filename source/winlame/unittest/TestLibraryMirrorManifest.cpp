@@ -0,0 +1,237 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2020 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestLibraryMirrorManifest.cpp
+/// \brief Unit tests for the LibraryMirrorManifest class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "LibraryMirrorManifest.hpp"
+#include "SettingsManager.hpp"
+#include "ModuleInterface.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for LibraryMirrorManifest class
+   TEST_CLASS(TestLibraryMirrorManifest)
+   {
+   public:
+      /// writes text file with given content
+      static void WriteFile(const CString& filename, const char* content)
+      {
+         FILE* fd = _tfopen(filename, _T("wb"));
+         Assert::IsNotNull(fd, _T("file must be able to be created"));
+
+         fwrite(content, 1, strlen(content), fd);
+         fclose(fd);
+      }
+
+      /// creates manifest entry for an existing input file
+      static Encoder::LibraryMirrorManifest::Entry CreateEntry(const CString& inputFilename, const CString& outputFilename)
+      {
+         Encoder::LibraryMirrorManifest::Entry entry;
+         entry.m_inputFilename = inputFilename;
+         entry.m_outputFilename = outputFilename;
+         entry.m_settingsHash = 42;
+
+         Assert::IsTrue(
+            Encoder::LibraryMirrorManifest::GetFileInfo(inputFilename, entry.m_fileSize, entry.m_lastWriteTime),
+            _T("file info must be available"));
+
+         return entry;
+      }
+
+      /// tests saving and loading manifest
+      TEST_METHOD(TestSaveLoad)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder inputFolder;
+         UnitTest::AutoCleanupFolder outputFolder;
+
+         CString inputFilename = Path::Combine(inputFolder.FolderName(), _T("track.wav"));
+         CString outputFilename = Path::Combine(outputFolder.FolderName(), _T("track.mp3"));
+         WriteFile(inputFilename, "input");
+
+         Encoder::LibraryMirrorManifest::Entry entry = CreateEntry(inputFilename, outputFilename);
+         entry.m_contentHash = Encoder::LibraryMirrorManifest::CalcContentHash(inputFilename);
+
+         // run
+         Encoder::LibraryMirrorManifest manifest(outputFolder.FolderName());
+         Assert::IsFalse(manifest.Load(), _T("there must be no manifest yet"));
+
+         manifest.Update(entry);
+         Assert::IsTrue(manifest.Save(), _T("saving manifest must succeed"));
+
+         Encoder::LibraryMirrorManifest manifest2(outputFolder.FolderName());
+         bool loaded = manifest2.Load();
+
+         // check
+         Assert::IsTrue(loaded, _T("loading manifest must succeed"));
+         Assert::AreEqual<size_t>(1, manifest2.Count(), _T("manifest must contain one entry"));
+
+         const Encoder::LibraryMirrorManifest::Entry* loadedEntry = manifest2.Find(inputFilename);
+         Assert::IsNotNull(loadedEntry, _T("entry must be found"));
+         Assert::AreEqual(entry.m_fileSize, loadedEntry->m_fileSize, _T("file size must match"));
+         Assert::AreEqual(entry.m_lastWriteTime, loadedEntry->m_lastWriteTime, _T("last write time must match"));
+         Assert::AreEqual(entry.m_contentHash, loadedEntry->m_contentHash, _T("content hash must match"));
+         Assert::AreEqual(entry.m_settingsHash, loadedEntry->m_settingsHash, _T("settings hash must match"));
+         Assert::IsTrue(outputFilename.CompareNoCase(loadedEntry->m_outputFilename) == 0, _T("output filename must match"));
+      }
+
+      /// tests checking if files are up-to-date
+      TEST_METHOD(TestIsUpToDate)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder inputFolder;
+         UnitTest::AutoCleanupFolder outputFolder;
+
+         CString inputFilename = Path::Combine(inputFolder.FolderName(), _T("track.wav"));
+         CString outputFilename = Path::Combine(outputFolder.FolderName(), _T("track.mp3"));
+         WriteFile(inputFilename, "input");
+
+         Encoder::LibraryMirrorManifest manifest(outputFolder.FolderName());
+         manifest.Update(CreateEntry(inputFilename, outputFilename));
+
+         Encoder::LibraryMirrorManifest::Entry currentEntry = CreateEntry(inputFilename, CString());
+
+         // run + check
+         Assert::IsFalse(manifest.IsUpToDate(currentEntry, outputFolder.FolderName(), false),
+            _T("file must not be up-to-date when output file is missing"));
+
+         WriteFile(outputFilename, "output");
+
+         Assert::IsTrue(manifest.IsUpToDate(currentEntry, outputFolder.FolderName(), false),
+            _T("unchanged file must be up-to-date"));
+
+         Assert::IsFalse(manifest.IsUpToDate(currentEntry, Path::Combine(outputFolder.FolderName(), _T("subfolder")), false),
+            _T("file must not be up-to-date when mirrored to another folder"));
+
+         Encoder::LibraryMirrorManifest::Entry changedSettingsEntry = currentEntry;
+         changedSettingsEntry.m_settingsHash++;
+         Assert::IsFalse(manifest.IsUpToDate(changedSettingsEntry, outputFolder.FolderName(), false),
+            _T("file must not be up-to-date when settings changed"));
+
+         Encoder::LibraryMirrorManifest::Entry changedSizeEntry = currentEntry;
+         changedSizeEntry.m_fileSize++;
+         Assert::IsFalse(manifest.IsUpToDate(changedSizeEntry, outputFolder.FolderName(), false),
+            _T("file must not be up-to-date when size changed"));
+
+         Encoder::LibraryMirrorManifest::Entry newEntry = currentEntry;
+         newEntry.m_inputFilename = Path::Combine(inputFolder.FolderName(), _T("new.wav"));
+         Assert::IsFalse(manifest.IsUpToDate(newEntry, outputFolder.FolderName(), false),
+            _T("new file must not be up-to-date"));
+      }
+
+      /// tests that touched files with unchanged content are up-to-date when using content hashes
+      TEST_METHOD(TestIsUpToDateContentHash)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder inputFolder;
+         UnitTest::AutoCleanupFolder outputFolder;
+
+         CString inputFilename = Path::Combine(inputFolder.FolderName(), _T("track.wav"));
+         CString outputFilename = Path::Combine(outputFolder.FolderName(), _T("track.mp3"));
+         WriteFile(inputFilename, "input");
+         WriteFile(outputFilename, "output");
+
+         Encoder::LibraryMirrorManifest::Entry entry = CreateEntry(inputFilename, outputFilename);
+         entry.m_contentHash = Encoder::LibraryMirrorManifest::CalcContentHash(inputFilename);
+
+         Encoder::LibraryMirrorManifest manifest(outputFolder.FolderName());
+         manifest.Update(entry);
+
+         Encoder::LibraryMirrorManifest::Entry touchedEntry = CreateEntry(inputFilename, CString());
+         touchedEntry.m_lastWriteTime += 10 * 1000 * 1000;
+
+         // run + check
+         Assert::IsFalse(manifest.IsUpToDate(touchedEntry, outputFolder.FolderName(), false),
+            _T("touched file must not be up-to-date without content hash"));
+
+         Assert::IsTrue(manifest.IsUpToDate(touchedEntry, outputFolder.FolderName(), true),
+            _T("touched file must be up-to-date with same content hash"));
+
+         WriteFile(inputFilename, "INPUT");
+         touchedEntry.m_lastWriteTime += 10 * 1000 * 1000;
+
+         Assert::IsFalse(manifest.IsUpToDate(touchedEntry, outputFolder.FolderName(), true),
+            _T("changed file must not be up-to-date"));
+      }
+
+      /// tests pruning output files of removed input files
+      TEST_METHOD(TestPruneRemovedInputFiles)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder inputFolder;
+         UnitTest::AutoCleanupFolder outputFolder;
+
+         CString inputFilename1 = Path::Combine(inputFolder.FolderName(), _T("track1.wav"));
+         CString inputFilename2 = Path::Combine(inputFolder.FolderName(), _T("track2.wav"));
+         CString outputFilename1 = Path::Combine(outputFolder.FolderName(), _T("track1.mp3"));
+         CString outputFilename2 = Path::Combine(outputFolder.FolderName(), _T("track2.mp3"));
+
+         WriteFile(inputFilename1, "input1");
+         WriteFile(inputFilename2, "input2");
+         WriteFile(outputFilename1, "output1");
+         WriteFile(outputFilename2, "output2");
+
+         Encoder::LibraryMirrorManifest manifest(outputFolder.FolderName());
+         manifest.Update(CreateEntry(inputFilename1, outputFilename1));
+         manifest.Update(CreateEntry(inputFilename2, outputFilename2));
+
+         DeleteFile(inputFilename2);
+
+         // run
+         size_t numRemoved = manifest.PruneRemovedInputFiles(inputFolder.FolderName());
+
+         // check
+         Assert::AreEqual<size_t>(1, numRemoved, _T("one entry must have been pruned"));
+         Assert::AreEqual<size_t>(1, manifest.Count(), _T("one entry must remain"));
+         Assert::IsTrue(Path::FileExists(outputFilename1), _T("output file of existing input file must remain"));
+         Assert::IsFalse(Path::FileExists(outputFilename2), _T("output file of removed input file must be deleted"));
+      }
+
+      /// tests that per-run settings don't change the settings hash
+      TEST_METHOD(TestCalcSettingsHash)
+      {
+         SettingsManager settingsManager;
+         settingsManager.setValue(LameSimpleQuality, 5);
+
+         ULONGLONG hash1 = Encoder::LibraryMirrorManifest::CalcSettingsHash(ID_OM_LAME, settingsManager);
+
+         settingsManager.setValue(LameNoGapInstanceId, 3);
+         settingsManager.setValue(GeneralIsLastFile, 1);
+         settingsManager.setValue(MonkeysAudioDecoderThreads, 4);
+         settingsManager.setValue(OggEncoderThread, 1);
+
+         ULONGLONG hash2 = Encoder::LibraryMirrorManifest::CalcSettingsHash(ID_OM_LAME, settingsManager);
+
+         settingsManager.setValue(LameSimpleQuality, 7);
+
+         ULONGLONG hash3 = Encoder::LibraryMirrorManifest::CalcSettingsHash(ID_OM_LAME, settingsManager);
+         ULONGLONG hash4 = Encoder::LibraryMirrorManifest::CalcSettingsHash(ID_OM_OGGV, settingsManager);
+
+         Assert::AreEqual(hash1, hash2, _T("per-run settings must not change hash"));
+         Assert::AreNotEqual(hash2, hash3, _T("changed setting must change hash"));
+         Assert::AreNotEqual(hash3, hash4, _T("changed output module must change hash"));
+      }
+   };
+} // namespace unittest
@@ -0,0 +1,206 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestMemoryBudget.cpp
+/// \brief Unit tests for the MemoryBudget class and task memory estimates
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "MemoryBudget.hpp"
+#include "EncoderTestFixture.hpp"
+#include "EncoderTask.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for MemoryBudget class
+   TEST_CLASS(TestMemoryBudget), public EncoderTestFixture
+   {
+   public:
+      /// sets up test; called before each test
+      TEST_CLASS_INITIALIZE(SetUp)
+      {
+         EncoderTestFixture::SetUp();
+      }
+
+      /// creates list of waiting tasks with given memory usages
+      static std::vector<MemoryBudget::WaitingTask> CreateWaitingTasks(const std::vector<size_t>& memoryUsageList)
+      {
+         std::vector<MemoryBudget::WaitingTask> waitingTasks;
+
+         for (size_t memoryUsage : memoryUsageList)
+         {
+            MemoryBudget::WaitingTask waitingTask;
+            waitingTask.m_memoryUsage = memoryUsage;
+            waitingTask.m_numOvertaken = 0;
+
+            waitingTasks.push_back(waitingTask);
+         }
+
+         return waitingTasks;
+      }
+
+      /// tests that all tasks are admitted when there's no limit
+      TEST_METHOD(TestUnlimitedBudget)
+      {
+         // set up
+         MemoryBudget budget(0);
+         std::vector<MemoryBudget::WaitingTask> waitingTasks = CreateWaitingTasks({ 100, 2000, 30000 });
+
+         // run
+         std::vector<size_t> admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::IsFalse(budget.IsLimited(), _T("budget must not be limited"));
+         Assert::AreEqual<size_t>(3, admittedTasks.size(), _T("all tasks must be admitted"));
+      }
+
+      /// tests that tasks are admitted until the budget is used up
+      TEST_METHOD(TestAdmitUntilBudgetIsUsed)
+      {
+         // set up
+         MemoryBudget budget(1000);
+         std::vector<MemoryBudget::WaitingTask> waitingTasks = CreateWaitingTasks({ 400, 400, 400 });
+
+         // run
+         std::vector<size_t> admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::AreEqual<size_t>(2, admittedTasks.size(), _T("two tasks must be admitted"));
+         Assert::AreEqual<size_t>(800, budget.ReservedMemory(), _T("memory of two tasks must be reserved"));
+
+         // run
+         budget.Release(400);
+         waitingTasks.erase(waitingTasks.begin(), waitingTasks.begin() + 2);
+         admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::AreEqual<size_t>(1, admittedTasks.size(), _T("last task must be admitted after release"));
+         Assert::AreEqual<size_t>(800, budget.ReservedMemory(), _T("memory of two tasks must be reserved"));
+      }
+
+      /// tests that a task exceeding the budget on its own is admitted when nothing is reserved
+      TEST_METHOD(TestAdmitTaskLargerThanBudget)
+      {
+         // set up
+         MemoryBudget budget(1000);
+         std::vector<MemoryBudget::WaitingTask> waitingTasks = CreateWaitingTasks({ 5000 });
+
+         // run
+         std::vector<size_t> admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::AreEqual<size_t>(1, admittedTasks.size(), _T("large task must be admitted"));
+         Assert::IsFalse(budget.Fits(1), _T("no other task must fit while the large task runs"));
+      }
+
+      /// tests that smaller tasks later in the queue overtake a task that doesn't fit
+      TEST_METHOD(TestSmallTasksOvertakeLargeTask)
+      {
+         // set up
+         MemoryBudget budget(1000);
+         budget.Reserve(500);
+
+         std::vector<MemoryBudget::WaitingTask> waitingTasks = CreateWaitingTasks({ 800, 100, 100 });
+
+         // run
+         std::vector<size_t> admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::AreEqual<size_t>(2, admittedTasks.size(), _T("both small tasks must be admitted"));
+         Assert::AreEqual<size_t>(1, admittedTasks[0], _T("first small task must be admitted"));
+         Assert::AreEqual<size_t>(2, admittedTasks[1], _T("second small task must be admitted"));
+         Assert::AreEqual(2U, waitingTasks[0].m_numOvertaken, _T("large task must have been overtaken twice"));
+      }
+
+      /// tests that a task overtaken too often blocks later tasks, so that it isn't starved
+      TEST_METHOD(TestOvertakenTaskIsNotStarved)
+      {
+         // set up
+         MemoryBudget budget(1000);
+         budget.Reserve(500);
+
+         std::vector<MemoryBudget::WaitingTask> waitingTasks = CreateWaitingTasks({ 800, 100 });
+         waitingTasks[0].m_numOvertaken = MemoryBudget::c_maxNumOvertaken;
+
+         // run
+         std::vector<size_t> admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::IsTrue(admittedTasks.empty(), _T("small task must not overtake the large task anymore"));
+
+         // run
+         budget.Release(500);
+         admittedTasks = budget.Admit(waitingTasks);
+
+         // check
+         Assert::AreEqual<size_t>(2, admittedTasks.size(), _T("both tasks must be admitted after release"));
+         Assert::AreEqual<size_t>(0, admittedTasks[0], _T("large task must be admitted first"));
+      }
+
+      /// tests that the memory estimate of encoder tasks includes binary infos, e.g. cover art
+      TEST_METHOD(TestEncoderTaskMemoryEstimate)
+      {
+         // set up
+         Encoder::EncoderTaskSettings settings;
+         Encoder::EncoderTask taskWithoutCoverArt(0, settings);
+
+         const size_t coverArtSize = 4 * 1024 * 1024;
+         settings.m_trackInfo.SetBinaryInfo(Encoder::TrackInfoFrontCover,
+            std::vector<unsigned char>(coverArtSize, 0x42));
+
+         Encoder::EncoderTask taskWithCoverArt(0, settings);
+
+         // run
+         size_t memoryUsageWithoutCoverArt = taskWithoutCoverArt.EstimatedMemoryUsage();
+         size_t memoryUsageWithCoverArt = taskWithCoverArt.EstimatedMemoryUsage();
+
+         // check
+         Assert::IsTrue(memoryUsageWithoutCoverArt > 0, _T("encoder task must have a memory estimate"));
+         Assert::IsTrue(memoryUsageWithCoverArt >= memoryUsageWithoutCoverArt + coverArtSize,
+            _T("memory estimate must include the cover art"));
+      }
+
+      /// tests that the encoder task's memory estimate includes the processing stages
+      TEST_METHOD(TestEncoderTaskMemoryEstimateProcessing)
+      {
+         // set up
+         Encoder::EncoderTaskSettings settings;
+         settings.m_inputFilename = _T("input.wav");
+         Encoder::EncoderTask taskWithoutProcessing(0, settings);
+
+         settings.m_settingsManager.setValue(GeneralDownmixChannels, 1);
+         Encoder::EncoderTask taskWithDownmix(0, settings);
+
+         settings.m_settingsManager.setValue(GeneralResampleRate, 96000);
+         Encoder::EncoderTask taskWithResampling(0, settings);
+
+         // run
+         size_t memoryUsageWithoutProcessing = taskWithoutProcessing.EstimatedMemoryUsage();
+         size_t memoryUsageWithDownmix = taskWithDownmix.EstimatedMemoryUsage();
+         size_t memoryUsageWithResampling = taskWithResampling.EstimatedMemoryUsage();
+
+         // check
+         Assert::IsTrue(memoryUsageWithDownmix > memoryUsageWithoutProcessing,
+            _T("memory estimate must include the downmix buffers"));
+         Assert::IsTrue(memoryUsageWithResampling > memoryUsageWithDownmix,
+            _T("memory estimate must include the resampler buffers"));
+      }
+   };
+} // namespace unittest
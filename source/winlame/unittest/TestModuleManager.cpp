@@ -198,6 +198,127 @@ namespace unittest
          Assert::AreEqual(44100, samplerateInHz, _T("sample rate must be 44100 Hz"));
          Assert::IsTrue(errorMessage.IsEmpty(), _T("error message must be empty"));
       }
+
+      /// Tests probing audio file infos from the file's headers
+      TEST_METHOD(TestProbeInputModule)
+      {
+         // set up
+         HINSTANCE hInstance = g_hDllInstance;
+         Win32::ResourceData data(MAKEINTRESOURCE(IDR_SAMPLE_MP3), _T("\"RT_RCDATA\""), hInstance);
+
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.mp3"));
+         data.AsFile(filename);
+
+         Encoder::ModuleManagerImpl moduleManager;
+         std::unique_ptr<Encoder::InputModule> inputModule(moduleManager.ChooseInputModule(filename));
+         Assert::IsNotNull(inputModule.get(), _T("input module must be found"));
+
+         // run
+         Encoder::ProbeInfo probeInfo;
+         bool ret = inputModule->Probe(filename, probeInfo);
+
+         // check
+         Assert::IsTrue(ret, _T("probing must succeed"));
+         Assert::AreEqual(44100, probeInfo.m_samplerateInHz, _T("sample rate must be 44100 Hz"));
+         Assert::AreEqual(128000, probeInfo.m_bitrateInBps, _T("bitrate must be 128 kbps"));
+         Assert::AreEqual(10, probeInfo.m_lengthInSeconds, _T("length must be 10 seconds"));
+         Assert::IsTrue(probeInfo.m_numSamples >= 10ULL * 44100, _T("sample count must match length"));
+      }
+
+      /// Tests that probing Ogg Vorbis and Opus files returns the same infos as opening them
+      TEST_METHOD(TestProbeOggInputModules)
+      {
+         HINSTANCE hInstance = g_hDllInstance;
+
+         std::vector<std::pair<UINT, CString>> sampleFilesList =
+         {
+            { IDR_SAMPLE_OGGV, _T("sample.ogg") },
+            { IDR_SAMPLE_OPUS, _T("sample.opus") },
+            { IDR_SAMPLE_OPUS_MULTICHANNEL, _T("sample-6ch.opus") },
+         };
+
+         for (const auto& sampleFile : sampleFilesList)
+         {
+            // set up
+            Win32::ResourceData data(MAKEINTRESOURCE(sampleFile.first), _T("\"RT_RCDATA\""), hInstance);
+
+            UnitTest::AutoCleanupFolder folder;
+
+            CString filename = Path::Combine(folder.FolderName(), sampleFile.second);
+            data.AsFile(filename);
+
+            Encoder::ModuleManagerImpl moduleManager;
+            std::unique_ptr<Encoder::InputModule> inputModule(moduleManager.ChooseInputModule(filename));
+            Assert::IsNotNull(inputModule.get(), _T("input module must be found"));
+
+            // run
+            Encoder::ProbeInfo probeInfo;
+            bool ret = inputModule->Probe(filename, probeInfo);
+
+            Encoder::TrackInfo trackInfo;
+            Encoder::SampleContainer samples;
+            SettingsManager settingsManager;
+            int initRet = inputModule->InitInput(filename, settingsManager, trackInfo, samples);
+
+            int numChannels = 0, bitrateInBps = 0, lengthInSeconds = 0, samplerateInHz = 0;
+            inputModule->GetInfo(numChannels, bitrateInBps, lengthInSeconds, samplerateInHz);
+
+            inputModule->DoneInput();
+
+            // check
+            Assert::IsTrue(ret, _T("probing must succeed"));
+            Assert::IsTrue(initRet >= 0, _T("opening file must succeed"));
+            Assert::AreEqual(numChannels, probeInfo.m_numChannels, _T("number of channels must match"));
+            Assert::AreEqual(samplerateInHz, probeInfo.m_samplerateInHz, _T("sample rate must match"));
+            Assert::AreEqual(lengthInSeconds, probeInfo.m_lengthInSeconds, _T("length must match"));
+            Assert::IsTrue(probeInfo.m_bitrateInBps > 0, _T("bitrate must be known"));
+         }
+      }
+
+      /// Tests choosing input modules by extension and by content
+      TEST_METHOD(TestChooseInputModule)
+      {
+         // set up
+         HINSTANCE hInstance = g_hDllInstance;
+         Win32::ResourceData data(MAKEINTRESOURCE(IDR_SAMPLE_MP3), _T("\"RT_RCDATA\""), hInstance);
+
+         UnitTest::AutoCleanupFolder folder;
+
+         CString upperCaseFilename = Path::Combine(folder.FolderName(), _T("SAMPLE.MP3"));
+         CString noExtensionFilename = Path::Combine(folder.FolderName(), _T("sample"));
+         CString wrongExtensionFilename = Path::Combine(folder.FolderName(), _T("sample.ogg"));
+         data.AsFile(upperCaseFilename);
+         data.AsFile(noExtensionFilename);
+         data.AsFile(wrongExtensionFilename);
+
+         Encoder::ModuleManagerImpl moduleManager;
+
+         // run + check
+         std::unique_ptr<Encoder::InputModule> inputModule(moduleManager.ChooseInputModule(upperCaseFilename));
+         Assert::IsNotNull(inputModule.get(), _T("input module must be found by extension"));
+         Assert::AreEqual(ID_IM_LIBMPG123, inputModule->GetModuleID(), _T("mp3 input module must be chosen"));
+
+         inputModule.reset(moduleManager.ChooseInputModule(noExtensionFilename));
+         Assert::IsNotNull(inputModule.get(), _T("input module must be found by content"));
+         Assert::AreEqual(ID_IM_LIBMPG123, inputModule->GetModuleID(), _T("mp3 input module must be chosen"));
+
+         inputModule.reset(moduleManager.ChooseInputModule(wrongExtensionFilename));
+         Assert::IsNotNull(inputModule.get(), _T("input module must be found by extension"));
+         Assert::AreEqual(ID_IM_OGGV, inputModule->GetModuleID(), _T("extension must be preferred"));
+
+         int lengthInSeconds = 0, bitrateInBps = 0, samplerateInHz = 0;
+         CString errorMessage;
+         bool ret = moduleManager.GetAudioFileInfo(wrongExtensionFilename,
+            lengthInSeconds, bitrateInBps, samplerateInHz, errorMessage);
+
+         Assert::IsTrue(ret, _T("audio file info of file with wrong extension must be retrieved by content"));
+         Assert::AreEqual(44100, samplerateInHz, _T("sample rate must be 44100 Hz"));
+
+         std::set<CString> extensionsSet = moduleManager.GetInputFileExtensions();
+         Assert::IsTrue(extensionsSet.find(_T("mp3")) != extensionsSet.end(), _T("mp3 extension must be supported"));
+      }
    };
 
    /// instance of static LAME NoGap instance manager
@@ -0,0 +1,227 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestMp4Demuxer.cpp
+/// \brief Unit tests for the Mp4Demuxer class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Mp4Demuxer.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for Mp4Demuxer class
+   TEST_CLASS(TestMp4Demuxer)
+   {
+   public:
+      /// appends 16-bit big-endian value
+      static void AppendUInt16(std::vector<unsigned char>& data, unsigned int value)
+      {
+         data.push_back(static_cast<unsigned char>(value >> 8));
+         data.push_back(static_cast<unsigned char>(value & 0xFF));
+      }
+
+      /// appends 32-bit big-endian value
+      static void AppendUInt32(std::vector<unsigned char>& data, unsigned int value)
+      {
+         AppendUInt16(data, value >> 16);
+         AppendUInt16(data, value & 0xFFFF);
+      }
+
+      /// creates box with given type and content
+      static std::vector<unsigned char> Box(const char* type, const std::vector<unsigned char>& content)
+      {
+         std::vector<unsigned char> box;
+         AppendUInt32(box, static_cast<unsigned int>(content.size() + 8));
+         box.insert(box.end(), type, type + 4);
+         box.insert(box.end(), content.begin(), content.end());
+         return box;
+      }
+
+      /// creates full box with version 0, with the given values as content
+      static std::vector<unsigned char> FullBox(const char* type, const std::vector<unsigned int>& values)
+      {
+         std::vector<unsigned char> content;
+         AppendUInt32(content, 0); // version and flags
+
+         for (unsigned int value : values)
+            AppendUInt32(content, value);
+
+         return Box(type, content);
+      }
+
+      /// concatenates boxes
+      static std::vector<unsigned char> Concat(const std::vector<std::vector<unsigned char>>& boxes)
+      {
+         std::vector<unsigned char> data;
+         for (const auto& box : boxes)
+            data.insert(data.end(), box.begin(), box.end());
+         return data;
+      }
+
+      /// \brief creates M4A file with an AAC track of 5 access units, stored in 2 chunks
+      /// \details access unit n has a size of 10*(n+1) bytes, all set to the value n; the media
+      /// data is stored before the moov box
+      static std::vector<unsigned char> CreateM4aFile()
+      {
+         std::vector<unsigned char> ftyp = Box("ftyp", { 'M', '4', 'A', ' ', 0, 0, 0, 0 });
+
+         std::vector<unsigned char> mediaData;
+         for (unsigned char index = 0; index < 5; index++)
+            mediaData.insert(mediaData.end(), 10 * (index + 1), index);
+
+         unsigned int firstChunkOffset = static_cast<unsigned int>(ftyp.size() + 8);
+         unsigned int secondChunkOffset = firstChunkOffset + 10 + 20 + 30;
+
+         // elementary stream descriptor: ES descriptor, decoder config descriptor with MPEG-4
+         // audio, 128 kbps, and AudioSpecificConfig for AAC LC, 44.1 kHz, stereo
+         std::vector<unsigned char> esds = { 0, 0, 0, 0, 0x03, 25, 0, 1, 0, 0x04, 17, 0x40, 0x15, 0, 0, 0 };
+         AppendUInt32(esds, 128000); // max. bitrate
+         AppendUInt32(esds, 128000); // avg. bitrate
+         esds.insert(esds.end(), { 0x05, 2, 0x12, 0x10 });
+         esds.insert(esds.end(), { 0x06, 1, 0x02 }); // SL config descriptor
+
+         std::vector<unsigned char> mp4a(28, 0);
+         mp4a[7] = 1; // data reference index
+         mp4a[17] = 2; // channels
+         mp4a[19] = 16; // bits per sample
+         mp4a[24] = 44100 >> 8;
+         mp4a[25] = 44100 & 0xFF;
+
+         std::vector<unsigned char> esdsBox = Box("esds", esds);
+         mp4a.insert(mp4a.end(), esdsBox.begin(), esdsBox.end());
+
+         std::vector<unsigned char> stsd = { 0, 0, 0, 0, 0, 0, 0, 1 };
+         std::vector<unsigned char> mp4aBox = Box("mp4a", mp4a);
+         stsd.insert(stsd.end(), mp4aBox.begin(), mp4aBox.end());
+
+         std::vector<unsigned char> stbl = Box("stbl", Concat({
+            Box("stsd", stsd),
+            FullBox("stts", { 1, 5, 1024 }),
+            FullBox("stsc", { 2, 1, 3, 1, 2, 2, 1 }),
+            FullBox("stsz", { 0, 5, 10, 20, 30, 40, 50 }),
+            FullBox("stco", { 2, firstChunkOffset, secondChunkOffset }),
+         }));
+
+         std::vector<unsigned char> moov = Box("moov", Box("trak", Box("mdia", Concat({
+            FullBox("mdhd", { 0, 0, 44100, 5 * 1024, 0 }),
+            FullBox("hdlr", { 0, 's' << 24 | 'o' << 16 | 'u' << 8 | 'n', 0, 0, 0 }),
+            Box("minf", stbl),
+         }))));
+
+         return Concat({ ftyp, Box("mdat", mediaData), moov });
+      }
+
+      /// writes data to file
+      static void WriteFile(const CString& filename, const std::vector<unsigned char>& data)
+      {
+         FILE* fd = _tfopen(filename, _T("wb"));
+         Assert::IsNotNull(fd, _T("file must be able to be created"));
+
+         fwrite(data.data(), 1, data.size(), fd);
+         fclose(fd);
+      }
+
+      /// tests reading track infos and access units
+      TEST_METHOD(TestReadAccessUnits)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.m4a"));
+         WriteFile(filename, CreateM4aFile());
+
+         Encoder::Mp4Demuxer demuxer;
+         Assert::IsTrue(demuxer.Open(filename), _T("file must be opened"));
+
+         Assert::AreEqual(2U, demuxer.GetNumChannels(), _T("number of channels must match"));
+         Assert::AreEqual(44100U, demuxer.GetSampleRate(), _T("sample rate must match"));
+         Assert::AreEqual(128000U, demuxer.GetAverageBitrate(), _T("bitrate must match"));
+         Assert::AreEqual(44100U, demuxer.GetTimescale(), _T("timescale must match"));
+         Assert::AreEqual(5ULL * 1024, demuxer.GetDuration(), _T("duration must match"));
+
+         const std::vector<unsigned char>& decoderConfig = demuxer.GetDecoderConfig();
+         Assert::AreEqual(size_t(2), decoderConfig.size(), _T("decoder config must have been read"));
+         Assert::AreEqual(0x12, int(decoderConfig[0]), _T("decoder config must match"));
+
+         Assert::AreEqual(size_t(5), demuxer.GetNumAccessUnits(), _T("number of access units must match"));
+
+         const unsigned char* data = nullptr;
+         size_t size = 0;
+         for (size_t index = 0; index < 5; index++)
+         {
+            Assert::IsTrue(demuxer.ReadAccessUnit(data, size), _T("access unit must be read"));
+
+            Assert::AreEqual(10 * (index + 1), size, _T("access unit size must match"));
+            Assert::IsTrue(std::all_of(data, data + size, [index](unsigned char value) { return value == index; }),
+               _T("access unit data must match"));
+         }
+
+         Assert::IsFalse(demuxer.ReadAccessUnit(data, size), _T("there must be no more access units"));
+      }
+
+      /// tests seeking
+      TEST_METHOD(TestSeek)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.m4a"));
+         WriteFile(filename, CreateM4aFile());
+
+         Encoder::Mp4Demuxer demuxer;
+         Assert::IsTrue(demuxer.Open(filename), _T("file must be opened"));
+
+         Assert::IsTrue(demuxer.Seek(3 * 1024 + 10), _T("seeking must succeed"));
+         Assert::AreEqual(size_t(3), demuxer.GetCurrentAccessUnit(), _T("access unit must contain the time"));
+
+         const unsigned char* data = nullptr;
+         size_t size = 0;
+         Assert::IsTrue(demuxer.ReadAccessUnit(data, size), _T("access unit must be read"));
+         Assert::AreEqual(size_t(40), size, _T("access unit size must match"));
+
+         Assert::IsFalse(demuxer.Seek(5 * 1024), _T("seeking after the end must fail"));
+      }
+
+      /// tests opening files that are no MP4 files
+      TEST_METHOD(TestInvalidFile)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.aac"));
+
+         std::vector<unsigned char> data(1000, 0);
+         data[0] = 0xFF;
+         data[1] = 0xF1;
+         WriteFile(filename, data);
+
+         Encoder::Mp4Demuxer demuxer;
+         Assert::IsFalse(demuxer.Open(filename), _T("ADTS file must not be opened"));
+         Assert::IsFalse(demuxer.IsOpen(), _T("demuxer must not be open"));
+
+         // truncated sample table
+         std::vector<unsigned char> m4aData = CreateM4aFile();
+         m4aData.resize(m4aData.size() - 4);
+         WriteFile(filename, m4aData);
+
+         Assert::IsFalse(demuxer.Open(filename), _T("truncated file must not be opened"));
+      }
+   };
+} // namespace unittest
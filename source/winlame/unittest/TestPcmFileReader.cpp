@@ -0,0 +1,330 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestPcmFileReader.cpp
+/// \brief Unit tests for the PcmFileReader class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "PcmFileReader.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for PcmFileReader class
+   TEST_CLASS(TestPcmFileReader)
+   {
+   public:
+      /// appends value with given number of bytes, in little-endian byte order
+      static void AppendLE(std::vector<unsigned char>& data, unsigned long long value, size_t numBytes)
+      {
+         for (size_t index = 0; index < numBytes; index++)
+            data.push_back(static_cast<unsigned char>((value >> (index * 8)) & 0xFF));
+      }
+
+      /// appends value with given number of bytes, in big-endian byte order
+      static void AppendBE(std::vector<unsigned char>& data, unsigned long long value, size_t numBytes)
+      {
+         for (size_t index = numBytes; index > 0; index--)
+            data.push_back(static_cast<unsigned char>((value >> ((index - 1) * 8)) & 0xFF));
+      }
+
+      /// appends chunk with 4-character id and 32-bit size, padded to an even size
+      static void AppendChunk(std::vector<unsigned char>& data, const char* id,
+         const std::vector<unsigned char>& content, bool bigEndian)
+      {
+         data.insert(data.end(), id, id + 4);
+
+         if (bigEndian)
+            AppendBE(data, content.size(), 4);
+         else
+            AppendLE(data, content.size(), 4);
+
+         data.insert(data.end(), content.begin(), content.end());
+
+         if ((content.size() & 1) != 0)
+            data.push_back(0);
+      }
+
+      /// creates wave format data, as stored in the fmt chunk
+      static std::vector<unsigned char> CreateWaveFormat(unsigned int formatTag,
+         unsigned int numChannels, unsigned int bitsPerSample, bool extensible)
+      {
+         unsigned int blockAlign = numChannels * ((bitsPerSample + 7) / 8);
+
+         std::vector<unsigned char> format;
+         AppendLE(format, extensible ? 0xFFFE : formatTag, 2);
+         AppendLE(format, numChannels, 2);
+         AppendLE(format, 44100, 4);
+         AppendLE(format, 44100 * blockAlign, 4);
+         AppendLE(format, blockAlign, 2);
+         AppendLE(format, bitsPerSample, 2);
+
+         if (extensible)
+         {
+            const unsigned char guidSuffix[14] =
+            {
+               0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+            };
+
+            AppendLE(format, 22, 2); // size of extension
+            AppendLE(format, bitsPerSample, 2); // valid bits per sample
+            AppendLE(format, 3, 4); // channel mask
+            AppendLE(format, formatTag, 2);
+            format.insert(format.end(), guidSuffix, guidSuffix + sizeof(guidSuffix));
+         }
+
+         return format;
+      }
+
+      /// creates RIFF wave file with given format and sample data
+      static std::vector<unsigned char> CreateWaveFile(const std::vector<unsigned char>& format,
+         const std::vector<unsigned char>& sampleData)
+      {
+         std::vector<unsigned char> chunks;
+         chunks.insert(chunks.end(), { 'W', 'A', 'V', 'E' });
+         AppendChunk(chunks, "fmt ", format, false);
+         AppendChunk(chunks, "data", sampleData, false);
+
+         std::vector<unsigned char> data;
+         AppendChunk(data, "RIFF", chunks, false);
+         return data;
+      }
+
+      /// writes data to file
+      static void WriteFile(const CString& filename, const std::vector<unsigned char>& data)
+      {
+         FILE* fd = _tfopen(filename, _T("wb"));
+         Assert::IsNotNull(fd, _T("file must be able to be created"));
+
+         fwrite(data.data(), 1, data.size(), fd);
+         fclose(fd);
+      }
+
+      /// reads all sample frames from the reader
+      static std::vector<unsigned char> ReadAllFrames(Encoder::PcmFileReader& reader, size_t maxFrames)
+      {
+         size_t bytesPerFrame = reader.GetNumChannels() * reader.GetBitsPerSample() / 8;
+
+         std::vector<unsigned char> sampleData;
+         const unsigned char* data = nullptr;
+         size_t numFrames = 0;
+
+         while ((numFrames = reader.ReadFrames(maxFrames, data)) > 0)
+         {
+            Assert::IsTrue(numFrames <= maxFrames, _T("no more frames than requested must be read"));
+            sampleData.insert(sampleData.end(), data, data + numFrames * bytesPerFrame);
+         }
+
+         return sampleData;
+      }
+
+      /// tests reading a 16-bit stereo wave file with an id3 chunk after the data chunk
+      TEST_METHOD(TestReadRiffWave)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         std::vector<unsigned char> sampleData;
+         for (unsigned int index = 0; index < 10; index++)
+            AppendLE(sampleData, index * 1000, 2);
+
+         std::vector<unsigned char> fileData = CreateWaveFile(CreateWaveFormat(1, 2, 16, false), sampleData);
+
+         std::vector<unsigned char> tagData(128, 0);
+         memcpy(tagData.data(), "TAGTitle", 8);
+         AppendChunk(fileData, "id3 ", tagData, false);
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.wav"));
+         WriteFile(filename, fileData);
+
+         Encoder::PcmFileReader reader;
+         Assert::IsTrue(reader.Open(filename), _T("wave file must be opened"));
+
+         Assert::AreEqual(2U, reader.GetNumChannels(), _T("number of channels must match"));
+         Assert::AreEqual(44100U, reader.GetSampleRate(), _T("sample rate must match"));
+         Assert::AreEqual(16U, reader.GetBitsPerSample(), _T("bits per sample must match"));
+         Assert::IsFalse(reader.IsFloat(), _T("samples must be integer samples"));
+         Assert::AreEqual(5ULL, reader.GetNumFrames(), _T("number of frames must match"));
+
+         Assert::IsNotNull(reader.GetId3v1Tag(), _T("id3 chunk must be found"));
+         Assert::IsTrue(memcmp(reader.GetId3v1Tag(), "TAGTitle", 8) == 0, _T("id3 chunk must be returned"));
+
+         Assert::IsTrue(sampleData == ReadAllFrames(reader, 2), _T("samples must match"));
+         Assert::AreEqual(5ULL, reader.GetCurrentFrame(), _T("all frames must have been read"));
+      }
+
+      /// tests reading a 24-bit wave file with WAVE_FORMAT_EXTENSIBLE format, that ends
+      /// directly after the sample data
+      TEST_METHOD(TestReadWaveFormatExtensible)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         std::vector<unsigned char> sampleData;
+         for (unsigned int index = 0; index < 7 * 2; index++)
+            AppendLE(sampleData, index * 0x10101, 3);
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.wav"));
+         WriteFile(filename, CreateWaveFile(CreateWaveFormat(1, 2, 24, true), sampleData));
+
+         Encoder::PcmFileReader reader;
+         Assert::IsTrue(reader.Open(filename), _T("wave file must be opened"));
+
+         Assert::AreEqual(24U, reader.GetBitsPerSample(), _T("bits per sample must match"));
+         Assert::AreEqual(7ULL, reader.GetNumFrames(), _T("number of frames must match"));
+         Assert::IsNull(reader.GetId3v1Tag(), _T("there must be no id3 tag"));
+
+         Assert::IsTrue(sampleData == ReadAllFrames(reader, 4), _T("samples must match"));
+      }
+
+      /// tests reading a Wave64 file with float samples
+      TEST_METHOD(TestReadWave64)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         const unsigned char riffGuid[16] =
+         {
+            0x72, 0x69, 0x66, 0x66, 0x2E, 0x91, 0xCF, 0x11, 0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00
+         };
+
+         const unsigned char guidSuffix[12] =
+         {
+            0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A
+         };
+
+         std::vector<unsigned char> sampleData;
+         for (unsigned int index = 0; index < 3; index++)
+         {
+            float sample = index * 0.25f;
+            const unsigned char* sampleBytes = reinterpret_cast<const unsigned char*>(&sample);
+            sampleData.insert(sampleData.end(), sampleBytes, sampleBytes + sizeof(sample));
+         }
+
+         // fmt chunk has 16 bytes, so no padding to multiples of 8 bytes is needed
+         std::vector<unsigned char> format = CreateWaveFormat(3, 1, 32, false);
+
+         std::vector<unsigned char> fileData(riffGuid, riffGuid + sizeof(riffGuid));
+         AppendLE(fileData, 40 + 24 + format.size() + 24 + sampleData.size(), 8);
+
+         for (const char* id : { "wave", "fmt ", "data" })
+         {
+            fileData.insert(fileData.end(), id, id + 4);
+            fileData.insert(fileData.end(), guidSuffix, guidSuffix + sizeof(guidSuffix));
+
+            if (strcmp(id, "fmt ") == 0)
+            {
+               AppendLE(fileData, 24 + format.size(), 8);
+               fileData.insert(fileData.end(), format.begin(), format.end());
+            }
+            else if (strcmp(id, "data") == 0)
+            {
+               AppendLE(fileData, 24 + sampleData.size(), 8);
+               fileData.insert(fileData.end(), sampleData.begin(), sampleData.end());
+            }
+         }
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.w64"));
+         WriteFile(filename, fileData);
+
+         Encoder::PcmFileReader reader;
+         Assert::IsTrue(reader.Open(filename), _T("Wave64 file must be opened"));
+
+         Assert::AreEqual(1U, reader.GetNumChannels(), _T("number of channels must match"));
+         Assert::AreEqual(32U, reader.GetBitsPerSample(), _T("bits per sample must match"));
+         Assert::IsTrue(reader.IsFloat(), _T("samples must be float samples"));
+         Assert::AreEqual(3ULL, reader.GetNumFrames(), _T("number of frames must match"));
+
+         Assert::IsTrue(sampleData == ReadAllFrames(reader, 1024), _T("samples must match"));
+      }
+
+      /// tests reading an AIFF file with big-endian samples
+      TEST_METHOD(TestReadAiff)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         std::vector<unsigned char> sampleData, expectedSampleData;
+         for (unsigned int index = 0; index < 6; index++)
+         {
+            AppendBE(sampleData, 0x1234 + index, 2);
+            AppendLE(expectedSampleData, 0x1234 + index, 2);
+         }
+
+         // 44100 Hz as 80-bit extended precision value
+         std::vector<unsigned char> common;
+         AppendBE(common, 1, 2); // channels
+         AppendBE(common, 6, 4); // sample frames
+         AppendBE(common, 16, 2); // bits per sample
+         AppendBE(common, 0x400E, 2);
+         AppendBE(common, 0xAC44000000000000ULL, 8);
+
+         std::vector<unsigned char> soundData;
+         AppendBE(soundData, 0, 4); // offset
+         AppendBE(soundData, 0, 4); // block size
+         soundData.insert(soundData.end(), sampleData.begin(), sampleData.end());
+
+         std::vector<unsigned char> chunks = { 'A', 'I', 'F', 'F' };
+         AppendChunk(chunks, "COMM", common, true);
+         AppendChunk(chunks, "SSND", soundData, true);
+
+         std::vector<unsigned char> fileData;
+         AppendChunk(fileData, "FORM", chunks, true);
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.aiff"));
+         WriteFile(filename, fileData);
+
+         Encoder::PcmFileReader reader;
+         Assert::IsTrue(reader.Open(filename), _T("AIFF file must be opened"));
+
+         Assert::AreEqual(44100U, reader.GetSampleRate(), _T("sample rate must match"));
+         Assert::AreEqual(16U, reader.GetBitsPerSample(), _T("bits per sample must match"));
+         Assert::AreEqual(6ULL, reader.GetNumFrames(), _T("number of frames must match"));
+
+         Assert::IsTrue(expectedSampleData == ReadAllFrames(reader, 4), _T("samples must have been byte-swapped"));
+      }
+
+      /// tests that files with unsupported formats are rejected
+      TEST_METHOD(TestUnsupportedFormats)
+      {
+         UnitTest::AutoCleanupFolder folder;
+
+         std::vector<unsigned char> sampleData(64, 0x80);
+
+         CString filename = Path::Combine(folder.FolderName(), _T("sample.wav"));
+
+         // 8-bit samples are unsigned
+         WriteFile(filename, CreateWaveFile(CreateWaveFormat(1, 2, 8, false), sampleData));
+
+         Encoder::PcmFileReader reader;
+         Assert::IsFalse(reader.Open(filename), _T("8-bit wave file must be rejected"));
+
+         // MS ADPCM
+         WriteFile(filename, CreateWaveFile(CreateWaveFormat(2, 2, 16, false), sampleData));
+         Assert::IsFalse(reader.Open(filename), _T("compressed wave file must be rejected"));
+
+         // no data chunk
+         std::vector<unsigned char> fileData = CreateWaveFile(CreateWaveFormat(1, 2, 16, false), sampleData);
+         memcpy(fileData.data() + 36, "junk", 4);
+
+         WriteFile(filename, fileData);
+         Assert::IsFalse(reader.Open(filename), _T("wave file without data chunk must be rejected"));
+         Assert::IsFalse(reader.IsOpen(), _T("reader must not be open"));
+      }
+   };
+} // namespace unittest
@@ -0,0 +1,155 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestResampler.cpp
+/// \brief Unit tests for the Resampler class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "Resampler.hpp"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for Resampler class
+   TEST_CLASS(TestResampler)
+   {
+   public:
+      /// resamples given sine wave in chunks, including flushing at the end
+      static std::vector<float> ResampleSine(Encoder::Resampler& resampler, int inputSampleRate,
+         double frequency, size_t numSamples, size_t chunkSize)
+      {
+         const double pi = 3.14159265358979323846;
+         size_t numChannels = resampler.GetNumChannels();
+
+         std::vector<float> samples(numSamples * numChannels);
+         for (size_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+            for (size_t channelIndex = 0; channelIndex < numChannels; channelIndex++)
+               samples[sampleIndex * numChannels + channelIndex] =
+                  static_cast<float>(0.5 * std::sin(2.0 * pi * frequency * sampleIndex / inputSampleRate));
+
+         std::vector<float> output, outputBuffer;
+         for (size_t offset = 0; offset < numSamples; offset += chunkSize)
+         {
+            size_t numChunkSamples = std::min(chunkSize, numSamples - offset);
+            size_t numOutputSamples = resampler.Process(samples.data() + offset * numChannels, numChunkSamples, outputBuffer);
+
+            Assert::AreEqual(numOutputSamples * numChannels, outputBuffer.size(), _T("output buffer must have the right size"));
+            output.insert(output.end(), outputBuffer.begin(), outputBuffer.end());
+         }
+
+         resampler.Flush(outputBuffer);
+         output.insert(output.end(), outputBuffer.begin(), outputBuffer.end());
+
+         return output;
+      }
+
+      /// tests invalid parameters
+      TEST_METHOD(TestInitInvalid)
+      {
+         Encoder::Resampler resampler;
+         Assert::IsFalse(resampler.IsActive(), _T("resampler must not be active"));
+
+         Assert::IsFalse(resampler.Init(0, 48000, 44100, Encoder::resamplerQualityNormal), _T("no channels must fail"));
+         Assert::IsFalse(resampler.Init(2, 0, 44100, Encoder::resamplerQualityNormal), _T("invalid sample rate must fail"));
+         Assert::IsFalse(resampler.Init(2, 768000, 8000, Encoder::resamplerQualityBest), _T("too large ratio must fail"));
+         Assert::IsFalse(resampler.IsActive(), _T("resampler must not be active"));
+
+         Assert::IsTrue(resampler.Init(2, 96000, 44100, Encoder::resamplerQualityNormal), _T("init must succeed"));
+         Assert::IsTrue(resampler.IsActive(), _T("resampler must be active"));
+      }
+
+      /// tests that the number of output samples only depends on the number of input samples
+      TEST_METHOD(TestNumOutputSamples)
+      {
+         const int sampleRates[][2] = { { 96000, 44100 }, { 44100, 48000 }, { 48000, 44100 }, { 44100, 44101 } };
+
+         for (const auto& rates : sampleRates)
+         {
+            for (size_t chunkSize : { size_t(1000), size_t(4096), size_t(100000) })
+            {
+               Encoder::Resampler resampler;
+               Assert::IsTrue(resampler.Init(2, rates[0], rates[1], Encoder::resamplerQualityFast), _T("init must succeed"));
+
+               std::vector<float> output = ResampleSine(resampler, rates[0], 1000.0, 10000, chunkSize);
+
+               size_t expectedNumSamples = static_cast<size_t>(
+                  (10000ULL * rates[1] + rates[0] - 1) / rates[0]);
+
+               Assert::AreEqual(expectedNumSamples * 2, output.size(), _T("number of output samples must match"));
+            }
+         }
+      }
+
+      /// tests that a sine wave is resampled without delay and distortion
+      TEST_METHOD(TestResampleSine)
+      {
+         const double pi = 3.14159265358979323846;
+
+         for (int quality = Encoder::resamplerQualityFast; quality <= Encoder::resamplerQualityBest; quality++)
+         {
+            Encoder::Resampler resampler;
+            Assert::IsTrue(resampler.Init(1, 96000, 44100, static_cast<Encoder::T_enResamplerQuality>(quality)),
+               _T("init must succeed"));
+
+            std::vector<float> output = ResampleSine(resampler, 96000, 1000.0, 96000, 4096);
+
+            // skip the start and the end, where the silence before and after the input is filtered in
+            double maxError = 0.0;
+            for (size_t sampleIndex = 1000; sampleIndex < output.size() - 1000; sampleIndex++)
+            {
+               double expected = 0.5 * std::sin(2.0 * pi * 1000.0 * sampleIndex / 44100);
+               maxError = std::max(maxError, std::abs(expected - output[sampleIndex]));
+            }
+
+            Assert::IsTrue(maxError < 1e-3, _T("resampled sine wave must match"));
+         }
+      }
+
+      /// tests that chunks too small to produce output samples don't change the output
+      TEST_METHOD(TestSmallChunks)
+      {
+         const int sampleRates[][2] = { { 96000, 44100 }, { 44100, 8000 }, { 44100, 48000 } };
+
+         for (const auto& rates : sampleRates)
+         {
+            Encoder::Resampler resampler;
+            Assert::IsTrue(resampler.Init(2, rates[0], rates[1], Encoder::resamplerQualityNormal), _T("init must succeed"));
+
+            std::vector<float> expectedOutput = ResampleSine(resampler, rates[0], 1000.0, 5000, 5000);
+
+            for (size_t chunkSize : { size_t(1), size_t(2), size_t(7) })
+            {
+               Assert::IsTrue(resampler.Init(2, rates[0], rates[1], Encoder::resamplerQualityNormal), _T("init must succeed"));
+
+               std::vector<float> output = ResampleSine(resampler, rates[0], 1000.0, 5000, chunkSize);
+
+               Assert::AreEqual(expectedOutput.size(), output.size(), _T("number of output samples must match"));
+
+               double maxError = 0.0;
+               for (size_t index = 0; index < output.size(); index++)
+                  maxError = std::max(maxError, double(std::abs(expectedOutput[index] - output[index])));
+
+               Assert::IsTrue(maxError < 1e-6, _T("output must not depend on the chunk size"));
+            }
+         }
+      }
+   };
+} // namespace unittest
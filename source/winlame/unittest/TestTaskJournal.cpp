@@ -0,0 +1,190 @@
+//
+// winLAME - a frontend for the LAME encoding engine
+// Copyright (c) 2000-2018 Michael Fink
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+/// \file TestTaskJournal.cpp
+/// \brief Unit tests for the TaskJournal class
+
+#include "stdafx.h"
+#include "CppUnitTest.h"
+#include "TaskJournal.hpp"
+#include <ulib/Path.hpp>
+#include <ulib/unittest/AutoCleanupFolder.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace unittest
+{
+   /// tests for TaskJournal class
+   TEST_CLASS(TestTaskJournal)
+   {
+   public:
+      /// creates encoder task settings for given input file
+      static Encoder::EncoderTaskSettings CreateSettings(const CString& inputFilename)
+      {
+         Encoder::EncoderTaskSettings settings;
+         settings.m_inputFilename = inputFilename;
+         settings.m_outputFolder = _T("C:\\Music\\Output");
+         settings.m_outputFilename = _T("C:\\Music\\Output\\track.mp3");
+         settings.m_outputModuleID = 1;
+         settings.m_title = _T("track");
+         settings.m_settingsManager.setValue(LameSimpleBitrate, 320);
+
+         return settings;
+      }
+
+      /// tests that finished tasks are not returned, and all settings are restored
+      TEST_METHOD(TestReadUnfinishedEntries)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+         CString journalFilename = Path::Combine(folder.FolderName(), _T("TaskJournal.txt"));
+
+         Encoder::EncoderTaskSettings settings2 = CreateSettings(_T("C:\\Music\\track2.wav"));
+         settings2.m_playlistFilename = _T("album.m3u");
+         settings2.m_outputSameFolder = true;
+         settings2.m_overwriteExisting = true;
+         settings2.m_gaplessPreviousInputFilename = _T("C:\\Music\\track1.wav");
+         settings2.m_gaplessNextInputFilename = _T("C:\\Music\\track3.wav");
+
+         // run
+         std::vector<TaskJournal::Entry> entriesList;
+         {
+            TaskJournal journal(journalFilename);
+
+            journal.TaskAdded(1, 0, CreateSettings(_T("C:\\Music\\track1.wav")));
+            journal.TaskAdded(2, 1, settings2);
+            journal.TaskAdded(3, 0, CreateSettings(_T("C:\\Music\\track3.wav")));
+
+            journal.TaskStarted(1);
+            journal.TaskFinished(1);
+            journal.TaskStarted(2);
+
+            entriesList = journal.ReadUnfinishedEntries();
+         }
+
+         // check
+         Assert::AreEqual<size_t>(2, entriesList.size(), _T("there must be two unfinished entries"));
+
+         TaskJournal::Entry& entry = entriesList[0];
+         Assert::AreEqual(2U, entry.m_taskId, _T("task id must match"));
+         Assert::AreEqual(1U, entry.m_dependentTaskId, _T("dependent task id must match"));
+
+         Encoder::EncoderTaskSettings& settings = entry.m_settings;
+         Assert::AreEqual(settings2.m_inputFilename.GetString(), settings.m_inputFilename.GetString(), _T("input filename must match"));
+         Assert::AreEqual(settings2.m_outputFolder.GetString(), settings.m_outputFolder.GetString(), _T("output folder must match"));
+         Assert::AreEqual(settings2.m_outputFilename.GetString(), settings.m_outputFilename.GetString(), _T("output filename must match"));
+         Assert::AreEqual(settings2.m_playlistFilename.GetString(), settings.m_playlistFilename.GetString(), _T("playlist filename must match"));
+         Assert::IsTrue(settings.m_outputSameFolder, _T("output same folder flag must match"));
+         Assert::IsTrue(settings.m_overwriteExisting, _T("overwrite flag must match"));
+         Assert::AreEqual(settings2.m_gaplessPreviousInputFilename.GetString(), settings.m_gaplessPreviousInputFilename.GetString(),
+            _T("previous gapless input filename must match"));
+         Assert::AreEqual(settings2.m_gaplessNextInputFilename.GetString(), settings.m_gaplessNextInputFilename.GetString(),
+            _T("next gapless input filename must match"));
+         Assert::AreEqual(320, settings.m_settingsManager.QueryValueInt(LameSimpleBitrate), _T("settings must match"));
+
+         Assert::AreEqual(3U, entriesList[1].m_taskId, _T("task id must match"));
+      }
+
+      /// tests that lines longer than the read buffer are read as one line
+      TEST_METHOD(TestReadLongLines)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+         CString journalFilename = Path::Combine(folder.FolderName(), _T("TaskJournal.txt"));
+
+         CString longFilename = _T("\\\\server\\share\\");
+         while (longFilename.GetLength() < 10000)
+            longFilename += _T("a long folder name\\");
+         longFilename += _T("track.wav");
+
+         Encoder::EncoderTaskSettings settings = CreateSettings(longFilename);
+         settings.m_outputFilename = longFilename + _T(".mp3");
+
+         // run
+         std::vector<TaskJournal::Entry> entriesList;
+         {
+            TaskJournal journal(journalFilename);
+            journal.TaskAdded(1, 0, settings);
+            journal.TaskAdded(2, 0, CreateSettings(_T("C:\\Music\\track2.wav")));
+
+            entriesList = journal.ReadUnfinishedEntries();
+         }
+
+         // check
+         Assert::AreEqual<size_t>(2, entriesList.size(), _T("there must be two entries"));
+         Assert::AreEqual(longFilename.GetString(), entriesList[0].m_settings.m_inputFilename.GetString(), _T("input filename must match"));
+         Assert::AreEqual(settings.m_outputFilename.GetString(), entriesList[0].m_settings.m_outputFilename.GetString(), _T("output filename must match"));
+         Assert::AreEqual(2U, entriesList[1].m_taskId, _T("task id must match"));
+      }
+
+      /// tests that tabs and line breaks in the title don't split the journal line
+      TEST_METHOD(TestTitleWithTabsAndLineBreaks)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+         CString journalFilename = Path::Combine(folder.FolderName(), _T("TaskJournal.txt"));
+
+         Encoder::EncoderTaskSettings settings = CreateSettings(_T("C:\\Music\\track1.wav"));
+         settings.m_title = _T("Artist\tTitle\r\nPart 2");
+
+         // run
+         std::vector<TaskJournal::Entry> entriesList;
+         {
+            TaskJournal journal(journalFilename);
+            journal.TaskAdded(1, 0, settings);
+
+            entriesList = journal.ReadUnfinishedEntries();
+         }
+
+         // check
+         Assert::AreEqual<size_t>(1, entriesList.size(), _T("there must be one entry"));
+         Assert::AreEqual(_T("Artist Title  Part 2"), entriesList[0].m_settings.m_title.GetString(),
+            _T("tabs and line breaks must be replaced by spaces"));
+         Assert::AreEqual(settings.m_inputFilename.GetString(), entriesList[0].m_settings.m_inputFilename.GetString(),
+            _T("input filename must match"));
+      }
+
+      /// tests that a line that was only partly written before a crash is ignored
+      TEST_METHOD(TestIgnorePartialLine)
+      {
+         // set up
+         UnitTest::AutoCleanupFolder folder;
+         CString journalFilename = Path::Combine(folder.FolderName(), _T("TaskJournal.txt"));
+
+         {
+            TaskJournal journal(journalFilename);
+            journal.TaskAdded(1, 0, CreateSettings(_T("C:\\Music\\track1.wav")));
+         }
+
+         FILE* fd = _tfopen(journalFilename, _T("at, ccs=UTF-8"));
+         Assert::IsNotNull(fd, _T("journal file must be able to be opened"));
+         _fputts(_T("F\t"), fd);
+         fclose(fd);
+
+         // run
+         TaskJournal journal(journalFilename);
+         std::vector<TaskJournal::Entry> entriesList = journal.ReadUnfinishedEntries();
+
+         // check
+         Assert::AreEqual<size_t>(1, entriesList.size(), _T("partly written line must be ignored"));
+
+         journal.Reset();
+         Assert::IsTrue(journal.ReadUnfinishedEntries().empty(), _T("journal must be empty after reset"));
+      }
+   };
+} // namespace unittest